@@ -13,6 +13,8 @@
 #include <Adafruit_MPU6050.h>
 #include <Adafruit_Sensor.h>
 
+#include "src/frame/frame.h"
+
 /* Private define ------------------------------------------------------------*/
 #define NUM_SAMPLES     50
 #define NUM_GESTURES    30
@@ -24,12 +26,89 @@
 #define GESTURE_TARGET  GESTURE_0
 //#define GESTURE_TARGET  GESTURE_1
 
+#define BINARY_FRAMES     0               // 1: raw counts in binary frames (neuton_tools/capture_decode), 0: CSV text
+#define SAMPLE_PERIOD_US  10000UL         // sampling period of the binary mode
+#define ACC_LSB_PER_G     2048            // MPU6050_RANGE_16_G
+#define GYRO_LSB_PER_DPS  131.0f          // MPU6050_RANGE_250_DEG
+#define DEG_TO_RAD_F      0.017453292519943295f
+#define MPU6050_DATA_REG  0x3B            // first of the accel, temp and gyro registers
+#define ACC_THRESHOLD_LSB (5L*ACC_LSB_PER_G/2) // ACC_THRESHOLD in counts
+
 /* Private variables ---------------------------------------------------------*/
 int samplesRead   = NUM_SAMPLES;
 int gesturesRead  = 0;
 
+#if BINARY_FRAMES
+uint16_t sequence = 0;
+uint8_t  frame[FRAME_MAX_SIZE];
+
+// value of one raw count of every measurement, in the units of mpu.getEvent()
+const FrameInfo frameInfo = {
+  FRAME_CHANNELS, NUM_SAMPLES, SAMPLE_PERIOD_US,
+  { G / ACC_LSB_PER_G, G / ACC_LSB_PER_G, G / ACC_LSB_PER_G,
+    DEG_TO_RAD_F / GYRO_LSB_PER_DPS, DEG_TO_RAD_F / GYRO_LSB_PER_DPS, DEG_TO_RAD_F / GYRO_LSB_PER_DPS }
+};
+#endif
+
 Adafruit_MPU6050 mpu;
 
+#if BINARY_FRAMES
+/**
+  * @brief  Read raw accelerometer and gyroscope counts (ax, ay, az, gx, gy, gz)
+  */
+void readRawMotion(int16_t* counts) {
+  Wire.beginTransmission(MPU6050_I2CADDR_DEFAULT);
+  Wire.write(MPU6050_DATA_REG);
+  Wire.endTransmission(false);
+  Wire.requestFrom(MPU6050_I2CADDR_DEFAULT, 14);
+
+  for (int i = 0; i < 7; i++) {
+    uint16_t value = (uint16_t) Wire.read() << 8;
+    value |= Wire.read();
+
+    // skip the temperature between the accelerometer and the gyroscope
+    if (i < 3) {
+      counts[i] = (int16_t) value;
+    } else if (i > 3) {
+      counts[i - 1] = (int16_t) value;
+    }
+  }
+}
+
+/**
+  * @brief  Capture one gesture as sample frames, read every SAMPLE_PERIOD_US from the motion
+  *         A frame is smaller than the Serial transmit buffer and is sent in less than the
+  *         period, so Serial.write() returns at once and does not move the next read.
+  */
+void captureGestureFrames() {
+  FrameSample sample;
+
+  // the settings go before every gesture, the decoder may start at any time
+  Serial.write(frame, FrameEncodeInfo(frame, &frameInfo));
+
+  // wait for significant motion
+  do {
+    readRawMotion(sample.counts);
+  } while (labs(sample.counts[0]) + labs(sample.counts[1]) + labs(sample.counts[2]) < ACC_THRESHOLD_LSB);
+
+  uint32_t next = micros();
+
+  // read samples of the detected motion on a fixed schedule, whatever the read and the send take
+  for (sample.index = 0; sample.index < NUM_SAMPLES; sample.index++) {
+    while ((int32_t) (micros() - next) < 0) {
+    }
+
+    sample.time = micros();
+    readRawMotion(sample.counts);
+    sample.sequence = sequence++;
+    sample.target = GESTURE_TARGET;
+    next += SAMPLE_PERIOD_US;
+
+    Serial.write(frame, FrameEncodeSample(frame, &sample));
+  }
+}
+#endif
+
 void setup() {
   // init serial port
   Serial.begin(115200);
@@ -50,6 +129,10 @@ void setup() {
   mpu.setGyroRange(MPU6050_RANGE_250_DEG);
   mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
 
+#if BINARY_FRAMES
+  // fast mode I2C: a sample is read in about 0.5 ms
+  Wire.setClock(400000);
+#else
   // print the CSV header (ax0,ay0,az0,...,gx49,gy49,gz49,target)
   for (int i=0; i<NUM_SAMPLES; i++) {
     Serial.print("aX");
@@ -67,8 +150,22 @@ void setup() {
     Serial.print(",");
   }
   Serial.println("target");
+#endif
 }
 
+#if BINARY_FRAMES
+void loop() {
+  while (gesturesRead < NUM_GESTURES) {
+    captureGestureFrames();
+    gesturesRead++;
+
+    // tell the decoder that the capture is complete
+    if (gesturesRead == NUM_GESTURES) {
+      Serial.write(frame, FrameEncodeEnd(frame, gesturesRead));
+    }
+  }
+}
+#else
 void loop() {
   sensors_event_t a, g, temp;
   
@@ -120,3 +217,4 @@ void loop() {
     gesturesRead++;
   }
 }
+#endif
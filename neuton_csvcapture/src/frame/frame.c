@@ -0,0 +1,261 @@
+#include <string.h>
+
+#include "frame.h"
+
+
+typedef enum FrameState_
+{
+	STATE_SYNC0 = 0,
+	STATE_SYNC1,
+	STATE_TYPE,
+	STATE_SIZE,
+	STATE_PAYLOAD,
+
+} FrameState;
+
+
+uint16_t FrameCrc16(uint16_t crc, const uint8_t* data, uint16_t size)
+{
+	while (size--)
+	{
+		crc ^= (uint16_t) *data++ << 8;
+
+		for (uint8_t bit = 0; bit < 8; ++bit)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+
+	return crc;
+}
+
+
+static inline uint8_t* Put16(uint8_t* out, uint16_t value)
+{
+	out[0] = (uint8_t) value;
+	out[1] = (uint8_t) (value >> 8);
+	return out + 2;
+}
+
+
+static inline uint8_t* Put32(uint8_t* out, uint32_t value)
+{
+	out = Put16(out, (uint16_t) value);
+	return Put16(out, (uint16_t) (value >> 16));
+}
+
+
+static inline uint16_t Get16(const uint8_t* in)
+{
+	return (uint16_t) (in[0] | (uint16_t) in[1] << 8);
+}
+
+
+static inline uint32_t Get32(const uint8_t* in)
+{
+	return Get16(in) | (uint32_t) Get16(in + 2) << 16;
+}
+
+
+/**
+ * \brief Add the sync, type and size before and the CRC after a payload written at frame + 4
+ * \return size of the frame
+ */
+static uint8_t Seal(uint8_t* frame, uint8_t type, uint8_t size)
+{
+	frame[0] = FRAME_SYNC0;
+	frame[1] = FRAME_SYNC1;
+	frame[2] = type;
+	frame[3] = size;
+
+	Put16(frame + 4 + size, FrameCrc16(0xFFFF, frame + 2, size + 2));
+
+	return size + FRAME_OVERHEAD;
+}
+
+
+uint8_t FrameEncodeInfo(uint8_t* frame, const FrameInfo* info)
+{
+	uint8_t* out = frame + 4;
+
+	*out++ = FRAME_VERSION;
+	*out++ = info->channels;
+	*out++ = info->samples;
+	out = Put32(out, info->period);
+
+	for (uint8_t ch = 0; ch < FRAME_CHANNELS; ++ch)
+	{
+		uint32_t bits;
+		memcpy(&bits, &info->units[ch], sizeof(bits));
+		out = Put32(out, bits);
+	}
+
+	return Seal(frame, FRAME_TYPE_INFO, FRAME_INFO_SIZE);
+}
+
+
+uint8_t FrameEncodeSample(uint8_t* frame, const FrameSample* sample)
+{
+	uint8_t* out = frame + 4;
+
+	out = Put16(out, sample->sequence);
+	out = Put32(out, sample->time);
+	*out++ = sample->index;
+	*out++ = sample->target;
+
+	for (uint8_t ch = 0; ch < FRAME_CHANNELS; ++ch)
+		out = Put16(out, (uint16_t) sample->counts[ch]);
+
+	return Seal(frame, FRAME_TYPE_SAMPLE, FRAME_SAMPLE_SIZE);
+}
+
+
+uint8_t FrameEncodeEnd(uint8_t* frame, uint16_t gestures)
+{
+	Put16(frame + 4, gestures);
+
+	return Seal(frame, FRAME_TYPE_END, FRAME_END_SIZE);
+}
+
+
+void FrameParserInit(FrameParser* parser)
+{
+	memset(parser, 0, sizeof(*parser));
+}
+
+
+/**
+ * \brief Look for a frame in the bytes of a rejected one after its sync, so a lost byte
+ *        costs only the frame it was lost from
+ */
+static void Rescan(FrameParser* parser)
+{
+	uint8_t bytes[FRAME_MAX_PAYLOAD + 4];
+	const uint8_t count = parser->received + 2;
+
+	bytes[0] = parser->type;
+	bytes[1] = parser->size;
+	memcpy(bytes + 2, parser->payload, parser->received);
+
+	parser->state = STATE_SYNC0;
+	parser->skipped += 2;
+
+	for (uint8_t idx = 0; idx < count; ++idx)
+		FrameParserPush(parser, bytes[idx]);
+}
+
+
+uint8_t FrameParserPush(FrameParser* parser, uint8_t byte)
+{
+	switch (parser->state)
+	{
+	case STATE_SYNC0:
+		if (byte == FRAME_SYNC0)
+			parser->state = STATE_SYNC1;
+		else
+			parser->skipped++;
+		break;
+
+	case STATE_SYNC1:
+		if (byte == FRAME_SYNC1)
+		{
+			parser->state = STATE_TYPE;
+		}
+		else if (byte != FRAME_SYNC0)
+		{
+			parser->state = STATE_SYNC0;
+			parser->skipped += 2;
+		}
+		else
+		{
+			parser->skipped++;
+		}
+		break;
+
+	case STATE_TYPE:
+		parser->type     = byte;
+		parser->received = 0;
+		parser->state    = STATE_SIZE;
+		break;
+
+	case STATE_SIZE:
+		parser->size  = byte;
+		parser->state = STATE_PAYLOAD;
+
+		if (byte > FRAME_MAX_PAYLOAD)
+			Rescan(parser);
+		break;
+
+	case STATE_PAYLOAD:
+		parser->payload[parser->received++] = byte;
+
+		if (parser->received < parser->size + 2u)
+			break;
+
+		uint16_t crc = FrameCrc16(0xFFFF, &parser->type, 1);
+		crc = FrameCrc16(crc, &parser->size, 1);
+		crc = FrameCrc16(crc, parser->payload, parser->size);
+
+		if (crc != Get16(parser->payload + parser->size))
+		{
+			parser->crcErrors++;
+			Rescan(parser);
+			break;
+		}
+
+		parser->state = STATE_SYNC0;
+		return parser->type;
+	}
+
+	return 0;
+}
+
+
+uint8_t FrameDecodeInfo(const FrameParser* parser, FrameInfo* info)
+{
+	const uint8_t* in = parser->payload;
+
+	if (parser->type != FRAME_TYPE_INFO || parser->size != FRAME_INFO_SIZE || in[0] != FRAME_VERSION ||
+		in[1] != FRAME_CHANNELS)
+		return 0;
+
+	info->channels = in[1];
+	info->samples  = in[2];
+	info->period   = Get32(in + 3);
+
+	for (uint8_t ch = 0; ch < FRAME_CHANNELS; ++ch)
+	{
+		const uint32_t bits = Get32(in + 7 + 4 * ch);
+		memcpy(&info->units[ch], &bits, sizeof(bits));
+	}
+
+	return 1;
+}
+
+
+uint8_t FrameDecodeSample(const FrameParser* parser, FrameSample* sample)
+{
+	const uint8_t* in = parser->payload;
+
+	if (parser->type != FRAME_TYPE_SAMPLE || parser->size != FRAME_SAMPLE_SIZE)
+		return 0;
+
+	sample->sequence = Get16(in);
+	sample->time     = Get32(in + 2);
+	sample->index    = in[6];
+	sample->target   = in[7];
+
+	for (uint8_t ch = 0; ch < FRAME_CHANNELS; ++ch)
+		sample->counts[ch] = (int16_t) Get16(in + 8 + 2 * ch);
+
+	return 1;
+}
+
+
+uint8_t FrameDecodeEnd(const FrameParser* parser, uint16_t* gestures)
+{
+	if (parser->type != FRAME_TYPE_END || parser->size != FRAME_END_SIZE)
+		return 0;
+
+	*gestures = Get16(parser->payload);
+
+	return 1;
+}
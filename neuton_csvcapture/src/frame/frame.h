@@ -0,0 +1,151 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * \brief Binary capture frames
+ * \details Every frame is
+ *
+ *          sync (2) | type (1) | payload size (1) | payload | CRC-16 (2)
+ *
+ *          The CRC-16/CCITT (polynomial 0x1021, initial 0xFFFF) covers the type, the size
+ *          and the payload. Multi-byte fields are little endian, floats are IEEE 754.
+ *          A receiver finds the next frame after a lost or damaged byte by the sync and
+ *          the CRC, and a lost sample frame by the sequence number.
+ */
+#define FRAME_SYNC0				0xA5
+#define FRAME_SYNC1				0x5A
+
+#define FRAME_TYPE_INFO			'I'
+#define FRAME_TYPE_SAMPLE		'S'
+#define FRAME_TYPE_END			'E'
+
+#define FRAME_VERSION			1
+
+/**
+ * \brief Counts in one sample: ax, ay, az, gx, gy, gz
+ */
+#define FRAME_CHANNELS			6
+
+#define FRAME_OVERHEAD			6
+#define FRAME_INFO_SIZE			(7 + 4 * FRAME_CHANNELS)
+#define FRAME_SAMPLE_SIZE		(8 + 2 * FRAME_CHANNELS)
+#define FRAME_END_SIZE			2
+#define FRAME_MAX_PAYLOAD		FRAME_INFO_SIZE
+#define FRAME_MAX_SIZE			(FRAME_OVERHEAD + FRAME_MAX_PAYLOAD)
+
+
+/**
+ * \brief Capture settings, sent before every gesture so a receiver can join at any time
+ */
+typedef struct FrameInfo_
+{
+	uint8_t  channels;
+	uint8_t  samples;
+	uint32_t period;
+	float    units[FRAME_CHANNELS];
+
+} FrameInfo;
+
+/**
+ * \brief One sample of a gesture
+ */
+typedef struct FrameSample_
+{
+	uint16_t sequence;
+	uint32_t time;
+	uint8_t  index;
+	uint8_t  target;
+	int16_t  counts[FRAME_CHANNELS];
+
+} FrameSample;
+
+/**
+ * \brief State of the receiver of a byte stream
+ */
+typedef struct FrameParser_
+{
+	uint8_t  state;
+	uint8_t  type;
+	uint8_t  size;
+	uint8_t  received;
+	uint8_t  payload[FRAME_MAX_PAYLOAD + 2];
+	uint32_t skipped;
+	uint32_t crcErrors;
+
+} FrameParser;
+
+
+/**
+ * \brief Update a CRC-16/CCITT
+ * \param crc - CRC of the preceding bytes, 0xFFFF at the start
+ * \param data - bytes
+ * \param size - number of bytes
+ * \return updated CRC
+ */
+extern uint16_t FrameCrc16(uint16_t crc, const uint8_t* data, uint16_t size);
+
+/**
+ * \brief Encode the info frame
+ * \param frame - output buffer of FRAME_MAX_SIZE bytes
+ * \return size of the frame
+ */
+extern uint8_t FrameEncodeInfo(uint8_t* frame, const FrameInfo* info);
+
+/**
+ * \brief Encode a sample frame
+ * \param frame - output buffer of FRAME_MAX_SIZE bytes
+ * \return size of the frame
+ */
+extern uint8_t FrameEncodeSample(uint8_t* frame, const FrameSample* sample);
+
+/**
+ * \brief Encode the end frame, sent after the last gesture
+ * \param frame - output buffer of FRAME_MAX_SIZE bytes
+ * \param gestures - number of gestures sent
+ * \return size of the frame
+ */
+extern uint8_t FrameEncodeEnd(uint8_t* frame, uint16_t gestures);
+
+/**
+ * \brief Reset the receiver
+ */
+extern void FrameParserInit(FrameParser* parser);
+
+/**
+ * \brief Feed one received byte
+ * \return type of the frame completed by the byte with a valid CRC, 0 otherwise;
+ *         the payload stays in the parser until the next byte
+ */
+extern uint8_t FrameParserPush(FrameParser* parser, uint8_t byte);
+
+/**
+ * \brief Decode the payload of a completed info frame
+ * \return 1 on success, 0 if the payload does not match
+ */
+extern uint8_t FrameDecodeInfo(const FrameParser* parser, FrameInfo* info);
+
+/**
+ * \brief Decode the payload of a completed sample frame
+ * \return 1 on success, 0 if the payload does not match
+ */
+extern uint8_t FrameDecodeSample(const FrameParser* parser, FrameSample* sample);
+
+/**
+ * \brief Decode the payload of a completed end frame
+ * \return 1 on success, 0 if the payload does not match
+ */
+extern uint8_t FrameDecodeEnd(const FrameParser* parser, uint16_t* gestures);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_H
@@ -14,19 +14,88 @@
 #include <Adafruit_Sensor.h>
 
 #include "src/Gesture Recognition_v1/user_app.h"
+#include "src/acquisition/acquisition.h"
 
 /* Private define ------------------------------------------------------------*/
 #define NUM_SAMPLES         50
 #define G                   9.80665f
-#define ACC_THRESHOLD       (2.5f*G)          // threshold of significant in G's
-#define GESTURE_ARRAY_SIZE  (6*NUM_SAMPLES+1) // 6 measurements (a,g)/sample + target
+#define ACC_LSB_PER_G       2048              // MPU6050_RANGE_16_G
+#define GYRO_LSB_PER_DPS    131.0f            // MPU6050_RANGE_250_DEG
+#define ACC_THRESHOLD       (5*ACC_LSB_PER_G/2) // threshold of significant motion (2.5 G)
+#define GESTURE_ARRAY_SIZE  (6*NUM_SAMPLES)   // 6 measurements (a,g)/sample
+#define MPU6050_DATA_REG    0x3B              // first of the accel, temp and gyro registers
+#define HOP_SAMPLES         0                 // inference on significant motion only (N: also every N samples)
+#define PRE_TRIGGER_SAMPLES 0                 // samples up to the significant motion in the window
+#define CONFIDENCE          0.5f              // minimum output of a detected gesture
+#define SAMPLE_PERIOD_MS    10                // sampling period of the training data (Timer1)
+#define STEP_NEURONS        2                 // neurons evaluated between two loop passes
+#define STATS_SAMPLES       0                 // print sample rate and jitter every N samples (0: never)
 
 /* Private variables ---------------------------------------------------------*/
-int   samplesRead                       = NUM_SAMPLES;
-float gestureArray[GESTURE_ARRAY_SIZE]  = {0};
+int16_t gestureArray[GESTURE_ARRAY_SIZE]  = {0};   // ring buffer of the last NUM_SAMPLES samples
+int     lastGesture                       = -1;
+AcqRing  acqRing;                                  // samples read by the timer interrupt, taken by loop()
+AcqStats acqStats;
+
+// value of one raw count of every measurement, in the units of mpu.getEvent()
+const float rawUnits[6] = {
+  G / ACC_LSB_PER_G, G / ACC_LSB_PER_G, G / ACC_LSB_PER_G,
+  DEG_TO_RAD / GYRO_LSB_PER_DPS, DEG_TO_RAD / GYRO_LSB_PER_DPS, DEG_TO_RAD / GYRO_LSB_PER_DPS
+};
 
 Adafruit_MPU6050 mpu;
 
+/**
+  * @brief  Read raw accelerometer and gyroscope counts (ax, ay, az, gx, gy, gz)
+  */
+void readRawMotion(int16_t* counts) {
+  Wire.beginTransmission(MPU6050_I2CADDR_DEFAULT);
+  Wire.write(MPU6050_DATA_REG);
+  Wire.endTransmission(false);
+  Wire.requestFrom(MPU6050_I2CADDR_DEFAULT, 14);
+
+  for (int i = 0; i < 7; i++) {
+    uint16_t value = (uint16_t) Wire.read() << 8;
+    value |= Wire.read();
+
+    // skip the temperature between the accelerometer and the gyroscope
+    if (i < 3) {
+      counts[i] = (int16_t) value;
+    } else if (i > 3) {
+      counts[i - 1] = (int16_t) value;
+    }
+  }
+}
+
+/**
+  * @brief  Timer1 compare interrupt: read a sample every SAMPLE_PERIOD_MS into the ring
+  *         Interrupts stay enabled (ISR_NOBLOCK), Wire needs them for the I2C transfer.
+  *         After setup() only this interrupt may use Wire.
+  */
+ISR(TIMER1_COMPA_vect, ISR_NOBLOCK) {
+  AcqSample* sample = AcqRingWriteSlot(&acqRing);
+
+  // the ring is full if loop() is ACQ_RING_SIZE samples behind, the sample is dropped then
+  if (sample) {
+    sample->time = micros();
+    readRawMotion(sample->counts);
+    AcqRingCommit(&acqRing);
+  }
+}
+
+/**
+  * @brief  Start Timer1 in CTC mode with a compare interrupt every SAMPLE_PERIOD_MS
+  */
+void startSampleTimer() {
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM12) | _BV(CS11) | _BV(CS10);    // CTC, clock / 64
+  TCNT1  = 0;
+  OCR1A  = (F_CPU / 64 / 1000) * SAMPLE_PERIOD_MS - 1;
+  TIMSK1 = _BV(OCIE1A);
+  interrupts();
+}
+
 void setup() {
   // init serial port
   Serial.begin(115200);
@@ -47,8 +116,13 @@ void setup() {
   mpu.setGyroRange(MPU6050_RANGE_250_DEG);
   mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
 
-  // init Neuton neural network model
-  if (!model_init()) {
+  // fast mode I2C: a sample is read in about 0.5 ms inside the timer interrupt
+  Wire.setClock(400000);
+
+  // init Neuton neural network model, the sensor scale is folded into the model inputs
+  // and the last input is the bias (1.0), as in the training data read by the library
+  if (!model_init() || !model_set_raw_units(rawUnits, 6, 1.0f) ||
+      !model_stream_init(gestureArray, GESTURE_ARRAY_SIZE, 6, HOP_SAMPLES)) {
     Serial.print("Failed to initialize Neuton model!");
     while (1) {
       delay(10);
@@ -56,76 +130,80 @@ void setup() {
   }
 
   Serial.println("Neuton neural network model: Gesture recognition system");
+
+  // start sampling
+  AcqRingInit(&acqRing);
+  AcqStatsInit(&acqStats, SAMPLE_PERIOD_MS * 1000UL);
+  startSampleTimer();
 }
 
 void loop() {
-  sensors_event_t a, g, temp;
-  
-  // wait for significant motion
-  while (samplesRead == NUM_SAMPLES) {
-    // read the acceleration data
-    mpu.getEvent(&a, &g, &temp);
-    
+  AcqSample sample;
+  uint32_t size_out = 0;
+
+  // take the samples read by the timer interrupt, in order; they were read on time even if
+  // loop() was held up by the inference or Serial
+  while (AcqRingRead(&acqRing, &sample)) {
+    // append the sample to the window (model input), start the inference if it is due;
+    // the window is converted at the start, so the next samples do not change the result
+    if (model_stream_push(sample.counts) && !model_start_stream_inference()) {
+      Serial.println("Inference fail to execute");
+    }
+
     // sum up the absolutes
-    float aSum = fabs(a.acceleration.x) + fabs(a.acceleration.y) + fabs(a.acceleration.z);
-    
-    // check if it's above the threshold
+    int32_t aSum = labs(sample.counts[0]) + labs(sample.counts[1]) + labs(sample.counts[2]);
+
+    // significant motion: run the inference once the next samples fill the window,
+    // which starts after the sample of the motion as the gesture capture always did
     if (aSum >= ACC_THRESHOLD) {
-      // reset the sample read count
-      samplesRead = 0;
-      break;
+      model_stream_trigger(PRE_TRIGGER_SAMPLES);
     }
+
+    AcqStatsAdd(&acqStats, sample.time);
   }
 
-  // read samples of the detected motion
-  while (samplesRead < NUM_SAMPLES) {
-    // read the acceleration and gyroscope data
-    mpu.getEvent(&a, &g, &temp);
-
-    // fill gesture array (model input)
-    gestureArray[samplesRead*6 + 0] = a.acceleration.x;
-    gestureArray[samplesRead*6 + 1] = a.acceleration.y;
-    gestureArray[samplesRead*6 + 2] = a.acceleration.z;
-    gestureArray[samplesRead*6 + 3] = g.gyro.x;
-    gestureArray[samplesRead*6 + 4] = g.gyro.y;
-    gestureArray[samplesRead*6 + 5] = g.gyro.z;
-    
-    samplesRead++;
-    
-    delay(10);
+  // report the achieved sample rate, the largest deviation from the period and the drops
+  if (STATS_SAMPLES && acqStats.samples >= STATS_SAMPLES) {
+    Serial.print("Sampling: ");
+    Serial.print(AcqStatsRate(&acqStats));
+    Serial.print(" Hz, jitter ");
+    Serial.print(AcqStatsJitter(&acqStats));
+    Serial.print(" us, overruns ");
+    Serial.println(AcqRingOverruns(&acqRing));
+    AcqStatsInit(&acqStats, SAMPLE_PERIOD_MS * 1000UL);
+  }
+
+  // evaluate the next neurons of the running inference, the result comes with the last step
+  float* result = model_inference_step(STEP_NEURONS, &size_out);
 
-    // check the end of gesture acquisition
-    if (samplesRead == NUM_SAMPLES) {
-      uint32_t size_out = 0;
-      
-      // run model inference
-      float* result = model_run_inference(gestureArray, GESTURE_ARRAY_SIZE, &size_out);
-
-      // check if model inference result is valid
-      if (result && size_out) {
-        // check if problem is binary classification
-        if (size_out >= 2) { 
-          // check if one of the result has >50% of accuracy
-          if (result[0] > 0.5) {
-            Serial.print("Detected gesture: 0 ");
-            Serial.print("[Accuracy: ");
-            Serial.print(result[0]);
-            Serial.println("]");
-          } else if (result[1] > 0.5) {
-            Serial.print("Detected gesture: 1 ");
-            Serial.print("[Accuracy: ");
-            Serial.print(result[1]);
-            Serial.println("]");
-          } else {
-			      // solution is not reliable
-            Serial.println("Detected gesture: NONE");
-          }
-        } else {
-          Serial.println("Inference result not valid");
-        }
-      } else {
-        Serial.println("Inference fail to execute");
+  // check if model inference is complete and its result is valid
+  if (result && size_out) {
+    // check if problem is binary classification
+    if (size_out >= 2) {
+      int gesture = -1;
+
+      // check if one of the result is above the confidence
+      if (result[0] > CONFIDENCE) {
+        gesture = 0;
+      } else if (result[1] > CONFIDENCE) {
+        gesture = 1;
+      }
+
+      // continuous mode reports the changes only
+      if (gesture >= 0 && (HOP_SAMPLES == 0 || gesture != lastGesture)) {
+        Serial.print("Detected gesture: ");
+        Serial.print(gesture);
+        Serial.print(" [Accuracy: ");
+        Serial.print(result[gesture]);
+        Serial.println("]");
+      } else if (gesture < 0 && HOP_SAMPLES == 0) {
+        // solution is not reliable
+        Serial.println("Detected gesture: NONE");
       }
+
+      lastGesture = gesture;
+    } else {
+      Serial.println("Inference result not valid");
     }
   }
 }
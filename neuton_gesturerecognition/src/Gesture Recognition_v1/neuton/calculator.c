@@ -41,6 +41,21 @@ inline Err CalculatorLoadFromMemory(NeuralNet* neuralNet, const void* model, uin
 }
 
 
+inline Err CalculatorLoadFromMemoryInto(NeuralNet* neuralNet, const void* model, uint32_t size, uint8_t copy,
+										void* arena, uint32_t arenaSize)
+{
+	if (!model || !size)
+		return ERR_BAD_ARGUMENT;
+
+	Err err = NLoadModelInto(arena, arenaSize, model, size, neuralNet, copy);
+
+	if (ERR_NO_ERROR == err)
+		err = CalculatorOnLoad(neuralNet);
+
+	return err;
+}
+
+
 inline Err CalculatorLoadFromFile(NeuralNet* neuralNet, const char* fileName)
 {
 	Err err = NLoadModelEx(fileName, neuralNet);
@@ -67,16 +82,90 @@ inline float* CalculatorRunInference(NeuralNet* neuralNet, float* inputs)
 		return NULL;
 
 	/**
-	 * Normalize sample values in the buffer
+	 * Normalize sample values and convert them to the model inputs
 	 */
-	NNormalizeSample(inputs, neuralNet);
+	NPrepareSample(inputs, neuralNet);
 
 	CalculatorOnInferenceStart(neuralNet);
 
 	/**
 	 * Get result of prediction
 	 */
-	float* result = NRunInference(neuralNet, inputs);
+	float* result = NRunPreparedInference(neuralNet, inputs);
+	if (!result)
+		return result;
+
+	CalculatorOnInferenceEnd(neuralNet);
+
+	/**
+	 * Restore result values
+	 */
+	NDenormalizeResult(result, neuralNet);
+
+	CalculatorOnInferenceResult(neuralNet, result);
+
+	return result;
+}
+
+
+inline float* CalculatorRunRawInference(NeuralNet* neuralNet, const int16_t* counts)
+{
+	if (!neuralNet || !counts)
+		return NULL;
+
+	const NRawView view = { counts, NULL, neuralNet->inputsDim - 1u };
+
+	return CalculatorRunRawInferenceView(neuralNet, &view);
+}
+
+
+inline float* CalculatorRunRawInferenceView(NeuralNet* neuralNet, const NRawView* view)
+{
+	if (!neuralNet || !view)
+		return NULL;
+
+	CalculatorOnInferenceStart(neuralNet);
+
+	/**
+	 * Convert raw counts to the model inputs and get result of prediction
+	 */
+	float* result = NRunRawInferenceView(neuralNet, view);
+	if (!result)
+		return result;
+
+	CalculatorOnInferenceEnd(neuralNet);
+
+	/**
+	 * Restore result values
+	 */
+	NDenormalizeResult(result, neuralNet);
+
+	CalculatorOnInferenceResult(neuralNet, result);
+
+	return result;
+}
+
+
+inline Err CalculatorStartRawInferenceView(NeuralNet* neuralNet, const NRawView* view)
+{
+	if (!neuralNet || !view)
+		return ERR_BAD_ARGUMENT;
+
+	CalculatorOnInferenceStart(neuralNet);
+
+	/**
+	 * Convert raw counts to the model inputs, neurons are evaluated by the steps
+	 */
+	return NStartRawInference(neuralNet, &neuralNet->context, view);
+}
+
+
+inline float* CalculatorInferenceStep(NeuralNet* neuralNet, uint32_t budget)
+{
+	if (!neuralNet)
+		return NULL;
+
+	float* result = NInferenceStep(neuralNet, &neuralNet->context, budget);
 	if (!result)
 		return result;
 
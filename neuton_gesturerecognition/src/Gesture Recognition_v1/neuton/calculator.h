@@ -31,6 +31,19 @@ void CalculatorFree(NeuralNet* neuralNet);
  */
 Err CalculatorLoadFromMemory(NeuralNet* neuralNet, const void* model, uint32_t size, uint8_t copy);
 
+/**
+ * @brief Load model from memory into caller's arena, with no heap allocations
+ * @param neuralNet - pointer to NeuralNet structure
+ * @param model - pointer to model data
+ * @param size - size of model data
+ * @param copy - flag of the need to copy the model sections into the arena
+ * @param arena - memory for the model, see @NModelMemoryRequirements
+ * @param arenaSize - size of the arena
+ * @return Error code
+ */
+Err CalculatorLoadFromMemoryInto(NeuralNet* neuralNet, const void* model, uint32_t size, uint8_t copy,
+								 void* arena, uint32_t arenaSize);
+
 /**
  * @brief Load model from file
  * @param neuralNet - pointer to NeuralNet structure
@@ -54,6 +67,39 @@ Err CalculatorRunApplication(NeuralNet* neuralNet);
  */
 float* CalculatorRunInference(NeuralNet* neuralNet, float* inputs);
 
+/**
+ * @brief Run inference on raw sensor counts, see @NSetRawInputs
+ * @param neuralNet - pointer to NeuralNet structure
+ * @param counts - raw counts of the inputs except bias (neuralNet->inputsDim - 1 elements)
+ * @return pointer to buffer with output values (neuralNet->outputsDim elements)
+ */
+float* CalculatorRunRawInference(NeuralNet* neuralNet, const int16_t* counts);
+
+/**
+ * @brief Run inference on raw sensor counts stored in two parts, see @NRunRawInferenceView
+ * @param neuralNet - pointer to NeuralNet structure
+ * @param view - raw counts of the inputs except bias (neuralNet->inputsDim - 1 in total)
+ * @return pointer to buffer with output values (neuralNet->outputsDim elements)
+ */
+float* CalculatorRunRawInferenceView(NeuralNet* neuralNet, const NRawView* view);
+
+/**
+ * @brief Start a time-sliced inference on raw sensor counts, see @NStartRawInference
+ * @param neuralNet - pointer to NeuralNet structure
+ * @param view - raw counts of the inputs except bias (neuralNet->inputsDim - 1 in total)
+ * @return error code or 0 on success
+ */
+Err CalculatorStartRawInferenceView(NeuralNet* neuralNet, const NRawView* view);
+
+/**
+ * @brief Evaluate the next neurons of the time-sliced inference, see @NInferenceStep
+ * @param neuralNet - pointer to NeuralNet structure
+ * @param budget - maximal number of neurons to evaluate
+ * @return pointer to buffer with output values (neuralNet->outputsDim elements)
+ *         once the inference is complete, NULL before
+ */
+float* CalculatorInferenceStep(NeuralNet* neuralNet, uint32_t budget);
+
 /**
  *
  * Callback functions
@@ -0,0 +1,494 @@
+#include "kernels.h"
+
+#if (NEUTON_SIMD == 1)
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+
+static const NKernels scalarKernels =
+{
+	DotQ8Scalar, DotQ16Scalar, DotF32Scalar,
+	DotLinksQ16Scalar, DotLinksF32Scalar,
+	KERNELS_SCALAR
+};
+
+
+#if defined(__x86_64__)
+
+#define TARGET_SSE41	__attribute__((target("sse4.1")))
+#define TARGET_AVX2		__attribute__((target("avx2,fma")))
+
+
+TARGET_SSE41 static inline int32_t HorizontalSumSse41(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(v);
+}
+
+
+TARGET_SSE41 static inline int64_t HorizontalSum64Sse41(__m128i v)
+{
+	return _mm_cvtsi128_si64(v) + _mm_extract_epi64(v, 1);
+}
+
+
+TARGET_SSE41 static int32_t DotQ8Sse41(const int8_t* weights, const uint16_t* links,
+									   const uint8_t* values, uint16_t count)
+{
+	__m128i summ = _mm_setzero_si128();
+	uint16_t idx = 0;
+
+	for (; idx + 8 <= count; idx += 8)
+	{
+		const __m128i firstValues  = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*) (weights + idx)));
+		const __m128i secondValues = _mm_setr_epi16(
+				values[links[idx+0]], values[links[idx+1]], values[links[idx+2]], values[links[idx+3]],
+				values[links[idx+4]], values[links[idx+5]], values[links[idx+6]], values[links[idx+7]]);
+		summ = _mm_add_epi32(summ, _mm_madd_epi16(firstValues, secondValues));
+	}
+
+	return HorizontalSumSse41(summ) + DotQ8Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+TARGET_SSE41 static int64_t DotQ16Sse41(const int16_t* weights, const uint16_t* links,
+										const uint16_t* values, uint16_t count)
+{
+	__m128i summ = _mm_setzero_si128();
+	uint16_t idx = 0;
+
+	for (; idx + 4 <= count; idx += 4)
+	{
+		const __m128i firstValues  = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*) (weights + idx)));
+		const __m128i secondValues = _mm_setr_epi32(
+				values[links[idx+0]], values[links[idx+1]], values[links[idx+2]], values[links[idx+3]]);
+		const __m128i products     = _mm_mullo_epi32(firstValues, secondValues);
+
+		summ = _mm_add_epi64(summ, _mm_cvtepi32_epi64(products));
+		summ = _mm_add_epi64(summ, _mm_cvtepi32_epi64(_mm_srli_si128(products, 8)));
+	}
+
+	return HorizontalSum64Sse41(summ) + DotQ16Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+TARGET_SSE41 static double DotF32Sse41(const float* weights, const uint16_t* links,
+									   const float* values, uint16_t count)
+{
+	__m128d summ = _mm_setzero_pd();
+	uint16_t idx = 0;
+
+	for (; idx + 2 <= count; idx += 2)
+	{
+		const __m128d firstValues  = _mm_setr_pd(weights[idx], weights[idx+1]);
+		const __m128d secondValues = _mm_setr_pd(values[links[idx]], values[links[idx+1]]);
+		summ = _mm_add_pd(summ, _mm_mul_pd(firstValues, secondValues));
+	}
+
+	summ = _mm_add_sd(summ, _mm_unpackhi_pd(summ, summ));
+
+	return _mm_cvtsd_f64(summ) + DotF32Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+TARGET_SSE41 static int64_t DotLinksQ16Sse41(const NLinkQ16* records, const uint16_t* values, uint16_t count)
+{
+	__m128i summ = _mm_setzero_si128();
+	uint16_t idx = 0;
+
+	for (; idx + 4 <= count; idx += 4)
+	{
+		const __m128i firstValues  = _mm_srai_epi32(_mm_loadu_si128((const __m128i*) (records + idx)), 16);
+		const __m128i secondValues = _mm_setr_epi32(
+				values[NLinkQ16Index(records[idx+0])], values[NLinkQ16Index(records[idx+1])],
+				values[NLinkQ16Index(records[idx+2])], values[NLinkQ16Index(records[idx+3])]);
+		const __m128i products     = _mm_mullo_epi32(firstValues, secondValues);
+
+		summ = _mm_add_epi64(summ, _mm_cvtepi32_epi64(products));
+		summ = _mm_add_epi64(summ, _mm_cvtepi32_epi64(_mm_srli_si128(products, 8)));
+	}
+
+	return HorizontalSum64Sse41(summ) + DotLinksQ16Scalar(records + idx, values, count - idx);
+}
+
+
+TARGET_SSE41 static double DotLinksF32Sse41(const NLinkF32* records, const float* values, uint16_t count)
+{
+	__m128d summ = _mm_setzero_pd();
+	uint16_t idx = 0;
+
+	for (; idx + 2 <= count; idx += 2)
+	{
+		const __m128d firstValues  = _mm_setr_pd(records[idx].weight, records[idx+1].weight);
+		const __m128d secondValues = _mm_setr_pd(values[records[idx].link], values[records[idx+1].link]);
+		summ = _mm_add_pd(summ, _mm_mul_pd(firstValues, secondValues));
+	}
+
+	summ = _mm_add_sd(summ, _mm_unpackhi_pd(summ, summ));
+
+	return _mm_cvtsd_f64(summ) + DotLinksF32Scalar(records + idx, values, count - idx);
+}
+
+
+TARGET_AVX2 static inline int32_t HorizontalSumAvx2(__m256i v)
+{
+	const __m128i half = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	return HorizontalSumSse41(half);
+}
+
+
+TARGET_AVX2 static inline int64_t HorizontalSum64Avx2(__m256i v)
+{
+	const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	return HorizontalSum64Sse41(half);
+}
+
+
+TARGET_AVX2 static inline __m256i LoadLinksAvx2(const uint16_t* links)
+{
+	return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*) links));
+}
+
+
+TARGET_AVX2 static inline __m256i WidenAddAvx2(__m256i summ, __m256i products)
+{
+	summ = _mm256_add_epi64(summ, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(products)));
+	return _mm256_add_epi64(summ, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(products, 1)));
+}
+
+
+TARGET_AVX2 static int32_t DotQ8Avx2(const int8_t* weights, const uint16_t* links,
+									 const uint8_t* values, uint16_t count)
+{
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+	__m256i summ = _mm256_setzero_si256();
+	uint16_t idx = 0;
+
+	for (; idx + 8 <= count; idx += 8)
+	{
+		const __m256i firstValues  = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*) (weights + idx)));
+		const __m256i secondValues = _mm256_and_si256(mask,
+				_mm256_i32gather_epi32((const int*) values, LoadLinksAvx2(links + idx), sizeof(*values)));
+		summ = _mm256_add_epi32(summ, _mm256_mullo_epi32(firstValues, secondValues));
+	}
+
+	return HorizontalSumAvx2(summ) + DotQ8Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+TARGET_AVX2 static int64_t DotQ16Avx2(const int16_t* weights, const uint16_t* links,
+									  const uint16_t* values, uint16_t count)
+{
+	const __m256i mask = _mm256_set1_epi32(0xFFFF);
+	__m256i summ = _mm256_setzero_si256();
+	uint16_t idx = 0;
+
+	for (; idx + 8 <= count; idx += 8)
+	{
+		const __m256i firstValues  = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*) (weights + idx)));
+		const __m256i secondValues = _mm256_and_si256(mask,
+				_mm256_i32gather_epi32((const int*) values, LoadLinksAvx2(links + idx), sizeof(*values)));
+		summ = WidenAddAvx2(summ, _mm256_mullo_epi32(firstValues, secondValues));
+	}
+
+	return HorizontalSum64Avx2(summ) + DotQ16Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+TARGET_AVX2 static double DotF32Avx2(const float* weights, const uint16_t* links,
+									 const float* values, uint16_t count)
+{
+	__m256d summLow  = _mm256_setzero_pd();
+	__m256d summHigh = _mm256_setzero_pd();
+	uint16_t idx = 0;
+
+	for (; idx + 8 <= count; idx += 8)
+	{
+		const __m256 firstValues  = _mm256_loadu_ps(weights + idx);
+		const __m256 secondValues = _mm256_i32gather_ps(values, LoadLinksAvx2(links + idx), sizeof(*values));
+
+		summLow  = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(firstValues)),
+								   _mm256_cvtps_pd(_mm256_castps256_ps128(secondValues)), summLow);
+		summHigh = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(firstValues, 1)),
+								   _mm256_cvtps_pd(_mm256_extractf128_ps(secondValues, 1)), summHigh);
+	}
+
+	const __m256d summ = _mm256_add_pd(summLow, summHigh);
+	__m128d half = _mm_add_pd(_mm256_castpd256_pd128(summ), _mm256_extractf128_pd(summ, 1));
+	half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+
+	return _mm_cvtsd_f64(half) + DotF32Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+TARGET_AVX2 static int64_t DotLinksQ16Avx2(const NLinkQ16* records, const uint16_t* values, uint16_t count)
+{
+	const __m256i mask = _mm256_set1_epi32(0xFFFF);
+	__m256i summ = _mm256_setzero_si256();
+	uint16_t idx = 0;
+
+	for (; idx + 8 <= count; idx += 8)
+	{
+		const __m256i links        = _mm256_loadu_si256((const __m256i*) (records + idx));
+		const __m256i firstValues  = _mm256_srai_epi32(links, 16);
+		const __m256i secondValues = _mm256_and_si256(mask,
+				_mm256_i32gather_epi32((const int*) values, _mm256_and_si256(links, mask), sizeof(*values)));
+		summ = WidenAddAvx2(summ, _mm256_mullo_epi32(firstValues, secondValues));
+	}
+
+	return HorizontalSum64Avx2(summ) + DotLinksQ16Scalar(records + idx, values, count - idx);
+}
+
+
+TARGET_AVX2 static double DotLinksF32Avx2(const NLinkF32* records, const float* values, uint16_t count)
+{
+	__m256d summLow  = _mm256_setzero_pd();
+	__m256d summHigh = _mm256_setzero_pd();
+	uint16_t idx = 0;
+
+	for (; idx + 8 <= count; idx += 8)
+	{
+		// Both shuffles pick records 0 1 4 5 | 2 3 6 7, so links and weights stay paired
+		const __m256  low          = _mm256_loadu_ps((const float*) (records + idx));
+		const __m256  high         = _mm256_loadu_ps((const float*) (records + idx + 4));
+		const __m256i links        = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m256  firstValues  = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+		const __m256  secondValues = _mm256_i32gather_ps(values, links, sizeof(*values));
+
+		summLow  = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(firstValues)),
+								   _mm256_cvtps_pd(_mm256_castps256_ps128(secondValues)), summLow);
+		summHigh = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(firstValues, 1)),
+								   _mm256_cvtps_pd(_mm256_extractf128_ps(secondValues, 1)), summHigh);
+	}
+
+	const __m256d summ = _mm256_add_pd(summLow, summHigh);
+	__m128d half = _mm_add_pd(_mm256_castpd256_pd128(summ), _mm256_extractf128_pd(summ, 1));
+	half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+
+	return _mm_cvtsd_f64(half) + DotLinksF32Scalar(records + idx, values, count - idx);
+}
+
+
+static const NKernels sse41Kernels =
+{
+	DotQ8Sse41, DotQ16Sse41, DotF32Sse41,
+	DotLinksQ16Sse41, DotLinksF32Sse41,
+	KERNELS_SSE41
+};
+
+static const NKernels avx2Kernels =
+{
+	DotQ8Avx2, DotQ16Avx2, DotF32Avx2,
+	DotLinksQ16Avx2, DotLinksF32Avx2,
+	KERNELS_AVX2
+};
+
+#endif // __x86_64__
+
+
+#if defined(__aarch64__)
+
+static inline uint32x4_t GatherU16Neon(const uint16_t* values, const uint16_t* links)
+{
+	uint16x4_t gathered = vdup_n_u16(0);
+	gathered = vset_lane_u16(values[links[0]], gathered, 0);
+	gathered = vset_lane_u16(values[links[1]], gathered, 1);
+	gathered = vset_lane_u16(values[links[2]], gathered, 2);
+	gathered = vset_lane_u16(values[links[3]], gathered, 3);
+	return vmovl_u16(gathered);
+}
+
+
+static int32_t DotQ8Neon(const int8_t* weights, const uint16_t* links,
+						 const uint8_t* values, uint16_t count)
+{
+	int32x4_t summ = vdupq_n_s32(0);
+	uint16_t idx = 0;
+
+	for (; idx + 8 <= count; idx += 8)
+	{
+		uint16x8_t gathered = vdupq_n_u16(0);
+		gathered = vsetq_lane_u16(values[links[idx+0]], gathered, 0);
+		gathered = vsetq_lane_u16(values[links[idx+1]], gathered, 1);
+		gathered = vsetq_lane_u16(values[links[idx+2]], gathered, 2);
+		gathered = vsetq_lane_u16(values[links[idx+3]], gathered, 3);
+		gathered = vsetq_lane_u16(values[links[idx+4]], gathered, 4);
+		gathered = vsetq_lane_u16(values[links[idx+5]], gathered, 5);
+		gathered = vsetq_lane_u16(values[links[idx+6]], gathered, 6);
+		gathered = vsetq_lane_u16(values[links[idx+7]], gathered, 7);
+
+		const int16x8_t firstValues  = vmovl_s8(vld1_s8(weights + idx));
+		const int16x8_t secondValues = vreinterpretq_s16_u16(gathered);
+
+		summ = vmlal_s16(summ, vget_low_s16(firstValues), vget_low_s16(secondValues));
+		summ = vmlal_high_s16(summ, firstValues, secondValues);
+	}
+
+	return vaddvq_s32(summ) + DotQ8Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+static int64_t DotQ16Neon(const int16_t* weights, const uint16_t* links,
+						  const uint16_t* values, uint16_t count)
+{
+	int64x2_t summ = vdupq_n_s64(0);
+	uint16_t idx = 0;
+
+	for (; idx + 4 <= count; idx += 4)
+	{
+		const int32x4_t firstValues  = vmovl_s16(vld1_s16(weights + idx));
+		const int32x4_t secondValues = vreinterpretq_s32_u32(GatherU16Neon(values, links + idx));
+
+		summ = vmlal_s32(summ, vget_low_s32(firstValues), vget_low_s32(secondValues));
+		summ = vmlal_high_s32(summ, firstValues, secondValues);
+	}
+
+	return vaddvq_s64(summ) + DotQ16Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+static double DotF32Neon(const float* weights, const uint16_t* links,
+						 const float* values, uint16_t count)
+{
+	float64x2_t summ = vdupq_n_f64(0.0);
+	uint16_t idx = 0;
+
+	for (; idx + 4 <= count; idx += 4)
+	{
+		float32x4_t secondValues = vdupq_n_f32(0.0f);
+		secondValues = vsetq_lane_f32(values[links[idx+0]], secondValues, 0);
+		secondValues = vsetq_lane_f32(values[links[idx+1]], secondValues, 1);
+		secondValues = vsetq_lane_f32(values[links[idx+2]], secondValues, 2);
+		secondValues = vsetq_lane_f32(values[links[idx+3]], secondValues, 3);
+
+		const float32x4_t firstValues = vld1q_f32(weights + idx);
+
+		summ = vfmaq_f64(summ, vcvt_f64_f32(vget_low_f32(firstValues)), vcvt_f64_f32(vget_low_f32(secondValues)));
+		summ = vfmaq_f64(summ, vcvt_high_f64_f32(firstValues), vcvt_high_f64_f32(secondValues));
+	}
+
+	return vaddvq_f64(summ) + DotF32Scalar(weights + idx, links + idx, values, count - idx);
+}
+
+
+static inline int32x4_t GatherLinksU16Neon(const uint16_t* values, const NLinkQ16* records)
+{
+	uint32x4_t gathered = vdupq_n_u32(0);
+	gathered = vsetq_lane_u32(values[NLinkQ16Index(records[0])], gathered, 0);
+	gathered = vsetq_lane_u32(values[NLinkQ16Index(records[1])], gathered, 1);
+	gathered = vsetq_lane_u32(values[NLinkQ16Index(records[2])], gathered, 2);
+	gathered = vsetq_lane_u32(values[NLinkQ16Index(records[3])], gathered, 3);
+	return vreinterpretq_s32_u32(gathered);
+}
+
+
+static int64_t DotLinksQ16Neon(const NLinkQ16* records, const uint16_t* values, uint16_t count)
+{
+	int64x2_t summ = vdupq_n_s64(0);
+	uint16_t idx = 0;
+
+	for (; idx + 4 <= count; idx += 4)
+	{
+		const int32x4_t firstValues  = vshrq_n_s32(vreinterpretq_s32_u32(vld1q_u32(records + idx)), 16);
+		const int32x4_t secondValues = GatherLinksU16Neon(values, records + idx);
+
+		summ = vmlal_s32(summ, vget_low_s32(firstValues), vget_low_s32(secondValues));
+		summ = vmlal_high_s32(summ, firstValues, secondValues);
+	}
+
+	return vaddvq_s64(summ) + DotLinksQ16Scalar(records + idx, values, count - idx);
+}
+
+
+static double DotLinksF32Neon(const NLinkF32* records, const float* values, uint16_t count)
+{
+	float64x2_t summ = vdupq_n_f64(0.0);
+	uint16_t idx = 0;
+
+	for (; idx + 4 <= count; idx += 4)
+	{
+		// De-interleaves the records: val[0] holds the links, val[1] the weights
+		const float32x4x2_t loaded = vld2q_f32((const float*) (records + idx));
+
+		float32x4_t secondValues = vdupq_n_f32(0.0f);
+		secondValues = vsetq_lane_f32(values[records[idx+0].link], secondValues, 0);
+		secondValues = vsetq_lane_f32(values[records[idx+1].link], secondValues, 1);
+		secondValues = vsetq_lane_f32(values[records[idx+2].link], secondValues, 2);
+		secondValues = vsetq_lane_f32(values[records[idx+3].link], secondValues, 3);
+
+		const float32x4_t firstValues = loaded.val[1];
+
+		summ = vfmaq_f64(summ, vcvt_f64_f32(vget_low_f32(firstValues)), vcvt_f64_f32(vget_low_f32(secondValues)));
+		summ = vfmaq_f64(summ, vcvt_high_f64_f32(firstValues), vcvt_high_f64_f32(secondValues));
+	}
+
+	return vaddvq_f64(summ) + DotLinksF32Scalar(records + idx, values, count - idx);
+}
+
+
+static const NKernels neonKernels =
+{
+	DotQ8Neon, DotQ16Neon, DotF32Neon,
+	DotLinksQ16Neon, DotLinksF32Neon,
+	KERNELS_NEON
+};
+
+#endif // __aarch64__
+
+
+const NKernels* NKernelsGet(NKernelsType type)
+{
+	switch (type)
+	{
+	case KERNELS_SCALAR:
+		return &scalarKernels;
+
+#if defined(__x86_64__)
+	case KERNELS_SSE41:
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("sse4.1") ? &sse41Kernels : NULL;
+
+	case KERNELS_AVX2:
+		__builtin_cpu_init();
+		return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? &avx2Kernels : NULL;
+#endif
+
+#if defined(__aarch64__)
+	case KERNELS_NEON:
+#if defined(__linux__)
+		return (getauxval(AT_HWCAP) & HWCAP_ASIMD) ? &neonKernels : NULL;
+#else
+		return &neonKernels;
+#endif
+#endif
+
+	default:
+		return NULL;
+	}
+}
+
+
+const NKernels* NKernelsSelect(void)
+{
+	static const NKernelsType preferred[] = { KERNELS_AVX2, KERNELS_SSE41, KERNELS_NEON };
+
+	for (uint32_t i = 0; i < sizeof(preferred) / sizeof(preferred[0]); ++i)
+	{
+		const NKernels* kernels = NKernelsGet(preferred[i]);
+		if (kernels)
+			return kernels;
+	}
+
+	return &scalarKernels;
+}
+
+#endif // NEUTON_SIMD
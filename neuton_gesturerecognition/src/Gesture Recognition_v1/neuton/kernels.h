@@ -0,0 +1,190 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if !defined(NEUTON_SIMD)
+#if (defined(__x86_64__) || defined(__aarch64__)) && defined(__GNUC__)
+#define NEUTON_SIMD				1
+#else
+#define NEUTON_SIMD				0
+#endif
+#endif
+
+
+/**
+ * \brief Interleaved link of the 16 bit models: neuron or input index in the low
+ *        16 bits, signed weight in the high 16 bits
+ */
+typedef uint32_t NLinkQ16;
+
+/**
+ * \brief Interleaved link of the float models
+ */
+typedef struct NLinkF32_
+{
+	uint32_t link;
+	float    weight;
+
+} NLinkF32;
+
+
+static inline NLinkQ16 NLinkQ16Make(uint16_t link, int16_t weight)
+{
+	return (uint32_t) link | (uint32_t) (uint16_t) weight << 16;
+}
+
+
+static inline uint16_t NLinkQ16Index(NLinkQ16 record)
+{
+	return (uint16_t) (record & 0xFFFF);
+}
+
+
+static inline int16_t NLinkQ16Weight(NLinkQ16 record)
+{
+	return (int16_t) (record >> 16);
+}
+
+
+/**
+ * \brief Kernels instruction set
+ */
+typedef enum NKernelsType_
+{
+	KERNELS_SCALAR  = 0,
+	KERNELS_SSE41   = 1,
+	KERNELS_AVX2    = 2,
+	KERNELS_NEON    = 3,
+
+} NKernelsType;
+
+/**
+ * \brief Dot products of weights and values gathered by links
+ * \details All functions compute sum(weights[i] * values[links[i]]) for i < count,
+ *          dotLinks variants read links and weights from interleaved records.
+ *          Integer variants are bit-exact with the scalar implementation.
+ */
+typedef struct NKernels_
+{
+	int32_t (*dotQ8) (const int8_t* weights, const uint16_t* links, const uint8_t* values, uint16_t count);
+	int64_t (*dotQ16)(const int16_t* weights, const uint16_t* links, const uint16_t* values, uint16_t count);
+	double  (*dotF32)(const float* weights, const uint16_t* links, const float* values, uint16_t count);
+
+	int64_t (*dotLinksQ16)(const NLinkQ16* records, const uint16_t* values, uint16_t count);
+	double  (*dotLinksF32)(const NLinkF32* records, const float* values, uint16_t count);
+
+	NKernelsType type;
+
+} NKernels;
+
+
+static inline int32_t DotQ8Scalar(const int8_t* weights, const uint16_t* links,
+								  const uint8_t* values, uint16_t count)
+{
+	int32_t summ = 0;
+
+	for (uint16_t idx = 0; idx < count; ++idx)
+	{
+		const int32_t firstValue  = (int32_t) weights[idx];
+		const int32_t secondValue = (int32_t) values[links[idx]];
+		summ += firstValue * secondValue;
+	}
+
+	return summ;
+}
+
+
+static inline int64_t DotQ16Scalar(const int16_t* weights, const uint16_t* links,
+								   const uint16_t* values, uint16_t count)
+{
+	int64_t summ = 0;
+
+	for (uint16_t idx = 0; idx < count; ++idx)
+	{
+		const int64_t firstValue  = (int64_t) weights[idx];
+		const int64_t secondValue = (int64_t) values[links[idx]];
+		summ += firstValue * secondValue;
+	}
+
+	return summ;
+}
+
+
+static inline double DotF32Scalar(const float* weights, const uint16_t* links,
+								  const float* values, uint16_t count)
+{
+	double summ = 0;
+
+	for (uint16_t idx = 0; idx < count; ++idx)
+	{
+		const double firstValue  = (double) weights[idx];
+		const double secondValue = (double) values[links[idx]];
+		summ += firstValue * secondValue;
+	}
+
+	return summ;
+}
+
+
+static inline int64_t DotLinksQ16Scalar(const NLinkQ16* records, const uint16_t* values, uint16_t count)
+{
+	int64_t summ = 0;
+
+	for (uint16_t idx = 0; idx < count; ++idx)
+	{
+		const int64_t firstValue  = (int64_t) NLinkQ16Weight(records[idx]);
+		const int64_t secondValue = (int64_t) values[NLinkQ16Index(records[idx])];
+		summ += firstValue * secondValue;
+	}
+
+	return summ;
+}
+
+
+static inline double DotLinksF32Scalar(const NLinkF32* records, const float* values, uint16_t count)
+{
+	double summ = 0;
+
+	for (uint16_t idx = 0; idx < count; ++idx)
+	{
+		const double firstValue  = (double) records[idx].weight;
+		const double secondValue = (double) values[records[idx].link];
+		summ += firstValue * secondValue;
+	}
+
+	return summ;
+}
+
+
+#if (NEUTON_SIMD == 1)
+/**
+ * \brief Bytes that vector kernels may read past the last gathered value
+ */
+#define NEUTON_SIMD_PADDING		sizeof(uint32_t)
+
+/**
+ * \brief Select the fastest kernels supported by the CPU
+ * \return pointer to kernels table, never NULL
+ */
+extern const NKernels* NKernelsSelect(void);
+
+/**
+ * \brief Get kernels for the instruction set
+ * \param type - instruction set
+ * \return pointer to kernels table or NULL if not supported by the CPU or the build
+ */
+extern const NKernels* NKernelsGet(NKernelsType type);
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KERNELS_H
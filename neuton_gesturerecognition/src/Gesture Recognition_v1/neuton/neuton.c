@@ -1,5 +1,8 @@
 #include "neuton.h"
+#include "kernels.h"
+#include "scheduler.h"
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -13,6 +16,21 @@
 #define SEEK_END	2	/* Seek from end of file.  */
 #endif
 
+#if !defined(NEUTON_MMAP)
+#if defined(__linux__) && defined(NEUTON_USE_STDIO)
+#define NEUTON_MMAP				1
+#else
+#define NEUTON_MMAP				0
+#endif
+#endif
+
+#if (NEUTON_MMAP == 1)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 #define MAX_INPUT_FLOAT			0.9999999f
 #define MAX_INPUT_DOUBLE		0.999999999999999
@@ -27,6 +45,32 @@
 #if !defined(NEUTON_Q16_SUPPORT)
 #define NEUTON_Q16_SUPPORT		1
 #endif
+#if !defined(NEUTON_BATCH_SIZE)
+#define NEUTON_BATCH_SIZE		1
+#endif
+#if !defined(NEUTON_INPUT_SCALES)
+#define NEUTON_INPUT_SCALES		1
+#endif
+#if !defined(NEUTON_INTERLEAVED_LINKS)
+#define NEUTON_INTERLEAVED_LINKS	0
+#endif
+#if !defined(NEUTON_THREADS_MIN_NEURONS)
+#define NEUTON_THREADS_MIN_NEURONS	256
+#endif
+#if !defined(NEUTON_CRC_SLICE_BY_8)
+#if (UINTPTR_MAX > 0xFFFFu)
+#define NEUTON_CRC_SLICE_BY_8	1
+#else
+#define NEUTON_CRC_SLICE_BY_8	0
+#endif
+#endif
+#if !defined(NEUTON_CRC_CACHE_SIZE)
+#define NEUTON_CRC_CACHE_SIZE	0
+#endif
+
+#if (NEUTON_THREADS == 1) && (NEUTON_CRC_CACHE_SIZE > 0)
+#include <pthread.h>
+#endif
 
 
 #if defined(NEUTON_MEMORY_BENCHMARK)
@@ -60,6 +104,41 @@ extern uint32_t _NeutonExtraMemoryUsage();
 
 static const uint8_t pointerTypeSize = sizeof(void*);
 
+/**
+ * \brief Alignment of 4 byte values required by the target, 1 on 8 bit targets
+ */
+typedef struct AlignProbe_
+{
+	uint8_t  byte;
+	uint32_t value;
+
+} AlignProbe;
+
+static const uint8_t valueAlign = offsetof(AlignProbe, value);
+
+#if (NEUTON_SIMD == 1)
+static const NKernels* kernels = NULL;
+#endif
+
+
+typedef float* (*InferenceKernel)(const NeuralNet* model, NContext* context, const float* inputs);
+
+/**
+ * \brief Get inference kernel specialised for the model
+ * \param model - loaded model
+ * \param offsetTypeSize - size of the int/ext links offsets
+ * \return kernel or NULL if model is not supported
+ */
+static InferenceKernel SelectInference(const NeuralNet* model, uint8_t offsetTypeSize);
+
+#if (NEUTON_THREADS == 1)
+/**
+ * \brief Stop threads of the parallel inference and restore the sequential kernel
+ * \param model - model of neural network
+ */
+static void FreeParallel(NeuralNet* model);
+#endif
+
 
 /**
  * \brief File types
@@ -266,21 +345,399 @@ static inline uint32_t NFileSize(NFile* file)
 }
 
 
+#if (NEUTON_CRC_SLICE_BY_8 == 1)
+/**
+ * \brief CRC tables of 1 - 8 bytes, constant so loads from several threads share them
+ */
+static const uint32_t crcTables[8][256] = {
+	{
+		0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
+		0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91,
+		0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
+		0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9, 0xfa0f3d63, 0x8d080df5,
+		0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172, 0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
+		0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
+		0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423, 0xcfba9599, 0xb8bda50f,
+		0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924, 0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d,
+		0x76dc4190, 0x01db7106, 0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
+		0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
+		0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e, 0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457,
+		0x65b0d9c6, 0x12b7e950, 0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
+		0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb,
+		0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0, 0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9,
+		0x5005713c, 0x270241aa, 0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
+		0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad,
+		0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a, 0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683,
+		0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
+		0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb, 0x196c3671, 0x6e6b06e7,
+		0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc, 0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
+		0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
+		0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55, 0x316e8eef, 0x4669be79,
+		0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236, 0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f,
+		0xc5ba3bbe, 0xb2bd0b28, 0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
+		0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
+		0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38, 0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21,
+		0x86d3d2d4, 0xf1d4e242, 0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
+		0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45,
+		0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2, 0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db,
+		0xaed16a4a, 0xd9d65adc, 0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
+		0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf,
+		0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
+	},
+	{
+		0x00000000, 0x191b3141, 0x32366282, 0x2b2d53c3, 0x646cc504, 0x7d77f445, 0x565aa786, 0x4f4196c7,
+		0xc8d98a08, 0xd1c2bb49, 0xfaefe88a, 0xe3f4d9cb, 0xacb54f0c, 0xb5ae7e4d, 0x9e832d8e, 0x87981ccf,
+		0x4ac21251, 0x53d92310, 0x78f470d3, 0x61ef4192, 0x2eaed755, 0x37b5e614, 0x1c98b5d7, 0x05838496,
+		0x821b9859, 0x9b00a918, 0xb02dfadb, 0xa936cb9a, 0xe6775d5d, 0xff6c6c1c, 0xd4413fdf, 0xcd5a0e9e,
+		0x958424a2, 0x8c9f15e3, 0xa7b24620, 0xbea97761, 0xf1e8e1a6, 0xe8f3d0e7, 0xc3de8324, 0xdac5b265,
+		0x5d5daeaa, 0x44469feb, 0x6f6bcc28, 0x7670fd69, 0x39316bae, 0x202a5aef, 0x0b07092c, 0x121c386d,
+		0xdf4636f3, 0xc65d07b2, 0xed705471, 0xf46b6530, 0xbb2af3f7, 0xa231c2b6, 0x891c9175, 0x9007a034,
+		0x179fbcfb, 0x0e848dba, 0x25a9de79, 0x3cb2ef38, 0x73f379ff, 0x6ae848be, 0x41c51b7d, 0x58de2a3c,
+		0xf0794f05, 0xe9627e44, 0xc24f2d87, 0xdb541cc6, 0x94158a01, 0x8d0ebb40, 0xa623e883, 0xbf38d9c2,
+		0x38a0c50d, 0x21bbf44c, 0x0a96a78f, 0x138d96ce, 0x5ccc0009, 0x45d73148, 0x6efa628b, 0x77e153ca,
+		0xbabb5d54, 0xa3a06c15, 0x888d3fd6, 0x91960e97, 0xded79850, 0xc7cca911, 0xece1fad2, 0xf5facb93,
+		0x7262d75c, 0x6b79e61d, 0x4054b5de, 0x594f849f, 0x160e1258, 0x0f152319, 0x243870da, 0x3d23419b,
+		0x65fd6ba7, 0x7ce65ae6, 0x57cb0925, 0x4ed03864, 0x0191aea3, 0x188a9fe2, 0x33a7cc21, 0x2abcfd60,
+		0xad24e1af, 0xb43fd0ee, 0x9f12832d, 0x8609b26c, 0xc94824ab, 0xd05315ea, 0xfb7e4629, 0xe2657768,
+		0x2f3f79f6, 0x362448b7, 0x1d091b74, 0x04122a35, 0x4b53bcf2, 0x52488db3, 0x7965de70, 0x607eef31,
+		0xe7e6f3fe, 0xfefdc2bf, 0xd5d0917c, 0xcccba03d, 0x838a36fa, 0x9a9107bb, 0xb1bc5478, 0xa8a76539,
+		0x3b83984b, 0x2298a90a, 0x09b5fac9, 0x10aecb88, 0x5fef5d4f, 0x46f46c0e, 0x6dd93fcd, 0x74c20e8c,
+		0xf35a1243, 0xea412302, 0xc16c70c1, 0xd8774180, 0x9736d747, 0x8e2de606, 0xa500b5c5, 0xbc1b8484,
+		0x71418a1a, 0x685abb5b, 0x4377e898, 0x5a6cd9d9, 0x152d4f1e, 0x0c367e5f, 0x271b2d9c, 0x3e001cdd,
+		0xb9980012, 0xa0833153, 0x8bae6290, 0x92b553d1, 0xddf4c516, 0xc4eff457, 0xefc2a794, 0xf6d996d5,
+		0xae07bce9, 0xb71c8da8, 0x9c31de6b, 0x852aef2a, 0xca6b79ed, 0xd37048ac, 0xf85d1b6f, 0xe1462a2e,
+		0x66de36e1, 0x7fc507a0, 0x54e85463, 0x4df36522, 0x02b2f3e5, 0x1ba9c2a4, 0x30849167, 0x299fa026,
+		0xe4c5aeb8, 0xfdde9ff9, 0xd6f3cc3a, 0xcfe8fd7b, 0x80a96bbc, 0x99b25afd, 0xb29f093e, 0xab84387f,
+		0x2c1c24b0, 0x350715f1, 0x1e2a4632, 0x07317773, 0x4870e1b4, 0x516bd0f5, 0x7a468336, 0x635db277,
+		0xcbfad74e, 0xd2e1e60f, 0xf9ccb5cc, 0xe0d7848d, 0xaf96124a, 0xb68d230b, 0x9da070c8, 0x84bb4189,
+		0x03235d46, 0x1a386c07, 0x31153fc4, 0x280e0e85, 0x674f9842, 0x7e54a903, 0x5579fac0, 0x4c62cb81,
+		0x8138c51f, 0x9823f45e, 0xb30ea79d, 0xaa1596dc, 0xe554001b, 0xfc4f315a, 0xd7626299, 0xce7953d8,
+		0x49e14f17, 0x50fa7e56, 0x7bd72d95, 0x62cc1cd4, 0x2d8d8a13, 0x3496bb52, 0x1fbbe891, 0x06a0d9d0,
+		0x5e7ef3ec, 0x4765c2ad, 0x6c48916e, 0x7553a02f, 0x3a1236e8, 0x230907a9, 0x0824546a, 0x113f652b,
+		0x96a779e4, 0x8fbc48a5, 0xa4911b66, 0xbd8a2a27, 0xf2cbbce0, 0xebd08da1, 0xc0fdde62, 0xd9e6ef23,
+		0x14bce1bd, 0x0da7d0fc, 0x268a833f, 0x3f91b27e, 0x70d024b9, 0x69cb15f8, 0x42e6463b, 0x5bfd777a,
+		0xdc656bb5, 0xc57e5af4, 0xee530937, 0xf7483876, 0xb809aeb1, 0xa1129ff0, 0x8a3fcc33, 0x9324fd72
+	},
+	{
+		0x00000000, 0x01c26a37, 0x0384d46e, 0x0246be59, 0x0709a8dc, 0x06cbc2eb, 0x048d7cb2, 0x054f1685,
+		0x0e1351b8, 0x0fd13b8f, 0x0d9785d6, 0x0c55efe1, 0x091af964, 0x08d89353, 0x0a9e2d0a, 0x0b5c473d,
+		0x1c26a370, 0x1de4c947, 0x1fa2771e, 0x1e601d29, 0x1b2f0bac, 0x1aed619b, 0x18abdfc2, 0x1969b5f5,
+		0x1235f2c8, 0x13f798ff, 0x11b126a6, 0x10734c91, 0x153c5a14, 0x14fe3023, 0x16b88e7a, 0x177ae44d,
+		0x384d46e0, 0x398f2cd7, 0x3bc9928e, 0x3a0bf8b9, 0x3f44ee3c, 0x3e86840b, 0x3cc03a52, 0x3d025065,
+		0x365e1758, 0x379c7d6f, 0x35dac336, 0x3418a901, 0x3157bf84, 0x3095d5b3, 0x32d36bea, 0x331101dd,
+		0x246be590, 0x25a98fa7, 0x27ef31fe, 0x262d5bc9, 0x23624d4c, 0x22a0277b, 0x20e69922, 0x2124f315,
+		0x2a78b428, 0x2bbade1f, 0x29fc6046, 0x283e0a71, 0x2d711cf4, 0x2cb376c3, 0x2ef5c89a, 0x2f37a2ad,
+		0x709a8dc0, 0x7158e7f7, 0x731e59ae, 0x72dc3399, 0x7793251c, 0x76514f2b, 0x7417f172, 0x75d59b45,
+		0x7e89dc78, 0x7f4bb64f, 0x7d0d0816, 0x7ccf6221, 0x798074a4, 0x78421e93, 0x7a04a0ca, 0x7bc6cafd,
+		0x6cbc2eb0, 0x6d7e4487, 0x6f38fade, 0x6efa90e9, 0x6bb5866c, 0x6a77ec5b, 0x68315202, 0x69f33835,
+		0x62af7f08, 0x636d153f, 0x612bab66, 0x60e9c151, 0x65a6d7d4, 0x6464bde3, 0x662203ba, 0x67e0698d,
+		0x48d7cb20, 0x4915a117, 0x4b531f4e, 0x4a917579, 0x4fde63fc, 0x4e1c09cb, 0x4c5ab792, 0x4d98dda5,
+		0x46c49a98, 0x4706f0af, 0x45404ef6, 0x448224c1, 0x41cd3244, 0x400f5873, 0x4249e62a, 0x438b8c1d,
+		0x54f16850, 0x55330267, 0x5775bc3e, 0x56b7d609, 0x53f8c08c, 0x523aaabb, 0x507c14e2, 0x51be7ed5,
+		0x5ae239e8, 0x5b2053df, 0x5966ed86, 0x58a487b1, 0x5deb9134, 0x5c29fb03, 0x5e6f455a, 0x5fad2f6d,
+		0xe1351b80, 0xe0f771b7, 0xe2b1cfee, 0xe373a5d9, 0xe63cb35c, 0xe7fed96b, 0xe5b86732, 0xe47a0d05,
+		0xef264a38, 0xeee4200f, 0xeca29e56, 0xed60f461, 0xe82fe2e4, 0xe9ed88d3, 0xebab368a, 0xea695cbd,
+		0xfd13b8f0, 0xfcd1d2c7, 0xfe976c9e, 0xff5506a9, 0xfa1a102c, 0xfbd87a1b, 0xf99ec442, 0xf85cae75,
+		0xf300e948, 0xf2c2837f, 0xf0843d26, 0xf1465711, 0xf4094194, 0xf5cb2ba3, 0xf78d95fa, 0xf64fffcd,
+		0xd9785d60, 0xd8ba3757, 0xdafc890e, 0xdb3ee339, 0xde71f5bc, 0xdfb39f8b, 0xddf521d2, 0xdc374be5,
+		0xd76b0cd8, 0xd6a966ef, 0xd4efd8b6, 0xd52db281, 0xd062a404, 0xd1a0ce33, 0xd3e6706a, 0xd2241a5d,
+		0xc55efe10, 0xc49c9427, 0xc6da2a7e, 0xc7184049, 0xc25756cc, 0xc3953cfb, 0xc1d382a2, 0xc011e895,
+		0xcb4dafa8, 0xca8fc59f, 0xc8c97bc6, 0xc90b11f1, 0xcc440774, 0xcd866d43, 0xcfc0d31a, 0xce02b92d,
+		0x91af9640, 0x906dfc77, 0x922b422e, 0x93e92819, 0x96a63e9c, 0x976454ab, 0x9522eaf2, 0x94e080c5,
+		0x9fbcc7f8, 0x9e7eadcf, 0x9c381396, 0x9dfa79a1, 0x98b56f24, 0x99770513, 0x9b31bb4a, 0x9af3d17d,
+		0x8d893530, 0x8c4b5f07, 0x8e0de15e, 0x8fcf8b69, 0x8a809dec, 0x8b42f7db, 0x89044982, 0x88c623b5,
+		0x839a6488, 0x82580ebf, 0x801eb0e6, 0x81dcdad1, 0x8493cc54, 0x8551a663, 0x8717183a, 0x86d5720d,
+		0xa9e2d0a0, 0xa820ba97, 0xaa6604ce, 0xaba46ef9, 0xaeeb787c, 0xaf29124b, 0xad6fac12, 0xacadc625,
+		0xa7f18118, 0xa633eb2f, 0xa4755576, 0xa5b73f41, 0xa0f829c4, 0xa13a43f3, 0xa37cfdaa, 0xa2be979d,
+		0xb5c473d0, 0xb40619e7, 0xb640a7be, 0xb782cd89, 0xb2cddb0c, 0xb30fb13b, 0xb1490f62, 0xb08b6555,
+		0xbbd72268, 0xba15485f, 0xb853f606, 0xb9919c31, 0xbcde8ab4, 0xbd1ce083, 0xbf5a5eda, 0xbe9834ed
+	},
+	{
+		0x00000000, 0xb8bc6765, 0xaa09c88b, 0x12b5afee, 0x8f629757, 0x37def032, 0x256b5fdc, 0x9dd738b9,
+		0xc5b428ef, 0x7d084f8a, 0x6fbde064, 0xd7018701, 0x4ad6bfb8, 0xf26ad8dd, 0xe0df7733, 0x58631056,
+		0x5019579f, 0xe8a530fa, 0xfa109f14, 0x42acf871, 0xdf7bc0c8, 0x67c7a7ad, 0x75720843, 0xcdce6f26,
+		0x95ad7f70, 0x2d111815, 0x3fa4b7fb, 0x8718d09e, 0x1acfe827, 0xa2738f42, 0xb0c620ac, 0x087a47c9,
+		0xa032af3e, 0x188ec85b, 0x0a3b67b5, 0xb28700d0, 0x2f503869, 0x97ec5f0c, 0x8559f0e2, 0x3de59787,
+		0x658687d1, 0xdd3ae0b4, 0xcf8f4f5a, 0x7733283f, 0xeae41086, 0x525877e3, 0x40edd80d, 0xf851bf68,
+		0xf02bf8a1, 0x48979fc4, 0x5a22302a, 0xe29e574f, 0x7f496ff6, 0xc7f50893, 0xd540a77d, 0x6dfcc018,
+		0x359fd04e, 0x8d23b72b, 0x9f9618c5, 0x272a7fa0, 0xbafd4719, 0x0241207c, 0x10f48f92, 0xa848e8f7,
+		0x9b14583d, 0x23a83f58, 0x311d90b6, 0x89a1f7d3, 0x1476cf6a, 0xaccaa80f, 0xbe7f07e1, 0x06c36084,
+		0x5ea070d2, 0xe61c17b7, 0xf4a9b859, 0x4c15df3c, 0xd1c2e785, 0x697e80e0, 0x7bcb2f0e, 0xc377486b,
+		0xcb0d0fa2, 0x73b168c7, 0x6104c729, 0xd9b8a04c, 0x446f98f5, 0xfcd3ff90, 0xee66507e, 0x56da371b,
+		0x0eb9274d, 0xb6054028, 0xa4b0efc6, 0x1c0c88a3, 0x81dbb01a, 0x3967d77f, 0x2bd27891, 0x936e1ff4,
+		0x3b26f703, 0x839a9066, 0x912f3f88, 0x299358ed, 0xb4446054, 0x0cf80731, 0x1e4da8df, 0xa6f1cfba,
+		0xfe92dfec, 0x462eb889, 0x549b1767, 0xec277002, 0x71f048bb, 0xc94c2fde, 0xdbf98030, 0x6345e755,
+		0x6b3fa09c, 0xd383c7f9, 0xc1366817, 0x798a0f72, 0xe45d37cb, 0x5ce150ae, 0x4e54ff40, 0xf6e89825,
+		0xae8b8873, 0x1637ef16, 0x048240f8, 0xbc3e279d, 0x21e91f24, 0x99557841, 0x8be0d7af, 0x335cb0ca,
+		0xed59b63b, 0x55e5d15e, 0x47507eb0, 0xffec19d5, 0x623b216c, 0xda874609, 0xc832e9e7, 0x708e8e82,
+		0x28ed9ed4, 0x9051f9b1, 0x82e4565f, 0x3a58313a, 0xa78f0983, 0x1f336ee6, 0x0d86c108, 0xb53aa66d,
+		0xbd40e1a4, 0x05fc86c1, 0x1749292f, 0xaff54e4a, 0x322276f3, 0x8a9e1196, 0x982bbe78, 0x2097d91d,
+		0x78f4c94b, 0xc048ae2e, 0xd2fd01c0, 0x6a4166a5, 0xf7965e1c, 0x4f2a3979, 0x5d9f9697, 0xe523f1f2,
+		0x4d6b1905, 0xf5d77e60, 0xe762d18e, 0x5fdeb6eb, 0xc2098e52, 0x7ab5e937, 0x680046d9, 0xd0bc21bc,
+		0x88df31ea, 0x3063568f, 0x22d6f961, 0x9a6a9e04, 0x07bda6bd, 0xbf01c1d8, 0xadb46e36, 0x15080953,
+		0x1d724e9a, 0xa5ce29ff, 0xb77b8611, 0x0fc7e174, 0x9210d9cd, 0x2aacbea8, 0x38191146, 0x80a57623,
+		0xd8c66675, 0x607a0110, 0x72cfaefe, 0xca73c99b, 0x57a4f122, 0xef189647, 0xfdad39a9, 0x45115ecc,
+		0x764dee06, 0xcef18963, 0xdc44268d, 0x64f841e8, 0xf92f7951, 0x41931e34, 0x5326b1da, 0xeb9ad6bf,
+		0xb3f9c6e9, 0x0b45a18c, 0x19f00e62, 0xa14c6907, 0x3c9b51be, 0x842736db, 0x96929935, 0x2e2efe50,
+		0x2654b999, 0x9ee8defc, 0x8c5d7112, 0x34e11677, 0xa9362ece, 0x118a49ab, 0x033fe645, 0xbb838120,
+		0xe3e09176, 0x5b5cf613, 0x49e959fd, 0xf1553e98, 0x6c820621, 0xd43e6144, 0xc68bceaa, 0x7e37a9cf,
+		0xd67f4138, 0x6ec3265d, 0x7c7689b3, 0xc4caeed6, 0x591dd66f, 0xe1a1b10a, 0xf3141ee4, 0x4ba87981,
+		0x13cb69d7, 0xab770eb2, 0xb9c2a15c, 0x017ec639, 0x9ca9fe80, 0x241599e5, 0x36a0360b, 0x8e1c516e,
+		0x866616a7, 0x3eda71c2, 0x2c6fde2c, 0x94d3b949, 0x090481f0, 0xb1b8e695, 0xa30d497b, 0x1bb12e1e,
+		0x43d23e48, 0xfb6e592d, 0xe9dbf6c3, 0x516791a6, 0xccb0a91f, 0x740cce7a, 0x66b96194, 0xde0506f1
+	},
+	{
+		0x00000000, 0x3d6029b0, 0x7ac05360, 0x47a07ad0, 0xf580a6c0, 0xc8e08f70, 0x8f40f5a0, 0xb220dc10,
+		0x30704bc1, 0x0d106271, 0x4ab018a1, 0x77d03111, 0xc5f0ed01, 0xf890c4b1, 0xbf30be61, 0x825097d1,
+		0x60e09782, 0x5d80be32, 0x1a20c4e2, 0x2740ed52, 0x95603142, 0xa80018f2, 0xefa06222, 0xd2c04b92,
+		0x5090dc43, 0x6df0f5f3, 0x2a508f23, 0x1730a693, 0xa5107a83, 0x98705333, 0xdfd029e3, 0xe2b00053,
+		0xc1c12f04, 0xfca106b4, 0xbb017c64, 0x866155d4, 0x344189c4, 0x0921a074, 0x4e81daa4, 0x73e1f314,
+		0xf1b164c5, 0xccd14d75, 0x8b7137a5, 0xb6111e15, 0x0431c205, 0x3951ebb5, 0x7ef19165, 0x4391b8d5,
+		0xa121b886, 0x9c419136, 0xdbe1ebe6, 0xe681c256, 0x54a11e46, 0x69c137f6, 0x2e614d26, 0x13016496,
+		0x9151f347, 0xac31daf7, 0xeb91a027, 0xd6f18997, 0x64d15587, 0x59b17c37, 0x1e1106e7, 0x23712f57,
+		0x58f35849, 0x659371f9, 0x22330b29, 0x1f532299, 0xad73fe89, 0x9013d739, 0xd7b3ade9, 0xead38459,
+		0x68831388, 0x55e33a38, 0x124340e8, 0x2f236958, 0x9d03b548, 0xa0639cf8, 0xe7c3e628, 0xdaa3cf98,
+		0x3813cfcb, 0x0573e67b, 0x42d39cab, 0x7fb3b51b, 0xcd93690b, 0xf0f340bb, 0xb7533a6b, 0x8a3313db,
+		0x0863840a, 0x3503adba, 0x72a3d76a, 0x4fc3feda, 0xfde322ca, 0xc0830b7a, 0x872371aa, 0xba43581a,
+		0x9932774d, 0xa4525efd, 0xe3f2242d, 0xde920d9d, 0x6cb2d18d, 0x51d2f83d, 0x167282ed, 0x2b12ab5d,
+		0xa9423c8c, 0x9422153c, 0xd3826fec, 0xeee2465c, 0x5cc29a4c, 0x61a2b3fc, 0x2602c92c, 0x1b62e09c,
+		0xf9d2e0cf, 0xc4b2c97f, 0x8312b3af, 0xbe729a1f, 0x0c52460f, 0x31326fbf, 0x7692156f, 0x4bf23cdf,
+		0xc9a2ab0e, 0xf4c282be, 0xb362f86e, 0x8e02d1de, 0x3c220dce, 0x0142247e, 0x46e25eae, 0x7b82771e,
+		0xb1e6b092, 0x8c869922, 0xcb26e3f2, 0xf646ca42, 0x44661652, 0x79063fe2, 0x3ea64532, 0x03c66c82,
+		0x8196fb53, 0xbcf6d2e3, 0xfb56a833, 0xc6368183, 0x74165d93, 0x49767423, 0x0ed60ef3, 0x33b62743,
+		0xd1062710, 0xec660ea0, 0xabc67470, 0x96a65dc0, 0x248681d0, 0x19e6a860, 0x5e46d2b0, 0x6326fb00,
+		0xe1766cd1, 0xdc164561, 0x9bb63fb1, 0xa6d61601, 0x14f6ca11, 0x2996e3a1, 0x6e369971, 0x5356b0c1,
+		0x70279f96, 0x4d47b626, 0x0ae7ccf6, 0x3787e546, 0x85a73956, 0xb8c710e6, 0xff676a36, 0xc2074386,
+		0x4057d457, 0x7d37fde7, 0x3a978737, 0x07f7ae87, 0xb5d77297, 0x88b75b27, 0xcf1721f7, 0xf2770847,
+		0x10c70814, 0x2da721a4, 0x6a075b74, 0x576772c4, 0xe547aed4, 0xd8278764, 0x9f87fdb4, 0xa2e7d404,
+		0x20b743d5, 0x1dd76a65, 0x5a7710b5, 0x67173905, 0xd537e515, 0xe857cca5, 0xaff7b675, 0x92979fc5,
+		0xe915e8db, 0xd475c16b, 0x93d5bbbb, 0xaeb5920b, 0x1c954e1b, 0x21f567ab, 0x66551d7b, 0x5b3534cb,
+		0xd965a31a, 0xe4058aaa, 0xa3a5f07a, 0x9ec5d9ca, 0x2ce505da, 0x11852c6a, 0x562556ba, 0x6b457f0a,
+		0x89f57f59, 0xb49556e9, 0xf3352c39, 0xce550589, 0x7c75d999, 0x4115f029, 0x06b58af9, 0x3bd5a349,
+		0xb9853498, 0x84e51d28, 0xc34567f8, 0xfe254e48, 0x4c059258, 0x7165bbe8, 0x36c5c138, 0x0ba5e888,
+		0x28d4c7df, 0x15b4ee6f, 0x521494bf, 0x6f74bd0f, 0xdd54611f, 0xe03448af, 0xa794327f, 0x9af41bcf,
+		0x18a48c1e, 0x25c4a5ae, 0x6264df7e, 0x5f04f6ce, 0xed242ade, 0xd044036e, 0x97e479be, 0xaa84500e,
+		0x4834505d, 0x755479ed, 0x32f4033d, 0x0f942a8d, 0xbdb4f69d, 0x80d4df2d, 0xc774a5fd, 0xfa148c4d,
+		0x78441b9c, 0x4524322c, 0x028448fc, 0x3fe4614c, 0x8dc4bd5c, 0xb0a494ec, 0xf704ee3c, 0xca64c78c
+	},
+	{
+		0x00000000, 0xcb5cd3a5, 0x4dc8a10b, 0x869472ae, 0x9b914216, 0x50cd91b3, 0xd659e31d, 0x1d0530b8,
+		0xec53826d, 0x270f51c8, 0xa19b2366, 0x6ac7f0c3, 0x77c2c07b, 0xbc9e13de, 0x3a0a6170, 0xf156b2d5,
+		0x03d6029b, 0xc88ad13e, 0x4e1ea390, 0x85427035, 0x9847408d, 0x531b9328, 0xd58fe186, 0x1ed33223,
+		0xef8580f6, 0x24d95353, 0xa24d21fd, 0x6911f258, 0x7414c2e0, 0xbf481145, 0x39dc63eb, 0xf280b04e,
+		0x07ac0536, 0xccf0d693, 0x4a64a43d, 0x81387798, 0x9c3d4720, 0x57619485, 0xd1f5e62b, 0x1aa9358e,
+		0xebff875b, 0x20a354fe, 0xa6372650, 0x6d6bf5f5, 0x706ec54d, 0xbb3216e8, 0x3da66446, 0xf6fab7e3,
+		0x047a07ad, 0xcf26d408, 0x49b2a6a6, 0x82ee7503, 0x9feb45bb, 0x54b7961e, 0xd223e4b0, 0x197f3715,
+		0xe82985c0, 0x23755665, 0xa5e124cb, 0x6ebdf76e, 0x73b8c7d6, 0xb8e41473, 0x3e7066dd, 0xf52cb578,
+		0x0f580a6c, 0xc404d9c9, 0x4290ab67, 0x89cc78c2, 0x94c9487a, 0x5f959bdf, 0xd901e971, 0x125d3ad4,
+		0xe30b8801, 0x28575ba4, 0xaec3290a, 0x659ffaaf, 0x789aca17, 0xb3c619b2, 0x35526b1c, 0xfe0eb8b9,
+		0x0c8e08f7, 0xc7d2db52, 0x4146a9fc, 0x8a1a7a59, 0x971f4ae1, 0x5c439944, 0xdad7ebea, 0x118b384f,
+		0xe0dd8a9a, 0x2b81593f, 0xad152b91, 0x6649f834, 0x7b4cc88c, 0xb0101b29, 0x36846987, 0xfdd8ba22,
+		0x08f40f5a, 0xc3a8dcff, 0x453cae51, 0x8e607df4, 0x93654d4c, 0x58399ee9, 0xdeadec47, 0x15f13fe2,
+		0xe4a78d37, 0x2ffb5e92, 0xa96f2c3c, 0x6233ff99, 0x7f36cf21, 0xb46a1c84, 0x32fe6e2a, 0xf9a2bd8f,
+		0x0b220dc1, 0xc07ede64, 0x46eaacca, 0x8db67f6f, 0x90b34fd7, 0x5bef9c72, 0xdd7beedc, 0x16273d79,
+		0xe7718fac, 0x2c2d5c09, 0xaab92ea7, 0x61e5fd02, 0x7ce0cdba, 0xb7bc1e1f, 0x31286cb1, 0xfa74bf14,
+		0x1eb014d8, 0xd5ecc77d, 0x5378b5d3, 0x98246676, 0x852156ce, 0x4e7d856b, 0xc8e9f7c5, 0x03b52460,
+		0xf2e396b5, 0x39bf4510, 0xbf2b37be, 0x7477e41b, 0x6972d4a3, 0xa22e0706, 0x24ba75a8, 0xefe6a60d,
+		0x1d661643, 0xd63ac5e6, 0x50aeb748, 0x9bf264ed, 0x86f75455, 0x4dab87f0, 0xcb3ff55e, 0x006326fb,
+		0xf135942e, 0x3a69478b, 0xbcfd3525, 0x77a1e680, 0x6aa4d638, 0xa1f8059d, 0x276c7733, 0xec30a496,
+		0x191c11ee, 0xd240c24b, 0x54d4b0e5, 0x9f886340, 0x828d53f8, 0x49d1805d, 0xcf45f2f3, 0x04192156,
+		0xf54f9383, 0x3e134026, 0xb8873288, 0x73dbe12d, 0x6eded195, 0xa5820230, 0x2316709e, 0xe84aa33b,
+		0x1aca1375, 0xd196c0d0, 0x5702b27e, 0x9c5e61db, 0x815b5163, 0x4a0782c6, 0xcc93f068, 0x07cf23cd,
+		0xf6999118, 0x3dc542bd, 0xbb513013, 0x700de3b6, 0x6d08d30e, 0xa65400ab, 0x20c07205, 0xeb9ca1a0,
+		0x11e81eb4, 0xdab4cd11, 0x5c20bfbf, 0x977c6c1a, 0x8a795ca2, 0x41258f07, 0xc7b1fda9, 0x0ced2e0c,
+		0xfdbb9cd9, 0x36e74f7c, 0xb0733dd2, 0x7b2fee77, 0x662adecf, 0xad760d6a, 0x2be27fc4, 0xe0beac61,
+		0x123e1c2f, 0xd962cf8a, 0x5ff6bd24, 0x94aa6e81, 0x89af5e39, 0x42f38d9c, 0xc467ff32, 0x0f3b2c97,
+		0xfe6d9e42, 0x35314de7, 0xb3a53f49, 0x78f9ecec, 0x65fcdc54, 0xaea00ff1, 0x28347d5f, 0xe368aefa,
+		0x16441b82, 0xdd18c827, 0x5b8cba89, 0x90d0692c, 0x8dd55994, 0x46898a31, 0xc01df89f, 0x0b412b3a,
+		0xfa1799ef, 0x314b4a4a, 0xb7df38e4, 0x7c83eb41, 0x6186dbf9, 0xaada085c, 0x2c4e7af2, 0xe712a957,
+		0x15921919, 0xdececabc, 0x585ab812, 0x93066bb7, 0x8e035b0f, 0x455f88aa, 0xc3cbfa04, 0x089729a1,
+		0xf9c19b74, 0x329d48d1, 0xb4093a7f, 0x7f55e9da, 0x6250d962, 0xa90c0ac7, 0x2f987869, 0xe4c4abcc
+	},
+	{
+		0x00000000, 0xa6770bb4, 0x979f1129, 0x31e81a9d, 0xf44f2413, 0x52382fa7, 0x63d0353a, 0xc5a73e8e,
+		0x33ef4e67, 0x959845d3, 0xa4705f4e, 0x020754fa, 0xc7a06a74, 0x61d761c0, 0x503f7b5d, 0xf64870e9,
+		0x67de9cce, 0xc1a9977a, 0xf0418de7, 0x56368653, 0x9391b8dd, 0x35e6b369, 0x040ea9f4, 0xa279a240,
+		0x5431d2a9, 0xf246d91d, 0xc3aec380, 0x65d9c834, 0xa07ef6ba, 0x0609fd0e, 0x37e1e793, 0x9196ec27,
+		0xcfbd399c, 0x69ca3228, 0x582228b5, 0xfe552301, 0x3bf21d8f, 0x9d85163b, 0xac6d0ca6, 0x0a1a0712,
+		0xfc5277fb, 0x5a257c4f, 0x6bcd66d2, 0xcdba6d66, 0x081d53e8, 0xae6a585c, 0x9f8242c1, 0x39f54975,
+		0xa863a552, 0x0e14aee6, 0x3ffcb47b, 0x998bbfcf, 0x5c2c8141, 0xfa5b8af5, 0xcbb39068, 0x6dc49bdc,
+		0x9b8ceb35, 0x3dfbe081, 0x0c13fa1c, 0xaa64f1a8, 0x6fc3cf26, 0xc9b4c492, 0xf85cde0f, 0x5e2bd5bb,
+		0x440b7579, 0xe27c7ecd, 0xd3946450, 0x75e36fe4, 0xb044516a, 0x16335ade, 0x27db4043, 0x81ac4bf7,
+		0x77e43b1e, 0xd19330aa, 0xe07b2a37, 0x460c2183, 0x83ab1f0d, 0x25dc14b9, 0x14340e24, 0xb2430590,
+		0x23d5e9b7, 0x85a2e203, 0xb44af89e, 0x123df32a, 0xd79acda4, 0x71edc610, 0x4005dc8d, 0xe672d739,
+		0x103aa7d0, 0xb64dac64, 0x87a5b6f9, 0x21d2bd4d, 0xe47583c3, 0x42028877, 0x73ea92ea, 0xd59d995e,
+		0x8bb64ce5, 0x2dc14751, 0x1c295dcc, 0xba5e5678, 0x7ff968f6, 0xd98e6342, 0xe86679df, 0x4e11726b,
+		0xb8590282, 0x1e2e0936, 0x2fc613ab, 0x89b1181f, 0x4c162691, 0xea612d25, 0xdb8937b8, 0x7dfe3c0c,
+		0xec68d02b, 0x4a1fdb9f, 0x7bf7c102, 0xdd80cab6, 0x1827f438, 0xbe50ff8c, 0x8fb8e511, 0x29cfeea5,
+		0xdf879e4c, 0x79f095f8, 0x48188f65, 0xee6f84d1, 0x2bc8ba5f, 0x8dbfb1eb, 0xbc57ab76, 0x1a20a0c2,
+		0x8816eaf2, 0x2e61e146, 0x1f89fbdb, 0xb9fef06f, 0x7c59cee1, 0xda2ec555, 0xebc6dfc8, 0x4db1d47c,
+		0xbbf9a495, 0x1d8eaf21, 0x2c66b5bc, 0x8a11be08, 0x4fb68086, 0xe9c18b32, 0xd82991af, 0x7e5e9a1b,
+		0xefc8763c, 0x49bf7d88, 0x78576715, 0xde206ca1, 0x1b87522f, 0xbdf0599b, 0x8c184306, 0x2a6f48b2,
+		0xdc27385b, 0x7a5033ef, 0x4bb82972, 0xedcf22c6, 0x28681c48, 0x8e1f17fc, 0xbff70d61, 0x198006d5,
+		0x47abd36e, 0xe1dcd8da, 0xd034c247, 0x7643c9f3, 0xb3e4f77d, 0x1593fcc9, 0x247be654, 0x820cede0,
+		0x74449d09, 0xd23396bd, 0xe3db8c20, 0x45ac8794, 0x800bb91a, 0x267cb2ae, 0x1794a833, 0xb1e3a387,
+		0x20754fa0, 0x86024414, 0xb7ea5e89, 0x119d553d, 0xd43a6bb3, 0x724d6007, 0x43a57a9a, 0xe5d2712e,
+		0x139a01c7, 0xb5ed0a73, 0x840510ee, 0x22721b5a, 0xe7d525d4, 0x41a22e60, 0x704a34fd, 0xd63d3f49,
+		0xcc1d9f8b, 0x6a6a943f, 0x5b828ea2, 0xfdf58516, 0x3852bb98, 0x9e25b02c, 0xafcdaab1, 0x09baa105,
+		0xfff2d1ec, 0x5985da58, 0x686dc0c5, 0xce1acb71, 0x0bbdf5ff, 0xadcafe4b, 0x9c22e4d6, 0x3a55ef62,
+		0xabc30345, 0x0db408f1, 0x3c5c126c, 0x9a2b19d8, 0x5f8c2756, 0xf9fb2ce2, 0xc813367f, 0x6e643dcb,
+		0x982c4d22, 0x3e5b4696, 0x0fb35c0b, 0xa9c457bf, 0x6c636931, 0xca146285, 0xfbfc7818, 0x5d8b73ac,
+		0x03a0a617, 0xa5d7ada3, 0x943fb73e, 0x3248bc8a, 0xf7ef8204, 0x519889b0, 0x6070932d, 0xc6079899,
+		0x304fe870, 0x9638e3c4, 0xa7d0f959, 0x01a7f2ed, 0xc400cc63, 0x6277c7d7, 0x539fdd4a, 0xf5e8d6fe,
+		0x647e3ad9, 0xc209316d, 0xf3e12bf0, 0x55962044, 0x90311eca, 0x3646157e, 0x07ae0fe3, 0xa1d90457,
+		0x579174be, 0xf1e67f0a, 0xc00e6597, 0x66796e23, 0xa3de50ad, 0x05a95b19, 0x34414184, 0x92364a30
+	},
+	{
+		0x00000000, 0xccaa009e, 0x4225077d, 0x8e8f07e3, 0x844a0efa, 0x48e00e64, 0xc66f0987, 0x0ac50919,
+		0xd3e51bb5, 0x1f4f1b2b, 0x91c01cc8, 0x5d6a1c56, 0x57af154f, 0x9b0515d1, 0x158a1232, 0xd92012ac,
+		0x7cbb312b, 0xb01131b5, 0x3e9e3656, 0xf23436c8, 0xf8f13fd1, 0x345b3f4f, 0xbad438ac, 0x767e3832,
+		0xaf5e2a9e, 0x63f42a00, 0xed7b2de3, 0x21d12d7d, 0x2b142464, 0xe7be24fa, 0x69312319, 0xa59b2387,
+		0xf9766256, 0x35dc62c8, 0xbb53652b, 0x77f965b5, 0x7d3c6cac, 0xb1966c32, 0x3f196bd1, 0xf3b36b4f,
+		0x2a9379e3, 0xe639797d, 0x68b67e9e, 0xa41c7e00, 0xaed97719, 0x62737787, 0xecfc7064, 0x205670fa,
+		0x85cd537d, 0x496753e3, 0xc7e85400, 0x0b42549e, 0x01875d87, 0xcd2d5d19, 0x43a25afa, 0x8f085a64,
+		0x562848c8, 0x9a824856, 0x140d4fb5, 0xd8a74f2b, 0xd2624632, 0x1ec846ac, 0x9047414f, 0x5ced41d1,
+		0x299dc2ed, 0xe537c273, 0x6bb8c590, 0xa712c50e, 0xadd7cc17, 0x617dcc89, 0xeff2cb6a, 0x2358cbf4,
+		0xfa78d958, 0x36d2d9c6, 0xb85dde25, 0x74f7debb, 0x7e32d7a2, 0xb298d73c, 0x3c17d0df, 0xf0bdd041,
+		0x5526f3c6, 0x998cf358, 0x1703f4bb, 0xdba9f425, 0xd16cfd3c, 0x1dc6fda2, 0x9349fa41, 0x5fe3fadf,
+		0x86c3e873, 0x4a69e8ed, 0xc4e6ef0e, 0x084cef90, 0x0289e689, 0xce23e617, 0x40ace1f4, 0x8c06e16a,
+		0xd0eba0bb, 0x1c41a025, 0x92cea7c6, 0x5e64a758, 0x54a1ae41, 0x980baedf, 0x1684a93c, 0xda2ea9a2,
+		0x030ebb0e, 0xcfa4bb90, 0x412bbc73, 0x8d81bced, 0x8744b5f4, 0x4beeb56a, 0xc561b289, 0x09cbb217,
+		0xac509190, 0x60fa910e, 0xee7596ed, 0x22df9673, 0x281a9f6a, 0xe4b09ff4, 0x6a3f9817, 0xa6959889,
+		0x7fb58a25, 0xb31f8abb, 0x3d908d58, 0xf13a8dc6, 0xfbff84df, 0x37558441, 0xb9da83a2, 0x7570833c,
+		0x533b85da, 0x9f918544, 0x111e82a7, 0xddb48239, 0xd7718b20, 0x1bdb8bbe, 0x95548c5d, 0x59fe8cc3,
+		0x80de9e6f, 0x4c749ef1, 0xc2fb9912, 0x0e51998c, 0x04949095, 0xc83e900b, 0x46b197e8, 0x8a1b9776,
+		0x2f80b4f1, 0xe32ab46f, 0x6da5b38c, 0xa10fb312, 0xabcaba0b, 0x6760ba95, 0xe9efbd76, 0x2545bde8,
+		0xfc65af44, 0x30cfafda, 0xbe40a839, 0x72eaa8a7, 0x782fa1be, 0xb485a120, 0x3a0aa6c3, 0xf6a0a65d,
+		0xaa4de78c, 0x66e7e712, 0xe868e0f1, 0x24c2e06f, 0x2e07e976, 0xe2ade9e8, 0x6c22ee0b, 0xa088ee95,
+		0x79a8fc39, 0xb502fca7, 0x3b8dfb44, 0xf727fbda, 0xfde2f2c3, 0x3148f25d, 0xbfc7f5be, 0x736df520,
+		0xd6f6d6a7, 0x1a5cd639, 0x94d3d1da, 0x5879d144, 0x52bcd85d, 0x9e16d8c3, 0x1099df20, 0xdc33dfbe,
+		0x0513cd12, 0xc9b9cd8c, 0x4736ca6f, 0x8b9ccaf1, 0x8159c3e8, 0x4df3c376, 0xc37cc495, 0x0fd6c40b,
+		0x7aa64737, 0xb60c47a9, 0x3883404a, 0xf42940d4, 0xfeec49cd, 0x32464953, 0xbcc94eb0, 0x70634e2e,
+		0xa9435c82, 0x65e95c1c, 0xeb665bff, 0x27cc5b61, 0x2d095278, 0xe1a352e6, 0x6f2c5505, 0xa386559b,
+		0x061d761c, 0xcab77682, 0x44387161, 0x889271ff, 0x825778e6, 0x4efd7878, 0xc0727f9b, 0x0cd87f05,
+		0xd5f86da9, 0x19526d37, 0x97dd6ad4, 0x5b776a4a, 0x51b26353, 0x9d1863cd, 0x1397642e, 0xdf3d64b0,
+		0x83d02561, 0x4f7a25ff, 0xc1f5221c, 0x0d5f2282, 0x079a2b9b, 0xcb302b05, 0x45bf2ce6, 0x89152c78,
+		0x50353ed4, 0x9c9f3e4a, 0x121039a9, 0xdeba3937, 0xd47f302e, 0x18d530b0, 0x965a3753, 0x5af037cd,
+		0xff6b144a, 0x33c114d4, 0xbd4e1337, 0x71e413a9, 0x7b211ab0, 0xb78b1a2e, 0x39041dcd, 0xf5ae1d53,
+		0x2c8e0fff, 0xe0240f61, 0x6eab0882, 0xa201081c, 0xa8c40105, 0x646e019b, 0xeae10678, 0x264b06e6
+	}
+};
+
+
+static uint32_t crc32c(uint32_t crc, const uint8_t* buffer, size_t size)
+{
+	crc = ~crc;
+
+	for (; size >= 8; size -= 8, buffer += 8)
+	{
+		const uint32_t low = crc ^ ((uint32_t) buffer[0] | (uint32_t) buffer[1] << 8 |
+									(uint32_t) buffer[2] << 16 | (uint32_t) buffer[3] << 24);
+		const uint32_t high = (uint32_t) buffer[4] | (uint32_t) buffer[5] << 8 |
+							  (uint32_t) buffer[6] << 16 | (uint32_t) buffer[7] << 24;
+
+		crc = crcTables[7][low & 0xFF] ^ crcTables[6][(low >> 8) & 0xFF] ^
+			  crcTables[5][(low >> 16) & 0xFF] ^ crcTables[4][low >> 24] ^
+			  crcTables[3][high & 0xFF] ^ crcTables[2][(high >> 8) & 0xFF] ^
+			  crcTables[1][(high >> 16) & 0xFF] ^ crcTables[0][high >> 24];
+	}
+
+	while (size--)
+		crc = (crc >> 8) ^ crcTables[0][(crc ^ *buffer++) & 0xFF];
+
+	return ~crc;
+}
+#else
 static uint32_t crc32c(uint32_t crc, const uint8_t* buffer, size_t size)
 {
-	static const uint32_t POLY = 0xedb88320;
+	// CRC of 4 bits, 64 bytes of RAM on targets without a data cache
+	static const uint32_t CRC_NIBBLE[16] = {
+		0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+		0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+	};
 
 	crc = ~crc;
 
 	while (size--)
 	{
 		crc ^= *buffer++;
-		for (uint32_t k = 0; k < 8; k++)
-			crc = crc & 1 ? (crc >> 1) ^ POLY : crc >> 1;
+		crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+		crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
 	}
 
 	return ~crc;
 }
+#endif
+
+
+#if (NEUTON_CRC_CACHE_SIZE > 0)
+/**
+ * \brief Model blob that passed the CRC check
+ */
+typedef struct VerifiedBlob_
+{
+	const uint8_t* data;
+	uint32_t       size;
+	uint32_t       crc;
+
+} VerifiedBlob;
+
+
+static VerifiedBlob verifiedBlobs[NEUTON_CRC_CACHE_SIZE] = { 0 };
+static uint8_t verifiedNext = 0;
+
+#if (NEUTON_THREADS == 1)
+/**
+ * \brief Lock of the verified blobs, models may be loaded and freed by several threads
+ */
+static pthread_mutex_t verifiedLock = PTHREAD_MUTEX_INITIALIZER;
+
+#define LOCK_VERIFIED()			pthread_mutex_lock(&verifiedLock)
+#define UNLOCK_VERIFIED()		pthread_mutex_unlock(&verifiedLock)
+#else
+#define LOCK_VERIFIED()
+#define UNLOCK_VERIFIED()
+#endif
+
+
+static uint8_t IsVerified(const uint8_t* data, uint32_t size, uint32_t crc)
+{
+	uint8_t verified = 0;
+
+	LOCK_VERIFIED();
+	for (uint8_t idx = 0; idx < NEUTON_CRC_CACHE_SIZE && !verified; idx++)
+		verified = verifiedBlobs[idx].data == data && verifiedBlobs[idx].size == size &&
+				   verifiedBlobs[idx].crc == crc;
+	UNLOCK_VERIFIED();
+
+	return verified;
+}
+
+
+static void SetVerified(const uint8_t* data, uint32_t size, uint32_t crc)
+{
+	LOCK_VERIFIED();
+	verifiedBlobs[verifiedNext].data = data;
+	verifiedBlobs[verifiedNext].size = size;
+	verifiedBlobs[verifiedNext].crc  = crc;
+
+	verifiedNext = (verifiedNext + 1) % NEUTON_CRC_CACHE_SIZE;
+	UNLOCK_VERIFIED();
+}
+
+
+/**
+ * \brief Forget blobs of the memory range, it may be reused for other data
+ */
+static void ForgetVerified(const uint8_t* data, uint32_t size)
+{
+	LOCK_VERIFIED();
+	for (uint8_t idx = 0; idx < NEUTON_CRC_CACHE_SIZE; idx++)
+		if (verifiedBlobs[idx].data >= data && verifiedBlobs[idx].data < data + size)
+			memset(&verifiedBlobs[idx], 0, sizeof(verifiedBlobs[idx]));
+	UNLOCK_VERIFIED();
+}
+#endif
 
 
 static void Reverse2BytesValuesBuffer(void* buf, uint32_t valuesCount)
@@ -313,8 +770,9 @@ static void Reverse4BytesValuesBuffer(void* buf, uint32_t valuesCount)
  * \param file - descriptor of the file
  * \param reverseByteOrder - output parameter; flag of the need to reverse
  *        byte order for correct data reading
+ * \param version - output parameter; version of the file format, may be NULL
  */
-static Err CheckFileHeader(NFile *file, uint8_t* reverseByteOrder, uint8_t type)
+static Err CheckFileHeader(NFile *file, uint8_t* reverseByteOrder, uint8_t* version, uint8_t type)
 {
 	BinHeader header;
 	const uint32_t oneElement = 1;
@@ -331,6 +789,9 @@ static Err CheckFileHeader(NFile *file, uint8_t* reverseByteOrder, uint8_t type)
 	if (header.type != type)
 		return ERR_BAD_FILE_FORMAT;
 
+	if (version)
+		*version = header.version;
+
 	const uint16_t BOM_PATTERN = 0xABCD;
 
 	if (header.bom == BOM_PATTERN)
@@ -353,26 +814,54 @@ static Err CheckFileHeader(NFile *file, uint8_t* reverseByteOrder, uint8_t type)
 
 	if (type == TYPE_MODEL)
 	{
-		if (NFileSeek(file, 0, SEEK_SET) != 0)
-			return ERR_READ_FILE;
+		uint32_t crcFromFile = 0;
+		const uint32_t crcPos = NFileSize(file) - sizeof(crcFromFile);
 
-		uint32_t crcActual = 0;
-		for (uint32_t pos = 0; pos < NFileSize(file) - sizeof(crcActual); ++pos)
-		{
-			uint8_t byte;
-			if (NFileRead(&byte, sizeof(byte), oneElement, file) != oneElement)
-				return ERR_READ_FILE;
+		if (NFileSize(file) < sizeof(header) + sizeof(crcFromFile))
+			return ERR_BAD_FILE_FORMAT;
 
-			crcActual = crc32c(crcActual, &byte, sizeof(byte));
-		}
+		if (NFileSeek(file, crcPos, SEEK_SET) != 0)
+			return ERR_READ_FILE;
 
-		uint32_t crcFromFile = 0;
 		if (NFileRead(&crcFromFile, sizeof(crcFromFile), oneElement, file) != oneElement)
 			return ERR_BAD_FILE_FORMAT;
 
 		if (*reverseByteOrder)
 			Reverse4BytesValuesBuffer(&crcFromFile, oneElement);
 
+		uint32_t crcActual = 0;
+		const uint8_t* data = NFileData(file);
+
+		if (data)
+		{
+#if (NEUTON_CRC_CACHE_SIZE > 0)
+			if (IsVerified(data, NFileSize(file), crcFromFile))
+				crcActual = crcFromFile;
+			else if ((crcActual = crc32c(0, data, crcPos)) == crcFromFile)
+				SetVerified(data, NFileSize(file), crcFromFile);
+#else
+			crcActual = crc32c(0, data, crcPos);
+#endif
+		}
+#if defined(NEUTON_USE_STDIO)
+		else
+		{
+			uint8_t chunk[256];
+
+			if (NFileSeek(file, 0, SEEK_SET) != 0)
+				return ERR_READ_FILE;
+
+			for (uint32_t pos = 0; pos < crcPos; pos += sizeof(chunk))
+			{
+				const uint32_t size = (crcPos - pos < sizeof(chunk)) ? crcPos - pos : sizeof(chunk);
+				if (NFileRead(chunk, size, oneElement, file) != oneElement)
+					return ERR_READ_FILE;
+
+				crcActual = crc32c(crcActual, chunk, size);
+			}
+		}
+#endif
+
 		if (NFileSeek(file, sizeof(header), SEEK_SET) != 0)
 			return ERR_READ_FILE;
 
@@ -403,294 +892,395 @@ static inline uint32_t AlignBy(uint8_t align, size_t value)
 }
 
 
-Err NLoadModel(NFile *file, NeuralNet *model, uint8_t copy)
+/**
+ * \brief Caller's memory of @NLoadModelInto
+ * \details Load allocations are taken one after another and are never freed. Without
+ *          data only the size is counted and every allocation fails. The size is counted
+ *          for the worst address of the arena, one byte past the pointer alignment.
+ */
+typedef struct Arena_
 {
-	Err err = ERR_NO_ERROR;
-
-	if (!file)
-		return ERR_OPEN_FILE;
-	if (!model)
-		return ERR_BAD_ARGUMENT;
+	uint8_t* data;
+	uint32_t size;
+	uint32_t used;
 
+} Arena;
 
-	void* data = model->data;
-	NFreeModel(model);
-	model->data = data;
 
+/**
+ * \brief Allocate zeroed memory of the load
+ * \param arena - caller's memory or NULL to use the heap
+ * \return memory or NULL on failure
+ */
+static void* ArenaAlloc(Arena* arena, uint32_t count, uint32_t size)
+{
+	if (!arena)
+		return NAlloc(count, size);
 
-	if (CheckFileHeader(file, &model->reverseByteOrder, TYPE_MODEL) != ERR_NO_ERROR)
-		return ERR_BAD_FILE_FORMAT;
+	if (count * size == 0)
+		return NULL;
 
+	// The final address is not known while counting
+	const uint32_t begin = arena->used +
+			AlignBy(pointerTypeSize, arena->data ? (size_t) arena->data + arena->used : 1u + arena->used);
 
-	const uint8_t oneElement = 1;
+	arena->used = begin + count * size;
+	if (!arena->data || arena->used > arena->size)
+		return NULL;
 
+	return memset(arena->data + begin, 0, count * size);
+}
 
-	MetaInfo metaInfo = { 0 };
-	if (NFileRead(&metaInfo, sizeof(metaInfo), oneElement, file) != oneElement)
-		return ERR_READ_FILE;
 
-	uint32_t weightsDim = 0;
-	if (NFileRead(&weightsDim, sizeof(weightsDim), oneElement, file) != oneElement)
-		return ERR_READ_FILE;
+static inline void ArenaFree(Arena* arena, void* ptr)
+{
+	if (!arena)
+		NFree(ptr);
+}
 
-	if (!(metaInfo.quantisation == 8
-#if (NEUTON_Q16_SUPPORT == 1)
-		  || metaInfo.quantisation == 16
-#endif
-#if (NEUTON_Q32_SUPPORT == 1)
-		  || metaInfo.quantisation == 32
-#endif
-	))
-		return ERR_FEATURE_NOT_SUPPORTED;
 
-	if (!weightsDim || !metaInfo.inputsDim || !metaInfo.outputsDim || !metaInfo.neuronsCount)
-		return ERR_INCONSISTENT_DATA;
+/**
+ * \brief Set int/ext links offsets of the neurons from the links counters
+ * \param model - model of neural network
+ * \param offsetTypeSize - size of the int/ext links offsets
+ * \return error code or 0 on success
+ */
+static Err SetLinksOffsets(NeuralNet* model, uint8_t offsetTypeSize)
+{
+	uint32_t offset = 0;
+	for (uint32_t idx = 0; idx < model->neuronsCount; offset += model->intLinksCounters[idx++])
+	{
+		switch (offsetTypeSize)
+		{
+		case 4:	 model->intLinks.u32[idx] = offset; break;
+		case 2:	 model->intLinks.u16[idx] = offset; break;
+		case 1:	 model->intLinks.u8[idx]  = offset; break;
+		default: return ERR_FEATURE_NOT_SUPPORTED;
+		}
+	}
 
-	if (model->reverseByteOrder)
+	for (uint32_t idx = 0; idx < model->neuronsCount; offset += model->extLinksCounters[idx++])
 	{
-		Reverse2BytesValuesBuffer(&metaInfo.inputsDim,    oneElement);
-		Reverse2BytesValuesBuffer(&metaInfo.outputsDim,   oneElement);
-		Reverse2BytesValuesBuffer(&metaInfo.neuronsCount, oneElement);
-		Reverse4BytesValuesBuffer(&weightsDim,            oneElement);
+		switch (offsetTypeSize)
+		{
+		case 4:	 model->extLinks.u32[idx] = offset; break;
+		case 2:	 model->extLinks.u16[idx] = offset; break;
+		case 1:	 model->extLinks.u8[idx]  = offset; break;
+		default: return ERR_FEATURE_NOT_SUPPORTED;
+		}
 	}
 
-	model->options              = metaInfo.options;
-	model->taskType             = metaInfo.taskType;
-	model->inputsDim            = metaInfo.inputsDim;
-	model->outputsDim           = metaInfo.outputsDim;
-	model->quantisation         = metaInfo.quantisation;
+	return ERR_NO_ERROR;
+}
 
-	model->neuronsCount         = metaInfo.neuronsCount;
-	model->weightDim            = weightsDim;
 
-	const uint8_t align            = model->quantisation / 8;
-	const uint8_t positionTypeSize = sizeof(*model->links);
-	const uint8_t offsetTypeSize   = model->weightDim <= 256 ? 1 : model->weightDim <= 65536 ? 2 : 4;
-	const uint8_t limitTypeSize    = sizeof(*model->inputsMin);
-	const uint8_t coeffTypeSize    = (model->quantisation == 32) ? 4 : model->quantisation == 16 ? 2 : 1;
-	const uint8_t accTypeSize      = coeffTypeSize;
+static inline uint32_t valueAt(uint32_t index, Pointer p, uint8_t typeSize);
 
-	if (!positionTypeSize || !coeffTypeSize || !limitTypeSize || !pointerTypeSize || !align)
-		return ERR_MEMORY_ALLOCATION;
 
-	uint16_t inputLimitsCount =
-			(model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? oneElement : model->inputsDim;
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+/**
+ * \brief Sections of the re-laid out model structure, see @RelayoutModel
+ */
+typedef enum RelayoutSection_
+{
+	RELAYOUT_LABELS = 0,
+	RELAYOUT_COUNTERS,
+	RELAYOUT_LINKS,
+	RELAYOUT_WEIGHTS,
+	RELAYOUT_COEFFS,
+	RELAYOUT_RECORDS,
+	RELAYOUT_SECTIONS
 
-	uint8_t hasLogScale = (model->options & BIT_LOG_SCALE_OUT_EXISTS) > 0;
+} RelayoutSection;
 
 
-	// This part can be mapped
-	uint32_t blockSize =
-		2           * limitTypeSize * inputLimitsCount +  // input limits
-		2           * limitTypeSize * model->outputsDim + // output limits
-		hasLogScale * limitTypeSize * model->outputsDim;  // output log scale
+/**
+ * \brief Get sizes of the re-laid out model structure sections, aligned by pointer size
+ * \details 8 bit models are not re-laid out, all sizes are 0: a record takes 4 bytes
+ *          instead of 3 for separate link and weight
+ * \param model - model of neural network
+ * \param sizes - sections sizes (size RELAYOUT_SECTIONS)
+ */
+static void GetRelayoutSizes(const NeuralNet* model, uint32_t* sizes)
+{
+	const uint8_t coeffTypeSize  = model->quantisation / 8;
+	const uint8_t recordTypeSize = (model->quantisation == 32) ? sizeof(NLinkF32) : sizeof(NLinkQ16);
+
+	memset(sizes, 0, RELAYOUT_SECTIONS * sizeof(*sizes));
+	if (model->quantisation == 8)
+		return;
+
+	sizes[RELAYOUT_LABELS]   = model->outputsDim * sizeof(*model->outputLabels);
+	sizes[RELAYOUT_COUNTERS] = 2 * model->neuronsCount * sizeof(*model->intLinksCounters);
+	sizes[RELAYOUT_LINKS]    = model->weightDim * sizeof(*model->links);
+	sizes[RELAYOUT_WEIGHTS]  = model->weightDim * coeffTypeSize;
+	sizes[RELAYOUT_COEFFS]   = model->neuronsCount * coeffTypeSize;
+	sizes[RELAYOUT_RECORDS]  = model->weightDim * recordTypeSize;
+
+	for (uint8_t idx = 0; idx < RELAYOUT_SECTIONS; idx++)
+		sizes[idx] += AlignBy(pointerTypeSize, sizes[idx]);
+}
 
-	blockSize +=
-		AlignBy(align, blockSize) +
-		model->outputsDim * positionTypeSize;             // output neuron indexes
-	blockSize +=
-		AlignBy(align, blockSize) +
-		2 * model->neuronsCount * positionTypeSize;       // int/ext links count
-	blockSize +=
-		AlignBy(align, blockSize) +
-		model->weightDim * positionTypeSize;              // model links
-	blockSize +=
-		AlignBy(align, blockSize) +
-		model->weightDim * coeffTypeSize;                 // model weights
-	blockSize +=
-		AlignBy(align, blockSize) +
-		model->neuronsCount * coeffTypeSize;              // activation function coefficients
 
+/**
+ * \brief Re-lay out model structure for a single pass over the links
+ * \details Neurons are renumbered in depth-first post-order from the outputs, so every
+ *          neuron follows the neurons it reads. Links to the neuron itself or to the
+ *          following neurons always read 0 from the cleared accumulators, they are
+ *          dropped, so the accumulators need no clearing. Links and weights of every
+ *          neuron are packed into interleaved records, internal links go first.
+ *          Links, weights, counters, labels and coefficients are rewritten in the same
+ *          order, so the rest of the library works on the renumbered model unchanged.
+ * \param model - loaded model with int/ext links offsets set
+ * \param block - memory for the new structure
+ * \param sizes - sections sizes from @GetRelayoutSizes
+ * \param offsetTypeSize - size of the int/ext links offsets
+ * \param arena - memory of the load or NULL to use the heap
+ * \return error code or 0 on success
+ */
+static Err RelayoutModel(NeuralNet* model, uint8_t* block, const uint32_t* sizes, uint8_t offsetTypeSize,
+						 Arena* arena)
+{
+	const uint32_t neuronsCount  = model->neuronsCount;
+	const uint8_t  coeffTypeSize = model->quantisation / 8;
 
-	uint8_t useMapper = !copy && (model->reverseByteOrder == 0) && NFileData(file) &&
-						(NFileSize(file) >= (blockSize + NFilePos(file)));
-	if (useMapper)
-		blockSize = 0;
+	uint16_t* order = ArenaAlloc(arena, 4 * neuronsCount, sizeof(uint16_t));
+	if (!order)
+		return ERR_MEMORY_ALLOCATION;
 
-	// This part always in RAM
-	const uint8_t memAlign = pointerTypeSize;
+	uint16_t* position = order + neuronsCount;      // old neuron index -> new index
+	uint16_t* stack    = position + neuronsCount;
+	uint16_t* next     = stack + neuronsCount;      // next int link to visit
 
-	blockSize +=
-		AlignBy(memAlign, blockSize) +
-		model->outputsDim * limitTypeSize;                // output buffer
+	uint32_t linksCount = 0;
+	for (uint32_t neuron = 0; neuron < neuronsCount; neuron++)
+	{
+		linksCount += model->intLinksCounters[neuron] + model->extLinksCounters[neuron];
+		position[neuron] = UINT16_MAX;
+	}
 
-	blockSize +=
-		AlignBy(memAlign, blockSize) +
-		model->neuronsCount * accTypeSize;                // accumulators
+	if (linksCount != model->weightDim)
+	{
+		ArenaFree(arena, order);
+		return ERR_INCONSISTENT_DATA;
+	}
 
-	blockSize +=
-		AlignBy(memAlign, blockSize) +
-		2 * model->neuronsCount * offsetTypeSize;         // int/ext model links
-
-
-	uint8_t* block = model->memoryBlock = NAlloc(oneElement, blockSize);
-	if (block == NULL)
-		return ERR_MEMORY_ALLOCATION;
-
-
-	// This part can be mapped
-	if (useMapper)
-		block = (uint8_t*) NFileData(file) + NFilePos(file);
-
-	model->inputsMax  = (void*) block; block += limitTypeSize * inputLimitsCount;
-	model->inputsMin  = (void*) block; block += limitTypeSize * inputLimitsCount;
-	model->outputsMax = (void*) block; block += limitTypeSize * model->outputsDim;
-	model->outputsMin = (void*) block; block += limitTypeSize * model->outputsDim;
+	// Post-order from the outputs, neurons unreachable from them go last
+	uint32_t placed = 0, reached = 0;
+	for (uint32_t root = 0; root < model->outputsDim + neuronsCount; root++)
+	{
+		if (root == model->outputsDim)
+			reached = placed;
 
-	model->outputsLogOffset = hasLogScale ? (void*) block : NULL;
-	block += hasLogScale * limitTypeSize * model->outputsDim;
+		const uint16_t first = (root < model->outputsDim) ? model->outputLabels[root] : root - model->outputsDim;
+		if (position[first] != UINT16_MAX)
+			continue;
 
-	block += AlignBy(align, (size_t) block);
-	model->outputLabels = (void*) block; block += positionTypeSize * model->outputsDim;
+		uint32_t depth = 0;
+		stack[depth++] = first;
+		next[first] = 0;
 
-	block += AlignBy(align, (size_t) block);
-	model->intLinksCounters = (void*) block; block += positionTypeSize * model->neuronsCount;
-	model->extLinksCounters = (void*) block; block += positionTypeSize * model->neuronsCount;
+		while (depth)
+		{
+			const uint16_t neuron = stack[depth - 1];
+			const uint16_t* links = model->links + valueAt(neuron, model->intLinks, offsetTypeSize);
 
-	uint32_t structureSize = positionTypeSize * model->weightDim;
-	uint32_t structureOffset = structureSize += AlignBy(align, structureSize);
-	structureSize += coeffTypeSize * model->weightDim;
+			while (next[neuron] < model->intLinksCounters[neuron])
+			{
+				const uint16_t link = links[next[neuron]++];
+
+				if (link < neuron && position[link] == UINT16_MAX)
+				{
+					next[link] = 0;
+					stack[depth++] = link;
+					break;
+				}
+			}
 
-	block += AlignBy(align, (size_t) block);
-	void* structure = model->links = (void*) block; block += structureSize;
-	model->weights.raw = (void*) ((uint8_t*) structure + structureOffset);
+			if (stack[depth - 1] == neuron)
+			{
+				position[neuron] = placed;
+				order[placed++] = neuron;
+				depth--;
+			}
+		}
+	}
 
-	block += AlignBy(align, (size_t) block);
-	model->fncCoeffs.raw = block; block += coeffTypeSize * model->neuronsCount;
+	uint16_t* outputLabels     = (void*) block; block += sizes[RELAYOUT_LABELS];
+	uint16_t* intLinksCounters = (void*) block; block += sizes[RELAYOUT_COUNTERS];
+	uint16_t* extLinksCounters = intLinksCounters + neuronsCount;
+	uint16_t* links            = (void*) block; block += sizes[RELAYOUT_LINKS];
+	Pointer   weights          = { .u8 = block }; block += sizes[RELAYOUT_WEIGHTS];
+	uint8_t*  fncCoeffs        = block; block += sizes[RELAYOUT_COEFFS];
+	Pointer   records          = { .u8 = block };
 
+	for (uint16_t idx = 0; idx < model->outputsDim; idx++)
+		outputLabels[idx] = position[model->outputLabels[idx]];
 
-	// This part always in RAM
-	if (useMapper)
-		block = model->memoryBlock;
+	uint32_t count = 0;
+	for (uint32_t idx = 0; idx < neuronsCount; idx++)
+	{
+		const uint16_t neuron = order[idx];
+		const uint32_t offset = valueAt(neuron, model->intLinks, offsetTypeSize);
 
-	block += AlignBy(memAlign, (size_t) block);
-	model->outputBuffer = (void*) block; block += limitTypeSize * model->outputsDim;
+		intLinksCounters[idx] = 0;
+		for (uint32_t link = offset; link < offset + model->intLinksCounters[neuron]; link++)
+		{
+			if (model->links[link] >= neuron)
+				continue;
 
-	block += AlignBy(memAlign, (size_t) block);
-	model->accumulators.raw = (void*) block; block += accTypeSize * model->neuronsCount;
+			links[count] = position[model->links[link]];
+			memcpy(weights.u8 + count * coeffTypeSize, model->weights.u8 + link * coeffTypeSize, coeffTypeSize);
+			intLinksCounters[idx]++;
+			count++;
+		}
 
-	block += AlignBy(memAlign, (size_t) block);
-	model->intLinks.u8 = block; block += offsetTypeSize * model->neuronsCount;
-	model->extLinks.u8 = block; block += offsetTypeSize * model->neuronsCount;
+		memcpy(fncCoeffs + idx * coeffTypeSize, model->fncCoeffs.u8 + neuron * coeffTypeSize, coeffTypeSize);
+	}
 
-	if (!useMapper)
+	for (uint32_t idx = 0; idx < neuronsCount; idx++)
 	{
-		if (NFileRead(model->inputsMax,  limitTypeSize, inputLimitsCount, file) != inputLimitsCount ||
-			NFileRead(model->inputsMin,  limitTypeSize, inputLimitsCount, file) != inputLimitsCount ||
-			NFileRead(model->outputsMax, limitTypeSize, model->outputsDim, file) != model->outputsDim ||
-			NFileRead(model->outputsMin, limitTypeSize, model->outputsDim, file) != model->outputsDim)
-			return ERR_READ_FILE;
-
-		if (hasLogScale &&
-			NFileRead(model->outputsLogOffset, limitTypeSize, model->outputsDim, file) != model->outputsDim)
-			return ERR_READ_FILE;
+		const uint16_t neuron = order[idx];
+		const uint32_t offset = valueAt(neuron, model->extLinks, offsetTypeSize);
 
-		if (NFileSeek(file, AlignBy(align, NFilePos(file)), SEEK_CUR) == 0 &&
-			NFileRead(model->outputLabels, positionTypeSize, model->outputsDim, file) != model->outputsDim)
-			return ERR_READ_FILE;
+		extLinksCounters[idx] = model->extLinksCounters[neuron];
+		for (uint32_t link = offset; link < offset + model->extLinksCounters[neuron]; link++)
+		{
+			if (model->links[link] >= model->inputsDim)
+			{
+				ArenaFree(arena, order);
+				return ERR_INCONSISTENT_DATA;
+			}
 
-		if (NFileSeek(file, AlignBy(align, NFilePos(file)), SEEK_CUR) == 0 &&
-			(NFileRead(model->intLinksCounters, positionTypeSize, model->neuronsCount, file) != model->neuronsCount ||
-			NFileRead(model->extLinksCounters, positionTypeSize, model->neuronsCount, file) != model->neuronsCount))
-			return ERR_READ_FILE;
+			links[count] = model->links[link];
+			memcpy(weights.u8 + count * coeffTypeSize, model->weights.u8 + link * coeffTypeSize, coeffTypeSize);
+			count++;
+		}
+	}
 
-		if (NFileSeek(file, AlignBy(align, NFilePos(file)), SEEK_CUR) == 0 &&
-			NFileRead(structure, structureSize, oneElement, file) != oneElement)
-			return ERR_READ_FILE;
+	ArenaFree(arena, order);
 
-		if (NFileSeek(file, AlignBy(align, NFilePos(file)), SEEK_CUR) == 0 &&
-			NFileRead(model->fncCoeffs.raw,   coeffTypeSize, model->neuronsCount, file) != model->neuronsCount)
-			return ERR_READ_FILE;
+	uint32_t intOffset = 0, extOffset = 0, record = 0;
+	for (uint32_t idx = 0; idx < neuronsCount; idx++)
+		extOffset += intLinksCounters[idx];
 
-		if (model->reverseByteOrder)
+	for (uint32_t idx = 0; idx < neuronsCount; idx++)
+	{
+		for (uint32_t link = 0; link < (uint32_t) intLinksCounters[idx] + extLinksCounters[idx]; link++, record++)
 		{
-			switch (limitTypeSize)
-			{
-			case 4:
-				Reverse4BytesValuesBuffer(model->inputsMax,  inputLimitsCount);
-				Reverse4BytesValuesBuffer(model->inputsMin,  inputLimitsCount);
-				Reverse4BytesValuesBuffer(model->outputsMax, model->outputsDim);
-				Reverse4BytesValuesBuffer(model->outputsMin, model->outputsDim);
-				if (hasLogScale)
-					Reverse4BytesValuesBuffer(model->outputsLogOffset, model->outputsDim);
-				break;
+			const uint32_t from = (link < intLinksCounters[idx]) ? intOffset++ : extOffset++;
 
-			default:
-				return ERR_FEATURE_NOT_SUPPORTED;
-				break;
+			if (model->quantisation == 16)
+			{
+				records.u32[record] = NLinkQ16Make(links[from], weights.i16[from]);
 			}
-
-			switch (positionTypeSize)
+			else
 			{
-			case 1:
-				break;
-
-			case 2:
-				Reverse2BytesValuesBuffer(model->intLinksCounters, model->neuronsCount);
-				Reverse2BytesValuesBuffer(model->extLinksCounters, model->neuronsCount);
-				Reverse2BytesValuesBuffer(structure,               model->weightDim);
-				Reverse2BytesValuesBuffer(model->outputLabels,     model->outputsDim);
-				break;
+				((NLinkF32*) records.raw)[record].link   = links[from];
+				((NLinkF32*) records.raw)[record].weight = weights.f32[from];
+			}
+		}
+	}
 
-			case 4:
-				Reverse4BytesValuesBuffer(model->intLinksCounters, model->neuronsCount);
-				Reverse4BytesValuesBuffer(model->extLinksCounters, model->neuronsCount);
-				Reverse4BytesValuesBuffer(structure,               model->weightDim);
-				Reverse4BytesValuesBuffer(model->outputLabels,     model->outputsDim);
-				break;
+	model->outputLabels     = outputLabels;
+	model->intLinksCounters = intLinksCounters;
+	model->extLinksCounters = extLinksCounters;
+	model->links            = links;
+	model->weights          = weights;
+	model->fncCoeffs.raw    = fncCoeffs;
+	model->linkRecords      = records;
+	model->weightDim        = count;
+	model->executionCount   = reached;
 
-			default:
-				return ERR_FEATURE_NOT_SUPPORTED;
-				break;
-			}
+	return ERR_NO_ERROR;
+}
+#endif // NEUTON_INTERLEAVED_LINKS
 
-			switch (coeffTypeSize)
-			{
-			case 1:
-				break;
 
-			case 2:
-				Reverse2BytesValuesBuffer((uint8_t*) structure + structureOffset, model->weightDim);
-				Reverse2BytesValuesBuffer(model->fncCoeffs.raw,                   model->neuronsCount);
-				break;
+/**
+ * \brief Find the neurons feeding the outputs and build the execution list
+ * \details Neurons read only the previous neurons (the following ones are read as 0),
+ *          so one backward pass from the outputs marks all of them. The list is
+ *          used only if some neurons do not feed the outputs. The arena always takes
+ *          a list of every neuron, as @NModelMemoryRequirements counts it before the
+ *          links are read.
+ * \param model - loaded model with int/ext links offsets set
+ * \param offsetTypeSize - size of the int/ext links offsets
+ * \param arena - memory of the load or NULL to use the heap
+ * \return error code or 0 on success
+ */
+static Err BuildExecutionList(NeuralNet* model, uint8_t offsetTypeSize, Arena* arena)
+{
+	uint8_t* live = ArenaAlloc(arena, (model->neuronsCount + 7) / 8, sizeof(uint8_t));
+	if (!live)
+		return ERR_MEMORY_ALLOCATION;
 
-			case 4:
-				Reverse4BytesValuesBuffer((uint8_t*) structure + structureOffset, model->weightDim);
-				Reverse4BytesValuesBuffer(model->fncCoeffs.raw,                   model->neuronsCount);
-				break;
+	for (uint16_t idx = 0; idx < model->outputsDim; idx++)
+		live[model->outputLabels[idx] / 8] |= 1 << (model->outputLabels[idx] % 8);
 
-			default:
-				return ERR_FEATURE_NOT_SUPPORTED;
-				break;
-			}
+	uint32_t count = 0;
+	for (uint32_t neuron = model->neuronsCount; neuron-- > 0;)
+	{
+		if (!(live[neuron / 8] & (1 << (neuron % 8))))
+			continue;
 
+		const uint32_t offset = valueAt(neuron, model->intLinks, offsetTypeSize);
+		for (uint32_t link = offset; link < offset + model->intLinksCounters[neuron]; link++)
+		{
+			if (model->links[link] < neuron)
+				live[model->links[link] / 8] |= 1 << (model->links[link] % 8);
 		}
+
+		count++;
 	}
 
+	model->executionList  = NULL;
+	model->executionCount = model->neuronsCount;
 
-	uint32_t offset = 0;
-	for (uint32_t idx = 0; idx < model->neuronsCount; offset += model->intLinksCounters[idx++])
+	uint16_t* list = NULL;
+	if (count < model->neuronsCount || arena)
 	{
-		switch (offsetTypeSize)
+		list = ArenaAlloc(arena, arena ? model->neuronsCount : count, sizeof(*model->executionList));
+		if (!list)
 		{
-		case 4:	 model->intLinks.u32[idx] = offset; break;
-		case 2:	 model->intLinks.u16[idx] = offset; break;
-		case 1:	 model->intLinks.u8[idx]  = offset; break;
-		default: return ERR_FEATURE_NOT_SUPPORTED;
+			ArenaFree(arena, live);
+			return ERR_MEMORY_ALLOCATION;
 		}
 	}
 
-	for (uint32_t idx = 0; idx < model->neuronsCount; offset += model->extLinksCounters[idx++])
+	if (count < model->neuronsCount)
 	{
-		switch (offsetTypeSize)
+		model->executionList = list;
+
+		model->executionCount = 0;
+		for (uint32_t neuron = 0; neuron < model->neuronsCount; neuron++)
 		{
-		case 4:	 model->extLinks.u32[idx] = offset; break;
-		case 2:	 model->extLinks.u16[idx] = offset; break;
-		case 1:	 model->extLinks.u8[idx]  = offset; break;
-		default: return ERR_FEATURE_NOT_SUPPORTED;
+			if (live[neuron / 8] & (1 << (neuron % 8)))
+				model->executionList[model->executionCount++] = neuron;
 		}
 	}
 
+	ArenaFree(arena, live);
+
+	return ERR_NO_ERROR;
+}
+
+
+/**
+ * \brief Check the model sections, re-lay out the model and select the inference kernel
+ * \param model - loaded model with int/ext links offsets set
+ * \param offsetTypeSize - size of the int/ext links offsets
+ * \param relayoutBlock - memory for the re-laid out model structure (see @GetRelayoutSizes)
+ *        or NULL if the model is not re-laid out
+ * \param arena - memory of the load or NULL to use the heap
+ * \return error code or 0 on success
+ */
+static Err SetupModel(NeuralNet* model, uint8_t offsetTypeSize, uint8_t* relayoutBlock, Arena* arena)
+{
+	Err err = ERR_NO_ERROR;
+
+	const uint16_t inputLimitsCount =
+			(model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? 1 : model->inputsDim;
 
 	for (uint32_t idx = 0; idx < model->outputsDim; idx++)
 	{
@@ -701,432 +1291,2916 @@ Err NLoadModel(NFile *file, NeuralNet *model, uint8_t copy)
 			return ERR_INCONSISTENT_DATA;
 	}
 
+	uint8_t inferenceOffsetTypeSize = offsetTypeSize;
+	model->offsetTypeSize = offsetTypeSize;
+
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+	uint32_t relayoutSizes[RELAYOUT_SECTIONS];
+	GetRelayoutSizes(model, relayoutSizes);
+
+	if (relayoutBlock && relayoutSizes[RELAYOUT_RECORDS])
+	{
+		err = RelayoutModel(model, relayoutBlock, relayoutSizes, offsetTypeSize, arena);
+		if (err != ERR_NO_ERROR)
+			return err;
+
+		inferenceOffsetTypeSize = model->weightDim <= 256 ? 1 : model->weightDim <= 65536 ? 2 : 4;
+		model->offsetTypeSize   = inferenceOffsetTypeSize;
+
+		err = SetLinksOffsets(model, inferenceOffsetTypeSize);
+		if (err != ERR_NO_ERROR)
+			return err;
+	}
+#else
+	(void) relayoutBlock;
+#endif
+
+	if (!model->executionCount)
+	{
+		err = BuildExecutionList(model, offsetTypeSize, arena);
+		if (err != ERR_NO_ERROR)
+			return err;
+	}
+
+	model->inference = SelectInference(model, inferenceOffsetTypeSize);
+	if (!model->inference)
+		return ERR_FEATURE_NOT_SUPPORTED;
+
 	for (uint32_t idx = 0; idx < inputLimitsCount; idx++)
 	{
 		if (model->inputsMin[idx] > model->inputsMax[idx])
 			return ERR_INCONSISTENT_DATA;
 	}
 
-	if ((inputLimitsCount == oneElement) && (model->inputsMax[0] != model->inputsMin[0]))
+	if ((inputLimitsCount == 1) && (model->inputsMax[0] != model->inputsMin[0]))
 		model->cachedInputsDiff = model->inputsMax[0] - model->inputsMin[0];
 
-
-	NFileClose(file);
-
-
 	return err;
 }
 
 
-Err NLoadModelEx(const char* fileName, NeuralNet* model)
+/**
+ * \brief Get count of the accumulators from the accumulator slots section
+ * \param file - model file
+ * \param section - accumulator slots section
+ * \param neuronsCount - neurons count
+ * \return highest slot + 1 or 0 if the section can not be read or a slot is out of range
+ */
+static uint32_t CountAccumulators(NFile* file, const NSection* section, uint32_t neuronsCount)
 {
-	return NLoadModel(NFileOpen(fileName, "rb"), model, 1);
-}
+	uint16_t slots[32];
+	const uint32_t maxChunk = sizeof(slots) / sizeof(*slots);
+	uint32_t count = 0;
 
+	if (NFileSeek(file, section->offset, SEEK_SET) != 0)
+		return 0;
 
-void NFreeModel(NeuralNet* model)
-{
-	if (model)
+	for (uint32_t first = 0; first < neuronsCount; first += maxChunk)
 	{
-		if (model->memoryBlock)
-			NFree(model->memoryBlock);
+		const uint32_t chunk = (neuronsCount - first) < maxChunk ? (neuronsCount - first) : maxChunk;
 
-		memset(model, 0, sizeof(*model));
+		if (NFileRead(slots, sizeof(*slots), chunk, file) != chunk)
+			return 0;
+
+		for (uint32_t idx = 0; idx < chunk; idx++)
+		{
+			if (slots[idx] >= neuronsCount)
+				return 0;
+			if (slots[idx] >= count)
+				count = slots[idx] + 1u;
+		}
 	}
+
+	return count;
 }
 
 
-void NNormalizeSample(float* sample, NeuralNet* model)
+/**
+ * \brief Load model from the file of version 2, see @NModelHeaderV2
+ * \details Without copy, sections of a buffer are used in place if all of them are
+ *          aligned in memory. Otherwise every section is read into the memory block.
+ *          Only the inference buffers are allocated in addition, and the re-laid out
+ *          structure with NEUTON_INTERLEAVED_LINKS.
+ * \param file - model file positioned after the common file header
+ * \param model - model of neural network
+ * \param copy - flag of the need to read sections even if the file is a buffer
+ * \param arena - memory of the load or NULL to use the heap
+ * \return error code or 0 on success
+ */
+static Err LoadModelV2(NFile* file, NeuralNet* model, uint8_t copy, Arena* arena)
 {
-	uint16_t inputLimitsCount =
-			(model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0
-			? 1 : model->inputsDim;
+	const uint8_t oneElement = 1;
 
-	for (uint16_t i = 0; i < model->inputsDim - 1; ++i)
-	{
-		if (inputLimitsCount == 1)
-		{
-			if (model->cachedInputsDiff)
-			{
-				sample[i] = (sample[i] - model->inputsMin[0]) / model->cachedInputsDiff;
-			}
-			else if (model->inputsMax[0] != model->inputsMin[0])
-			{
-				sample[i] = (sample[i] - model->inputsMin[0]) /
-						(model->inputsMax[0] - model->inputsMin[0]);
-			}
+	// Version 2 files are written in the byte order of the target
+	if (model->reverseByteOrder)
+		return ERR_FEATURE_NOT_SUPPORTED;
 
-		}
-		else if (model->inputsMax[i] != model->inputsMin[i])
-		{
-			sample[i] = (sample[i] - model->inputsMin[i]) /
-					(model->inputsMax[i] - model->inputsMin[i]);
-		}
+	NModelHeaderV2 header;
+	if (NFileRead(&header, sizeof(header), oneElement, file) != oneElement)
+		return ERR_READ_FILE;
 
-		if (sample[i] > 1.0f)
-			sample[i] = 1.0f;
+	if (!(header.quantisation == 8
+#if (NEUTON_Q16_SUPPORT == 1)
+		  || header.quantisation == 16
+#endif
+#if (NEUTON_Q32_SUPPORT == 1)
+		  || header.quantisation == 32
+#endif
+	))
+		return ERR_FEATURE_NOT_SUPPORTED;
 
-		if (sample[i] < 0.0f)
-			sample[i] = 0.0f;
-	}
-}
+	if (!header.weightDim || !header.inputsDim || !header.outputsDim || !header.neuronsCount ||
+		!header.executionCount || header.executionCount > header.neuronsCount)
+		return ERR_INCONSISTENT_DATA;
 
+	// Links and output labels are 16 bit
+	if (header.inputsDim > UINT16_MAX || header.outputsDim > UINT16_MAX || header.neuronsCount > UINT16_MAX)
+		return ERR_FEATURE_NOT_SUPPORTED;
 
-void NDenormalizeResult(float* result, NeuralNet* model)
-{
-	if (model->taskType == TASK_BINARY_CLASSIFICATION)
-	{
-		float sum = 0;
+	const uint8_t offsetTypeSize = header.offsetTypeSize;
+	if (offsetTypeSize != 1 && offsetTypeSize != 2 && offsetTypeSize != 4)
+		return ERR_FEATURE_NOT_SUPPORTED;
 
-		for (uint16_t i = 0; i < model->outputsDim; ++i)
-			sum += (float) result[i];
+	// Offsets run up to weightDim. A wider width than the one of a version 1 file is kept,
+	// the inference reads the width stored on the model
+	if (offsetTypeSize < (header.weightDim <= 256 ? 1 : header.weightDim <= 65536 ? 2 : 4))
+		return ERR_INCONSISTENT_DATA;
 
-		for (uint16_t i = 0; i < model->outputsDim; ++i)
-			result[i] = (float) result[i] / sum;
-	}
+	model->options      = header.options;
+	model->taskType     = header.taskType;
+	model->inputsDim    = header.inputsDim;
+	model->outputsDim   = header.outputsDim;
+	model->quantisation = header.quantisation;
+	model->neuronsCount = header.neuronsCount;
+	model->weightDim    = header.weightDim;
+
+	const uint8_t  positionTypeSize = sizeof(*model->links);
+	const uint8_t  limitTypeSize    = sizeof(*model->inputsMin);
+	const uint8_t  coeffTypeSize    = model->quantisation / 8;
+	const uint8_t  accTypeSize      = coeffTypeSize;
+	const uint8_t  inputTypeSize    = (model->quantisation == 32) ? 0 : coeffTypeSize;
+	const uint32_t inputLimitsCount =
+			(model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? oneElement : model->inputsDim;
+	const uint8_t  hasLogScale      = (model->options & BIT_LOG_SCALE_OUT_EXISTS) > 0;
 
-	if (model->taskType == TASK_MULTICLASS_CLASSIFICATION || model->taskType == TASK_REGRESSION)
+	if (model->weightDim > NFileSize(file) / (positionTypeSize + coeffTypeSize))
+		return ERR_INCONSISTENT_DATA;
+
+	// Size and value size of the sections used, 0 for the sections not used
+	uint32_t sizes[SECTIONS_COUNT] = { 0 };
+	uint8_t  valueSizes[SECTIONS_COUNT] = { 0 };
+
+	sizes[SECTION_INPUTS_MAX]         = limitTypeSize * inputLimitsCount;
+	sizes[SECTION_INPUTS_MIN]         = limitTypeSize * inputLimitsCount;
+	sizes[SECTION_OUTPUTS_MAX]        = limitTypeSize * model->outputsDim;
+	sizes[SECTION_OUTPUTS_MIN]        = limitTypeSize * model->outputsDim;
+	sizes[SECTION_OUTPUTS_LOG_OFFSET] = limitTypeSize * model->outputsDim * hasLogScale;
+	sizes[SECTION_OUTPUT_LABELS]      = positionTypeSize * model->outputsDim;
+	sizes[SECTION_INT_LINKS_COUNTERS] = positionTypeSize * model->neuronsCount;
+	sizes[SECTION_EXT_LINKS_COUNTERS] = positionTypeSize * model->neuronsCount;
+	sizes[SECTION_LINKS]              = positionTypeSize * model->weightDim;
+	sizes[SECTION_WEIGHTS]            = coeffTypeSize * model->weightDim;
+	sizes[SECTION_FNC_COEFFS]         = coeffTypeSize * model->neuronsCount;
+	sizes[SECTION_INT_LINKS]          = offsetTypeSize * model->neuronsCount;
+	sizes[SECTION_EXT_LINKS]          = offsetTypeSize * model->neuronsCount;
+#if (NEUTON_INPUT_SCALES == 1)
+	sizes[SECTION_INPUTS_SCALE]       = limitTypeSize * inputLimitsCount;
+#endif
+
+	valueSizes[SECTION_INPUTS_MAX]         = limitTypeSize;
+	valueSizes[SECTION_INPUTS_MIN]         = limitTypeSize;
+	valueSizes[SECTION_OUTPUTS_MAX]        = limitTypeSize;
+	valueSizes[SECTION_OUTPUTS_MIN]        = limitTypeSize;
+	valueSizes[SECTION_OUTPUTS_LOG_OFFSET] = limitTypeSize;
+	valueSizes[SECTION_OUTPUT_LABELS]      = positionTypeSize;
+	valueSizes[SECTION_INT_LINKS_COUNTERS] = positionTypeSize;
+	valueSizes[SECTION_EXT_LINKS_COUNTERS] = positionTypeSize;
+	valueSizes[SECTION_LINKS]              = positionTypeSize;
+	valueSizes[SECTION_WEIGHTS]            = coeffTypeSize;
+	valueSizes[SECTION_FNC_COEFFS]         = coeffTypeSize;
+	valueSizes[SECTION_INT_LINKS]          = offsetTypeSize;
+	valueSizes[SECTION_EXT_LINKS]          = offsetTypeSize;
+	valueSizes[SECTION_INPUTS_SCALE]       = limitTypeSize;
+	valueSizes[SECTION_EXECUTION_LIST]     = positionTypeSize;
+	valueSizes[SECTION_ACCUMULATOR_SLOTS]  = positionTypeSize;
+
+	NSection sections[SECTIONS_COUNT];
+	memset(sections, 0, sizeof(sections));
+
+	for (uint32_t idx = 0; idx < header.sectionsCount; idx++)
 	{
-		uint8_t hasLogScale = (model->options & BIT_LOG_SCALE_OUT_EXISTS) > 0;
+		NSection section;
+		if (NFileRead(&section, sizeof(section), oneElement, file) != oneElement)
+			return ERR_READ_FILE;
 
-		for (uint16_t i = 0; i < model->outputsDim; ++i)
+		if (section.id < SECTIONS_COUNT)
+			sections[section.id] = section;
+	}
+
+	// Links of the models with accumulator slots can not be followed to re-lay out the model
+	const uint8_t hasSlots = sections[SECTION_ACCUMULATOR_SLOTS].size > 0;
+	if (hasSlots)
+		sizes[SECTION_ACCUMULATOR_SLOTS] = positionTypeSize * model->neuronsCount;
+
+	uint8_t relayout = 0;
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+	uint32_t relayoutSizes[RELAYOUT_SECTIONS];
+	GetRelayoutSizes(model, relayoutSizes);
+	relayout = relayoutSizes[RELAYOUT_RECORDS] > 0 && !hasSlots;
+#endif
+
+	if (header.executionCount < model->neuronsCount && !relayout)
+		sizes[SECTION_EXECUTION_LIST] = positionTypeSize * header.executionCount;
+
+	// Sections end before CRC
+	const uint32_t dataSize = NFileSize(file) - sizeof(uint32_t);
+	const uint8_t* data = NFileData(file);
+	uint8_t inPlace = !copy && data;
+
+	for (uint8_t id = 0; id < SECTIONS_COUNT; id++)
+	{
+		const NSection* section = &sections[id];
+		if (!sizes[id])
+			continue;
+
+		if (section->size != sizes[id] || !section->align || (section->align & (section->align - 1)) ||
+			section->offset % section->align || section->offset > dataSize ||
+			section->size > dataSize - section->offset)
+			return ERR_BAD_FILE_FORMAT;
+
+		const uint8_t align = (valueSizes[id] < valueAlign) ? valueSizes[id] : valueAlign;
+		if (inPlace && ((size_t) (data + section->offset)) % align)
+			inPlace = 0;
+	}
+
+	model->accumulatorsCount = model->neuronsCount;
+	if (hasSlots)
+	{
+		model->accumulatorsCount = CountAccumulators(file, &sections[SECTION_ACCUMULATOR_SLOTS], model->neuronsCount);
+		if (!model->accumulatorsCount)
+			return ERR_INCONSISTENT_DATA;
+	}
+
+
+	const uint8_t memAlign = pointerTypeSize;
+	uint32_t blockSize = 0;
+
+	if (!inPlace)
+	{
+		for (uint8_t id = 0; id < SECTIONS_COUNT; id++)
+		{
+			if (sizes[id])
+				blockSize += AlignBy(memAlign, blockSize) + sizes[id]; // model sections
+		}
+	}
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		model->outputsDim * limitTypeSize;                // output buffer
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		model->accumulatorsCount * accTypeSize * NEUTON_BATCH_SIZE; // accumulators
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		model->inputsDim * inputTypeSize * NEUTON_BATCH_SIZE;  // quantised inputs
+
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+	if (relayout)
+	{
+		if (inPlace)
+			blockSize +=
+				AlignBy(memAlign, blockSize) +
+				2 * model->neuronsCount * offsetTypeSize; // int/ext model links, rewritten
+
+		blockSize += AlignBy(memAlign, blockSize);
+		for (uint8_t idx = 0; idx < RELAYOUT_SECTIONS; idx++)
+			blockSize += relayoutSizes[idx];              // re-laid out model structure
+	}
+#endif
+
+#if (NEUTON_SIMD == 1)
+	blockSize += NEUTON_SIMD_PADDING;                     // vector gathers overrun
+	kernels = NKernelsSelect();
+#endif
+
+
+	uint8_t* block = model->memoryBlock = ArenaAlloc(arena, oneElement, blockSize);
+	if (block == NULL)
+		return ERR_MEMORY_ALLOCATION;
+
+	uint8_t* sectionData[SECTIONS_COUNT] = { NULL };
+
+	for (uint8_t id = 0; id < SECTIONS_COUNT; id++)
+	{
+		if (!sizes[id])
+			continue;
+
+		if (inPlace)
+		{
+			sectionData[id] = (uint8_t*) data + sections[id].offset;
+			continue;
+		}
+
+		block += AlignBy(memAlign, (size_t) block);
+		sectionData[id] = block; block += sizes[id];
+
+		if (NFileSeek(file, sections[id].offset, SEEK_SET) != 0 ||
+			NFileRead(sectionData[id], sizes[id], oneElement, file) != oneElement)
+			return ERR_READ_FILE;
+	}
+
+	model->inputsMax        = (void*) sectionData[SECTION_INPUTS_MAX];
+	model->inputsMin        = (void*) sectionData[SECTION_INPUTS_MIN];
+	model->outputsMax       = (void*) sectionData[SECTION_OUTPUTS_MAX];
+	model->outputsMin       = (void*) sectionData[SECTION_OUTPUTS_MIN];
+	model->outputsLogOffset = (void*) sectionData[SECTION_OUTPUTS_LOG_OFFSET];
+	model->outputLabels     = (void*) sectionData[SECTION_OUTPUT_LABELS];
+	model->intLinksCounters = (void*) sectionData[SECTION_INT_LINKS_COUNTERS];
+	model->extLinksCounters = (void*) sectionData[SECTION_EXT_LINKS_COUNTERS];
+	model->links            = (void*) sectionData[SECTION_LINKS];
+	model->weights.raw      = sectionData[SECTION_WEIGHTS];
+	model->fncCoeffs.raw    = sectionData[SECTION_FNC_COEFFS];
+	model->intLinks.u8      = sectionData[SECTION_INT_LINKS];
+	model->extLinks.u8      = sectionData[SECTION_EXT_LINKS];
+#if (NEUTON_INPUT_SCALES == 1)
+	model->inputsScale      = (void*) sectionData[SECTION_INPUTS_SCALE];
+#endif
+	model->accumulatorSlots = (void*) sectionData[SECTION_ACCUMULATOR_SLOTS];
+
+	block += AlignBy(memAlign, (size_t) block);
+	model->context.outputBuffer = (void*) block; block += limitTypeSize * model->outputsDim;
+
+	block += AlignBy(memAlign, (size_t) block);
+	model->context.accumulators.raw = (void*) block;
+	block += accTypeSize * model->accumulatorsCount * NEUTON_BATCH_SIZE;
+
+	block += AlignBy(memAlign, (size_t) block);
+	model->context.quantisedInputs.raw = inputTypeSize ? (void*) block : NULL;
+	block += inputTypeSize * model->inputsDim * NEUTON_BATCH_SIZE;
+
+	uint8_t* relayoutBlock = NULL;
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+	if (relayout)
+	{
+		// Offsets are rewritten after the re-layout
+		if (inPlace)
+		{
+			block += AlignBy(memAlign, (size_t) block);
+			model->intLinks.u8 = memcpy(block, sectionData[SECTION_INT_LINKS], sizes[SECTION_INT_LINKS]);
+			block += sizes[SECTION_INT_LINKS];
+			model->extLinks.u8 = memcpy(block, sectionData[SECTION_EXT_LINKS], sizes[SECTION_EXT_LINKS]);
+			block += sizes[SECTION_EXT_LINKS];
+		}
+
+		block += AlignBy(memAlign, (size_t) block);
+		relayoutBlock = block;
+	}
+#endif
+
+	uint32_t offset = 0;
+	for (uint32_t idx = 0; idx < model->neuronsCount; offset += model->intLinksCounters[idx++])
+	{
+		if (valueAt(idx, model->intLinks, offsetTypeSize) != offset)
+			return ERR_INCONSISTENT_DATA;
+	}
+
+	for (uint32_t idx = 0; idx < model->neuronsCount; offset += model->extLinksCounters[idx++])
+	{
+		if (valueAt(idx, model->extLinks, offsetTypeSize) != offset)
+			return ERR_INCONSISTENT_DATA;
+	}
+
+	if (offset != model->weightDim)
+		return ERR_INCONSISTENT_DATA;
+
+	// Internal links read the accumulators, there are fewer of them than neurons
+	const uint32_t intLinksCount = valueAt(0, model->extLinks, offsetTypeSize);
+	for (uint32_t link = 0; hasSlots && link < intLinksCount; link++)
+	{
+		if (model->links[link] >= model->accumulatorsCount)
+			return ERR_INCONSISTENT_DATA;
+	}
+
+	if (!relayout)
+	{
+		model->executionCount = header.executionCount;
+		model->executionList  = (void*) sectionData[SECTION_EXECUTION_LIST];
+
+		for (uint32_t step = 0; model->executionList && step < model->executionCount; step++)
+		{
+			if (model->executionList[step] >= model->neuronsCount ||
+				(step > 0 && model->executionList[step] <= model->executionList[step - 1]))
+				return ERR_INCONSISTENT_DATA;
+		}
+	}
+
+	return SetupModel(model, offsetTypeSize, relayoutBlock, arena);
+}
+
+
+/**
+ * \brief Load model, the file is not closed
+ * \param file - model file
+ * \param model - model of neural network
+ * \param copy - flag of the need to read the model even if the file is a buffer
+ * \param arena - memory of the load or NULL to use the heap
+ * \return error code or 0 on success
+ */
+static Err LoadModel(NFile* file, NeuralNet* model, uint8_t copy, Arena* arena)
+{
+	Err err = ERR_NO_ERROR;
+
+	if (!file)
+		return ERR_OPEN_FILE;
+	if (!model)
+		return ERR_BAD_ARGUMENT;
+
+
+	void* data = model->data;
+	NFreeModel(model);
+	model->data = data;
+
+
+	if (CheckFileHeader(file, &model->reverseByteOrder, &model->version, TYPE_MODEL) != ERR_NO_ERROR)
+		return ERR_BAD_FILE_FORMAT;
+
+	if (model->version == 2)
+		return LoadModelV2(file, model, copy, arena);
+
+
+	const uint8_t oneElement = 1;
+
+
+	MetaInfo metaInfo = { 0 };
+	if (NFileRead(&metaInfo, sizeof(metaInfo), oneElement, file) != oneElement)
+		return ERR_READ_FILE;
+
+	uint32_t weightsDim = 0;
+	if (NFileRead(&weightsDim, sizeof(weightsDim), oneElement, file) != oneElement)
+		return ERR_READ_FILE;
+
+	if (!(metaInfo.quantisation == 8
+#if (NEUTON_Q16_SUPPORT == 1)
+		  || metaInfo.quantisation == 16
+#endif
+#if (NEUTON_Q32_SUPPORT == 1)
+		  || metaInfo.quantisation == 32
+#endif
+	))
+		return ERR_FEATURE_NOT_SUPPORTED;
+
+	if (!weightsDim || !metaInfo.inputsDim || !metaInfo.outputsDim || !metaInfo.neuronsCount)
+		return ERR_INCONSISTENT_DATA;
+
+	if (model->reverseByteOrder)
+	{
+		Reverse2BytesValuesBuffer(&metaInfo.inputsDim,    oneElement);
+		Reverse2BytesValuesBuffer(&metaInfo.outputsDim,   oneElement);
+		Reverse2BytesValuesBuffer(&metaInfo.neuronsCount, oneElement);
+		Reverse4BytesValuesBuffer(&weightsDim,            oneElement);
+	}
+
+	model->options              = metaInfo.options;
+	model->taskType             = metaInfo.taskType;
+	model->inputsDim            = metaInfo.inputsDim;
+	model->outputsDim           = metaInfo.outputsDim;
+	model->quantisation         = metaInfo.quantisation;
+
+	model->neuronsCount         = metaInfo.neuronsCount;
+	model->accumulatorsCount    = metaInfo.neuronsCount;
+	model->weightDim            = weightsDim;
+
+	const uint8_t align            = model->quantisation / 8;
+	const uint8_t positionTypeSize = sizeof(*model->links);
+	const uint8_t offsetTypeSize   = model->weightDim <= 256 ? 1 : model->weightDim <= 65536 ? 2 : 4;
+	const uint8_t limitTypeSize    = sizeof(*model->inputsMin);
+	const uint8_t coeffTypeSize    = (model->quantisation == 32) ? 4 : model->quantisation == 16 ? 2 : 1;
+	const uint8_t accTypeSize      = coeffTypeSize;
+	const uint8_t inputTypeSize    = (model->quantisation == 32) ? 0 : coeffTypeSize;
+
+	if (!positionTypeSize || !coeffTypeSize || !limitTypeSize || !pointerTypeSize || !align)
+		return ERR_MEMORY_ALLOCATION;
+
+	uint16_t inputLimitsCount =
+			(model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? oneElement : model->inputsDim;
+
+	uint8_t hasLogScale = (model->options & BIT_LOG_SCALE_OUT_EXISTS) > 0;
+
+
+	// This part can be mapped
+	uint32_t blockSize =
+		2           * limitTypeSize * inputLimitsCount +  // input limits
+		2           * limitTypeSize * model->outputsDim + // output limits
+		hasLogScale * limitTypeSize * model->outputsDim;  // output log scale
+
+	blockSize +=
+		AlignBy(align, blockSize) +
+		model->outputsDim * positionTypeSize;             // output neuron indexes
+	blockSize +=
+		AlignBy(align, blockSize) +
+		2 * model->neuronsCount * positionTypeSize;       // int/ext links count
+	blockSize +=
+		AlignBy(align, blockSize) +
+		model->weightDim * positionTypeSize;              // model links
+	blockSize +=
+		AlignBy(align, blockSize) +
+		model->weightDim * coeffTypeSize;                 // model weights
+	blockSize +=
+		AlignBy(align, blockSize) +
+		model->neuronsCount * coeffTypeSize;              // activation function coefficients
+
+
+	uint8_t useMapper = !copy && (model->reverseByteOrder == 0) && NFileData(file) &&
+						(NFileSize(file) >= (blockSize + NFilePos(file)));
+	if (useMapper)
+		blockSize = 0;
+
+	// This part always in RAM
+	const uint8_t memAlign = pointerTypeSize;
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		model->outputsDim * limitTypeSize;                // output buffer
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		model->neuronsCount * accTypeSize * NEUTON_BATCH_SIZE; // accumulators
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		model->inputsDim * inputTypeSize * NEUTON_BATCH_SIZE;  // quantised inputs
+
+#if (NEUTON_INPUT_SCALES == 1)
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		inputLimitsCount * limitTypeSize;                 // input scales
+#endif
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		2 * model->neuronsCount * offsetTypeSize;         // int/ext model links
+
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+	uint32_t relayoutSizes[RELAYOUT_SECTIONS];
+	GetRelayoutSizes(model, relayoutSizes);
+
+	blockSize += AlignBy(memAlign, blockSize);
+	for (uint8_t idx = 0; idx < RELAYOUT_SECTIONS; idx++)
+		blockSize += relayoutSizes[idx];                  // re-laid out model structure
+#endif
+
+#if (NEUTON_SIMD == 1)
+	blockSize += NEUTON_SIMD_PADDING;                     // vector gathers overrun
+	kernels = NKernelsSelect();
+#endif
+
+
+	uint8_t* block = model->memoryBlock = ArenaAlloc(arena, oneElement, blockSize);
+	if (block == NULL)
+		return ERR_MEMORY_ALLOCATION;
+
+
+	// This part can be mapped
+	if (useMapper)
+		block = (uint8_t*) NFileData(file) + NFilePos(file);
+
+	model->inputsMax  = (void*) block; block += limitTypeSize * inputLimitsCount;
+	model->inputsMin  = (void*) block; block += limitTypeSize * inputLimitsCount;
+	model->outputsMax = (void*) block; block += limitTypeSize * model->outputsDim;
+	model->outputsMin = (void*) block; block += limitTypeSize * model->outputsDim;
+
+	model->outputsLogOffset = hasLogScale ? (void*) block : NULL;
+	block += hasLogScale * limitTypeSize * model->outputsDim;
+
+	block += AlignBy(align, (size_t) block);
+	model->outputLabels = (void*) block; block += positionTypeSize * model->outputsDim;
+
+	block += AlignBy(align, (size_t) block);
+	model->intLinksCounters = (void*) block; block += positionTypeSize * model->neuronsCount;
+	model->extLinksCounters = (void*) block; block += positionTypeSize * model->neuronsCount;
+
+	uint32_t structureSize = positionTypeSize * model->weightDim;
+	uint32_t structureOffset = structureSize += AlignBy(align, structureSize);
+	structureSize += coeffTypeSize * model->weightDim;
+
+	block += AlignBy(align, (size_t) block);
+	void* structure = model->links = (void*) block; block += structureSize;
+	model->weights.raw = (void*) ((uint8_t*) structure + structureOffset);
+
+	block += AlignBy(align, (size_t) block);
+	model->fncCoeffs.raw = block; block += coeffTypeSize * model->neuronsCount;
+
+
+	// This part always in RAM
+	if (useMapper)
+		block = model->memoryBlock;
+
+	block += AlignBy(memAlign, (size_t) block);
+	model->context.outputBuffer = (void*) block; block += limitTypeSize * model->outputsDim;
+
+	block += AlignBy(memAlign, (size_t) block);
+	model->context.accumulators.raw = (void*) block; block += accTypeSize * model->neuronsCount * NEUTON_BATCH_SIZE;
+
+	block += AlignBy(memAlign, (size_t) block);
+	model->context.quantisedInputs.raw = inputTypeSize ? (void*) block : NULL;
+	block += inputTypeSize * model->inputsDim * NEUTON_BATCH_SIZE;
+
+#if (NEUTON_INPUT_SCALES == 1)
+	block += AlignBy(memAlign, (size_t) block);
+	model->inputsScale = (void*) block; block += limitTypeSize * inputLimitsCount;
+#endif
+
+	block += AlignBy(memAlign, (size_t) block);
+	model->intLinks.u8 = block; block += offsetTypeSize * model->neuronsCount;
+	model->extLinks.u8 = block; block += offsetTypeSize * model->neuronsCount;
+
+	uint8_t* relayoutBlock = NULL;
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+	block += AlignBy(memAlign, (size_t) block);
+	relayoutBlock = block;
+#endif
+
+	if (!useMapper)
+	{
+		if (NFileRead(model->inputsMax,  limitTypeSize, inputLimitsCount, file) != inputLimitsCount ||
+			NFileRead(model->inputsMin,  limitTypeSize, inputLimitsCount, file) != inputLimitsCount ||
+			NFileRead(model->outputsMax, limitTypeSize, model->outputsDim, file) != model->outputsDim ||
+			NFileRead(model->outputsMin, limitTypeSize, model->outputsDim, file) != model->outputsDim)
+			return ERR_READ_FILE;
+
+		if (hasLogScale &&
+			NFileRead(model->outputsLogOffset, limitTypeSize, model->outputsDim, file) != model->outputsDim)
+			return ERR_READ_FILE;
+
+		if (NFileSeek(file, AlignBy(align, NFilePos(file)), SEEK_CUR) == 0 &&
+			NFileRead(model->outputLabels, positionTypeSize, model->outputsDim, file) != model->outputsDim)
+			return ERR_READ_FILE;
+
+		if (NFileSeek(file, AlignBy(align, NFilePos(file)), SEEK_CUR) == 0 &&
+			(NFileRead(model->intLinksCounters, positionTypeSize, model->neuronsCount, file) != model->neuronsCount ||
+			NFileRead(model->extLinksCounters, positionTypeSize, model->neuronsCount, file) != model->neuronsCount))
+			return ERR_READ_FILE;
+
+		if (NFileSeek(file, AlignBy(align, NFilePos(file)), SEEK_CUR) == 0 &&
+			NFileRead(structure, structureSize, oneElement, file) != oneElement)
+			return ERR_READ_FILE;
+
+		if (NFileSeek(file, AlignBy(align, NFilePos(file)), SEEK_CUR) == 0 &&
+			NFileRead(model->fncCoeffs.raw,   coeffTypeSize, model->neuronsCount, file) != model->neuronsCount)
+			return ERR_READ_FILE;
+
+		if (model->reverseByteOrder)
+		{
+			switch (limitTypeSize)
+			{
+			case 4:
+				Reverse4BytesValuesBuffer(model->inputsMax,  inputLimitsCount);
+				Reverse4BytesValuesBuffer(model->inputsMin,  inputLimitsCount);
+				Reverse4BytesValuesBuffer(model->outputsMax, model->outputsDim);
+				Reverse4BytesValuesBuffer(model->outputsMin, model->outputsDim);
+				if (hasLogScale)
+					Reverse4BytesValuesBuffer(model->outputsLogOffset, model->outputsDim);
+				break;
+
+			default:
+				return ERR_FEATURE_NOT_SUPPORTED;
+				break;
+			}
+
+			switch (positionTypeSize)
+			{
+			case 1:
+				break;
+
+			case 2:
+				Reverse2BytesValuesBuffer(model->intLinksCounters, model->neuronsCount);
+				Reverse2BytesValuesBuffer(model->extLinksCounters, model->neuronsCount);
+				Reverse2BytesValuesBuffer(structure,               model->weightDim);
+				Reverse2BytesValuesBuffer(model->outputLabels,     model->outputsDim);
+				break;
+
+			case 4:
+				Reverse4BytesValuesBuffer(model->intLinksCounters, model->neuronsCount);
+				Reverse4BytesValuesBuffer(model->extLinksCounters, model->neuronsCount);
+				Reverse4BytesValuesBuffer(structure,               model->weightDim);
+				Reverse4BytesValuesBuffer(model->outputLabels,     model->outputsDim);
+				break;
+
+			default:
+				return ERR_FEATURE_NOT_SUPPORTED;
+				break;
+			}
+
+			switch (coeffTypeSize)
+			{
+			case 1:
+				break;
+
+			case 2:
+				Reverse2BytesValuesBuffer((uint8_t*) structure + structureOffset, model->weightDim);
+				Reverse2BytesValuesBuffer(model->fncCoeffs.raw,                   model->neuronsCount);
+				break;
+
+			case 4:
+				Reverse4BytesValuesBuffer((uint8_t*) structure + structureOffset, model->weightDim);
+				Reverse4BytesValuesBuffer(model->fncCoeffs.raw,                   model->neuronsCount);
+				break;
+
+			default:
+				return ERR_FEATURE_NOT_SUPPORTED;
+				break;
+			}
+
+		}
+	}
+
+
+	err = SetLinksOffsets(model, offsetTypeSize);
+	if (err != ERR_NO_ERROR)
+		return err;
+
+
+	err = SetupModel(model, offsetTypeSize, relayoutBlock, arena);
+	if (err != ERR_NO_ERROR)
+		return err;
+
+#if (NEUTON_INPUT_SCALES == 1)
+	const float inputRange = (model->quantisation == 32) ? 1.0f : (float) (1ul << model->quantisation);
+
+	for (uint32_t idx = 0; idx < inputLimitsCount; idx++)
+	{
+		model->inputsScale[idx] = (model->inputsMax[idx] != model->inputsMin[idx]) ?
+				inputRange / (model->inputsMax[idx] - model->inputsMin[idx]) : 0.0f;
+	}
+#endif
+
+	return err;
+}
+
+
+Err NLoadModel(NFile *file, NeuralNet *model, uint8_t copy)
+{
+	const Err err = LoadModel(file, model, copy, NULL);
+	if (err == ERR_NO_ERROR)
+		NFileClose(file);
+
+	return err;
+}
+
+
+/**
+ * \brief Load model from buffer with all the memory taken from arena
+ * \param arena - caller's memory, without data only the size is counted
+ */
+static Err LoadModelInArena(const uint8_t* buffer, uint32_t size, NeuralNet* model, uint8_t copy, Arena* arena)
+{
+	NFile counted;
+
+	NFile* file = ArenaAlloc(arena, 1, sizeof(struct NFile_));
+	if (!arena->data)
+		file = &counted;
+	if (!file)
+		return ERR_MEMORY_ALLOCATION;
+
+	memset(file, 0, sizeof(struct NFile_));
+	file->data = (uint8_t*) buffer;
+	file->size = size;
+
+	return LoadModel(file, model, copy, arena);
+}
+
+
+uint32_t NModelMemoryRequirements(const uint8_t* buffer, uint32_t size, uint8_t copy)
+{
+	if (!buffer || !size)
+		return 0;
+
+	// The load stops at the memory block, everything before it is counted
+	Arena arena = { NULL, 0, 0 };
+	NeuralNet model = { 0 };
+
+	if (LoadModelInArena(buffer, size, &model, copy, &arena) != ERR_MEMORY_ALLOCATION ||
+		!model.neuronsCount)
+		return 0;
+
+	// Allocations after the memory block, in the order of the load
+	uint8_t relayout = 0;
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+	// Neurons order of the re-layout, models with accumulator slots are not re-laid out
+	relayout = model.quantisation != 8 && model.accumulatorsCount == model.neuronsCount;
+	if (relayout)
+		ArenaAlloc(&arena, 4 * model.neuronsCount, sizeof(uint16_t));
+#endif
+
+	// Live neurons and the execution list of version 1, the re-layout finds them itself
+	if (model.version < 2 && !relayout)
+	{
+		ArenaAlloc(&arena, (model.neuronsCount + 7) / 8, sizeof(uint8_t));
+		ArenaAlloc(&arena, model.neuronsCount, sizeof(*model.executionList));
+	}
+
+	return arena.used;
+}
+
+
+Err NLoadModelInto(void* arena, uint32_t arenaSize, const uint8_t* buffer, uint32_t size,
+				   NeuralNet* model, uint8_t copy)
+{
+	if (!arena || !buffer || !size || !model)
+		return ERR_BAD_ARGUMENT;
+
+	Arena memory = { arena, arenaSize, 0 };
+
+	const Err err = LoadModelInArena(buffer, size, model, copy, &memory);
+	model->inArena = 1;
+
+	return err;
+}
+
+
+#if (NEUTON_MMAP == 1)
+/**
+ * \brief Map the model file read-only and load the model from the mapping
+ * \details Sections of the file are used in place, so only the RAM part of the model is
+ *          allocated and the pages are shared by all processes loading the same file.
+ *          Mapping is released at once if the model does not use it (reversed byte order).
+ * \return error code or 0 on success, ERR_OPEN_FILE if the file can not be mapped
+ */
+static Err LoadMappedModel(const char* fileName, NeuralNet* model)
+{
+	const int fd = open(fileName, O_RDONLY);
+	if (fd < 0)
+		return ERR_OPEN_FILE;
+
+	struct stat st;
+	void* data = MAP_FAILED;
+
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= UINT32_MAX)
+		data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return ERR_OPEN_FILE;
+
+	const Err err = NLoadModel(NFileFromBuffer(data, st.st_size), model, 0);
+
+	// Input limits are the first section, they are in the mapping if the mapper is used
+	const uint8_t* section = (const uint8_t*) model->inputsMax;
+	if (err == ERR_NO_ERROR && section >= (uint8_t*) data && section < (uint8_t*) data + st.st_size)
+	{
+		model->mappedFile = data;
+		model->mappedSize = st.st_size;
+	}
+	else
+	{
+#if (NEUTON_CRC_CACHE_SIZE > 0)
+		ForgetVerified(data, st.st_size);
+#endif
+		munmap(data, st.st_size);
+	}
+
+	return err;
+}
+#endif
+
+
+Err NLoadModelEx(const char* fileName, NeuralNet* model)
+{
+#if (NEUTON_MMAP == 1)
+	if (!fileName || !model)
+		return ERR_BAD_ARGUMENT;
+
+	const Err err = LoadMappedModel(fileName, model);
+	if (err != ERR_OPEN_FILE)
+		return err;
+#endif
+
+	return NLoadModel(NFileOpen(fileName, "rb"), model, 1);
+}
+
+
+void NFreeModel(NeuralNet* model)
+{
+	if (model)
+	{
+#if (NEUTON_THREADS == 1)
+		FreeParallel(model);
+#endif
+
+		// The execution list of version 2 models is a section of the model
+		if (!model->inArena)
+		{
+			if (model->memoryBlock)
+				NFree(model->memoryBlock);
+
+			if (model->executionList && model->version < 2)
+				NFree(model->executionList);
+		}
+
+		if (model->rawInputs)
+			NFree(model->rawInputs);
+
+#if (NEUTON_MMAP == 1)
+		if (model->mappedFile)
+		{
+#if (NEUTON_CRC_CACHE_SIZE > 0)
+			ForgetVerified(model->mappedFile, model->mappedSize);
+#endif
+			munmap(model->mappedFile, model->mappedSize);
+		}
+#endif
+
+		memset(model, 0, sizeof(*model));
+	}
+}
+
+
+void NGetPruneReport(const NeuralNet* model, NPruneReport* report)
+{
+	const uint8_t coeffTypeSize = model->quantisation / 8;
+	uint32_t step = 0;
+
+	memset(report, 0, sizeof(*report));
+
+	for (uint32_t neuron = 0; neuron < model->neuronsCount; neuron++)
+	{
+		const uint8_t evaluated = model->executionList ?
+				(step < model->executionCount && model->executionList[step] == neuron) :
+				(neuron < model->executionCount);
+		if (evaluated)
+		{
+			step++;
+			continue;
+		}
+
+		report->neurons++;
+		report->links += model->intLinksCounters[neuron] + model->extLinksCounters[neuron];
+	}
+
+	report->bytes = report->links * (sizeof(*model->links) + coeffTypeSize) +
+			report->neurons * (2 * sizeof(*model->intLinksCounters) + coeffTypeSize);
+}
+
+
+void NNormalizeSample(float* sample, NeuralNet* model)
+{
+	const uint16_t limitStep = (model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? 0 : 1;
+
+	for (uint16_t i = 0; i < model->inputsDim - 1; ++i)
+	{
+		const uint16_t limit = i * limitStep;
+
+		if (model->inputsMax[limit] != model->inputsMin[limit])
+		{
+			sample[i] = (sample[i] - model->inputsMin[limit]) /
+					(model->inputsMax[limit] - model->inputsMin[limit]);
+		}
+
+		if (sample[i] > 1.0f)
+			sample[i] = 1.0f;
+
+		if (sample[i] < 0.0f)
+			sample[i] = 0.0f;
+	}
+}
+
+
+void NDenormalizeResult(float* result, NeuralNet* model)
+{
+	if (model->taskType == TASK_BINARY_CLASSIFICATION)
+	{
+		float sum = 0;
+
+		for (uint16_t i = 0; i < model->outputsDim; ++i)
+			sum += (float) result[i];
+
+		for (uint16_t i = 0; i < model->outputsDim; ++i)
+			result[i] = (float) result[i] / sum;
+	}
+
+	if (model->taskType == TASK_MULTICLASS_CLASSIFICATION || model->taskType == TASK_REGRESSION)
+	{
+		uint8_t hasLogScale = (model->options & BIT_LOG_SCALE_OUT_EXISTS) > 0;
+
+		for (uint16_t i = 0; i < model->outputsDim; ++i)
+		{
+			result[i] = result[i] * (model->outputsMax[i] - model->outputsMin[i]) +
+					model->outputsMin[i];
+
+			if (hasLogScale && (model->outputsLogOffset[i] != 0xFFFFFFFF))
+			{
+				result[i] = exp(result[i]) - model->outputsLogOffset[i];
+			}
+		}
+	}
+}
+
+
+static inline uint32_t valueAt(uint32_t index, Pointer p, uint8_t typeSize)
+{
+	switch (typeSize)
+	{
+	case sizeof(uint8_t):  return p.u8[index];
+	case sizeof(uint16_t): return p.u16[index];
+	case sizeof(uint32_t): return p.u32[index];
+	default:               return 0;
+	}
+}
+
+
+/**
+ * \brief Get index of the neuron value in the accumulators of one sample
+ */
+static inline uint32_t AccumulatorSlot(const NeuralNet* model, uint32_t neuron)
+{
+	return model->accumulatorSlots ? model->accumulatorSlots[neuron] : neuron;
+}
+
+
+static inline int32_t DotQ8(const int8_t* weights, const uint16_t* links,
+							const uint8_t* values, uint16_t count)
+{
+#if (NEUTON_SIMD == 1)
+	return kernels->dotQ8(weights, links, values, count);
+#else
+	return DotQ8Scalar(weights, links, values, count);
+#endif
+}
+
+
+#if (NEUTON_Q16_SUPPORT == 1)
+static inline int64_t DotQ16(const int16_t* weights, const uint16_t* links,
+							 const uint16_t* values, uint16_t count)
+{
+#if (NEUTON_SIMD == 1)
+	return kernels->dotQ16(weights, links, values, count);
+#else
+	return DotQ16Scalar(weights, links, values, count);
+#endif
+}
+
+
+#endif // NEUTON_Q16_SUPPORT
+
+
+#if (NEUTON_Q32_SUPPORT == 1)
+static inline double DotF32(const float* weights, const uint16_t* links,
+							const float* values, uint16_t count)
+{
+#if (NEUTON_SIMD == 1)
+	return kernels->dotF32(weights, links, values, count);
+#else
+	return DotF32Scalar(weights, links, values, count);
+#endif
+}
+#endif // NEUTON_Q32_SUPPORT
+
+
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+#if (NEUTON_Q16_SUPPORT == 1)
+static inline int64_t DotLinksQ16(const NLinkQ16* records, const uint16_t* values, uint16_t count)
+{
+#if (NEUTON_SIMD == 1)
+	return kernels->dotLinksQ16(records, values, count);
+#else
+	return DotLinksQ16Scalar(records, values, count);
+#endif
+}
+#endif // NEUTON_Q16_SUPPORT
+
+
+#if (NEUTON_Q32_SUPPORT == 1)
+static inline double DotLinksF32(const NLinkF32* records, const float* values, uint16_t count)
+{
+#if (NEUTON_SIMD == 1)
+	return kernels->dotLinksF32(records, values, count);
+#else
+	return DotLinksF32Scalar(records, values, count);
+#endif
+}
+#endif // NEUTON_Q32_SUPPORT
+#endif // NEUTON_INTERLEAVED_LINKS
+
+
+/**
+ * \brief Interpolation points of the integer sigmoid
+ * \details Point n (n > 0) has bit i (from MSB) set to (i / n) % 2, point 0 is 0.5.
+ *          Points past the last one are all zero.
+ */
+static const uint8_t sigmoidPointsU8[] =
+{
+	0x80, 0x55, 0x33, 0x1C, 0x0F, 0x07, 0x03, 0x01, 0x00
+};
+
+
+static uint8_t accurate_fast_sigmoid_u8(int32_t arg)
+{
+	const uint8_t QLVL = 8;
+	const uint8_t LAST_POINT = sizeof(sigmoidPointsU8) - 1;
+	const uint32_t absArg = arg < 0 ? 0u - (uint32_t) arg : (uint32_t) arg;
+	const uint32_t intPart = absArg >> QLVL;
+	const uint16_t realPart = absArg & ((1u << QLVL) - 1);
+
+	if (absArg == 0)
+		return sigmoidPointsU8[0];
+
+	const uint8_t firstPointY = sigmoidPointsU8[intPart < LAST_POINT ? intPart : LAST_POINT];
+
+	if (realPart == 0)
+		return arg > 0 ? firstPointY : (uint8_t) ~firstPointY;
+
+	const uint8_t secondPointY = sigmoidPointsU8[intPart < LAST_POINT ? intPart + 1 : LAST_POINT];
+
+	const uint8_t qResult = ((uint16_t) ((1u << QLVL) - realPart) * firstPointY +
+							 (uint16_t) realPart * secondPointY) >> QLVL;
+	if (arg > 0)
+		return qResult;
+	else
+		return qResult == 0 ? UINT8_MAX : (uint8_t) ((1u << QLVL) - qResult);
+}
+
+#if (NEUTON_Q16_SUPPORT == 1)
+/**
+ * \brief Interpolation points of the integer sigmoid, see @sigmoidPointsU8
+ */
+static const uint16_t sigmoidPointsU16[] =
+{
+	0x8000, 0x5555, 0x3333, 0x1C71, 0x0F0F, 0x07C1, 0x03F0, 0x01FC, 0x00FF,
+	0x007F, 0x003F, 0x001F, 0x000F, 0x0007, 0x0003, 0x0001, 0x0000
+};
+
+
+static uint16_t accurate_fast_sigmoid_u16(int64_t arg)
+{
+	const uint8_t QLVL = 16;
+	const uint8_t LAST_POINT = sizeof(sigmoidPointsU16) / sizeof(sigmoidPointsU16[0]) - 1;
+	const uint64_t absArg = arg < 0 ? 0u - (uint64_t) arg : (uint64_t) arg;
+	const uint64_t intPart = absArg >> QLVL;
+	const uint32_t realPart = absArg & ((1ul << QLVL) - 1);
+
+	if (absArg == 0)
+		return sigmoidPointsU16[0];
+
+	const uint16_t firstPointY = sigmoidPointsU16[intPart < LAST_POINT ? (uint8_t) intPart : LAST_POINT];
+
+	if (realPart == 0)
+		return arg > 0 ? firstPointY : (uint16_t) ~firstPointY;
+
+	const uint16_t secondPointY = sigmoidPointsU16[intPart < LAST_POINT ? (uint8_t) intPart + 1 : LAST_POINT];
+
+	const uint16_t qResult = ((uint32_t) ((1ul << QLVL) - realPart) * firstPointY +
+							  (uint32_t) realPart * secondPointY) >> QLVL;
+	if (arg > 0)
+		return qResult;
+	else
+		return qResult == 0 ? UINT16_MAX : (uint16_t) ((1ul << QLVL) - qResult);
+}
+#endif // NEUTON_Q16_SUPPORT
+
+
+static inline float dequantiseValue(int32_t value, const NeuralNet* model)
+{
+	return (float) value / (float) (2 << (model->quantisation - 1));
+}
+
+
+/**
+ * \brief Define inference kernel of the integer model
+ * \details Kernel is specialised for the quantisation, the type of the int/ext links
+ *          offsets and the activation, so the neuron loop has no runtime dispatch
+ * \param Q - quantisation, 8 or 16
+ * \param SUMM - type of the neuron summ
+ * \param OFFSET - member of @Pointer with the links offsets: u8, u16 or u32
+ * \param ACTIVATION - activation variant: Integer or Float
+ */
+#define DEFINE_INFERENCE_Q(Q, SUMM, OFFSET, ACTIVATION)													\
+static float* RunInferenceQ##Q##_##OFFSET##_##ACTIVATION(const NeuralNet* model, NContext* context,		\
+														 const float* inputs)							\
+{																										\
+	(void) inputs;																						\
+																										\
+	memset(context->accumulators.raw, 0,																\
+		   model->accumulatorsCount * sizeof(*context->accumulators.u##Q));								\
+																										\
+	for (uint32_t step = 0; step < model->executionCount; step++)										\
+	{																									\
+		const uint32_t neuronIndex = model->executionList ? model->executionList[step] : step;			\
+																										\
+		uint32_t offset = model->intLinks.OFFSET[neuronIndex];											\
+		SUMM summ = DotQ##Q(model->weights.i##Q + offset, model->links + offset,						\
+							context->accumulators.u##Q, model->intLinksCounters[neuronIndex]);			\
+																										\
+		offset = model->extLinks.OFFSET[neuronIndex];													\
+		summ += DotQ##Q(model->weights.i##Q + offset, model->links + offset,							\
+						context->quantisedInputs.u##Q, model->extLinksCounters[neuronIndex]);			\
+																										\
+		context->accumulators.u##Q[AccumulatorSlot(model, neuronIndex)] =								\
+				ActivationQ##Q##ACTIVATION(model, neuronIndex, summ);									\
+	}																									\
+																										\
+	for (uint16_t idx = 0; idx < model->outputsDim; idx++)												\
+		context->outputBuffer[idx] = dequantiseValue(													\
+				context->accumulators.u##Q[AccumulatorSlot(model, model->outputLabels[idx])], model);	\
+																										\
+	return context->outputBuffer;																		\
+}
+
+
+/**
+ * \brief Define inference kernel of the float model, see @DEFINE_INFERENCE_Q
+ */
+#define DEFINE_INFERENCE_F32(OFFSET)																	\
+static float* RunInferenceF32_##OFFSET(const NeuralNet* model, NContext* context, const float* inputs)	\
+{																										\
+	memset(context->accumulators.raw, 0,																\
+		   model->accumulatorsCount * sizeof(*context->accumulators.f32));								\
+																										\
+	for (uint32_t step = 0; step < model->executionCount; step++)										\
+	{																									\
+		const uint32_t neuronIndex = model->executionList ? model->executionList[step] : step;			\
+																										\
+		uint32_t offset = model->intLinks.OFFSET[neuronIndex];											\
+		double summ = DotF32(model->weights.f32 + offset, model->links + offset,						\
+							 context->accumulators.f32, model->intLinksCounters[neuronIndex]);			\
+																										\
+		offset = model->extLinks.OFFSET[neuronIndex];													\
+		summ += DotF32(model->weights.f32 + offset, model->links + offset,								\
+					   inputs, model->extLinksCounters[neuronIndex]);									\
+																										\
+		context->accumulators.f32[AccumulatorSlot(model, neuronIndex)] =								\
+				1.0f / (1.0f + exp((double) ((double) -model->fncCoeffs.f32[neuronIndex]) * summ));		\
+	}																									\
+																										\
+	for (uint16_t idx = 0; idx < model->outputsDim; idx++)												\
+		context->outputBuffer[idx] =																	\
+				context->accumulators.f32[AccumulatorSlot(model, model->outputLabels[idx])];			\
+																										\
+	return context->outputBuffer;																		\
+}
+
+/**
+ * \brief Define inference kernel of the model re-laid out by @RelayoutModel
+ * \details Links and weights are read from one stream of records. All links point to
+ *          already computed neurons, so the accumulators are not cleared.
+ * \param Q - quantisation, 16
+ * \param SUMM - type of the neuron summ
+ * \param ACTIVATION - activation variant: Integer or Float
+ */
+#define DEFINE_INFERENCE_RECORDS_Q(Q, SUMM, ACTIVATION)													\
+static float* RunInferenceRecordsQ##Q##_##ACTIVATION(const NeuralNet* model, NContext* context,			\
+													 const float* inputs)								\
+{																										\
+	const NLinkQ##Q* records = model->linkRecords.u32;													\
+	(void) inputs;																						\
+																										\
+	for (uint32_t neuronIndex = 0; neuronIndex < model->executionCount; neuronIndex++)					\
+	{																									\
+		const uint16_t intCount = model->intLinksCounters[neuronIndex];									\
+		const uint16_t extCount = model->extLinksCounters[neuronIndex];									\
+																										\
+		SUMM summ = DotLinksQ##Q(records, context->accumulators.u##Q, intCount);						\
+		summ += DotLinksQ##Q(records + intCount, context->quantisedInputs.u##Q, extCount);				\
+		records += intCount + extCount;																	\
+																										\
+		context->accumulators.u##Q[neuronIndex] =														\
+				ActivationQ##Q##ACTIVATION(model, neuronIndex, summ);									\
+	}																									\
+																										\
+	for (uint16_t idx = 0; idx < model->outputsDim; idx++)												\
+		context->outputBuffer[idx] =																	\
+				dequantiseValue(context->accumulators.u##Q[model->outputLabels[idx]], model);			\
+																										\
+	return context->outputBuffer;																		\
+}
+
+
+/**
+ * \brief Define inference kernel of the re-laid out float model, see @DEFINE_INFERENCE_RECORDS_Q
+ */
+#define DEFINE_INFERENCE_RECORDS_F32()																	\
+static float* RunInferenceRecordsF32(const NeuralNet* model, NContext* context, const float* inputs)	\
+{																										\
+	const NLinkF32* records = model->linkRecords.raw;													\
+																										\
+	for (uint32_t neuronIndex = 0; neuronIndex < model->executionCount; neuronIndex++)					\
+	{																									\
+		const uint16_t intCount = model->intLinksCounters[neuronIndex];									\
+		const uint16_t extCount = model->extLinksCounters[neuronIndex];									\
+																										\
+		double summ = DotLinksF32(records, context->accumulators.f32, intCount);						\
+		summ += DotLinksF32(records + intCount, inputs, extCount);										\
+		records += intCount + extCount;																	\
+																										\
+		context->accumulators.f32[neuronIndex] =														\
+				1.0f / (1.0f + exp((double) ((double) -model->fncCoeffs.f32[neuronIndex]) * summ));		\
+	}																									\
+																										\
+	for (uint16_t idx = 0; idx < model->outputsDim; idx++)												\
+		context->outputBuffer[idx] = context->accumulators.f32[model->outputLabels[idx]];				\
+																										\
+	return context->outputBuffer;																		\
+}
+
+
+static inline uint8_t quantiseInputQ8(float value)
+{
+	return value > 0.0f ? (value > MAX_INPUT_FLOAT ? MAX_INPUT_FLOAT : value) * 256.0f : 0;
+}
+
+
+static inline uint8_t quantiseScaledInputQ8(float value)
+{
+	return value > 0.0f ? (value > MAX_INPUT_FLOAT * 256.0f ? MAX_INPUT_FLOAT * 256.0f : value) : 0;
+}
+
+
+/**
+ * \brief Normalise input value and multiply it by range
+ * \details Range is a power of two, so the result is the same as of the
+ *          normalisation followed by the quantisation
+ * \param model - model of neural network
+ * \param value - raw input value
+ * \param limit - index of the input limits
+ * \param range - 2^quantisation for integer models, 1.0 for float models
+ * \return scaled value, not clamped
+ */
+static inline float scaleInput(const NeuralNet* model, float value, uint16_t limit, float range)
+{
+#if (NEUTON_INPUT_SCALES == 1)
+	const float scale = model->inputsScale[limit];
+
+	return scale ? (value - model->inputsMin[limit]) * scale : value * range;
+#else
+	const float diff = model->inputsMax[limit] - model->inputsMin[limit];
+
+	return diff ? (value - model->inputsMin[limit]) / diff * range : value * range;
+#endif
+}
+
+
+/**
+ * \brief Read a value of a dataset row, rows of mapped datasets are not aligned
+ * \param row - values of one sample
+ * \param input - index of the value
+ */
+static inline float rowValue(const uint8_t* row, uint16_t input)
+{
+	float value;
+
+	memcpy(&value, row + (size_t) input * sizeof(value), sizeof(value));
+	return value;
+}
+
+
+/**
+ * \brief Quantise model inputs into context->quantisedInputs
+ * \details Only inputs used by external links are converted unless there are at
+ *          least as many external links as inputs
+ * \param model - model of neural network
+ * \param context - inference context
+ * \param inputs - input values, value of input i for sample s is inputs[i * inputsStride + s]
+ * \param inputsStride - distance between consecutive inputs of one sample
+ * \param bufferStride - distance between consecutive inputs in the quantised buffer
+ * \param samples - number of samples
+ */
+static inline void QuantiseInputsQ8(const NeuralNet* model, NContext* context, const float* inputs,
+									uint32_t inputsStride, uint32_t bufferStride, uint32_t samples)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t extLinksBegin = valueAt(0, model->extLinks, offsetTypeSize);
+	uint8_t* buffer = context->quantisedInputs.u8;
+
+	if (model->weightDim - extLinksBegin >= model->inputsDim)
+	{
+		if (bufferStride == 1)
+		{
+			for (uint16_t input = 0; input < model->inputsDim; ++input)
+				buffer[input] = quantiseInputQ8(inputs[(size_t) input * inputsStride]);
+			return;
+		}
+
+		for (uint16_t input = 0; input < model->inputsDim; ++input)
+			for (uint32_t s = 0; s < samples; ++s)
+				buffer[input * bufferStride + s] = quantiseInputQ8(inputs[(size_t) input * inputsStride + s]);
+	}
+	else
+	{
+		for (uint32_t idx = extLinksBegin; idx < model->weightDim; ++idx)
+		{
+			const uint16_t input = model->links[idx];
+
+			for (uint32_t s = 0; s < samples; ++s)
+				buffer[input * bufferStride + s] = quantiseInputQ8(inputs[(size_t) input * inputsStride + s]);
+		}
+	}
+}
+
+
+/**
+ * \brief Normalise and quantise sample into context->quantisedInputs in a single pass
+ * \details Inputs are selected the same way as by @QuantiseInputsQ8
+ * \param model - model of neural network
+ * \param context - inference context
+ * \param sample - raw input values, the last one is bias and is not normalised
+ * \param limitStep - 0 if all inputs share one min/max pair, 1 otherwise
+ */
+static inline void PrepareSampleQ8(const NeuralNet* model, NContext* context, const float* sample,
+								   uint16_t limitStep)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t extLinksBegin = valueAt(0, model->extLinks, offsetTypeSize);
+	const uint16_t bias = model->inputsDim - 1;
+	uint8_t* buffer = context->quantisedInputs.u8;
+
+	if (model->weightDim - extLinksBegin >= model->inputsDim)
+	{
+		for (uint16_t input = 0; input < bias; ++input)
+			buffer[input] = quantiseScaledInputQ8(scaleInput(model, sample[input], input * limitStep, 256.0f));
+
+		buffer[bias] = quantiseInputQ8(sample[bias]);
+	}
+	else
+	{
+		for (uint32_t idx = extLinksBegin; idx < model->weightDim; ++idx)
+		{
+			const uint16_t input = model->links[idx];
+
+			buffer[input] = (input < bias)
+					? quantiseScaledInputQ8(scaleInput(model, sample[input], input * limitStep, 256.0f))
+					: quantiseInputQ8(sample[input]);
+		}
+	}
+}
+
+
+/**
+ * \brief Normalise and quantise dataset rows into context->quantisedInputs, NEUTON_BATCH_SIZE apart
+ * \details Inputs are selected the same way as by @QuantiseInputsQ8, bias is 1.0 for every row
+ * \param rows - raw input values except bias, row s starts at rows + s * rowSize
+ * \param rowSize - distance between rows in bytes
+ * \param samples - number of rows, up to NEUTON_BATCH_SIZE
+ * \param limitStep - 0 if all inputs share one min/max pair, 1 otherwise
+ */
+static inline void PrepareRowsQ8(const NeuralNet* model, NContext* context, const uint8_t* rows, uint32_t rowSize,
+								 uint32_t samples, uint16_t limitStep)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t extLinksBegin = valueAt(0, model->extLinks, offsetTypeSize);
+	const uint16_t bias = model->inputsDim - 1;
+	uint8_t* buffer = context->quantisedInputs.u8;
+
+	if (model->weightDim - extLinksBegin >= model->inputsDim)
+	{
+		for (uint32_t s = 0; s < samples; ++s)
+		{
+			const uint8_t* row = rows + (size_t) s * rowSize;
+
+			for (uint16_t input = 0; input < bias; ++input)
+				buffer[input * NEUTON_BATCH_SIZE + s] =
+						quantiseScaledInputQ8(scaleInput(model, rowValue(row, input), input * limitStep, 256.0f));
+
+			buffer[bias * NEUTON_BATCH_SIZE + s] = quantiseInputQ8(1.0f);
+		}
+	}
+	else
+	{
+		for (uint32_t idx = extLinksBegin; idx < model->weightDim; ++idx)
+		{
+			const uint16_t input = model->links[idx];
+
+			for (uint32_t s = 0; s < samples; ++s)
+				buffer[input * NEUTON_BATCH_SIZE + s] = (input < bias)
+						? quantiseScaledInputQ8(scaleInput(model, rowValue(rows + (size_t) s * rowSize, input),
+															input * limitStep, 256.0f))
+						: quantiseInputQ8(1.0f);
+		}
+	}
+}
+
+
+static inline uint8_t quantiseRawInputQ8(const NRawInput* raw, int16_t count)
+{
+	// count * multiplier >> 16 from two 16 x 16 bit products, it does not overflow 32 bits
+	const int32_t high = (int32_t) count * (int16_t) (raw->multiplier >> 16);
+	const int32_t low  = ((int32_t) count * (int32_t) (uint16_t) raw->multiplier) >> 16;
+	const int32_t value = high + low + raw->offset;
+
+	return value > 0 ? ((value >> raw->shift) > UINT8_MAX ? UINT8_MAX : (value >> raw->shift)) : 0;
+}
+
+
+static inline int16_t rawCount(const NRawView* view, uint16_t input)
+{
+	return input < view->firstCount ? view->first[input] : view->second[input - view->firstCount];
+}
+
+
+/**
+ * \brief Convert raw counts into context->quantisedInputs, see @NSetRawInputs
+ * \details Inputs are selected the same way as by @QuantiseInputsQ8. Conversions are indexed
+ *          by input or, if only the inputs of external links are converted, by external link
+ * \param model - model of neural network
+ * \param context - inference context
+ * \param view - raw counts of the inputs except bias
+ */
+static inline void QuantiseRawInputsQ8(const NeuralNet* model, NContext* context, const NRawView* view)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t extLinksBegin = valueAt(0, model->extLinks, offsetTypeSize);
+	const uint16_t bias = model->inputsDim - 1;
+	const NRawInput* raw = model->rawInputs;
+	uint8_t* buffer = context->quantisedInputs.u8;
+
+	if (model->weightDim - extLinksBegin >= model->inputsDim)
+	{
+		const uint16_t firstCount = view->firstCount < bias ? view->firstCount : bias;
+
+		for (uint16_t input = 0; input < firstCount; ++input)
+			buffer[input] = quantiseRawInputQ8(&raw[input], view->first[input]);
+
+		for (uint16_t input = firstCount; input < bias; ++input)
+			buffer[input] = quantiseRawInputQ8(&raw[input], view->second[input - firstCount]);
+
+		buffer[bias] = quantiseRawInputQ8(&raw[bias], 0);
+	}
+	else
+	{
+		for (uint32_t idx = extLinksBegin; idx < model->weightDim; ++idx)
+		{
+			const uint16_t input = model->links[idx];
+
+			buffer[input] = quantiseRawInputQ8(&raw[idx - extLinksBegin], input < bias ? rawCount(view, input) : 0);
+		}
+	}
+}
+
+
+static inline uint8_t ActivationQ8Integer(const NeuralNet* model, uint32_t neuronIndex, int32_t summ)
+{
+	return accurate_fast_sigmoid_u8(
+		-(((int32_t) model->fncCoeffs.u8[neuronIndex] * summ) >> (8 + KSHIFT_2 - 1))
+	);
+}
+
+
+static inline uint8_t ActivationQ8Float(const NeuralNet* model, uint32_t neuronIndex, int32_t summ)
+{
+	const float qs = (float) (((int32_t) model->fncCoeffs.u8[neuronIndex] * summ)
+			>> (8 + KSHIFT_2 - 1)) / (float) (2u << 7);
+	const float tmpValue = 1.0f / (1.0f + expf(-qs));
+	return ldexp(tmpValue > MAX_INPUT_FLOAT ? MAX_INPUT_FLOAT : tmpValue, 8);
+}
+
+
+static inline uint8_t ActivationQ8(const NeuralNet* model, uint32_t neuronIndex, int32_t summ)
+{
+	if (model->options & BIT_FORCE_INTEGER_CALCULATIONS)
+		return ActivationQ8Integer(model, neuronIndex, summ);
+	else
+		return ActivationQ8Float(model, neuronIndex, summ);
+}
+
+
+DEFINE_INFERENCE_Q(8, int32_t, u8, Integer)
+DEFINE_INFERENCE_Q(8, int32_t, u8, Float)
+DEFINE_INFERENCE_Q(8, int32_t, u16, Integer)
+DEFINE_INFERENCE_Q(8, int32_t, u16, Float)
+DEFINE_INFERENCE_Q(8, int32_t, u32, Integer)
+DEFINE_INFERENCE_Q(8, int32_t, u32, Float)
+
+
+/**
+ * \brief Evaluate the samples quantised into context->quantisedInputs, NEUTON_BATCH_SIZE apart
+ * \param samples - number of samples, up to NEUTON_BATCH_SIZE
+ * \param outputs - buffer for output values, sample s results start at outputs[s * model->outputsDim]
+ */
+static inline void EvaluateBatchQ8(const NeuralNet* model, NContext* context, uint32_t samples, float* outputs)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	uint8_t* accumulators = context->accumulators.u8;
+	uint32_t offset;
+
+	memset(accumulators, 0, model->accumulatorsCount * NEUTON_BATCH_SIZE * sizeof(*accumulators));
+
+	for (uint32_t step = 0; step < model->executionCount; step++)
+	{
+		const uint32_t neuronIndex = model->executionList ? model->executionList[step] : step;
+
+		int32_t summ[NEUTON_BATCH_SIZE] = { 0 };
+
+		offset = valueAt(neuronIndex, model->intLinks, offsetTypeSize);
+		for (uint16_t idx = 0; idx < model->intLinksCounters[neuronIndex]; ++idx)
+		{
+			const int32_t firstValue = (int32_t) model->weights.i8[offset+idx];
+			const uint8_t* secondValues = accumulators + model->links[offset+idx] * NEUTON_BATCH_SIZE;
+
+			for (uint32_t s = 0; s < samples; ++s)
+				summ[s] += firstValue * (int32_t) secondValues[s];
+		}
+
+		offset = valueAt(neuronIndex, model->extLinks, offsetTypeSize);
+		for (uint16_t idx = 0; idx < model->extLinksCounters[neuronIndex]; ++idx)
+		{
+			const int32_t firstValue = (int32_t) model->weights.i8[offset+idx];
+			const uint8_t* secondValues = context->quantisedInputs.u8 + model->links[offset+idx] * NEUTON_BATCH_SIZE;
+
+			for (uint32_t s = 0; s < samples; ++s)
+				summ[s] += firstValue * (int32_t) secondValues[s];
+		}
+
+		uint8_t* values = accumulators + AccumulatorSlot(model, neuronIndex) * NEUTON_BATCH_SIZE;
+		for (uint32_t s = 0; s < samples; ++s)
+			values[s] = ActivationQ8(model, neuronIndex, summ[s]);
+	}
+
+	for (uint32_t s = 0; s < samples; ++s, outputs += model->outputsDim)
+		for (uint16_t idx = 0; idx < model->outputsDim; idx++)
+			outputs[idx] = dequantiseValue(accumulators[
+					AccumulatorSlot(model, model->outputLabels[idx]) * NEUTON_BATCH_SIZE + s], model);
+}
+
+
+static inline void RunInferenceBatchQ8(const NeuralNet* model, NContext* context, const float* inputs,
+										uint32_t count, float* outputs)
+{
+	for (uint32_t first = 0; first < count; first += NEUTON_BATCH_SIZE)
+	{
+		const uint32_t samples = (count - first) < NEUTON_BATCH_SIZE ? (count - first) : NEUTON_BATCH_SIZE;
+
+		QuantiseInputsQ8(model, context, inputs + first, count, NEUTON_BATCH_SIZE, samples);
+		EvaluateBatchQ8(model, context, samples, outputs + (size_t) first * model->outputsDim);
+	}
+}
+
+
+#if (NEUTON_Q16_SUPPORT == 1)
+static inline uint16_t quantiseInputQ16(float value)
+{
+	return value > 0.0f ? (value > MAX_INPUT_FLOAT ? MAX_INPUT_FLOAT : value) * 65536.0f : 0;
+}
+
+
+static inline uint16_t quantiseScaledInputQ16(float value)
+{
+	return value > 0.0f ? (value > MAX_INPUT_FLOAT * 65536.0f ? MAX_INPUT_FLOAT * 65536.0f : value) : 0;
+}
+
+
+/**
+ * \brief Quantise model inputs into context->quantisedInputs, see @QuantiseInputsQ8
+ */
+static inline void QuantiseInputsQ16(const NeuralNet* model, NContext* context, const float* inputs,
+									 uint32_t inputsStride, uint32_t bufferStride, uint32_t samples)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t extLinksBegin = valueAt(0, model->extLinks, offsetTypeSize);
+	uint16_t* buffer = context->quantisedInputs.u16;
+
+	if (model->weightDim - extLinksBegin >= model->inputsDim)
+	{
+		if (bufferStride == 1)
 		{
-			result[i] = result[i] * (model->outputsMax[i] - model->outputsMin[i]) +
-					model->outputsMin[i];
+			for (uint16_t input = 0; input < model->inputsDim; ++input)
+				buffer[input] = quantiseInputQ16(inputs[(size_t) input * inputsStride]);
+			return;
+		}
+
+		for (uint16_t input = 0; input < model->inputsDim; ++input)
+			for (uint32_t s = 0; s < samples; ++s)
+				buffer[input * bufferStride + s] = quantiseInputQ16(inputs[(size_t) input * inputsStride + s]);
+	}
+	else
+	{
+		for (uint32_t idx = extLinksBegin; idx < model->weightDim; ++idx)
+		{
+			const uint16_t input = model->links[idx];
+
+			for (uint32_t s = 0; s < samples; ++s)
+				buffer[input * bufferStride + s] = quantiseInputQ16(inputs[(size_t) input * inputsStride + s]);
+		}
+	}
+}
+
+
+/**
+ * \brief Normalise and quantise sample into context->quantisedInputs, see @PrepareSampleQ8
+ */
+static inline void PrepareSampleQ16(const NeuralNet* model, NContext* context, const float* sample,
+									uint16_t limitStep)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t extLinksBegin = valueAt(0, model->extLinks, offsetTypeSize);
+	const uint16_t bias = model->inputsDim - 1;
+	uint16_t* buffer = context->quantisedInputs.u16;
+
+	if (model->weightDim - extLinksBegin >= model->inputsDim)
+	{
+		for (uint16_t input = 0; input < bias; ++input)
+			buffer[input] = quantiseScaledInputQ16(scaleInput(model, sample[input], input * limitStep, 65536.0f));
+
+		buffer[bias] = quantiseInputQ16(sample[bias]);
+	}
+	else
+	{
+		for (uint32_t idx = extLinksBegin; idx < model->weightDim; ++idx)
+		{
+			const uint16_t input = model->links[idx];
+
+			buffer[input] = (input < bias)
+					? quantiseScaledInputQ16(scaleInput(model, sample[input], input * limitStep, 65536.0f))
+					: quantiseInputQ16(sample[input]);
+		}
+	}
+}
+
+
+/**
+ * \brief Normalise and quantise dataset rows into context->quantisedInputs, see @PrepareRowsQ8
+ */
+static inline void PrepareRowsQ16(const NeuralNet* model, NContext* context, const uint8_t* rows,
+								  uint32_t rowSize, uint32_t samples, uint16_t limitStep)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t extLinksBegin = valueAt(0, model->extLinks, offsetTypeSize);
+	const uint16_t bias = model->inputsDim - 1;
+	uint16_t* buffer = context->quantisedInputs.u16;
+
+	if (model->weightDim - extLinksBegin >= model->inputsDim)
+	{
+		for (uint32_t s = 0; s < samples; ++s)
+		{
+			const uint8_t* row = rows + (size_t) s * rowSize;
+
+			for (uint16_t input = 0; input < bias; ++input)
+				buffer[input * NEUTON_BATCH_SIZE + s] =
+						quantiseScaledInputQ16(scaleInput(model, rowValue(row, input), input * limitStep, 65536.0f));
+
+			buffer[bias * NEUTON_BATCH_SIZE + s] = quantiseInputQ16(1.0f);
+		}
+	}
+	else
+	{
+		for (uint32_t idx = extLinksBegin; idx < model->weightDim; ++idx)
+		{
+			const uint16_t input = model->links[idx];
+
+			for (uint32_t s = 0; s < samples; ++s)
+				buffer[input * NEUTON_BATCH_SIZE + s] = (input < bias)
+						? quantiseScaledInputQ16(scaleInput(model, rowValue(rows + (size_t) s * rowSize, input),
+															 input * limitStep, 65536.0f))
+						: quantiseInputQ16(1.0f);
+		}
+	}
+}
+
+
+static inline uint16_t ActivationQ16Integer(const NeuralNet* model, uint32_t neuronIndex, int64_t summ)
+{
+	return accurate_fast_sigmoid_u16(
+		-(((int64_t) model->fncCoeffs.u16[neuronIndex] * summ) >> (16 + KSHIFT_10 - 1))
+	);
+}
+
+
+static inline uint16_t ActivationQ16Float(const NeuralNet* model, uint32_t neuronIndex, int64_t summ)
+{
+	const float qs = (float) (((int64_t) model->fncCoeffs.u16[neuronIndex] * summ)
+			>> (16 + KSHIFT_10 - 1)) / (float) (2u << 15);
+	const float tmpValue = 1.0f / (1.0f + expf(-qs));
+	return ldexp(tmpValue > MAX_INPUT_FLOAT ? MAX_INPUT_FLOAT : tmpValue, 16);
+}
+
+
+static inline uint16_t ActivationQ16(const NeuralNet* model, uint32_t neuronIndex, int64_t summ)
+{
+	if (model->options & BIT_FORCE_INTEGER_CALCULATIONS)
+		return ActivationQ16Integer(model, neuronIndex, summ);
+	else
+		return ActivationQ16Float(model, neuronIndex, summ);
+}
+
+
+DEFINE_INFERENCE_Q(16, int64_t, u8, Integer)
+DEFINE_INFERENCE_Q(16, int64_t, u8, Float)
+DEFINE_INFERENCE_Q(16, int64_t, u16, Integer)
+DEFINE_INFERENCE_Q(16, int64_t, u16, Float)
+DEFINE_INFERENCE_Q(16, int64_t, u32, Integer)
+DEFINE_INFERENCE_Q(16, int64_t, u32, Float)
+
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+DEFINE_INFERENCE_RECORDS_Q(16, int64_t, Integer)
+DEFINE_INFERENCE_RECORDS_Q(16, int64_t, Float)
+#endif
+
+
+/**
+ * \brief Evaluate the samples quantised into context->quantisedInputs, NEUTON_BATCH_SIZE apart
+ * \param samples - number of samples, up to NEUTON_BATCH_SIZE
+ * \param outputs - buffer for output values, sample s results start at outputs[s * model->outputsDim]
+ */
+static inline void EvaluateBatchQ16(const NeuralNet* model, NContext* context, uint32_t samples, float* outputs)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	uint16_t* accumulators = context->accumulators.u16;
+	uint32_t offset;
+
+	memset(accumulators, 0, model->accumulatorsCount * NEUTON_BATCH_SIZE * sizeof(*accumulators));
+
+	for (uint32_t step = 0; step < model->executionCount; step++)
+	{
+		const uint32_t neuronIndex = model->executionList ? model->executionList[step] : step;
+
+		int64_t summ[NEUTON_BATCH_SIZE] = { 0 };
+
+		offset = valueAt(neuronIndex, model->intLinks, offsetTypeSize);
+		for (uint16_t idx = 0; idx < model->intLinksCounters[neuronIndex]; ++idx)
+		{
+			const int64_t firstValue = (int64_t) model->weights.i16[offset+idx];
+			const uint16_t* secondValues = accumulators + model->links[offset+idx] * NEUTON_BATCH_SIZE;
+
+			for (uint32_t s = 0; s < samples; ++s)
+				summ[s] += firstValue * (int64_t) secondValues[s];
+		}
+
+		offset = valueAt(neuronIndex, model->extLinks, offsetTypeSize);
+		for (uint16_t idx = 0; idx < model->extLinksCounters[neuronIndex]; ++idx)
+		{
+			const int64_t firstValue = (int64_t) model->weights.i16[offset+idx];
+			const uint16_t* secondValues =
+					context->quantisedInputs.u16 + model->links[offset+idx] * NEUTON_BATCH_SIZE;
+
+			for (uint32_t s = 0; s < samples; ++s)
+				summ[s] += firstValue * (int64_t) secondValues[s];
+		}
+
+		uint16_t* values = accumulators + AccumulatorSlot(model, neuronIndex) * NEUTON_BATCH_SIZE;
+		for (uint32_t s = 0; s < samples; ++s)
+			values[s] = ActivationQ16(model, neuronIndex, summ[s]);
+	}
+
+	for (uint32_t s = 0; s < samples; ++s, outputs += model->outputsDim)
+		for (uint16_t idx = 0; idx < model->outputsDim; idx++)
+			outputs[idx] = dequantiseValue(accumulators[
+					AccumulatorSlot(model, model->outputLabels[idx]) * NEUTON_BATCH_SIZE + s], model);
+}
+
+
+static inline void RunInferenceBatchQ16(const NeuralNet* model, NContext* context, const float* inputs,
+										uint32_t count, float* outputs)
+{
+	for (uint32_t first = 0; first < count; first += NEUTON_BATCH_SIZE)
+	{
+		const uint32_t samples = (count - first) < NEUTON_BATCH_SIZE ? (count - first) : NEUTON_BATCH_SIZE;
+
+		QuantiseInputsQ16(model, context, inputs + first, count, NEUTON_BATCH_SIZE, samples);
+		EvaluateBatchQ16(model, context, samples, outputs + (size_t) first * model->outputsDim);
+	}
+}
+#endif
+
+
+#if (NEUTON_Q32_SUPPORT == 1)
+/**
+ * \brief Normalise and clamp sample values into buffer, see @PrepareSampleQ8
+ * \param buffer - normalised values (size model->inputsDim), may be the sample itself
+ */
+static inline void PrepareSampleF32(const NeuralNet* model, const float* sample, float* buffer,
+									uint16_t limitStep)
+{
+	const uint16_t bias = model->inputsDim - 1;
+
+	for (uint16_t input = 0; input < bias; ++input)
+	{
+		const float value = scaleInput(model, sample[input], input * limitStep, 1.0f);
+
+		buffer[input] = value > 1.0f ? 1.0f : value < 0.0f ? 0.0f : value;
+	}
+
+	buffer[bias] = sample[bias];
+}
+
+
+DEFINE_INFERENCE_F32(u8)
+DEFINE_INFERENCE_F32(u16)
+DEFINE_INFERENCE_F32(u32)
+
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+DEFINE_INFERENCE_RECORDS_F32()
+#endif
+
+
+/**
+ * \brief Normalise dataset rows into buffer, NEUTON_BATCH_SIZE apart, see @PrepareRowsQ8
+ */
+static inline void PrepareRowsF32(const NeuralNet* model, float* buffer, const uint8_t* rows, uint32_t rowSize,
+								  uint32_t samples, uint16_t limitStep)
+{
+	const uint16_t bias = model->inputsDim - 1;
+
+	for (uint32_t s = 0; s < samples; ++s)
+	{
+		const uint8_t* row = rows + (size_t) s * rowSize;
+
+		for (uint16_t input = 0; input < bias; ++input)
+		{
+			const float value = scaleInput(model, rowValue(row, input), input * limitStep, 1.0f);
+
+			buffer[input * NEUTON_BATCH_SIZE + s] = value > 1.0f ? 1.0f : value < 0.0f ? 0.0f : value;
+		}
+
+		buffer[bias * NEUTON_BATCH_SIZE + s] = 1.0f;
+	}
+}
+
+
+/**
+ * \brief Normalise a value of a dataset row the same way as @PrepareSampleF32
+ */
+static inline float rowInputF32(const NeuralNet* model, const uint8_t* row, uint16_t input, uint16_t limitStep)
+{
+	if (input == model->inputsDim - 1)
+		return 1.0f;
+
+	const float value = scaleInput(model, rowValue(row, input), input * limitStep, 1.0f);
+
+	return value > 1.0f ? 1.0f : value < 0.0f ? 0.0f : value;
+}
+
+
+/**
+ * \brief Evaluate up to NEUTON_BATCH_SIZE samples of a 32 bit model
+ * \details Inputs are read either from the normalised inputs or, if rows is not NULL, from
+ *          dataset rows normalised on the fly, see @PrepareRowsQ8
+ * \param inputs - normalised inputs, value of input i for sample s is inputs[i * inputsStride + s]
+ * \param rows - raw input values except bias, row s starts at rows + s * rowSize
+ * \param samples - number of samples, up to NEUTON_BATCH_SIZE
+ * \param outputs - buffer for output values, sample s results start at outputs[s * model->outputsDim]
+ */
+static inline void EvaluateBatchF32(const NeuralNet* model, NContext* context, const float* inputs,
+									uint32_t inputsStride, const uint8_t* rows, uint32_t rowSize,
+									uint32_t samples, float* outputs)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint16_t limitStep = (model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? 0 : 1;
+	float* accumulators = context->accumulators.f32;
+	uint32_t offset;
+
+	memset(accumulators, 0, model->accumulatorsCount * NEUTON_BATCH_SIZE * sizeof(*accumulators));
+
+	for (uint32_t step = 0; step < model->executionCount; step++)
+	{
+		const uint32_t neuronIndex = model->executionList ? model->executionList[step] : step;
+
+		double summ[NEUTON_BATCH_SIZE] = { 0 };
+
+		offset = valueAt(neuronIndex, model->intLinks, offsetTypeSize);
+		for (uint16_t idx = 0; idx < model->intLinksCounters[neuronIndex]; ++idx)
+		{
+			const double firstValue = (double) model->weights.f32[offset+idx];
+			const float* secondValues = accumulators + model->links[offset+idx] * NEUTON_BATCH_SIZE;
+
+			for (uint32_t s = 0; s < samples; ++s)
+				summ[s] += firstValue * (double) secondValues[s];
+		}
+
+		offset = valueAt(neuronIndex, model->extLinks, offsetTypeSize);
+		for (uint16_t idx = 0; idx < model->extLinksCounters[neuronIndex]; ++idx)
+		{
+			const double firstValue = (double) model->weights.f32[offset+idx];
+			const uint16_t input = model->links[offset+idx];
+
+			if (rows)
+			{
+				for (uint32_t s = 0; s < samples; ++s)
+					summ[s] += firstValue *
+							(double) rowInputF32(model, rows + (size_t) s * rowSize, input, limitStep);
+			}
+			else
+			{
+				const float* secondValues = inputs + (size_t) input * inputsStride;
+
+				for (uint32_t s = 0; s < samples; ++s)
+					summ[s] += firstValue * (double) secondValues[s];
+			}
+		}
+
+		float* values = accumulators + AccumulatorSlot(model, neuronIndex) * NEUTON_BATCH_SIZE;
+		for (uint32_t s = 0; s < samples; ++s)
+			values[s] = 1.0f / (1.0f + exp((double) ((double) -model->fncCoeffs.f32[neuronIndex]) * summ[s]));
+	}
+
+	for (uint32_t s = 0; s < samples; ++s, outputs += model->outputsDim)
+		for (uint16_t idx = 0; idx < model->outputsDim; idx++)
+			outputs[idx] = accumulators[AccumulatorSlot(model, model->outputLabels[idx]) * NEUTON_BATCH_SIZE + s];
+}
+
+
+static inline void RunInferenceBatchF32(const NeuralNet* model, NContext* context, const float* inputs,
+										uint32_t count, float* outputs)
+{
+	for (uint32_t first = 0; first < count; first += NEUTON_BATCH_SIZE)
+	{
+		const uint32_t samples = (count - first) < NEUTON_BATCH_SIZE ? (count - first) : NEUTON_BATCH_SIZE;
+
+		EvaluateBatchF32(model, context, inputs + first, count, NULL, 0, samples,
+						 outputs + (size_t) first * model->outputsDim);
+	}
+}
+#endif
+
+
+static InferenceKernel SelectInference(const NeuralNet* model, uint8_t offsetTypeSize)
+{
+	const uint8_t integer = (model->options & BIT_FORCE_INTEGER_CALCULATIONS) > 0;
+
+#if (NEUTON_INTERLEAVED_LINKS == 1)
+	if (model->linkRecords.raw)
+	{
+		switch (model->quantisation)
+		{
+#if (NEUTON_Q16_SUPPORT == 1)
+		case 16: return integer ? RunInferenceRecordsQ16_Integer : RunInferenceRecordsQ16_Float;
+#endif
+
+#if (NEUTON_Q32_SUPPORT == 1)
+		case 32: return RunInferenceRecordsF32;
+#endif
+
+		default: return NULL;
+		}
+	}
+#endif
+
+	switch (model->quantisation)
+	{
+	case 8:
+		switch (offsetTypeSize)
+		{
+		case 1:  return integer ? RunInferenceQ8_u8_Integer  : RunInferenceQ8_u8_Float;
+		case 2:  return integer ? RunInferenceQ8_u16_Integer : RunInferenceQ8_u16_Float;
+		case 4:  return integer ? RunInferenceQ8_u32_Integer : RunInferenceQ8_u32_Float;
+		default: return NULL;
+		}
+
+#if (NEUTON_Q16_SUPPORT == 1)
+	case 16:
+		switch (offsetTypeSize)
+		{
+		case 1:  return integer ? RunInferenceQ16_u8_Integer  : RunInferenceQ16_u8_Float;
+		case 2:  return integer ? RunInferenceQ16_u16_Integer : RunInferenceQ16_u16_Float;
+		case 4:  return integer ? RunInferenceQ16_u32_Integer : RunInferenceQ16_u32_Float;
+		default: return NULL;
+		}
+#endif
+
+#if (NEUTON_Q32_SUPPORT == 1)
+	case 32:
+		switch (offsetTypeSize)
+		{
+		case 1:  return RunInferenceF32_u8;
+		case 2:  return RunInferenceF32_u16;
+		case 4:  return RunInferenceF32_u32;
+		default: return NULL;
+		}
+#endif
+
+	default: return NULL;
+	}
+}
+
+
+/**
+ * \brief Evaluate one neuron, the same way as the sequential kernels do
+ * \details Used where neurons are not evaluated in one pass of the execution list:
+ *          by the threads of the level schedule and by the time-sliced inference
+ * \param model - loaded model
+ * \param context - context with the quantised inputs and the accumulators
+ * \param inputs - normalised inputs of 32 bit models
+ * \param neuronIndex - neuron to evaluate
+ * \param offsetTypeSize - size of the int/ext links offsets
+ */
+static inline void EvaluateNeuron(const NeuralNet* model, NContext* context, const float* inputs,
+								  uint32_t neuronIndex, uint8_t offsetTypeSize)
+{
+	const uint32_t intOffset = valueAt(neuronIndex, model->intLinks, offsetTypeSize);
+	const uint32_t extOffset = valueAt(neuronIndex, model->extLinks, offsetTypeSize);
+	const uint32_t slot = AccumulatorSlot(model, neuronIndex);
+	(void) inputs;
+
+	switch (model->quantisation)
+	{
+	case 8:
+	{
+		int32_t summ = DotQ8(model->weights.i8 + intOffset, model->links + intOffset,
+							 context->accumulators.u8, model->intLinksCounters[neuronIndex]);
+		summ += DotQ8(model->weights.i8 + extOffset, model->links + extOffset,
+					  context->quantisedInputs.u8, model->extLinksCounters[neuronIndex]);
+
+		context->accumulators.u8[slot] = ActivationQ8(model, neuronIndex, summ);
+		break;
+	}
+
+#if (NEUTON_Q16_SUPPORT == 1)
+	case 16:
+	{
+		int64_t summ = DotQ16(model->weights.i16 + intOffset, model->links + intOffset,
+							  context->accumulators.u16, model->intLinksCounters[neuronIndex]);
+		summ += DotQ16(model->weights.i16 + extOffset, model->links + extOffset,
+					   context->quantisedInputs.u16, model->extLinksCounters[neuronIndex]);
+
+		context->accumulators.u16[slot] = ActivationQ16(model, neuronIndex, summ);
+		break;
+	}
+#endif
+
+#if (NEUTON_Q32_SUPPORT == 1)
+	case 32:
+	{
+		double summ = DotF32(model->weights.f32 + intOffset, model->links + intOffset,
+							 context->accumulators.f32, model->intLinksCounters[neuronIndex]);
+		summ += DotF32(model->weights.f32 + extOffset, model->links + extOffset,
+					   inputs, model->extLinksCounters[neuronIndex]);
+
+		context->accumulators.f32[slot] =
+				1.0f / (1.0f + exp((double) ((double) -model->fncCoeffs.f32[neuronIndex]) * summ));
+		break;
+	}
+#endif
+
+	default: break;
+	}
+}
+
+
+/**
+ * \brief Read the outputs from the accumulators into the output buffer
+ * \return output buffer of the context
+ */
+static float* CollectOutputs(const NeuralNet* model, NContext* context)
+{
+	for (uint16_t idx = 0; idx < model->outputsDim; idx++)
+	{
+		const uint32_t slot = AccumulatorSlot(model, model->outputLabels[idx]);
 
-			if (hasLogScale && (model->outputsLogOffset[i] != 0xFFFFFFFF))
-			{
-				result[i] = exp(result[i]) - model->outputsLogOffset[i];
-			}
+		switch (model->quantisation)
+		{
+		case 8:  context->outputBuffer[idx] = dequantiseValue(context->accumulators.u8[slot], model); break;
+		case 16: context->outputBuffer[idx] = dequantiseValue(context->accumulators.u16[slot], model); break;
+		default: context->outputBuffer[idx] = context->accumulators.f32[slot]; break;
 		}
 	}
+
+	return context->outputBuffer;
 }
 
 
-static inline uint32_t valueAt(uint32_t index, Pointer p, uint8_t typeSize)
+#if (NEUTON_THREADS == 1)
+/**
+ * \brief Level schedule of the parallel inference
+ */
+struct NParallel_
 {
-	switch (typeSize)
+	NScheduler*     scheduler;
+	InferenceKernel sequential;
+
+	/**
+	 * \brief Evaluated neurons sorted by level
+	 */
+	uint16_t*       order;
+
+	/**
+	 * \brief First item of every level in order and the end of the last one
+	 */
+	uint32_t*       bounds;
+	uint32_t        levels;
+};
+
+
+/**
+ * \brief Inference run by the threads of @NParallel_
+ */
+typedef struct ParallelJob_
+{
+	const NeuralNet* model;
+	NContext*        context;
+	const float*     inputs;
+
+} ParallelJob;
+
+
+/**
+ * \brief Sort evaluated neurons by level, a neuron level is one more than the highest
+ *        level of the previous neurons it reads and of the neurons reading it as a
+ *        following one
+ * \param model - loaded model
+ * \param parallel - schedule, order and bounds are allocated
+ * \return error code or 0 on success
+ */
+static Err BuildLevels(const NeuralNet* model, struct NParallel_* parallel)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+
+	uint16_t* level = NAlloc(model->neuronsCount, sizeof(uint16_t));
+	if (!level)
+		return ERR_MEMORY_ALLOCATION;
+
+	parallel->levels = 0;
+
+	for (uint32_t step = 0; step < model->executionCount; step++)
 	{
-	case sizeof(uint8_t):  return p.u8[index];
-	case sizeof(uint16_t): return p.u16[index];
-	case sizeof(uint32_t): return p.u32[index];
-	default:               return 0;
+		const uint32_t neuron = model->executionList ? model->executionList[step] : step;
+		const uint32_t offset = valueAt(neuron, model->intLinks, offsetTypeSize);
+		uint16_t neuronLevel = level[neuron];
+
+		for (uint32_t link = offset; link < offset + model->intLinksCounters[neuron]; link++)
+		{
+			const uint16_t source = model->links[link];
+			if (source < neuron && level[source] + 1 > neuronLevel)
+				neuronLevel = level[source] + 1;
+		}
+
+		// Following neurons are read as 0, so they are evaluated at the next levels
+		for (uint32_t link = offset; link < offset + model->intLinksCounters[neuron]; link++)
+		{
+			const uint16_t source = model->links[link];
+			if (source > neuron && source < model->neuronsCount && level[source] < neuronLevel + 1)
+				level[source] = neuronLevel + 1;
+		}
+
+		level[neuron] = neuronLevel;
+		if (neuronLevel >= parallel->levels)
+			parallel->levels = neuronLevel + 1u;
+	}
+
+	parallel->order  = NAlloc(model->executionCount, sizeof(*parallel->order));
+	parallel->bounds = NAlloc(parallel->levels + 1, sizeof(*parallel->bounds));
+	if (!parallel->order || !parallel->bounds)
+	{
+		NFree(level);
+		return ERR_MEMORY_ALLOCATION;
+	}
+
+	for (uint32_t step = 0; step < model->executionCount; step++)
+		parallel->bounds[level[model->executionList ? model->executionList[step] : step] + 1]++;
+
+	for (uint32_t idx = 1; idx <= parallel->levels; idx++)
+		parallel->bounds[idx] += parallel->bounds[idx - 1];
+
+	// Neurons keep the evaluation order within a level, bounds are moved one level up
+	for (uint32_t step = 0; step < model->executionCount; step++)
+	{
+		const uint32_t neuron = model->executionList ? model->executionList[step] : step;
+		parallel->order[parallel->bounds[level[neuron]]++] = neuron;
 	}
+
+	for (uint32_t idx = parallel->levels; idx > 0; idx--)
+		parallel->bounds[idx] = parallel->bounds[idx - 1];
+	parallel->bounds[0] = 0;
+
+	NFree(level);
+
+	return ERR_NO_ERROR;
 }
 
 
-static uint8_t accurate_fast_sigmoid_u8(int32_t arg)
+static void FreeParallel(NeuralNet* model)
 {
-	uint8_t qResult = 0;
-	uint8_t secondPointY = 0;
-	uint8_t firstPointY = 0;
+	struct NParallel_* parallel = model->parallel;
+	if (!parallel)
+		return;
+
+	NSchedulerDestroy(parallel->scheduler);
+
+	if (parallel->order)
+		NFree(parallel->order);
+	if (parallel->bounds)
+		NFree(parallel->bounds);
+
+	model->inference = parallel->sequential;
+	model->parallel  = NULL;
+
+	NFree(parallel);
+}
+
+
+/**
+ * \brief Evaluate neurons [begin, end) of the level schedule, see @NSchedulerTask
+ * \details Neurons are evaluated the same way as by the sequential kernels
+ */
+static void EvaluateNeurons(void* arg, uint32_t begin, uint32_t end)
+{
+	const ParallelJob* job = arg;
+	const struct NParallel_* parallel = job->model->parallel;
+	const uint8_t offsetTypeSize = job->model->offsetTypeSize;
+
+	for (uint32_t item = begin; item < end; item++)
+		EvaluateNeuron(job->model, job->context, job->inputs, parallel->order[item], offsetTypeSize);
+}
 
-	const uint8_t QLVL = 8;
-	const int32_t CT_MAX_VALUE = 1u << QLVL;
-	const int32_t intPart = abs(arg) / (2u << (QLVL - 1));
-	const int32_t realPart = abs(arg) - (intPart << QLVL);
 
-	if (intPart == 0 && realPart == 0)
+static float* RunInferenceParallel(const NeuralNet* model, NContext* context, const float* inputs)
+{
+	const struct NParallel_* parallel = model->parallel;
+	ParallelJob job = { model, context, inputs };
+
+	memset(context->accumulators.raw, 0, model->neuronsCount * (model->quantisation / 8));
+
+	if (NSchedulerRunLevels(parallel->scheduler, parallel->bounds, parallel->levels,
+							EvaluateNeurons, &job) != 0)
+		return parallel->sequential(model, context, inputs);
+
+	return CollectOutputs(model, context);
+}
+#endif // NEUTON_THREADS
+
+
+Err NSetThreads(NeuralNet* model, uint8_t threads)
+{
+	if (!model || !model->inference)
+		return ERR_BAD_ARGUMENT;
+
+#if (NEUTON_THREADS == 1)
+	FreeParallel(model);
+
+	// Neurons of one level can share an accumulator slot
+	if (threads <= 1 || model->executionCount < NEUTON_THREADS_MIN_NEURONS || model->accumulatorSlots)
+		return ERR_NO_ERROR;
+
+	struct NParallel_* parallel = NAlloc(1, sizeof(*parallel));
+	if (!parallel)
+		return ERR_MEMORY_ALLOCATION;
+
+	parallel->sequential = model->inference;
+	model->parallel = parallel;
+
+	Err err = BuildLevels(model, parallel);
+	if (err != ERR_NO_ERROR)
 	{
-		return ldexp(0.5, QLVL);
+		FreeParallel(model);
+		return err;
 	}
 
-	int s = arg > 0 ? 0 : 1;
-	if (realPart == 0)
+	// Levels narrower than the pool on average leave threads waiting at every level
+	if (model->executionCount / parallel->levels < threads)
 	{
-		for (int i = 0; i < QLVL; i++)
-		{
-			const uint8_t bit = ((i / intPart + s) % 2);
-			qResult = qResult | (bit << (QLVL - i - 1));
-		}
-		return qResult;
+		FreeParallel(model);
+		return ERR_NO_ERROR;
 	}
 
-	const int32_t secondPointX = intPart + 1;
-	if (intPart == 0)
+	parallel->scheduler = NSchedulerCreate(threads - 1);
+	if (!parallel->scheduler)
 	{
-		firstPointY = ldexp(0.5, QLVL);
-		for (int i = 0; i < QLVL; i++)
-		{
-			const uint8_t bit = ((i / secondPointX) % 2);
-			secondPointY = secondPointY | (bit << (QLVL - i - 1));
-		}
+		FreeParallel(model);
+		return ERR_MEMORY_ALLOCATION;
 	}
-	else
+
+	model->inference = RunInferenceParallel;
+
+	return ERR_NO_ERROR;
+#else
+	return threads <= 1 ? ERR_NO_ERROR : ERR_FEATURE_NOT_SUPPORTED;
+#endif
+}
+
+
+/**
+ * \brief Quantise inputs into the context and run kernel, see @NRunInference
+ */
+static inline float* RunInference(const NeuralNet* model, NContext* context, InferenceKernel inference,
+								  const float* inputs)
+{
+	switch (model->quantisation)
 	{
-		if (secondPointX == 0)
-		{
-			for (int i = 0; i < QLVL; i++)
-			{
-				const uint8_t bit = ((i / intPart) % 2);
-				firstPointY = firstPointY | (bit << (QLVL - i - 1));
-			}
-			secondPointY = ldexp(0.5, QLVL);
-		}
-		else
-		{
-			for (int i = 0; i < QLVL; i++)
-			{
-				uint8_t bit = ((i / intPart) % 2);
-				firstPointY = firstPointY | (bit << (QLVL - i - 1));
-				bit = ((i / secondPointX) % 2);
-				secondPointY = secondPointY | (bit << (QLVL - i - 1));
-			}
-		}
+	case 8:  QuantiseInputsQ8 (model, context, inputs, 1, 1, 1); break;
+
+#if (NEUTON_Q16_SUPPORT == 1)
+	case 16: QuantiseInputsQ16(model, context, inputs, 1, 1, 1); break;
+#endif
+
+#if (NEUTON_Q32_SUPPORT == 1)
+	case 32: break;
+#endif
+
+	default: return NULL;
 	}
 
-	const int32_t res = (CT_MAX_VALUE - realPart) * firstPointY + realPart * secondPointY;
-	if (arg > 0)
+	return inference(model, context, inputs);
+}
+
+
+/**
+ * \brief Normalise sample into buffer, see @NPrepareSample
+ * \param buffer - normalised values of 32 bit models
+ */
+static inline void PrepareSample(const float* sample, const NeuralNet* model, NContext* context, float* buffer)
+{
+	const uint16_t limitStep = (model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? 0 : 1;
+	(void) buffer;
+
+	switch (model->quantisation)
 	{
-		return res >> QLVL;
+	case 8:  PrepareSampleQ8 (model, context, sample, limitStep); break;
+
+#if (NEUTON_Q16_SUPPORT == 1)
+	case 16: PrepareSampleQ16(model, context, sample, limitStep); break;
+#endif
+
+#if (NEUTON_Q32_SUPPORT == 1)
+	case 32: PrepareSampleF32(model, sample, buffer, limitStep); break;
+#endif
+
+	default: break;
 	}
-	else
+}
+
+
+/**
+ * \brief Get kernel that can run concurrently with other contexts
+ */
+static inline InferenceKernel ContextInference(const NeuralNet* model)
+{
+#if (NEUTON_THREADS == 1)
+	if (model->parallel)
+		return model->parallel->sequential;
+#endif
+
+	return model->inference;
+}
+
+
+float* NRunInference(NeuralNet* model, float* inputs)
+{
+	return RunInference(model, &model->context, model->inference, inputs);
+}
+
+
+void NPrepareSample(float* sample, NeuralNet* model)
+{
+	PrepareSample(sample, model, &model->context, sample);
+}
+
+
+float* NRunPreparedInference(NeuralNet* model, float* sample)
+{
+	return model->inference ? model->inference(model, &model->context, sample) : NULL;
+}
+
+
+Err NCreateContext(const NeuralNet* model, NContext* context)
+{
+	if (!model || !context || !model->inference)
+		return ERR_BAD_ARGUMENT;
+
+	const uint8_t valueTypeSize = model->quantisation / 8;
+	const uint8_t memAlign = pointerTypeSize;
+	uint32_t blockSize = 0;
+
+	blockSize +=
+		model->outputsDim * sizeof(float);                // output buffer
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		model->accumulatorsCount * valueTypeSize * NEUTON_BATCH_SIZE; // accumulators
+
+	blockSize +=
+		AlignBy(memAlign, blockSize) +
+		model->inputsDim * valueTypeSize * NEUTON_BATCH_SIZE; // quantised or normalised inputs
+
+#if (NEUTON_SIMD == 1)
+	blockSize += NEUTON_SIMD_PADDING;                     // vector gathers overrun
+#endif
+
+	uint8_t* block = context->memoryBlock = NAlloc(1, blockSize);
+	if (!block)
+		return ERR_MEMORY_ALLOCATION;
+
+	context->outputBuffer = (void*) block; block += sizeof(float) * model->outputsDim;
+
+	block += AlignBy(memAlign, (size_t) block);
+	context->accumulators.raw = (void*) block; block += valueTypeSize * model->accumulatorsCount * NEUTON_BATCH_SIZE;
+
+	block += AlignBy(memAlign, (size_t) block);
+	context->quantisedInputs.raw = (void*) block;
+
+	return ERR_NO_ERROR;
+}
+
+
+void NFreeContext(NContext* context)
+{
+	if (context)
 	{
-		qResult = res >> QLVL;
-		return qResult == 0 ? CT_MAX_VALUE - 1 : CT_MAX_VALUE - qResult;
+		if (context->memoryBlock)
+			NFree(context->memoryBlock);
+
+		memset(context, 0, sizeof(*context));
 	}
 }
 
-#if (NEUTON_Q16_SUPPORT == 1)
-static uint16_t accurate_fast_sigmoid_u16(int64_t arg)
+
+float* NRunInferenceContext(const NeuralNet* model, NContext* context, const float* inputs)
 {
-	uint16_t qResult = 0;
-	uint16_t secondPointY = 0;
-	uint16_t firstPointY = 0;
+	return RunInference(model, context, ContextInference(model), inputs);
+}
 
-	const uint8_t QLVL = 16;
-	const int64_t CT_MAX_VALUE = 1ul << QLVL;
-	const int64_t intPart = labs(arg) / (2ul << (QLVL - 1));
-	const int64_t realPart = labs(arg) - (intPart << QLVL);
 
-	if (intPart == 0 && realPart == 0)
+void NPrepareSampleContext(const float* sample, const NeuralNet* model, NContext* context)
+{
+	PrepareSample(sample, model, context, context->quantisedInputs.f32);
+}
+
+
+float* NRunPreparedInferenceContext(const NeuralNet* model, NContext* context)
+{
+	return ContextInference(model)(model, context, context->quantisedInputs.f32);
+}
+
+
+/**
+ * \brief Clear the accumulators and rewind the time-sliced inference, see @NStartInference
+ */
+static inline void StartInference(const NeuralNet* model, NContext* context, const float* inputs)
+{
+	memset(context->accumulators.raw, 0, model->accumulatorsCount * (model->quantisation / 8));
+
+	context->step   = 0;
+	context->inputs = inputs;
+}
+
+
+Err NStartInference(const NeuralNet* model, NContext* context, const float* inputs)
+{
+	if (!model || !context || !inputs || !model->inference)
+		return ERR_BAD_ARGUMENT;
+
+	switch (model->quantisation)
 	{
-		return ldexp(0.5, QLVL);
+	case 8:  QuantiseInputsQ8 (model, context, inputs, 1, 1, 1); break;
+
+#if (NEUTON_Q16_SUPPORT == 1)
+	case 16: QuantiseInputsQ16(model, context, inputs, 1, 1, 1); break;
+#endif
+
+#if (NEUTON_Q32_SUPPORT == 1)
+	case 32: break;
+#endif
+
+	default: return ERR_FEATURE_NOT_SUPPORTED;
 	}
 
-	int s = arg > 0 ? 0 : 1;
-	if (realPart == 0)
+	StartInference(model, context, inputs);
+
+	return ERR_NO_ERROR;
+}
+
+
+float* NInferenceStep(const NeuralNet* model, NContext* context, uint32_t budget)
+{
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t end = budget < model->executionCount - context->step ?
+			context->step + budget : model->executionCount;
+
+	for (; context->step < end; context->step++)
 	{
-		for (int i = 0; i < QLVL; i++)
-		{
-			const uint8_t bit = ((i / intPart + s) % 2);
-			qResult = qResult | (bit << (QLVL - i - 1));
-		}
-		return qResult;
+		const uint32_t neuronIndex = model->executionList ? model->executionList[context->step] : context->step;
+
+		EvaluateNeuron(model, context, context->inputs, neuronIndex, offsetTypeSize);
 	}
 
-	const int64_t secondPointX = intPart + 1;
-	if (intPart == 0)
+	return context->step == model->executionCount ? CollectOutputs(model, context) : NULL;
+}
+
+
+/**
+ * \brief Fold the value of one count and the limits of the input into a fixed-point conversion
+ * \param model - model of neural network
+ * \param input - input index
+ * \param unit - value of one count
+ * \param bias - value of the bias input
+ * \param raw - output parameter
+ * \return error code or 0 on success
+ */
+static Err SetRawInput(const NeuralNet* model, uint16_t input, float unit, float bias, NRawInput* raw)
+{
+	if (input == model->inputsDim - 1)
 	{
-		firstPointY = ldexp(0.5, QLVL);
-		for (int i = 0; i < QLVL; i++)
-		{
-			const uint8_t bit = ((i / secondPointX) % 2);
-			secondPointY = secondPointY | (bit << (QLVL - i - 1));
-		}
+		raw->offset     = quantiseInputQ8(bias);
+		raw->multiplier = 0;
+		raw->shift      = 0;
+		return ERR_NO_ERROR;
 	}
-	else
+
+	const uint16_t limit = (model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? 0 : input;
+#if (NEUTON_INPUT_SCALES == 1)
+	const double scale = model->inputsScale[limit];
+#else
+	const double diff = model->inputsMax[limit] - model->inputsMin[limit];
+	const double scale = diff ? 256.0 / diff : 0.0;
+#endif
+
+	// Input is slope * count + offset, the same as scaleInput(model, count * unit, limit, 256.0f)
+	const double slope  = scale ? unit * scale : unit * 256.0;
+	const double offset = scale ? -model->inputsMin[limit] * scale : 0.0;
+
+	// The most precise shift that keeps count * multiplier >> 16 and offset below 2^30
+	for (int8_t shift = 30; shift >= 0; shift--)
 	{
-		if (secondPointX == 0)
-		{
-			for (int i = 0; i < QLVL; i++)
-			{
-				const uint8_t bit = ((i / intPart) % 2);
-				firstPointY = firstPointY | (bit << (QLVL - i - 1));
-			}
-			secondPointY = ldexp(0.5, QLVL);
-		}
-		else
+		const double multiplier = ldexp(slope, shift + 16);
+		const double fixedOffset = ldexp(offset, shift);
+
+		if (fabs(multiplier) < ldexp(1.0, 31) - 1.0 && fabs(fixedOffset) < ldexp(1.0, 30))
 		{
-			for (int i = 0; i < QLVL; i++)
-			{
-				uint8_t bit = ((i / intPart) % 2);
-				firstPointY = firstPointY | (bit << (QLVL - i - 1));
-				bit = ((i / secondPointX) % 2);
-				secondPointY = secondPointY | (bit << (QLVL - i - 1));
-			}
+			raw->multiplier = (int32_t) floor(multiplier + 0.5);
+			raw->offset     = (int32_t) floor(fixedOffset + 0.5);
+			raw->shift      = shift;
+			return ERR_NO_ERROR;
 		}
 	}
 
-	const int64_t res = (CT_MAX_VALUE - realPart) * firstPointY + realPart * secondPointY;
-	if (arg > 0)
+	return ERR_BAD_ARGUMENT;
+}
+
+
+Err NSetRawInputs(NeuralNet* model, const float* units, uint16_t channels, float bias)
+{
+	if (!model || !model->inference || !units || !channels)
+		return ERR_BAD_ARGUMENT;
+
+	if (model->quantisation != 8)
+		return ERR_FEATURE_NOT_SUPPORTED;
+
+	if (model->rawInputs)
 	{
-		return res >> QLVL;
+		NFree(model->rawInputs);
+		model->rawInputs = NULL;
 	}
-	else
+
+	const uint8_t offsetTypeSize = model->offsetTypeSize;
+	const uint32_t extLinksBegin = valueAt(0, model->extLinks, offsetTypeSize);
+	const uint8_t byInput = model->weightDim - extLinksBegin >= model->inputsDim;
+	const uint32_t count = byInput ? model->inputsDim : model->weightDim - extLinksBegin;
+
+	NRawInput* raw = NAlloc(count, sizeof(*raw));
+	if (!raw)
+		return ERR_MEMORY_ALLOCATION;
+
+	for (uint32_t idx = 0; idx < count; ++idx)
 	{
-		qResult = res >> QLVL;
-		return qResult == 0 ? CT_MAX_VALUE - 1 : CT_MAX_VALUE - qResult;
+		const uint16_t input = byInput ? idx : model->links[extLinksBegin + idx];
+
+		const Err err = SetRawInput(model, input, units[input % channels], bias, &raw[idx]);
+		if (err != ERR_NO_ERROR)
+		{
+			NFree(raw);
+			return err;
+		}
 	}
+
+	model->rawInputs = raw;
+
+	return ERR_NO_ERROR;
 }
-#endif // NEUTON_Q16_SUPPORT
 
 
-static inline float dequantiseValue(int32_t value, NeuralNet* model)
+float* NRunRawInference(NeuralNet* model, const int16_t* counts)
 {
-	return (float) value / (float) (2 << (model->quantisation - 1));
+	const NRawView view = { counts, NULL, model->inputsDim - 1u };
+
+	return NRunRawInferenceView(model, &view);
 }
 
 
-static inline float* RunInferenceQ8(NeuralNet* model, float* inputs)
+float* NRunRawInferenceContext(const NeuralNet* model, NContext* context, const int16_t* counts)
 {
-	const uint8_t offsetTypeSize = model->weightDim <= 256 ? 1 : model->weightDim <= 65536 ? 2 : 4;
-	uint32_t offset;
+	const NRawView view = { counts, NULL, model->inputsDim - 1u };
 
-	memset(model->accumulators.raw, 0, model->neuronsCount * sizeof(*model->accumulators.u8));
+	if (!model->rawInputs)
+		return NULL;
 
-	for (uint32_t neuronIndex = 0; neuronIndex < model->neuronsCount; neuronIndex++)
-	{
-		int32_t summ = 0;
+	QuantiseRawInputsQ8(model, context, &view);
 
-		offset = valueAt(neuronIndex, model->intLinks, offsetTypeSize);
-		for (uint16_t idx = 0; idx < model->intLinksCounters[neuronIndex]; ++idx)
-		{
-			const int32_t firstValue  = (int32_t) model->weights.i8[offset+idx];
-			const int32_t secondValue = (int32_t) model->accumulators.u8[model->links[offset+idx]];
-			summ += firstValue * secondValue;
-		}
+	return ContextInference(model)(model, context, NULL);
+}
 
-		offset = valueAt(neuronIndex, model->extLinks, offsetTypeSize);
-		for (uint16_t idx = 0; idx < model->extLinksCounters[neuronIndex]; ++idx)
-		{
-			const int32_t firstValue  = (int32_t) model->weights.i8[offset+idx];
-			const int32_t secondValue = (int32_t) ldexp(inputs[model->links[offset+idx]] > MAX_INPUT_FLOAT
-					? MAX_INPUT_FLOAT : inputs[model->links[offset+idx]], 8);
-			summ += firstValue * secondValue;
-		}
 
-		if (model->options & BIT_FORCE_INTEGER_CALCULATIONS)
-		{
-			model->accumulators.u8[neuronIndex] = accurate_fast_sigmoid_u8(
-				-(((int32_t) model->fncCoeffs.u8[neuronIndex] * summ) >> (8 + KSHIFT_2 - 1))
-			);
-		}
-		else
-		{
-			const float qs = (float) (((int32_t) model->fncCoeffs.u8[neuronIndex] * summ)
-					>> (8 + KSHIFT_2 - 1)) / (float) (2u << 7);
-			const float tmpValue = 1.0f / (1.0f + expf(-qs));
-			model->accumulators.u8[neuronIndex] = ldexp(tmpValue > MAX_INPUT_FLOAT ? MAX_INPUT_FLOAT : tmpValue, 8);
-		}
+float* NRunRawInferenceView(NeuralNet* model, const NRawView* view)
+{
+	if (!model->rawInputs)
+		return NULL;
 
-	}
+	QuantiseRawInputsQ8(model, &model->context, view);
+
+	return model->inference(model, &model->context, NULL);
+}
 
-	for (uint16_t idx = 0; idx < model->outputsDim; idx++)
-		model->outputBuffer[idx] = dequantiseValue(model->accumulators.u8[model->outputLabels[idx]], model);
 
-	return model->outputBuffer;
+Err NStartRawInference(const NeuralNet* model, NContext* context, const NRawView* view)
+{
+	if (!model || !context || !view)
+		return ERR_BAD_ARGUMENT;
+
+	if (!model->rawInputs)
+		return ERR_FEATURE_NOT_SUPPORTED;
+
+	QuantiseRawInputsQ8(model, context, view);
+	StartInference(model, context, NULL);
+
+	return ERR_NO_ERROR;
 }
 
 
-#if (NEUTON_Q16_SUPPORT == 1)
-static inline float* RunInferenceQ16(NeuralNet* model, float* inputs)
+Err NStreamInit(NStream* stream, const NeuralNet* model, int16_t* ring, uint16_t channels, uint16_t hop)
 {
-	const uint8_t offsetTypeSize = model->weightDim <= 256 ? 1 : model->weightDim <= 65536 ? 2 : 4;
-	uint32_t offset;
+	if (!stream || !model || !ring || !channels || model->inputsDim < 2)
+		return ERR_BAD_ARGUMENT;
 
-	memset(model->accumulators.raw, 0, model->neuronsCount * sizeof(*model->accumulators.u16));
+	const uint32_t size = model->inputsDim - 1u;
+	if (size % channels)
+		return ERR_BAD_ARGUMENT;
 
-	for (uint32_t neuronIndex = 0; neuronIndex < model->neuronsCount; neuronIndex++)
-	{
-		int64_t summ = 0;
+	memset(stream, 0, sizeof(*stream));
+	memset(ring, 0, size * sizeof(*ring));
 
-		offset = valueAt(neuronIndex, model->intLinks, offsetTypeSize);
-		for (uint16_t idx = 0; idx < model->intLinksCounters[neuronIndex]; ++idx)
-		{
-			const int64_t firstValue  = (int64_t) model->weights.i16[offset+idx];
-			const int64_t secondValue = (int64_t) model->accumulators.u16[model->links[offset+idx]];
-			summ += firstValue * secondValue;
-		}
+	stream->ring     = ring;
+	stream->size     = size;
+	stream->channels = channels;
+	stream->hop      = hop;
 
-		offset = valueAt(neuronIndex, model->extLinks, offsetTypeSize);
-		for (uint16_t idx = 0; idx < model->extLinksCounters[neuronIndex]; ++idx)
-		{
-			const int64_t firstValue  = (int64_t) model->weights.i16[offset+idx];
-			const int64_t secondValue = (int64_t) ldexp(inputs[model->links[offset+idx]] > MAX_INPUT_FLOAT
-					? MAX_INPUT_FLOAT : inputs[model->links[offset+idx]], 16);
-			summ += firstValue * secondValue;
-		}
+	return ERR_NO_ERROR;
+}
 
-		if (model->options & BIT_FORCE_INTEGER_CALCULATIONS)
-		{
-			model->accumulators.u16[neuronIndex] = accurate_fast_sigmoid_u16(
-				-(((int64_t) model->fncCoeffs.u16[neuronIndex] * summ) >> (16 + KSHIFT_10 - 1))
-			);
-		}
-		else
-		{
-			const float qs = (float) (((int64_t) model->fncCoeffs.u16[neuronIndex] * summ)
-					>> (16 + KSHIFT_10 - 1)) / (float) (2u << 15);
-			const float tmpValue = 1.0f / (1.0f + expf(-qs));
-			model->accumulators.u16[neuronIndex] = ldexp(tmpValue > MAX_INPUT_FLOAT ? MAX_INPUT_FLOAT : tmpValue, 16);
-		}
-	}
 
-	for (uint16_t idx = 0; idx < model->outputsDim; idx++)
-		model->outputBuffer[idx] = dequantiseValue(model->accumulators.u16[model->outputLabels[idx]], model);
+uint8_t NStreamPush(NStream* stream, const int16_t* sample)
+{
+	memcpy(stream->ring + stream->head, sample, stream->channels * sizeof(*sample));
+
+	stream->head += stream->channels;
+	if (stream->head == stream->size)
+		stream->head = 0;
+
+	if (stream->filled < stream->size)
+		stream->filled += stream->channels;
 
-	return model->outputBuffer;
+	uint8_t due = 0;
+
+	if (stream->hop && ++stream->sinceInference >= stream->hop)
+		due = 1;
+
+	if (stream->countdown && --stream->countdown == 0)
+		due = 1;
+
+	// Samples pushed before the window is full are counted, the first inference is not delayed
+	if (!due || stream->filled < stream->size)
+		return 0;
+
+	stream->sinceInference = 0;
+
+	return 1;
 }
-#endif
 
 
-#if (NEUTON_Q32_SUPPORT == 1)
-static inline float* RunInferenceF32(NeuralNet* model, float* inputs)
+void NStreamTrigger(NStream* stream, uint16_t preTrigger)
 {
-	const uint8_t offsetTypeSize = model->weightDim <= 256 ? 1 : model->weightDim <= 65536 ? 2 : 4;
-	uint32_t offset;
+	const uint32_t samples = stream->size / stream->channels;
 
-	memset(model->accumulators.raw, 0, model->neuronsCount * sizeof(*model->accumulators.f32));
+	if (!stream->countdown && preTrigger < samples)
+		stream->countdown = samples - preTrigger;
+}
+
+
+void NStreamView(const NStream* stream, NRawView* view)
+{
+	view->first      = stream->ring + stream->head;
+	view->firstCount = stream->size - stream->head;
+	view->second     = stream->ring;
+}
+
+
+Err NRunInferenceBatch(NeuralNet* model, const float* inputs, uint32_t count, float* outputs)
+{
+	if (!model || !inputs || !outputs)
+		return ERR_BAD_ARGUMENT;
 
-	for (uint32_t neuronIndex = 0; neuronIndex < model->neuronsCount; neuronIndex++)
+	switch (model->quantisation)
 	{
-		double summ = 0;
+	case 8:  RunInferenceBatchQ8 (model, &model->context, inputs, count, outputs); break;
 
-		offset = valueAt(neuronIndex, model->intLinks, offsetTypeSize);
-		for (uint16_t idx = 0; idx < model->intLinksCounters[neuronIndex]; ++idx)
-		{
-			const double firstValue  = (double) model->weights.f32[offset+idx];
-			const double secondValue = (double) model->accumulators.f32[model->links[offset+idx]];
-			summ += firstValue * secondValue;
-		}
+#if (NEUTON_Q16_SUPPORT == 1)
+	case 16: RunInferenceBatchQ16(model, &model->context, inputs, count, outputs); break;
+#endif
 
-		offset = valueAt(neuronIndex, model->extLinks, offsetTypeSize);
-		for (uint16_t idx = 0; idx < model->extLinksCounters[neuronIndex]; ++idx)
-		{
-			const double firstValue  = (double) model->weights.f32[offset+idx];
-			const double secondValue = (double) inputs[model->links[offset+idx]];
-			summ += firstValue * secondValue;
-		}
+#if (NEUTON_Q32_SUPPORT == 1)
+	case 32: RunInferenceBatchF32(model, &model->context, inputs, count, outputs); break;
+#endif
 
-		model->accumulators.f32[neuronIndex] =
-				1.0f / (1.0f + exp((double) ((double) -model->fncCoeffs.f32[neuronIndex]) * summ));
+	default: return ERR_FEATURE_NOT_SUPPORTED;
 	}
 
-	for (uint16_t idx = 0; idx < model->outputsDim; idx++)
-		model->outputBuffer[idx] = model->accumulators.f32[model->outputLabels[idx]];
-
-	return model->outputBuffer;
+	return ERR_NO_ERROR;
 }
-#endif
 
 
-float* NRunInference(NeuralNet* model, float* inputs)
+/**
+ * \brief Run inference for dataset rows, see @NRunInferenceRowsContext
+ */
+static Err RunInferenceRows(const NeuralNet* model, NContext* context, const void* rows, uint32_t rowDim,
+							uint32_t count, float* outputs)
 {
+	if (!rows || !outputs || rowDim + 1 < model->inputsDim)
+		return ERR_BAD_ARGUMENT;
+
 	switch (model->quantisation)
 	{
-	case 8:  return RunInferenceQ8 (model, inputs);
+	case 8:
+#if (NEUTON_Q16_SUPPORT == 1)
+	case 16:
+#endif
+#if (NEUTON_Q32_SUPPORT == 1)
+	case 32:
+#endif
+		break;
+
+	default: return ERR_FEATURE_NOT_SUPPORTED;
+	}
+
+	const uint16_t limitStep = (model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? 0 : 1;
+	const uint32_t rowSize = rowDim * sizeof(float);
+
+	for (uint32_t first = 0; first < count; first += NEUTON_BATCH_SIZE)
+	{
+		const uint32_t samples = (count - first) < NEUTON_BATCH_SIZE ? (count - first) : NEUTON_BATCH_SIZE;
+		const uint8_t* block = (const uint8_t*) rows + (size_t) first * rowSize;
+		float* blockOutputs = outputs + (size_t) first * model->outputsDim;
+		const float* inputs = NULL;
+
+		switch (model->quantisation)
+		{
+		case 8:  PrepareRowsQ8 (model, context, block, rowSize, samples, limitStep); break;
 
 #if (NEUTON_Q16_SUPPORT == 1)
-	case 16: return RunInferenceQ16(model, inputs);
+		case 16: PrepareRowsQ16(model, context, block, rowSize, samples, limitStep); break;
 #endif
 
 #if (NEUTON_Q32_SUPPORT == 1)
-	case 32: return RunInferenceF32(model, inputs);
+		case 32:
+			// The context of the model has no buffer for the inputs, they are normalised on every read
+			if (context->quantisedInputs.raw)
+			{
+				PrepareRowsF32(model, context->quantisedInputs.f32, block, rowSize, samples, limitStep);
+				inputs = context->quantisedInputs.f32;
+			}
+			break;
 #endif
+		}
 
-	default: return NULL;
+#if (NEUTON_BATCH_SIZE == 1)
+		// Single samples are evaluated by the kernel selected for the model
+		if (model->quantisation != 32 || inputs)
+		{
+			memcpy(blockOutputs, ContextInference(model)(model, context, inputs), model->outputsDim * sizeof(float));
+			continue;
+		}
+#endif
+
+		switch (model->quantisation)
+		{
+		case 8:  EvaluateBatchQ8 (model, context, samples, blockOutputs); break;
+
+#if (NEUTON_Q16_SUPPORT == 1)
+		case 16: EvaluateBatchQ16(model, context, samples, blockOutputs); break;
+#endif
+
+#if (NEUTON_Q32_SUPPORT == 1)
+		case 32:
+			EvaluateBatchF32(model, context, inputs, NEUTON_BATCH_SIZE, inputs ? NULL : block, rowSize, samples,
+							 blockOutputs);
+			break;
+#endif
+		}
 	}
+
+	return ERR_NO_ERROR;
+}
+
+
+Err NRunInferenceRows(NeuralNet* model, const void* rows, uint32_t rowDim, uint32_t count, float* outputs)
+{
+	if (!model)
+		return ERR_BAD_ARGUMENT;
+
+	return RunInferenceRows(model, &model->context, rows, rowDim, count, outputs);
+}
+
+
+Err NRunInferenceRowsContext(const NeuralNet* model, NContext* context, const void* rows, uint32_t rowDim,
+							 uint32_t count, float* outputs)
+{
+	if (!model || !context || !context->memoryBlock)
+		return ERR_BAD_ARGUMENT;
+
+	return RunInferenceRows(model, context, rows, rowDim, count, outputs);
 }
 
 
@@ -1138,7 +4212,7 @@ Err NOpenDataset(NFile *file, Dataset *dataset)
 	dataset->file = file;
 	dataset->reverseByteOrder = 0;
 
-	if (CheckFileHeader(dataset->file, &dataset->reverseByteOrder, TYPE_DATASET) != ERR_NO_ERROR)
+	if (CheckFileHeader(dataset->file, &dataset->reverseByteOrder, NULL, TYPE_DATASET) != ERR_NO_ERROR)
 		return ERR_BAD_FILE_FORMAT;
 
 	const uint32_t oneElement = 1;
@@ -1211,6 +4285,205 @@ Err NReadDatasetSample(Dataset* dataset, float* sample, uint32_t* readSamples)
 }
 
 
+static inline uint32_t bufferValue32(const uint8_t* data, uint8_t reverseByteOrder)
+{
+	uint32_t value;
+
+	memcpy(&value, data, sizeof(value));
+	if (reverseByteOrder)
+		Reverse4BytesValuesBuffer(&value, 1);
+
+	return value;
+}
+
+
+/**
+ * \brief Check the header of dataset in memory and find its samples
+ * \param reverseByteOrder - output parameter; flag of the need to reverse byte order
+ * \return error code or 0 on success
+ */
+static Err ParseDatasetView(const uint8_t* data, uint32_t size, NDatasetView* view, uint8_t* reverseByteOrder)
+{
+	const uint32_t dataBegin = sizeof(BinHeader) + 2 * sizeof(uint32_t);
+	const uint16_t BOM_PATTERN = 0xABCD;
+	BinHeader header;
+
+	if (size < dataBegin)
+		return ERR_BAD_FILE_FORMAT;
+
+	memcpy(&header, data, sizeof(header));
+
+	if (!(header.nb[0] == 'n' && header.nb[1] == 'b') || header.type != TYPE_DATASET)
+		return ERR_BAD_FILE_FORMAT;
+
+	if (header.bom == BOM_PATTERN)
+		*reverseByteOrder = 0;
+	else if (((header.bom & 0x00FF) << 8 | (header.bom & 0xFF00) >> 8) == BOM_PATTERN)
+		*reverseByteOrder = 1;
+	else
+		return ERR_BAD_FILE_FORMAT;
+
+	const uint32_t endDataPos = bufferValue32(data + sizeof(BinHeader), *reverseByteOrder);
+
+	if (endDataPos < dataBegin || endDataPos > size - sizeof(uint32_t))
+		return ERR_BAD_FILE_FORMAT;
+
+	const uint32_t sampleDim = bufferValue32(data + endDataPos, *reverseByteOrder);
+
+	if (sampleDim == 0 || sampleDim > UINT32_MAX / sizeof(float) ||
+		(endDataPos - dataBegin) % (sampleDim * sizeof(float)) != 0)
+		return ERR_INCONSISTENT_DATA;
+
+	view->samples      = data + dataBegin;
+	view->samplesCount = (endDataPos - dataBegin) / (sampleDim * sizeof(float));
+	view->sampleDim    = sampleDim;
+	view->position     = 0;
+
+	return ERR_NO_ERROR;
+}
+
+
+Err NOpenDatasetView(const uint8_t* buffer, uint32_t size, NDatasetView* view)
+{
+	if (!buffer || !view)
+		return ERR_BAD_ARGUMENT;
+
+	uint8_t reverseByteOrder;
+
+	memset(view, 0, sizeof(*view));
+
+	const Err err = ParseDatasetView(buffer, size, view, &reverseByteOrder);
+	if (err != ERR_NO_ERROR)
+		return err;
+
+	return reverseByteOrder ? ERR_FEATURE_NOT_SUPPORTED : ERR_NO_ERROR;
+}
+
+
+Err NMapDataset(const char* fileName, NDatasetView* view)
+{
+	if (!fileName || !view)
+		return ERR_BAD_ARGUMENT;
+
+	memset(view, 0, sizeof(*view));
+
+	uint8_t* data = NULL;
+	uint32_t size = 0;
+
+#if (NEUTON_MMAP == 1)
+	const int fd = open(fileName, O_RDONLY);
+	if (fd < 0)
+		return ERR_OPEN_FILE;
+
+	struct stat st;
+	void* mapping = MAP_FAILED;
+	memset(&st, 0, sizeof(st));
+
+	// Private writable mapping, pages are copied only if byte order is converted
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= UINT32_MAX)
+		mapping = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return (S_ISREG(st.st_mode) && st.st_size == 0) ? ERR_BAD_FILE_FORMAT : ERR_OPEN_FILE;
+
+	// madvise is not POSIX, strict C99 builds do not declare it
+#if defined(MADV_SEQUENTIAL)
+	madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+#endif
+
+	data = mapping;
+	size = st.st_size;
+	view->mapped = 1;
+#else
+	NFile* file = NFileOpen(fileName, "rb");
+	if (!file)
+		return ERR_OPEN_FILE;
+
+	const int64_t fileSize = NFileSeek(file, 0, SEEK_END) == 0 ? NFilePos(file) : -1;
+	const uint32_t oneElement = 1;
+
+	if (fileSize <= 0 || fileSize > UINT32_MAX)
+	{
+		NFileClose(file);
+		return fileSize == 0 ? ERR_BAD_FILE_FORMAT : ERR_READ_FILE;
+	}
+
+	size = fileSize;
+	data = NAlloc(1, size);
+
+	if (!data || NFileSeek(file, 0, SEEK_SET) != 0 || NFileRead(data, size, oneElement, file) != oneElement)
+	{
+		if (data)
+			NFree(data);
+		NFileClose(file);
+		return data ? ERR_READ_FILE : ERR_MEMORY_ALLOCATION;
+	}
+
+	NFileClose(file);
+#endif
+
+	view->memory     = data;
+	view->memorySize = size;
+
+	uint8_t reverseByteOrder;
+
+	const Err err = ParseDatasetView(data, size, view, &reverseByteOrder);
+	if (err != ERR_NO_ERROR)
+	{
+		NCloseDatasetView(view);
+		return err;
+	}
+
+	// Samples start at an odd offset, so values are reversed byte by byte
+	if (reverseByteOrder)
+	{
+		uint8_t* value = data + sizeof(BinHeader) + 2 * sizeof(uint32_t);
+		const uint8_t* end = view->samples + (size_t) view->samplesCount * view->sampleDim * sizeof(float);
+
+		for (; value < end; value += sizeof(float))
+		{
+			uint8_t tmp = value[0]; value[0] = value[3]; value[3] = tmp;
+			tmp = value[1]; value[1] = value[2]; value[2] = tmp;
+		}
+	}
+
+	return ERR_NO_ERROR;
+}
+
+
+const void* NDatasetBlock(NDatasetView* view, uint32_t maxCount, uint32_t* count)
+{
+	const uint32_t left = view->samplesCount - view->position;
+	const uint32_t taken = left < maxCount ? left : maxCount;
+
+	*count = taken;
+	if (!taken)
+		return NULL;
+
+	const uint8_t* block = view->samples + (size_t) view->position * view->sampleDim * sizeof(float);
+	view->position += taken;
+
+	return block;
+}
+
+
+void NCloseDatasetView(NDatasetView* view)
+{
+	if (view)
+	{
+#if (NEUTON_MMAP == 1)
+		if (view->mapped)
+			munmap(view->memory, view->memorySize);
+#endif
+		if (view->memory && !view->mapped)
+			NFree(view->memory);
+
+		memset(view, 0, sizeof(*view));
+	}
+}
+
+
 #if defined(NEUTON_MEMORY_BENCHMARK)
 static inline uint32_t NAllocCost()
 {
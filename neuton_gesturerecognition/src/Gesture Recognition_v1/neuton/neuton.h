@@ -63,6 +63,70 @@ typedef union Pointer_
 
 } Pointer;
 
+/**
+ * \brief Inference scratch buffers
+ * \details Inference changes only the context, so one loaded model can be shared by
+ *          several threads, each with its own context (see @NCreateContext)
+ */
+typedef struct NContext_
+{
+	/**
+	 * \brief Buffer for the neurons outs
+	 */
+	Pointer   accumulators;
+
+	/**
+	 * \brief Buffer for the quantised model inputs, normalised inputs of 32 bit models
+	 *        in the contexts created by @NCreateContext
+	 */
+	Pointer   quantisedInputs;
+
+	/**
+	 * \brief Buffer for output data
+	 */
+	float*    outputBuffer;
+
+	/**
+	 * \brief Allocated memory block, NULL for the context of the model
+	 */
+	void*     memoryBlock;
+
+	/**
+	 * \brief Next step of the execution list of the time-sliced inference, see @NInferenceStep
+	 */
+	uint32_t  step;
+
+	/**
+	 * \brief Normalised inputs of 32 bit models for the time-sliced inference
+	 */
+	const float* inputs;
+
+} NContext;
+
+/**
+ * \brief Fixed-point conversion of a raw sensor count into a quantised input, see @NSetRawInputs
+ * \details Input is ((count * multiplier >> 16) + offset) >> shift, clamped to 0 - 255
+ */
+typedef struct NRawInput_
+{
+	int32_t  multiplier;
+	int32_t  offset;
+	uint8_t  shift;
+
+} NRawInput;
+
+/**
+ * \brief Raw counts of the model inputs in two parts, such as the latest window of a ring buffer
+ * \details Count of input i is first[i] for i < firstCount and second[i - firstCount] after it
+ */
+typedef struct NRawView_
+{
+	const int16_t* first;
+	const int16_t* second;
+	uint32_t       firstCount;
+
+} NRawView;
+
 /**
  * \brief Model structure
  */
@@ -89,9 +153,15 @@ typedef struct NeuralNet_
 	Pointer   weights;
 
 	/**
-	 * \brief Buffer for the neurons outs
+	 * \brief Interleaved links and weights of every neuron in the inference order,
+	 *        NULL unless the model was re-laid out at load (NEUTON_INTERLEAVED_LINKS)
 	 */
-	Pointer   accumulators;
+	Pointer   linkRecords;
+
+	/**
+	 * \brief Scratch buffers of @NRunInference and @NRunInferenceBatch
+	 */
+	NContext  context;
 
 	/**
 	 * \brief Coefficients of the activation functions
@@ -114,9 +184,16 @@ typedef struct NeuralNet_
 	uint16_t* outputLabels;
 
 	/**
-	 * \brief Buffer for output data
+	 * \brief Indexes of the neurons feeding the outputs in the evaluation order,
+	 *        NULL if the first executionCount neurons are evaluated
 	 */
-	float*    outputBuffer;
+	uint16_t* executionList;
+
+	/**
+	 * \brief Accumulator slot of every neuron, links between neurons hold slots instead of
+	 *        neuron indexes, NULL if every neuron has its own slot (see SECTION_ACCUMULATOR_SLOTS)
+	 */
+	uint16_t* accumulatorSlots;
 
 	/**
 	 * \brief Cached value
@@ -128,6 +205,16 @@ typedef struct NeuralNet_
 	 */
 	uint32_t  neuronsCount;
 
+	/**
+	 * \brief Count of the neurons evaluated by inference
+	 */
+	uint32_t  executionCount;
+
+	/**
+	 * \brief Count of the accumulators of one sample
+	 */
+	uint32_t  accumulatorsCount;
+
 	/**
 	 * \brief Quantisation type
 	 */
@@ -148,6 +235,16 @@ typedef struct NeuralNet_
 	 */
 	uint8_t   reverseByteOrder;
 
+	/**
+	 * \brief Version of the model file format
+	 */
+	uint8_t   version;
+
+	/**
+	 * \brief Size of the int/ext links offsets in bytes (1, 2 or 4), set at load
+	 */
+	uint8_t   offsetTypeSize;
+
 	/**
 	 * \brief Dimension of neural network inputs
 	 */
@@ -173,6 +270,12 @@ typedef struct NeuralNet_
 	 */
 	float*    inputsMin;
 
+	/**
+	 * \brief Normalisation scales of the inputs, 2^quantisation / (max - min)
+	 *        or 0 if max == min (1.0 is used instead of 2^32 for 32 bit models)
+	 */
+	float*    inputsScale;
+
 	/**
 	 * \brief Neural network maximum outputs
 	 */
@@ -198,6 +301,40 @@ typedef struct NeuralNet_
 	 */
 	void*     memoryBlock;
 
+	/**
+	 * \brief Read-only mapping of the model file used in place of the model sections,
+	 *        NULL unless the model is loaded by @NLoadModelEx with NEUTON_MMAP
+	 */
+	void*     mappedFile;
+
+	/**
+	 * \brief Size of the mapping
+	 */
+	uint32_t  mappedSize;
+
+	/**
+	 * \brief Flag of the model memory taken from the caller's arena by @NLoadModelInto,
+	 *        it is not freed by @NFreeModel
+	 */
+	uint8_t   inArena;
+
+	/**
+	 * \brief Level schedule and threads of the parallel inference,
+	 *        NULL if neurons are evaluated sequentially (see @NSetThreads)
+	 */
+	struct NParallel_* parallel;
+
+	/**
+	 * \brief Conversions of raw sensor counts into the inputs of 8 bit models,
+	 *        NULL unless set by @NSetRawInputs
+	 */
+	NRawInput* rawInputs;
+
+	/**
+	 * \brief Inference kernel specialised for the model at load
+	 */
+	float*    (*inference)(const struct NeuralNet_* model, NContext* context, const float* inputs);
+
 } NeuralNet;
 
 /**
@@ -217,9 +354,148 @@ typedef struct Dataset_
 
 } Dataset;
 
+/**
+ * \brief Dataset in memory read by blocks of samples, see @NMapDataset
+ */
+typedef struct NDatasetView_
+{
+	/**
+	 * \brief First sample, samples follow each other with no gaps and are not aligned
+	 */
+	const uint8_t* samples;
+
+	/**
+	 * \brief Number of samples
+	 */
+	uint32_t  samplesCount;
+
+	/**
+	 * \brief Number of float values in one sample, bias is not stored
+	 */
+	uint32_t  sampleDim;
+
+	/**
+	 * \brief Next sample returned by @NDatasetBlock
+	 */
+	uint32_t  position;
+
+	/**
+	 * \brief Mapped or allocated file, NULL for the views of a buffer
+	 */
+	void*     memory;
+	uint32_t  memorySize;
+	uint8_t   mapped;
+
+} NDatasetView;
+
+
+/**
+ * \brief Parts of the model that do not feed any output and are skipped by inference
+ */
+typedef struct NPruneReport_
+{
+	uint32_t neurons;
+	uint32_t links;
+	uint32_t bytes;
+
+} NPruneReport;
+
+/**
+ * \brief Stream of raw sensor samples, the latest window of it is kept in a ring buffer
+ * \details A sample is the counts of all channels. The window holds model->inputsDim - 1
+ *          counts, the oldest sample starts at head. Inference reads the window in place
+ *          through a @NRawView, see @NStreamInit.
+ */
+typedef struct NStream_
+{
+	int16_t*  ring;
+	uint32_t  size;
+	uint32_t  head;
+	uint32_t  filled;
+	uint16_t  channels;
+	uint16_t  hop;
+	uint16_t  sinceInference;
+	uint16_t  countdown;
+
+} NStream;
+
+/**
+ * \brief Sections of the model file version 2
+ */
+typedef enum NSectionId_
+{
+	SECTION_INPUTS_MAX          = 0,
+	SECTION_INPUTS_MIN          = 1,
+	SECTION_OUTPUTS_MAX         = 2,
+	SECTION_OUTPUTS_MIN         = 3,
+	SECTION_OUTPUTS_LOG_OFFSET  = 4,
+	SECTION_OUTPUT_LABELS       = 5,
+	SECTION_INT_LINKS_COUNTERS  = 6,
+	SECTION_EXT_LINKS_COUNTERS  = 7,
+	SECTION_LINKS               = 8,
+	SECTION_WEIGHTS             = 9,
+	SECTION_FNC_COEFFS          = 10,
+	SECTION_INT_LINKS           = 11,
+	SECTION_EXT_LINKS           = 12,
+	SECTION_INPUTS_SCALE        = 13,
+	SECTION_EXECUTION_LIST      = 14,
+	SECTION_ACCUMULATOR_SLOTS   = 15,
+	SECTIONS_COUNT
+
+} NSectionId;
+
+/**
+ * \brief Header of the model file version 2, follows the common file header
+ * \details Version 2 files are written in the byte order of the target. The header is
+ *          followed by sectionsCount @NSection entries, the sections data and CRC32 of
+ *          all the preceding bytes. Every section holds a model array as it is used by
+ *          the library: int/ext links offsets (offsetTypeSize bytes each), input scales
+ *          and the execution list are precomputed, so the whole file can be used in
+ *          place. Sections with unknown ids are ignored.
+ *          The optional accumulator slots section maps every neuron to a slot shared by
+ *          neurons that are not alive at the same time, and internal links hold slots.
+ *          The accumulators then take one value per slot instead of one per neuron.
+ */
+typedef struct __attribute__((packed)) NModelHeaderV2_
+{
+	uint8_t  options;
+	uint8_t  taskType;
+	uint8_t  quantisation;
+	uint8_t  offsetTypeSize;
+	uint32_t inputsDim;
+	uint32_t outputsDim;
+	uint32_t neuronsCount;
+	uint32_t weightDim;
+	uint32_t executionCount;
+	uint32_t sectionsCount;
+
+} NModelHeaderV2;
+
+/**
+ * \brief Entry of the section table of the model file version 2
+ * \details Offset is counted from the start of the file and is a multiple of align,
+ *          a power of 2
+ */
+typedef struct __attribute__((packed)) NSection_
+{
+	uint16_t id;
+	uint16_t align;
+	uint32_t offset;
+	uint32_t size;
+
+} NSection;
+
 
 /**
  * \brief Load model using file descriptor
+ * \details Model files of version 1 and 2 (see @NModelHeaderV2) are accepted. Without
+ *          copy, sections of a version 2 buffer are used in place if they are aligned
+ *          in memory, only the inference buffers are allocated.
+ *          With NEUTON_CRC_CACHE_SIZE > 0 the CRC of a buffer is checked once: loading the
+ *          same buffer (address, size and CRC) again skips the check. The buffer must not
+ *          be changed in place after it was loaded. The cache is shared by all models and
+ *          is locked with NEUTON_THREADS=1; without it, loads and frees of models must not
+ *          run on several threads at once.
  * \param file - model file
  * \param weightsFile - file with model weights
  * \param model - model of neural network
@@ -229,18 +505,72 @@ extern Err NLoadModel(NFile* file, NeuralNet* model, uint8_t copy);
 
 /**
  * \brief Load model using filename
+ * \details With NEUTON_MMAP (default on Linux with NEUTON_USE_STDIO) the file is mapped
+ *          read-only and the model sections are used in place, the mapping lives until
+ *          @NFreeModel. Files that can not be mapped are read into memory.
  * \param fileName - path to model file
  * \param model - model of neural network
  * \return error code or 0 on success
  */
 extern Err NLoadModelEx(const char* fileName, NeuralNet* model);
 
+/**
+ * \brief Get size of the arena needed by @NLoadModelInto
+ * \details The model header is parsed and the model CRC is checked, the model is not loaded.
+ *          The size is enough for an arena at any address, an arena aligned by the pointer
+ *          size may use up to sizeof(void*) - 1 bytes less.
+ * \param buffer - model file in memory
+ * \param size - size of the model file
+ * \param copy - flag of the need to copy the model sections into the arena
+ * \return size in bytes or 0 if the model can not be loaded
+ */
+extern uint32_t NModelMemoryRequirements(const uint8_t* buffer, uint32_t size, uint8_t copy);
+
+/**
+ * \brief Load model from memory with no heap allocations
+ * \details All the memory of the model, including the file descriptor, is taken from the
+ *          arena. The arena and the buffer must live until the model is freed or loaded
+ *          again; @NFreeModel does not free them.
+ * \param arena - caller's memory
+ * \param arenaSize - size of the arena, see @NModelMemoryRequirements
+ * \param buffer - model file in memory
+ * \param size - size of the model file
+ * \param model - model of neural network
+ * \param copy - flag of the need to copy the model sections into the arena
+ * \return error code or 0 on success, ERR_MEMORY_ALLOCATION if the arena is too small
+ */
+extern Err NLoadModelInto(void* arena, uint32_t arenaSize, const uint8_t* buffer, uint32_t size,
+						  NeuralNet* model, uint8_t copy);
+
 /**
  * \brief Free resources used by model
  * \param model - model of neural network
  */
 extern void NFreeModel(NeuralNet* model);
 
+/**
+ * \brief Evaluate independent neurons of the model on several threads
+ * \details Neurons are grouped into levels, a neuron reads only the neurons of the previous
+ *          levels. Neurons of one level are evaluated concurrently by a pool of threads that
+ *          lives until the model is freed. Models with less than NEUTON_THREADS_MIN_NEURONS
+ *          evaluated neurons, with narrow levels or with accumulator slots stay sequential.
+ *          Results are the same as of the sequential inference. Batch inference is always
+ *          sequential.
+ *          Requires POSIX threads and NEUTON_THREADS=1.
+ * \param model - loaded model
+ * \param threads - number of threads including the calling one, 0 or 1 - sequential inference
+ * \return error code or 0 on success
+ */
+extern Err NSetThreads(NeuralNet* model, uint8_t threads);
+
+/**
+ * \brief Get the parts of the model pruned at load
+ * \param model - loaded model
+ * \param report - output parameter; pruned neurons, their links and bytes of the model
+ *        structure (links, weights, counters and coefficients) they take
+ */
+extern void NGetPruneReport(const NeuralNet* model, NPruneReport* report);
+
 /**
  * \brief Change sample value to the value from the 0.0 - 1.0 range based on the info about
  *        minimums and maximums from the training
@@ -259,11 +589,231 @@ extern void NDenormalizeResult(float* sample, NeuralNet* model);
 /**
  * \brief Run inference
  * \param model - model of neural network
+ * \details For 8 and 16 bit models inputs are expected in the 0.0 - 1.0 range,
+ *          values outside of it are clamped
  * \param inputs - vector of input values (size model->inputsDim)
  * \return pointer to buffer with output values (size model->outputsDim)
  */
 extern float* NRunInference(NeuralNet* model, float* inputs);
 
+/**
+ * \brief Normalise sample and convert it to the model inputs in a single pass
+ * \details For 8 and 16 bit models values are written to the model->context.quantisedInputs
+ *          and sample is left unchanged, only inputs used by the model are converted.
+ *          For 32 bit models sample is normalised in place.
+ * \param sample - pointer to the buffer with data (size model->inputsDim)
+ * \param model - pointer to model structure
+ */
+extern void NPrepareSample(float* sample, NeuralNet* model);
+
+/**
+ * \brief Run inference on the sample prepared by @NPrepareSample
+ * \param model - model of neural network
+ * \param sample - sample passed to @NPrepareSample
+ * \return pointer to buffer with output values (size model->outputsDim)
+ */
+extern float* NRunPreparedInference(NeuralNet* model, float* sample);
+
+/**
+ * \brief Run inference for a block of samples
+ * \details Samples are evaluated NEUTON_BATCH_SIZE at a time, so every link and weight
+ *          is read once per group of samples instead of once per sample
+ * \param model - model of neural network
+ * \param inputs - input values in structure-of-arrays layout, value of input i for
+ *        sample s is inputs[i * count + s] (size model->inputsDim * count)
+ * \param count - number of samples
+ * \param outputs - buffer for output values, sample s results start at
+ *        outputs[s * model->outputsDim] (size model->outputsDim * count)
+ * \return error code or 0 on success
+ */
+extern Err NRunInferenceBatch(NeuralNet* model, const float* inputs, uint32_t count, float* outputs);
+
+/**
+ * \brief Run inference for a block of dataset rows, see @NDatasetBlock
+ * \details Rows are normalised and converted to the model inputs NEUTON_BATCH_SIZE at a time
+ *          with no intermediate copy. The bias is not read from the rows, it is 1.0 for every
+ *          row. Results are the same as of @NPrepareSample and @NRunPreparedInference on
+ *          every row followed by the bias.
+ * \param model - model of neural network
+ * \param rows - raw input values, row s starts at value s * rowDim, need not be aligned
+ * \param rowDim - number of values in one row, at least model->inputsDim - 1; values after
+ *        the inputs (e.g. a target) are ignored
+ * \param count - number of rows
+ * \param outputs - buffer for output values, row s results start at
+ *        outputs[s * model->outputsDim] (size model->outputsDim * count)
+ * \return error code or 0 on success
+ */
+extern Err NRunInferenceRows(NeuralNet* model, const void* rows, uint32_t rowDim, uint32_t count, float* outputs);
+
+/**
+ * \brief Run inference for a block of dataset rows using the context, see @NRunInferenceRows
+ * \param model - model of neural network
+ * \param context - context created by @NCreateContext for the model
+ * \return error code or 0 on success
+ */
+extern Err NRunInferenceRowsContext(const NeuralNet* model, NContext* context, const void* rows, uint32_t rowDim,
+									uint32_t count, float* outputs);
+
+/**
+ * \brief Allocate scratch buffers for inference on a shared model
+ * \details Inference with a context does not change the model, so one loaded model can be
+ *          used by several threads at once, each with its own context. The model must not
+ *          be freed or reloaded while contexts are in use.
+ * \param model - loaded model
+ * \param context - context to initialise
+ * \return error code or 0 on success
+ */
+extern Err NCreateContext(const NeuralNet* model, NContext* context);
+
+/**
+ * \brief Free scratch buffers of the context
+ * \param context - context created by @NCreateContext
+ */
+extern void NFreeContext(NContext* context);
+
+/**
+ * \brief Run inference using the context, see @NRunInference
+ * \details Neurons are evaluated by the calling thread only (see @NSetThreads)
+ * \param model - model of neural network
+ * \param context - context created by @NCreateContext for the model
+ * \param inputs - vector of input values (size model->inputsDim), not changed
+ * \return pointer to context->outputBuffer with output values (size model->outputsDim)
+ */
+extern float* NRunInferenceContext(const NeuralNet* model, NContext* context, const float* inputs);
+
+/**
+ * \brief Normalise sample and convert it to the model inputs in the context, see @NPrepareSample
+ * \param sample - pointer to the buffer with data (size model->inputsDim), not changed
+ * \param model - pointer to model structure
+ * \param context - context created by @NCreateContext for the model
+ */
+extern void NPrepareSampleContext(const float* sample, const NeuralNet* model, NContext* context);
+
+/**
+ * \brief Run inference on the sample prepared by @NPrepareSampleContext
+ * \param model - model of neural network
+ * \param context - context passed to @NPrepareSampleContext
+ * \return pointer to context->outputBuffer with output values (size model->outputsDim)
+ */
+extern float* NRunPreparedInferenceContext(const NeuralNet* model, NContext* context);
+
+/**
+ * \brief Start a time-sliced inference, neurons are evaluated by @NInferenceStep
+ * \details Inputs are quantised at once, so the sample can be reused right after the call.
+ *          Inputs of 32 bit models are read by the steps and must stay unchanged until the
+ *          inference is complete. Starting an inference abandons the running one.
+ * \param model - model of neural network
+ * \param context - context of the model (&model->context) or created by @NCreateContext
+ * \param inputs - pointer to the buffer with input data (size model->inputsDim)
+ * \return error code or 0 on success
+ */
+extern Err NStartInference(const NeuralNet* model, NContext* context, const float* inputs);
+
+/**
+ * \brief Evaluate at most budget neurons of the inference started by @NStartInference or
+ *        @NStartRawInference
+ * \details Results are the same as of @NRunInference. The time of one step is about
+ *          budget neurons, so the caller can interleave steps with sampling.
+ * \param model - model of neural network
+ * \param context - context passed to the start of the inference
+ * \param budget - maximal number of neurons to evaluate
+ * \return pointer to context->outputBuffer with output values (size model->outputsDim)
+ *         once all neurons are evaluated, NULL before
+ */
+extern float* NInferenceStep(const NeuralNet* model, NContext* context, uint32_t budget);
+
+/**
+ * \brief Prepare inference on raw integer sensor counts of 8 bit models
+ * \details The sensor scale and the input minimums and maximums are folded into a fixed-point
+ *          multiplier and offset of every input used by the model, so @NRunRawInference
+ *          converts counts to the quantised inputs with no float arithmetic. The result
+ *          matches @NPrepareSample on the values count * units[channel] up to the float
+ *          rounding of the latter. The conversions are allocated on the heap and live
+ *          until the model is freed or the function is called again.
+ * \param model - loaded model
+ * \param units - value of one count of every channel
+ * \param channels - number of channels, input i is a count of the channel i % channels
+ * \param bias - value of the last (bias) input
+ * \return error code or 0 on success, ERR_FEATURE_NOT_SUPPORTED for 16 and 32 bit models
+ */
+extern Err NSetRawInputs(NeuralNet* model, const float* units, uint16_t channels, float bias);
+
+/**
+ * \brief Run inference on raw sensor counts, see @NSetRawInputs
+ * \param model - model of neural network
+ * \param counts - raw counts of the inputs except bias (size model->inputsDim - 1)
+ * \return pointer to buffer with output values (size model->outputsDim)
+ *         or NULL if conversions are not set
+ */
+extern float* NRunRawInference(NeuralNet* model, const int16_t* counts);
+
+/**
+ * \brief Run inference on raw sensor counts using the context, see @NRunRawInference
+ * \param model - model of neural network
+ * \param context - context created by @NCreateContext for the model
+ * \param counts - raw counts of the inputs except bias (size model->inputsDim - 1)
+ * \return pointer to context->outputBuffer with output values (size model->outputsDim)
+ *         or NULL if conversions are not set
+ */
+extern float* NRunRawInferenceContext(const NeuralNet* model, NContext* context, const int16_t* counts);
+
+/**
+ * \brief Run inference on raw sensor counts stored in two parts, see @NRunRawInference
+ * \param model - model of neural network
+ * \param view - raw counts of the inputs except bias (model->inputsDim - 1 in total)
+ * \return pointer to buffer with output values (size model->outputsDim)
+ *         or NULL if conversions are not set
+ */
+extern float* NRunRawInferenceView(NeuralNet* model, const NRawView* view);
+
+/**
+ * \brief Start a time-sliced inference on raw sensor counts, see @NStartInference
+ * \details Counts are converted at once, so the view can change right after the call
+ * \param model - model of neural network
+ * \param context - context of the model (&model->context) or created by @NCreateContext
+ * \param view - raw counts of the inputs except bias (model->inputsDim - 1 in total)
+ * \return error code or 0 on success
+ */
+extern Err NStartRawInference(const NeuralNet* model, NContext* context, const NRawView* view);
+
+/**
+ * \brief Start a stream of raw sensor samples
+ * \details Inference is due every hop samples (continuous mode) and once after a trigger
+ *          (see @NStreamTrigger), but not before the window is full
+ * \param stream - stream to initialise
+ * \param model - loaded model, model->inputsDim - 1 must be a multiple of channels
+ * \param ring - buffer for the window (size model->inputsDim - 1)
+ * \param channels - counts in one sample
+ * \param hop - samples between inferences, 0 to run inference only after a trigger
+ * \return error code or 0 on success
+ */
+extern Err NStreamInit(NStream* stream, const NeuralNet* model, int16_t* ring, uint16_t channels,
+					   uint16_t hop);
+
+/**
+ * \brief Add a sample to the window in place of the oldest one
+ * \param stream - stream
+ * \param sample - counts of all channels
+ * \return 1 if inference on the window is due, 0 otherwise
+ */
+extern uint8_t NStreamPush(NStream* stream, const int16_t* sample);
+
+/**
+ * \brief Schedule inference on the window in which the next pushed sample is preceded by
+ *        preTrigger samples
+ * \details Nothing is done if inference after a trigger is already pending
+ * \param stream - stream
+ * \param preTrigger - samples before the trigger, less than the window
+ */
+extern void NStreamTrigger(NStream* stream, uint16_t preTrigger);
+
+/**
+ * \brief Get the window of the stream, from the oldest sample to the latest one
+ * \param stream - stream
+ * \param view - output parameter
+ */
+extern void NStreamView(const NStream* stream, NRawView* view);
+
 /**
  * \brief Open dataset for line-by-line reading
  * \param file - binary file
@@ -295,6 +845,42 @@ extern void NCloseDataset(Dataset* dataset);
  */
 extern Err NReadDatasetSample(Dataset* dataset, float* sample, uint32_t *readSamples);
 
+/**
+ * \brief Open dataset stored in a buffer for reading by blocks, see @NDatasetBlock
+ * \details Samples are used in place, the buffer must stay unchanged until the view is closed
+ * \param buffer - dataset file data
+ * \param size - size of data
+ * \param view - output parameter
+ * \return error code or 0 on success, ERR_FEATURE_NOT_SUPPORTED for reversed byte order
+ */
+extern Err NOpenDatasetView(const uint8_t* buffer, uint32_t size, NDatasetView* view);
+
+/**
+ * \brief Map dataset file into memory for reading by blocks, see @NDatasetBlock
+ * \details The file is mapped privately where supported and read into memory otherwise.
+ *          Reversed byte order is converted once here, so blocks are read with no
+ *          per-sample work.
+ * \param fileName - name of binary file
+ * \param view - output parameter
+ * \return error code or 0 on success, ERR_BAD_FILE_FORMAT for an empty file
+ */
+extern Err NMapDataset(const char* fileName, NDatasetView* view);
+
+/**
+ * \brief Get the next block of samples of the dataset
+ * \param view - dataset view
+ * \param maxCount - maximal number of samples in the block
+ * \param count - output parameter; number of samples in the block
+ * \return pointer to the first sample of the block, NULL at the end of the dataset
+ */
+extern const void* NDatasetBlock(NDatasetView* view, uint32_t maxCount, uint32_t* count);
+
+/**
+ * \brief Close dataset view, unmap or free the file
+ * \param view - view opened by @NOpenDatasetView or @NMapDataset
+ */
+extern void NCloseDatasetView(NDatasetView* view);
+
 /**
  * \brief Open file by name
  * \param filename - name of the file
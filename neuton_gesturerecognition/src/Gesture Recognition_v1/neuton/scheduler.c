@@ -0,0 +1,222 @@
+#include "scheduler.h"
+
+#if (NEUTON_THREADS == 1)
+
+#include "neuton.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+
+#define CHUNKS_PER_THREAD		4
+#define SPINS_BEFORE_YIELD		256
+
+
+struct NScheduler_
+{
+	pthread_t*      threads;
+	uint8_t         workers;
+	uint8_t         stop;
+
+	pthread_mutex_t lock;
+	pthread_cond_t  wake;
+	uint32_t        generation;
+
+	/**
+	 * \brief Current job, valid while workers are inside it
+	 */
+	const uint32_t* bounds;
+	uint32_t        levels;
+	NSchedulerTask  task;
+	void*           context;
+
+	/**
+	 * \brief Next item to take and count of done items of every level
+	 */
+	atomic_uint*    taken;
+	atomic_uint*    done;
+	uint32_t        capacity;
+
+	/**
+	 * \brief Workers that have not finished the current job yet
+	 */
+	atomic_uint     pending;
+};
+
+
+static inline void Wait(uint32_t* spins)
+{
+	if (++*spins > SPINS_BEFORE_YIELD)
+		sched_yield();
+}
+
+
+static void RunJob(NScheduler* scheduler)
+{
+	const uint32_t participants = scheduler->workers + 1u;
+
+	for (uint32_t level = 0; level < scheduler->levels; level++)
+	{
+		const uint32_t begin = scheduler->bounds[level];
+		const uint32_t size  = scheduler->bounds[level + 1] - begin;
+		const uint32_t chunk = (size + participants * CHUNKS_PER_THREAD - 1) / (participants * CHUNKS_PER_THREAD);
+
+		for (;;)
+		{
+			const uint32_t first = atomic_fetch_add(&scheduler->taken[level], chunk);
+			if (first >= size)
+				break;
+
+			const uint32_t last = (first + chunk < size) ? first + chunk : size;
+			scheduler->task(scheduler->context, begin + first, begin + last);
+			atomic_fetch_add(&scheduler->done[level], last - first);
+		}
+
+		uint32_t spins = 0;
+		while (atomic_load(&scheduler->done[level]) < size)
+			Wait(&spins);
+	}
+}
+
+
+static void* WorkerMain(void* arg)
+{
+	NScheduler* scheduler = arg;
+	uint32_t generation = 0;
+
+	pthread_mutex_lock(&scheduler->lock);
+
+	for (;;)
+	{
+		while (!scheduler->stop && scheduler->generation == generation)
+			pthread_cond_wait(&scheduler->wake, &scheduler->lock);
+
+		if (scheduler->stop)
+			break;
+
+		generation = scheduler->generation;
+		pthread_mutex_unlock(&scheduler->lock);
+
+		RunJob(scheduler);
+		atomic_fetch_sub(&scheduler->pending, 1);
+
+		pthread_mutex_lock(&scheduler->lock);
+	}
+
+	pthread_mutex_unlock(&scheduler->lock);
+
+	return NULL;
+}
+
+
+NScheduler* NSchedulerCreate(uint8_t workers)
+{
+	NScheduler* scheduler = NAlloc(1, sizeof(*scheduler));
+	if (!scheduler)
+		return NULL;
+
+	scheduler->threads = NAlloc(workers ? workers : 1, sizeof(*scheduler->threads));
+	if (!scheduler->threads)
+	{
+		NFree(scheduler);
+		return NULL;
+	}
+
+	pthread_mutex_init(&scheduler->lock, NULL);
+	pthread_cond_init(&scheduler->wake, NULL);
+	atomic_init(&scheduler->pending, 0);
+
+	for (; scheduler->workers < workers; scheduler->workers++)
+	{
+		if (pthread_create(&scheduler->threads[scheduler->workers], NULL, WorkerMain, scheduler) != 0)
+		{
+			NSchedulerDestroy(scheduler);
+			return NULL;
+		}
+	}
+
+	return scheduler;
+}
+
+
+void NSchedulerDestroy(NScheduler* scheduler)
+{
+	if (!scheduler)
+		return;
+
+	pthread_mutex_lock(&scheduler->lock);
+	scheduler->stop = 1;
+	pthread_cond_broadcast(&scheduler->wake);
+	pthread_mutex_unlock(&scheduler->lock);
+
+	for (uint8_t idx = 0; idx < scheduler->workers; idx++)
+		pthread_join(scheduler->threads[idx], NULL);
+
+	pthread_cond_destroy(&scheduler->wake);
+	pthread_mutex_destroy(&scheduler->lock);
+
+	if (scheduler->taken)
+		NFree(scheduler->taken);
+	if (scheduler->done)
+		NFree(scheduler->done);
+
+	NFree(scheduler->threads);
+	NFree(scheduler);
+}
+
+
+int32_t NSchedulerRunLevels(NScheduler* scheduler, const uint32_t* bounds, uint32_t levels,
+							NSchedulerTask task, void* context)
+{
+	if (levels > scheduler->capacity)
+	{
+		atomic_uint* taken = NAlloc(levels, sizeof(*taken));
+		atomic_uint* done  = NAlloc(levels, sizeof(*done));
+		if (!taken || !done)
+		{
+			if (taken)
+				NFree(taken);
+			if (done)
+				NFree(done);
+			return -1;
+		}
+
+		if (scheduler->taken)
+			NFree(scheduler->taken);
+		if (scheduler->done)
+			NFree(scheduler->done);
+
+		scheduler->taken    = taken;
+		scheduler->done     = done;
+		scheduler->capacity = levels;
+	}
+
+	for (uint32_t level = 0; level < levels; level++)
+	{
+		atomic_store(&scheduler->taken[level], 0);
+		atomic_store(&scheduler->done[level], 0);
+	}
+
+	scheduler->bounds  = bounds;
+	scheduler->levels  = levels;
+	scheduler->task    = task;
+	scheduler->context = context;
+	atomic_store(&scheduler->pending, scheduler->workers);
+
+	pthread_mutex_lock(&scheduler->lock);
+	scheduler->generation++;
+	pthread_cond_broadcast(&scheduler->wake);
+	pthread_mutex_unlock(&scheduler->lock);
+
+	RunJob(scheduler);
+
+	// Workers must leave the job before the counters are reset by the next one
+	uint32_t spins = 0;
+	while (atomic_load(&scheduler->pending))
+		Wait(&spins);
+
+	return 0;
+}
+
+#endif // NEUTON_THREADS
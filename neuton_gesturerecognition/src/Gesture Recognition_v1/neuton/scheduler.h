@@ -0,0 +1,64 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if !defined(NEUTON_THREADS)
+#define NEUTON_THREADS			0
+#endif
+
+
+#if (NEUTON_THREADS == 1)
+
+/**
+ * \brief Persistent pool of worker threads
+ */
+typedef struct NScheduler_ NScheduler;
+
+/**
+ * \brief Task evaluating items [begin, end) of a level
+ */
+typedef void (*NSchedulerTask)(void* context, uint32_t begin, uint32_t end);
+
+
+/**
+ * \brief Start worker threads
+ * \param workers - number of threads started in addition to the calling one
+ * \return scheduler or NULL on failure
+ */
+extern NScheduler* NSchedulerCreate(uint8_t workers);
+
+/**
+ * \brief Stop worker threads and free the scheduler
+ * \param scheduler - scheduler, may be NULL
+ */
+extern void NSchedulerDestroy(NScheduler* scheduler);
+
+/**
+ * \brief Run task over the items of every level, level by level
+ * \details Items of a level are split into chunks taken by the calling thread and the
+ *          workers as they become free. A level starts when all items of the
+ *          previous one are done. Returns when all levels are done.
+ * \param scheduler - scheduler
+ * \param bounds - first item of every level and the end of the last one (size levels + 1)
+ * \param levels - number of levels
+ * \param task - task
+ * \param context - task context
+ * \return 0 on success or -1 on failure, nothing is run then
+ */
+extern int32_t NSchedulerRunLevels(NScheduler* scheduler, const uint32_t* bounds, uint32_t levels,
+								   NSchedulerTask task, void* context);
+
+#endif // NEUTON_THREADS
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCHEDULER_H
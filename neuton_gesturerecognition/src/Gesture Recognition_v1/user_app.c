@@ -3,9 +3,23 @@
 
 #include "neuton/calculator.h"
 
+/**
+ * Size of the static memory of the model, 0 to allocate it on the heap.
+ * Set it to NModelMemoryRequirements(model_bin, model_bin_len, 0) of the target.
+ */
+#if !defined(NEUTON_MODEL_ARENA_SIZE)
+#define NEUTON_MODEL_ARENA_SIZE	0
+#endif
+
 static NeuralNet neuralNet = { 0 };
+static NStream stream = { 0 };
+static uint8_t inferenceRunning = 0;
 static uint32_t memUsage = 0;
 
+#if (NEUTON_MODEL_ARENA_SIZE > 0)
+static uint8_t modelArena[NEUTON_MODEL_ARENA_SIZE];
+#endif
+
 extern const unsigned char model_bin[];
 extern const unsigned int model_bin_len;
 
@@ -19,8 +33,13 @@ uint32_t _NeutonExtraMemoryUsage()
 
 inline Err CalculatorOnInit(NeuralNet* neuralNet)
 {
-	memUsage += sizeof(*neuralNet);
+	memUsage += sizeof(*neuralNet) + sizeof(stream) + sizeof(inferenceRunning);
+#if (NEUTON_MODEL_ARENA_SIZE > 0)
+	memUsage += sizeof(modelArena);
+	return CalculatorLoadFromMemoryInto(neuralNet, model_bin, model_bin_len, 0, modelArena, sizeof(modelArena));
+#else
 	return CalculatorLoadFromMemory(neuralNet, model_bin, model_bin_len, 0);
+#endif
 }
 
 
@@ -79,3 +98,89 @@ float* model_run_inference(float* sample, uint32_t size_in, uint32_t *size_out)
 
 	return CalculatorRunInference(&neuralNet, sample);
 }
+
+uint8_t model_set_raw_units(const float* units, uint32_t channels, float bias)
+{
+	if (!units || !channels || channels > neuralNet.inputsDim)
+		return 0;
+
+	return (ERR_NO_ERROR == NSetRawInputs(&neuralNet, units, channels, bias));
+}
+
+float* model_run_raw_inference(const int16_t* counts, uint32_t size_in, uint32_t *size_out)
+{
+	if (!counts || !size_out)
+		return NULL;
+
+	if (size_in != neuralNet.inputsDim - 1u)
+		return NULL;
+
+	*size_out = neuralNet.outputsDim;
+
+	return CalculatorRunRawInference(&neuralNet, counts);
+}
+
+uint8_t model_stream_init(int16_t* ring, uint32_t size, uint32_t channels, uint32_t hop)
+{
+	if (!ring || size != neuralNet.inputsDim - 1u || channels > UINT16_MAX || hop > UINT16_MAX)
+		return 0;
+
+	return (ERR_NO_ERROR == NStreamInit(&stream, &neuralNet, ring, channels, hop));
+}
+
+uint8_t model_stream_push(const int16_t* sample)
+{
+	if (!sample || !stream.ring)
+		return 0;
+
+	return NStreamPush(&stream, sample);
+}
+
+void model_stream_trigger(uint32_t pre_trigger)
+{
+	if (stream.ring && pre_trigger <= UINT16_MAX)
+		NStreamTrigger(&stream, pre_trigger);
+}
+
+float* model_run_stream_inference(uint32_t* size_out)
+{
+	NRawView view;
+
+	if (!size_out || !stream.ring)
+		return NULL;
+
+	NStreamView(&stream, &view);
+
+	*size_out = neuralNet.outputsDim;
+
+	return CalculatorRunRawInferenceView(&neuralNet, &view);
+}
+
+uint8_t model_start_stream_inference()
+{
+	NRawView view;
+
+	if (!stream.ring)
+		return 0;
+
+	NStreamView(&stream, &view);
+
+	inferenceRunning = (ERR_NO_ERROR == CalculatorStartRawInferenceView(&neuralNet, &view));
+
+	return inferenceRunning;
+}
+
+float* model_inference_step(uint32_t budget, uint32_t* size_out)
+{
+	if (!size_out || !inferenceRunning)
+		return NULL;
+
+	float* result = CalculatorInferenceStep(&neuralNet, budget);
+	if (!result)
+		return NULL;
+
+	inferenceRunning = 0;
+	*size_out = neuralNet.outputsDim;
+
+	return result;
+}
@@ -11,6 +11,22 @@ uint8_t model_init();
 float*  model_run_inference(float* sample, 
 							uint32_t size_in, 
 							uint32_t* size_out);
+uint8_t model_set_raw_units(const float* units,
+							uint32_t channels,
+							float bias);
+float*  model_run_raw_inference(const int16_t* counts,
+								uint32_t size_in,
+								uint32_t* size_out);
+uint8_t model_stream_init(int16_t* ring,
+						  uint32_t size,
+						  uint32_t channels,
+						  uint32_t hop);
+uint8_t model_stream_push(const int16_t* sample);
+void    model_stream_trigger(uint32_t pre_trigger);
+float*  model_run_stream_inference(uint32_t* size_out);
+uint8_t model_start_stream_inference();
+float*  model_inference_step(uint32_t budget,
+							 uint32_t* size_out);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,76 @@
+#include <string.h>
+
+#include "acquisition.h"
+
+
+void AcqRingInit(AcqRing* ring)
+{
+	memset(ring, 0, sizeof(*ring));
+}
+
+
+uint16_t AcqRingOverruns(const AcqRing* ring)
+{
+	uint16_t overruns;
+
+	do
+	{
+		overruns = ring->overruns;
+	}
+	while (overruns != ring->overruns);
+
+	return overruns;
+}
+
+
+void AcqStatsInit(AcqStats* stats, uint32_t period)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	stats->period      = period;
+	stats->minInterval = UINT32_MAX;
+}
+
+
+void AcqStatsAdd(AcqStats* stats, uint32_t time)
+{
+	if (stats->samples++ == 0)
+	{
+		stats->firstTime = stats->lastTime = time;
+		return;
+	}
+
+	// Unsigned difference stays right across the wrap of the timer
+	const uint32_t interval = time - stats->lastTime;
+
+	if (interval < stats->minInterval)
+		stats->minInterval = interval;
+	if (interval > stats->maxInterval)
+		stats->maxInterval = interval;
+
+	if (interval >= stats->period + stats->period / 2)
+		stats->gaps++;
+
+	stats->lastTime = time;
+}
+
+
+float AcqStatsRate(const AcqStats* stats)
+{
+	if (stats->samples < 2 || stats->lastTime == stats->firstTime)
+		return 0.0f;
+
+	return (stats->samples - 1) * 1e6f / (float) (stats->lastTime - stats->firstTime);
+}
+
+
+uint32_t AcqStatsJitter(const AcqStats* stats)
+{
+	if (stats->samples < 2)
+		return 0;
+
+	const uint32_t late  = stats->maxInterval > stats->period ? stats->maxInterval - stats->period : 0;
+	const uint32_t early = stats->minInterval < stats->period ? stats->period - stats->minInterval : 0;
+
+	return late > early ? late : early;
+}
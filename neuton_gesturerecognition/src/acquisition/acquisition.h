@@ -0,0 +1,188 @@
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * \brief Samples in the ring, a power of 2 up to 128, so the 8 bit indexes are read and
+ *        written in one instruction by the interrupt and loop()
+ */
+#if !defined(ACQ_RING_SIZE)
+#define ACQ_RING_SIZE			32
+#endif
+
+/**
+ * \brief Counts in one sample: ax, ay, az, gx, gy, gz
+ */
+#if !defined(ACQ_CHANNELS)
+#define ACQ_CHANNELS			6
+#endif
+
+
+#if (ACQ_RING_SIZE < 2) || (ACQ_RING_SIZE > 128) || (ACQ_RING_SIZE & (ACQ_RING_SIZE - 1))
+#error "ACQ_RING_SIZE must be a power of 2 from 2 to 128"
+#endif
+
+
+/**
+ * \brief Keep the compiler from moving memory accesses across it, enough to order the
+ *        accesses of an interrupt and the code it interrupts on a single core
+ */
+#if defined(__GNUC__)
+#define ACQ_BARRIER()			__asm__ __volatile__("" ::: "memory")
+#else
+#define ACQ_BARRIER()
+#endif
+
+
+/**
+ * \brief Raw sensor sample and the time it was read at
+ */
+typedef struct AcqSample_
+{
+	uint32_t time;
+	int16_t  counts[ACQ_CHANNELS];
+
+} AcqSample;
+
+/**
+ * \brief Single-producer, single-consumer ring of samples
+ * \details The producer (interrupt) writes only head and overruns, the consumer (loop())
+ *          writes only tail. Indexes run freely and are masked on access, so the ring
+ *          holds ACQ_RING_SIZE samples and needs no lock.
+ */
+typedef struct AcqRing_
+{
+	AcqSample         samples[ACQ_RING_SIZE];
+	volatile uint8_t  head;
+	volatile uint8_t  tail;
+
+	/**
+	 * \brief Samples dropped because the ring was full, see @AcqRingOverruns
+	 */
+	volatile uint16_t overruns;
+
+} AcqRing;
+
+/**
+ * \brief Sample rate and timing of the consumed samples
+ */
+typedef struct AcqStats_
+{
+	uint32_t period;
+	uint32_t samples;
+	uint32_t firstTime;
+	uint32_t lastTime;
+	uint32_t minInterval;
+	uint32_t maxInterval;
+
+	/**
+	 * \brief Intervals of 1.5 periods or more, a sample was missed before them
+	 */
+	uint32_t gaps;
+
+} AcqStats;
+
+
+/**
+ * \brief Get the slot of the next sample, called by the producer
+ * \param ring - ring
+ * \return slot to fill and pass to @AcqRingCommit, or NULL if the ring is full and the
+ *         sample is dropped
+ */
+static inline AcqSample* AcqRingWriteSlot(AcqRing* ring)
+{
+	const uint8_t head = ring->head;
+
+	if ((uint8_t) (head - ring->tail) == ACQ_RING_SIZE)
+	{
+		ring->overruns++;
+		return NULL;
+	}
+
+	return &ring->samples[head & (ACQ_RING_SIZE - 1)];
+}
+
+
+/**
+ * \brief Publish the sample written to the slot of @AcqRingWriteSlot, called by the producer
+ */
+static inline void AcqRingCommit(AcqRing* ring)
+{
+	ACQ_BARRIER();
+	ring->head = ring->head + 1;
+}
+
+
+/**
+ * \brief Take the oldest sample, called by the consumer
+ * \param ring - ring
+ * \param sample - output parameter
+ * \return 1 if a sample was taken, 0 if the ring is empty
+ */
+static inline uint8_t AcqRingRead(AcqRing* ring, AcqSample* sample)
+{
+	const uint8_t tail = ring->tail;
+
+	if (tail == ring->head)
+		return 0;
+
+	ACQ_BARRIER();
+	*sample = ring->samples[tail & (ACQ_RING_SIZE - 1)];
+	ACQ_BARRIER();
+
+	ring->tail = tail + 1;
+
+	return 1;
+}
+
+
+/**
+ * \brief Empty the ring and reset the overruns
+ * \details Must not run concurrently with the producer
+ */
+extern void AcqRingInit(AcqRing* ring);
+
+/**
+ * \brief Get the dropped samples, called by the consumer
+ * \details The counter is 16 bit, so it is read until two reads agree
+ */
+extern uint16_t AcqRingOverruns(const AcqRing* ring);
+
+/**
+ * \brief Reset statistics
+ * \param stats - statistics
+ * \param period - nominal sample period, in the units of the sample time
+ */
+extern void AcqStatsInit(AcqStats* stats, uint32_t period);
+
+/**
+ * \brief Add a consumed sample to the statistics
+ * \param stats - statistics
+ * \param time - time of the sample
+ */
+extern void AcqStatsAdd(AcqStats* stats, uint32_t time);
+
+/**
+ * \brief Get the achieved sample rate
+ * \return samples per 1000000 units of the sample time (Hz with microseconds),
+ *         0 before two samples
+ */
+extern float AcqStatsRate(const AcqStats* stats);
+
+/**
+ * \brief Get the largest deviation of an interval from the nominal period
+ */
+extern uint32_t AcqStatsJitter(const AcqStats* stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ACQUISITION_H
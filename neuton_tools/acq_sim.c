@@ -0,0 +1,583 @@
+/**
+ ******************************************************************************
+ * @file    acq_sim.c
+ * @brief   Simulation of the sketch sampling on a simulated clock and sensor:
+ *          delay() loop, millis() loop and timer interrupt with the sample ring
+ *          of acquisition.h
+ *
+ * The sensor replays a stream (see stream_replay.c) at 10 ms per sample: a read
+ * at time t returns the sample t / 10 ms. The main program and the interrupt
+ * spend the modelled time of every action (I2C read, input conversion, neurons,
+ * Serial output). The interrupt preempts the main program, which is delayed by
+ * the time of the interrupt. The windows go through the real model, so timing
+ * errors show in the detections.
+ *
+ * Usage: acq_sim [-k hop] [-c confidence] [-b step_neurons] [-r read_us] [-q convert_us]
+ *                [-e neuron_us] [-j latency_us] [-x stall_ms] model.bin data.csv
+ ******************************************************************************
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "neuton/neuton.h"
+#include "acquisition/acquisition.h"
+
+
+#define MAX_LINE_LENGTH		(1 << 16)
+
+#define G					9.80665f
+#define DEG_TO_RAD			0.017453292519943295f
+
+#define SAMPLE_PERIOD_US	10000u
+#define ACC_THRESHOLD		(5 * 2048 / 2)
+#define GAP_SAMPLES			100
+#define LOOP_PASS_US		20.0
+#define SERIAL_CHAR_US		86.8
+#define SERIAL_BUFFER		64
+#define REPORT_CHARS		38
+
+
+typedef enum Mode_
+{
+	MODE_DELAY,
+	MODE_MILLIS,
+	MODE_TIMER,
+	MODES
+
+} Mode;
+
+
+static const char* modeNames[MODES] = { "delay(10)", "millis()", "timer + ring" };
+
+
+typedef struct Stream_
+{
+	int16_t* counts;
+	int16_t* targets;
+	uint32_t samples;
+	uint32_t capacity;
+
+} Stream;
+
+
+/**
+ * \brief Modelled time of the actions on the target, in microseconds
+ */
+typedef struct Costs_
+{
+	double read;
+	double convert;
+	double neuron;
+	double latency;
+	double stall;
+
+} Costs;
+
+
+/**
+ * \brief State of one simulated run
+ */
+typedef struct Sim_
+{
+	const Stream* stream;
+	const Costs*  costs;
+	NeuralNet*    model;
+	NStream       window;
+	Mode          mode;
+
+	double        now;
+	double        nextTimer;
+	double        nextStall;
+	double        serialFree;
+	uint32_t      seed;
+
+	AcqRing       ring;
+	AcqStats      stats;
+	double*       intervals;
+	uint32_t      intervalsCount;
+	uint32_t      lastTime;
+
+	uint8_t       running;
+	int16_t       lastGesture;
+	uint32_t      inferences;
+	uint32_t      detected;
+	uint32_t      wrong;
+	uint32_t      outside;
+	uint8_t*      found;
+
+	/**
+	 * \brief First sample of the latest gesture at every sample, UINT32_MAX before the first one
+	 */
+	const uint32_t* onsets;
+
+} Sim;
+
+
+static int16_t ToCount(float value, float unit)
+{
+	const double count = nearbyint(value / unit);
+
+	return count > INT16_MAX ? INT16_MAX : count < INT16_MIN ? INT16_MIN : (int16_t) count;
+}
+
+
+static void Append(Stream* stream, const int16_t* counts, int16_t target)
+{
+	if (stream->samples == stream->capacity)
+	{
+		stream->capacity = stream->capacity ? stream->capacity * 2 : 1024;
+		stream->counts  = realloc(stream->counts, (size_t) stream->capacity * ACQ_CHANNELS * sizeof(int16_t));
+		stream->targets = realloc(stream->targets, (size_t) stream->capacity * sizeof(int16_t));
+	}
+
+	memcpy(stream->counts + (size_t) stream->samples * ACQ_CHANNELS, counts, ACQ_CHANNELS * sizeof(int16_t));
+	stream->targets[stream->samples++] = target;
+}
+
+
+/**
+ * \brief Append samples of a device lying still, with a little deterministic noise
+ */
+static void AppendRest(Stream* stream, const float* units, uint32_t samples)
+{
+	static uint32_t seed = 1;
+	int16_t counts[ACQ_CHANNELS];
+
+	for (uint32_t s = 0; s < samples; ++s)
+	{
+		for (uint16_t ch = 0; ch < ACQ_CHANNELS; ++ch)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const float noise = ((seed >> 8) / 16777216.0f - 0.5f) * (ch < 3 ? 0.1f : 0.02f);
+			const float rest = (ch == 0 || ch == 1) ? -0.4f : (ch == 2) ? 9.2f : 0.0f;
+
+			counts[ch] = ToCount(rest + noise, units[ch]);
+		}
+
+		Append(stream, counts, -1);
+	}
+}
+
+
+/**
+ * \brief Read the windows of the CSV file into a stream with rest between them
+ * \return number of samples
+ */
+static uint32_t ReadStream(const char* fileName, const float* units, uint32_t windowCounts, Stream* stream)
+{
+	FILE* file = fopen(fileName, "r");
+	if (!file)
+		return 0;
+
+	char* line = malloc(MAX_LINE_LENGTH);
+	float* values = malloc((windowCounts + 1) * sizeof(float));
+	int16_t counts[ACQ_CHANNELS];
+
+	if (!line || !values || !fgets(line, MAX_LINE_LENGTH, file))
+	{
+		free(values);
+		free(line);
+		fclose(file);
+		return 0;
+	}
+
+	while (fgets(line, MAX_LINE_LENGTH, file))
+	{
+		uint32_t count = 0;
+		char* pos = line;
+
+		while (count <= windowCounts)
+		{
+			char* end;
+			values[count] = strtof(pos, &end);
+			if (end == pos)
+				break;
+
+			count++;
+			pos = (*end == ',') ? end + 1 : end;
+		}
+
+		if (count < windowCounts)
+			continue;
+
+		AppendRest(stream, units, GAP_SAMPLES);
+
+		for (uint32_t first = 0; first < windowCounts; first += ACQ_CHANNELS)
+		{
+			for (uint16_t ch = 0; ch < ACQ_CHANNELS; ++ch)
+				counts[ch] = ToCount(values[first + ch], units[ch]);
+
+			Append(stream, counts, count > windowCounts ? (int16_t) values[windowCounts] : 0);
+		}
+	}
+
+	AppendRest(stream, units, GAP_SAMPLES);
+
+	free(values);
+	free(line);
+	fclose(file);
+
+	return stream->samples;
+}
+
+
+static int CompareDouble(const void* a, const void* b)
+{
+	const double x = *(const double*) a, y = *(const double*) b;
+
+	return (x > y) - (x < y);
+}
+
+
+/**
+ * \brief Read the sensor registers at the current time
+ */
+static const int16_t* SensorSample(const Sim* sim, double time)
+{
+	uint32_t index = (uint32_t) (time / SAMPLE_PERIOD_US);
+	if (index >= sim->stream->samples)
+		index = sim->stream->samples - 1;
+
+	return sim->stream->counts + (size_t) index * ACQ_CHANNELS;
+}
+
+
+/**
+ * \brief Run the timer interrupt: read the sensor into the ring
+ */
+static void TimerInterrupt(Sim* sim, double time)
+{
+	AcqSample* sample = AcqRingWriteSlot(&sim->ring);
+
+	if (sample)
+	{
+		sample->time = (uint32_t) time;
+		memcpy(sample->counts, SensorSample(sim, time + sim->costs->read / 2), sizeof(sample->counts));
+		AcqRingCommit(&sim->ring);
+	}
+}
+
+
+/**
+ * \brief Spend time of the main program, interrupts due meanwhile run and delay it
+ */
+static void Spend(Sim* sim, double duration)
+{
+	double end = sim->now + duration;
+
+	while (sim->mode == MODE_TIMER && sim->nextTimer < end)
+	{
+		sim->seed = sim->seed * 1664525u + 1013904223u;
+
+		// Entry is delayed by the other interrupts, the timer keeps its own period
+		const double entry = sim->nextTimer + (sim->seed >> 8) / 16777216.0 * sim->costs->latency;
+
+		TimerInterrupt(sim, entry);
+		end += sim->costs->read;
+		sim->nextTimer += SAMPLE_PERIOD_US;
+	}
+
+	sim->now = end;
+}
+
+
+/**
+ * \brief Print over Serial, blocks while the transmit buffer is full
+ */
+static void SerialPrint(Sim* sim, uint32_t chars)
+{
+	const double queued = sim->serialFree > sim->now ? (sim->serialFree - sim->now) / SERIAL_CHAR_US : 0;
+	const double overflow = queued + chars - SERIAL_BUFFER;
+
+	sim->serialFree = (sim->serialFree > sim->now ? sim->serialFree : sim->now) + chars * SERIAL_CHAR_US;
+
+	if (overflow > 0)
+		Spend(sim, overflow * SERIAL_CHAR_US);
+}
+
+
+/**
+ * \brief Block the main program now and then, as a long Serial or SD card write does
+ */
+static void Stall(Sim* sim)
+{
+	if (sim->costs->stall > 0 && sim->now >= sim->nextStall)
+	{
+		Spend(sim, sim->costs->stall);
+		sim->nextStall += 1e6;
+	}
+}
+
+
+/**
+ * \brief Report the result the same way as the sketch, match it with the gestures
+ */
+static void Report(Sim* sim, float* result, float confidence, uint32_t hop)
+{
+	const uint32_t windowSamples = (sim->model->inputsDim - 1u) / ACQ_CHANNELS;
+	int16_t gesture = -1;
+
+	// The same as CalculatorInferenceStep
+	NDenormalizeResult(result, sim->model);
+	sim->inferences++;
+
+	for (uint16_t idx = 0; idx < sim->model->outputsDim; ++idx)
+		if (result[idx] > confidence)
+			gesture = idx;
+
+	const uint8_t reported = gesture >= 0 && (hop == 0 || gesture != sim->lastGesture);
+	sim->lastGesture = gesture;
+
+	if (!reported)
+		return;
+
+	SerialPrint(sim, REPORT_CHARS);
+
+	// A detection belongs to the latest gesture until one more window has passed after it
+	uint32_t index = (uint32_t) (sim->now / SAMPLE_PERIOD_US);
+	if (index >= sim->stream->samples)
+		index = sim->stream->samples - 1;
+
+	const uint32_t onset = sim->onsets[index];
+
+	if (onset == UINT32_MAX || index >= onset + 2 * windowSamples)
+		sim->outside++;
+	else if (sim->stream->targets[onset] != gesture)
+		sim->wrong++;
+	else if (!sim->found[onset])
+		sim->found[onset] = 1, sim->detected++;
+}
+
+
+/**
+ * \brief Process one sample read at time, the same way in every mode
+ * \return 1 if an inference is due
+ */
+static uint8_t ConsumeSample(Sim* sim, const int16_t* counts, uint32_t time)
+{
+	if (sim->stats.samples)
+		sim->intervals[sim->intervalsCount++] = (double) (time - sim->lastTime);
+
+	AcqStatsAdd(&sim->stats, time);
+	sim->lastTime = time;
+
+	if (labs(counts[0]) + labs(counts[1]) + labs(counts[2]) >= ACC_THRESHOLD)
+		NStreamTrigger(&sim->window, 0);
+
+	return NStreamPush(&sim->window, counts);
+}
+
+
+static void StartInference(Sim* sim)
+{
+	NRawView view;
+
+	NStreamView(&sim->window, &view);
+	NStartRawInference(sim->model, &sim->model->context, &view);
+	Spend(sim, sim->costs->convert);
+	sim->running = 1;
+}
+
+
+/**
+ * \brief Run the loop of the sketch in the mode until the stream ends
+ */
+static void Run(Sim* sim, uint32_t hop, float confidence, uint32_t budget)
+{
+	const double end = (double) sim->stream->samples * SAMPLE_PERIOD_US;
+	const uint32_t neurons = sim->model->executionCount;
+	uint32_t lastMillis = 0;
+	AcqSample sample;
+
+	while (sim->now < end)
+	{
+		Stall(sim);
+
+		switch (sim->mode)
+		{
+		case MODE_DELAY:
+		{
+			// Original loop: read, blocking inference, report, delay(10)
+			const uint32_t time = (uint32_t) sim->now;
+
+			Spend(sim, sim->costs->read);
+			if (ConsumeSample(sim, SensorSample(sim, sim->now - sim->costs->read / 2), time))
+			{
+				StartInference(sim);
+				Spend(sim, sim->costs->neuron * neurons);
+				Report(sim, NInferenceStep(sim->model, &sim->model->context, neurons), confidence, hop);
+				sim->running = 0;
+			}
+
+			Spend(sim, SAMPLE_PERIOD_US);
+			continue;
+		}
+
+		case MODE_MILLIS:
+		{
+			// A sample when millis() passes the next 10 ms, inference steps in between
+			Spend(sim, LOOP_PASS_US);
+
+			const uint32_t millis = (uint32_t) (sim->now / 1000);
+			if (millis - lastMillis >= SAMPLE_PERIOD_US / 1000)
+			{
+				const uint32_t time = (uint32_t) sim->now;
+
+				lastMillis += SAMPLE_PERIOD_US / 1000;
+				Spend(sim, sim->costs->read);
+
+				if (ConsumeSample(sim, SensorSample(sim, sim->now - sim->costs->read / 2), time))
+					StartInference(sim);
+			}
+			break;
+		}
+
+		default:
+			// Samples read by the timer interrupt, taken from the ring
+			Spend(sim, LOOP_PASS_US);
+
+			while (AcqRingRead(&sim->ring, &sample))
+				if (ConsumeSample(sim, sample.counts, sample.time))
+					StartInference(sim);
+			break;
+		}
+
+		if (sim->running)
+		{
+			Spend(sim, sim->costs->neuron * (budget < neurons ? budget : neurons));
+
+			float* result = NInferenceStep(sim->model, &sim->model->context, budget);
+			if (result)
+			{
+				sim->running = 0;
+				Report(sim, result, confidence, hop);
+			}
+		}
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	const float units[ACQ_CHANNELS] = {
+		G / 2048, G / 2048, G / 2048,
+		DEG_TO_RAD / 131.0f, DEG_TO_RAD / 131.0f, DEG_TO_RAD / 131.0f
+	};
+	Costs costs = { 450, 100, 25, 10, 0 };
+	uint32_t hop = 10, budget = 2;
+	float confidence = 0.6f;
+	int arg = 1;
+
+	for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2)
+	{
+		const double value = atof(argv[arg + 1]);
+
+		switch (argv[arg][1])
+		{
+		case 'k': hop = (uint32_t) value; break;
+		case 'c': confidence = (float) value; break;
+		case 'b': budget = (uint32_t) value; break;
+		case 'r': costs.read = value; break;
+		case 'q': costs.convert = value; break;
+		case 'e': costs.neuron = value; break;
+		case 'j': costs.latency = value; break;
+		case 'x': costs.stall = value * 1000; break;
+		default:  arg = argc; break;
+		}
+	}
+
+	if (argc - arg != 2 || !budget || hop > UINT16_MAX)
+	{
+		fprintf(stderr, "Usage: %s [-k hop] [-c confidence] [-b step_neurons] [-r read_us] [-q convert_us]\n"
+				"       [-e neuron_us] [-j latency_us] [-x stall_ms] model.bin data.csv\n", argv[0]);
+		return 1;
+	}
+
+	NeuralNet model = { 0 };
+	if (NLoadModelEx(argv[arg], &model) != ERR_NO_ERROR ||
+		NSetRawInputs(&model, units, ACQ_CHANNELS, 1.0f) != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Failed to load %s with raw inputs\n", argv[arg]);
+		return 1;
+	}
+
+	Stream stream = { 0 };
+	const uint32_t windowCounts = model.inputsDim - 1u;
+	int16_t* ring = malloc(windowCounts * sizeof(int16_t));
+
+	if (!ReadStream(argv[arg + 1], units, windowCounts, &stream) || !ring)
+	{
+		fprintf(stderr, "No windows of %u values in %s\n", windowCounts, argv[arg + 1]);
+		return 1;
+	}
+
+	uint32_t* onsets = malloc(stream.samples * sizeof(uint32_t));
+	uint32_t gestures = 0;
+
+	for (uint32_t s = 0; s < stream.samples; ++s)
+	{
+		const uint8_t first = stream.targets[s] >= 0 && (s == 0 || stream.targets[s - 1] != stream.targets[s]);
+
+		gestures += first;
+		onsets[s] = first ? s : s ? onsets[s - 1] : UINT32_MAX;
+	}
+
+	printf("stream: %u samples (%.1f s), %u gestures; read %.0f us, convert %.0f us, neuron %.0f us, "
+		   "interrupt latency up to %.0f us, stall %.0f ms/s\n\n",
+		   stream.samples, stream.samples * SAMPLE_PERIOD_US * 1e-6, gestures,
+		   costs.read, costs.convert, costs.neuron, costs.latency, costs.stall / 1000);
+	printf("sampling,rate Hz,interval min us,interval max us,jitter p99 us,jitter max us,"
+		   "missed samples,overruns,inferences,detected,wrong class,outside gestures\n");
+
+	for (Mode mode = 0; mode < MODES; ++mode)
+	{
+		Sim sim;
+
+		memset(&sim, 0, sizeof(sim));
+		sim.stream      = &stream;
+		sim.costs       = &costs;
+		sim.model       = &model;
+		sim.mode        = mode;
+		sim.seed        = 1;
+		sim.nextTimer   = SAMPLE_PERIOD_US;
+		sim.nextStall   = 1e6;
+		sim.lastGesture = -1;
+		sim.intervals   = malloc(stream.samples * 2 * sizeof(double));
+		sim.found       = calloc(stream.samples, 1);
+		sim.onsets      = onsets;
+
+		AcqRingInit(&sim.ring);
+		AcqStatsInit(&sim.stats, SAMPLE_PERIOD_US);
+		NStreamInit(&sim.window, &model, ring, ACQ_CHANNELS, (uint16_t) hop);
+
+		Run(&sim, hop, confidence, budget);
+
+		// Jitter is the deviation of an interval from the period
+		for (uint32_t idx = 0; idx < sim.intervalsCount; ++idx)
+			sim.intervals[idx] = fabs(sim.intervals[idx] - SAMPLE_PERIOD_US);
+		qsort(sim.intervals, sim.intervalsCount, sizeof(double), CompareDouble);
+
+		const double p99 = sim.intervalsCount ? sim.intervals[(sim.intervalsCount - 1) * 99 / 100] : 0;
+		const uint32_t nominal = (sim.stats.lastTime - sim.stats.firstTime + SAMPLE_PERIOD_US / 2) /
+								 SAMPLE_PERIOD_US + 1;
+
+		printf("%s,%.2f,%u,%u,%.0f,%u,%u,%u,%u,%u/%u,%u,%u\n", modeNames[mode],
+			   AcqStatsRate(&sim.stats), sim.stats.minInterval, sim.stats.maxInterval, p99,
+			   AcqStatsJitter(&sim.stats), nominal > sim.stats.samples ? nominal - sim.stats.samples : 0,
+			   AcqRingOverruns(&sim.ring), sim.inferences, sim.detected, gestures, sim.wrong, sim.outside);
+
+		free(sim.found);
+		free(sim.intervals);
+	}
+
+	free(onsets);
+	free(ring);
+	free(stream.targets);
+	free(stream.counts);
+	NFreeModel(&model);
+
+	return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ ******************************************************************************
+ * @file    alloc_check.c
+ * @brief   Check of the loads with no heap allocations (NLoadModelInto) and of
+ *          the arena size given by NModelMemoryRequirements
+ *
+ * malloc, calloc and realloc are wrapped by the linker and counted while the
+ * model is loaded into the arena, run and freed. The arena of exactly the
+ * required size is placed one byte past the pointer alignment, the worst
+ * address, and must load. One byte less must fail with ERR_MEMORY_ALLOCATION.
+ * Every model is checked with the sections copied into the arena and used in
+ * place.
+ *
+ * Build with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (GNU ld).
+ *
+ * Usage: alloc_check [-n inferences] model.bin...
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "neuton/neuton.h"
+
+
+#define DEFAULT_INFERENCES		100
+
+
+/**
+ * \brief Heap calls counted while the flag is set
+ */
+static uint8_t  counting;
+static uint32_t heapCalls;
+
+extern void* __real_malloc(size_t size);
+extern void* __real_calloc(size_t count, size_t size);
+extern void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size)
+{
+	heapCalls += counting;
+	return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+	heapCalls += counting;
+	return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+	heapCalls += counting;
+	return __real_realloc(ptr, size);
+}
+
+
+#if defined(NEUTON_MEMORY_BENCHMARK)
+uint32_t _NeutonExtraMemoryUsage()
+{
+	return 0;
+}
+#endif
+
+
+/**
+ * \brief Heap calls of one phase of the check
+ */
+typedef struct Calls_
+{
+	uint32_t load;
+	uint32_t inference;
+	uint32_t free;
+
+} Calls;
+
+
+/**
+ * \brief Load the model into the arena, run seeded samples and free it, counting heap calls
+ * \param calls - heap calls of every phase
+ * \return error code of the load
+ */
+static Err RunInArena(uint8_t* arena, uint32_t arenaSize, const uint8_t* data, uint32_t size, uint8_t copy,
+					  uint32_t inferences, Calls* calls)
+{
+	NeuralNet model;
+	memset(&model, 0, sizeof(model));
+
+	heapCalls = 0;
+	counting  = 1;
+	const Err err = NLoadModelInto(arena, arenaSize, data, size, &model, copy);
+	counting  = 0;
+	calls->load = heapCalls;
+
+	if (err != ERR_NO_ERROR)
+		return err;
+
+	// Samples are made before counting, the inference may normalise them in place
+	const uint32_t inputsDim = model.inputsDim;
+	float* samples = malloc(2 * inputsDim * sizeof(float));
+	if (!samples)
+		return ERR_MEMORY_ALLOCATION;
+
+	srand(1);
+
+	heapCalls = 0;
+	for (uint32_t run = 0; run < inferences; run++)
+	{
+		// The last input is the bias, fed as 1 as the model was trained
+		for (uint32_t idx = 0; idx < inputsDim; idx++)
+			samples[idx] = (idx == inputsDim - 1u) ? 1.0f : (float) rand() / RAND_MAX;
+
+		counting = 1;
+		const float* outputs = NRunInference(&model, samples);
+		counting = 0;
+
+		if (!outputs)
+		{
+			fprintf(stderr, "Inference failed\n");
+			break;
+		}
+	}
+	calls->inference = heapCalls;
+
+	heapCalls = 0;
+	counting  = 1;
+	NFreeModel(&model);
+	counting  = 0;
+	calls->free = heapCalls;
+
+	free(samples);
+
+	return err;
+}
+
+
+static uint8_t* ReadFile(const char* fileName, uint32_t* size)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
+		return NULL;
+
+	fseek(file, 0, SEEK_END);
+	const long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	uint8_t* data = (length > 0) ? malloc(length) : NULL;
+	if (data && fread(data, length, 1, file) != 1)
+	{
+		free(data);
+		data = NULL;
+	}
+
+	fclose(file);
+	*size = length;
+
+	return data;
+}
+
+
+/**
+ * \brief Check one model with the sections copied into the arena or used in place
+ * \return 0 if the check passed, -1 otherwise
+ */
+static int CheckModel(const char* name, const uint8_t* data, uint32_t size, uint8_t copy, uint32_t inferences)
+{
+	const uint32_t required = NModelMemoryRequirements(data, size, copy);
+	if (!required)
+	{
+		fprintf(stderr, "%s: the model can not be loaded\n", name);
+		return -1;
+	}
+
+	// malloc aligns by the pointer size at least, the arena starts one byte past it
+	uint8_t* memory = malloc(required + 1);
+	if (!memory)
+		return -1;
+
+	Calls calls = { 0, 0, 0 };
+	Calls shorter = { 0, 0, 0 };
+	Calls aligned = { 0, 0, 0 };
+
+	const Err exact   = RunInArena(memory + 1, required, data, size, copy, inferences, &calls);
+	const Err less    = RunInArena(memory + 1, required - 1, data, size, copy, 0, &shorter);
+	const Err atStart = RunInArena(memory, required, data, size, copy, 0, &aligned);
+
+	free(memory);
+
+	const uint32_t heap = calls.load + calls.inference + calls.free + shorter.load + aligned.load;
+	const int passed = exact == ERR_NO_ERROR && less == ERR_MEMORY_ALLOCATION && atStart == ERR_NO_ERROR &&
+			heap == 0;
+
+	printf("%-24s %-8s arena %8u B: load %d, %u inferences; %u B: load %d; aligned: load %d; "
+		   "heap calls %u + %u + %u  %s\n",
+		   name, copy ? "copy" : "in place", required, exact, inferences, required - 1, less, atStart,
+		   calls.load + shorter.load + aligned.load, calls.inference, calls.free, passed ? "ok" : "FAILED");
+
+	return passed ? 0 : -1;
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t inferences = DEFAULT_INFERENCES;
+
+	int arg = 1;
+	for (; arg < argc && argv[arg][0] == '-'; arg++)
+	{
+		if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+			inferences = (uint32_t) strtoul(argv[++arg], NULL, 10);
+		else
+			break;
+	}
+
+	if (arg >= argc)
+	{
+		fprintf(stderr, "Usage: %s [-n inferences] model.bin...\n", argv[0]);
+		return 2;
+	}
+
+	uint32_t failed = 0, checked = 0;
+	for (; arg < argc; arg++)
+	{
+		uint32_t size = 0;
+		uint8_t* data = ReadFile(argv[arg], &size);
+		if (!data)
+		{
+			fprintf(stderr, "Failed to read %s\n", argv[arg]);
+			failed++;
+			continue;
+		}
+
+		for (uint8_t copy = 0; copy < 2; copy++, checked++)
+			failed += CheckModel(argv[arg], data, size, copy, inferences) != 0;
+
+		free(data);
+	}
+
+	printf("%u of %u checks failed\n", failed, checked);
+
+	return failed ? 1 : 0;
+}
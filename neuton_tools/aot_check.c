@@ -0,0 +1,204 @@
+/**
+ ******************************************************************************
+ * @file    aot_check.c
+ * @brief   Differential test and benchmark of the neuton_aot generated source
+ *          against the Neuton interpreter
+ *
+ * The generated file must be produced with "-p aot_" and linked together with
+ * the Neuton library, see README.md.
+ *
+ * Usage: aot_check model.bin data.csv [repeats]
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "neuton/neuton.h"
+
+
+extern uint8_t aot_model_init();
+extern float*  aot_model_run_inference(float* sample, uint32_t size_in, uint32_t* size_out);
+
+
+#define MAX_LINE_LENGTH		(1 << 16)
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * \brief Run the interpreter the same way as CalculatorRunInference
+ */
+static float* RunInterpreter(NeuralNet* model, float* sample)
+{
+	NPrepareSample(sample, model);
+
+	float* result = NRunPreparedInference(model, sample);
+	if (result)
+		NDenormalizeResult(result, model);
+
+	return result;
+}
+
+
+/**
+ * \brief Read CSV rows into samples, extra columns (target) are ignored and bias is set to 1.0
+ * \return number of samples
+ */
+static uint32_t ReadCsv(const char* fileName, uint16_t inputsDim, float** samples)
+{
+	FILE* file = fopen(fileName, "r");
+	if (!file)
+		return 0;
+
+	char* line = malloc(MAX_LINE_LENGTH);
+	uint32_t count = 0, capacity = 0;
+	*samples = NULL;
+
+	if (!line || !fgets(line, MAX_LINE_LENGTH, file))
+	{
+		free(line);
+		fclose(file);
+		return 0;
+	}
+
+	while (fgets(line, MAX_LINE_LENGTH, file))
+	{
+		if (count == capacity)
+		{
+			capacity = capacity ? capacity * 2 : 64;
+			*samples = realloc(*samples, (size_t) capacity * inputsDim * sizeof(float));
+		}
+
+		float* sample = *samples + (size_t) count * inputsDim;
+		char* pos = line;
+
+		for (uint16_t idx = 0; idx < inputsDim - 1; ++idx)
+		{
+			char* end;
+			sample[idx] = strtof(pos, &end);
+			pos = (*end == ',') ? end + 1 : end;
+		}
+		sample[inputsDim - 1] = 1.0f;
+
+		count++;
+	}
+
+	free(line);
+	fclose(file);
+
+	return count;
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s model.bin data.csv [repeats]\n", argv[0]);
+		return 1;
+	}
+
+	const uint32_t repeats = argc > 3 ? (uint32_t) atoi(argv[3]) : 1000;
+
+	NeuralNet model = { 0 };
+	if (NLoadModelEx(argv[1], &model) != ERR_NO_ERROR || !aot_model_init())
+	{
+		fprintf(stderr, "Failed to load %s\n", argv[1]);
+		return 1;
+	}
+
+	float* samples = NULL;
+	const uint32_t count = ReadCsv(argv[2], model.inputsDim, &samples);
+	if (!count)
+	{
+		fprintf(stderr, "No samples in %s\n", argv[2]);
+		return 1;
+	}
+
+	float* sample = malloc(model.inputsDim * sizeof(float));
+	uint32_t mismatches = 0, argmaxMismatches = 0;
+	double maxDiff = 0;
+
+	for (uint32_t s = 0; s < count; ++s)
+	{
+		float expected[64], actual[64];
+		uint32_t outputsDim = 0;
+
+		memcpy(sample, samples + (size_t) s * model.inputsDim, model.inputsDim * sizeof(float));
+		float* result = RunInterpreter(&model, sample);
+		memcpy(expected, result, model.outputsDim * sizeof(float));
+
+		memcpy(sample, samples + (size_t) s * model.inputsDim, model.inputsDim * sizeof(float));
+		result = aot_model_run_inference(sample, model.inputsDim, &outputsDim);
+		memcpy(actual, result, outputsDim * sizeof(float));
+
+		if (outputsDim != model.outputsDim || memcmp(expected, actual, outputsDim * sizeof(float)) != 0)
+			mismatches++;
+
+		uint16_t expectedMax = 0, actualMax = 0;
+		for (uint16_t idx = 0; idx < model.outputsDim; ++idx)
+		{
+			const double diff = expected[idx] > actual[idx] ?
+					expected[idx] - actual[idx] : actual[idx] - expected[idx];
+			if (diff > maxDiff)
+				maxDiff = diff;
+
+			if (expected[idx] > expected[expectedMax])
+				expectedMax = idx;
+			if (actual[idx] > actual[actualMax])
+				actualMax = idx;
+		}
+
+		argmaxMismatches += expectedMax != actualMax;
+	}
+
+	double interpreterTime = 0, generatedTime = 0;
+	volatile float sink = 0;
+
+	for (uint32_t r = 0; r < repeats; ++r)
+	{
+		uint32_t outputsDim;
+		double start = Now();
+
+		for (uint32_t s = 0; s < count; ++s)
+		{
+			memcpy(sample, samples + (size_t) s * model.inputsDim, model.inputsDim * sizeof(float));
+			sink += RunInterpreter(&model, sample)[0];
+		}
+
+		interpreterTime += Now() - start;
+		start = Now();
+
+		for (uint32_t s = 0; s < count; ++s)
+		{
+			memcpy(sample, samples + (size_t) s * model.inputsDim, model.inputsDim * sizeof(float));
+			sink += aot_model_run_inference(sample, model.inputsDim, &outputsDim)[0];
+		}
+
+		generatedTime += Now() - start;
+	}
+
+	const double runs = (double) repeats * count;
+
+	printf("samples:      %u\n", count);
+	printf("mismatches:   %u (argmax %u, max abs diff %g)\n", mismatches, argmaxMismatches, maxDiff);
+	printf("interpreter:  %.1f ns/inference\n", interpreterTime / runs * 1e9);
+	printf("generated:    %.1f ns/inference\n", generatedTime / runs * 1e9);
+
+	free(sample);
+	free(samples);
+	NFreeModel(&model);
+
+	return mismatches ? 2 : 0;
+}
@@ -0,0 +1,623 @@
+/**
+ ******************************************************************************
+ * @file    capture_decode.c
+ * @brief   Host decoder of the binary frames of neuton_csvcapture (BINARY_FRAMES)
+ *
+ * The frames are read from a serial device, a pseudo terminal or a file of
+ * recorded bytes and the complete gestures are written as CSV in the format
+ * of trainingdata.csv and/or as a binary dataset for NOpenDataset. Damaged
+ * frames and gestures with lost samples are counted and left out. The report
+ * gives the bytes per gesture of both formats and the sample period achieved
+ * on the board, from the time stamps of the samples.
+ *
+ * With -e the tool stands in for the board: it sends the gestures of a CSV
+ * file as frames to a file or to a new pseudo terminal ("pty").
+ *
+ * Usage: capture_decode [-o data.csv] [-d dataset.bin] [-n gestures] [-B baud] input
+ *        capture_decode -e data.csv [-t period_us] [-z corrupt_every] output|pty
+ ******************************************************************************
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "frame/frame.h"
+
+
+#define MAX_LINE_LENGTH		(1 << 16)
+#define MAX_SAMPLES			255
+
+#define G					9.80665f
+#define DEG_TO_RAD			0.017453292519943295f
+
+#define DATASET_TYPE		1
+#define DATASET_BOM			0xABCD
+
+
+typedef struct Decoder_
+{
+	FrameInfo   info;
+	FrameSample samples[MAX_SAMPLES];
+	uint8_t     haveInfo;
+	uint8_t     count;
+	uint8_t     haveSequence;
+	uint16_t    nextSequence;
+
+	FILE*       csv;
+	FILE*       dataset;
+	uint32_t    datasetRows;
+	uint8_t     headerWritten;
+
+	uint64_t    bytes;
+	uint32_t    frames;
+	uint32_t    gestures;
+	uint32_t    dropped;
+	uint32_t    lostSamples;
+	uint64_t    csvBytes;
+
+	uint32_t*   intervals;
+	uint32_t    intervalsCount;
+	uint32_t    intervalsCapacity;
+
+} Decoder;
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static speed_t BaudConstant(long baud)
+{
+	switch (baud)
+	{
+	case 9600:    return B9600;
+	case 19200:   return B19200;
+	case 38400:   return B38400;
+	case 57600:   return B57600;
+	case 115200:  return B115200;
+	case 230400:  return B230400;
+	case 460800:  return B460800;
+	case 500000:  return B500000;
+	case 1000000: return B1000000;
+	case 2000000: return B2000000;
+	default:      return B0;
+	}
+}
+
+
+/**
+ * \brief Put a terminal into raw mode, so no byte of a frame is translated or swallowed
+ */
+static int SetRaw(int fd, speed_t speed)
+{
+	struct termios tio;
+
+	if (tcgetattr(fd, &tio) != 0)
+		return -1;
+
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN]  = 1;
+	tio.c_cc[VTIME] = 0;
+
+	if (speed != B0)
+	{
+		cfsetispeed(&tio, speed);
+		cfsetospeed(&tio, speed);
+	}
+
+	return tcsetattr(fd, TCSANOW, &tio);
+}
+
+
+static void WriteCsvHeader(Decoder* decoder)
+{
+	static const char* names[FRAME_CHANNELS] = { "aX", "aY", "aZ", "gX", "gY", "gZ" };
+
+	for (uint32_t s = 0; s < decoder->info.samples; ++s)
+		for (uint32_t ch = 0; ch < FRAME_CHANNELS; ++ch)
+			fprintf(decoder->csv, "%s%u,", names[ch], s);
+
+	fprintf(decoder->csv, "target\n");
+}
+
+
+/**
+ * \brief Start the dataset: header, end of data (written at the end) and a reserved word
+ */
+static void WriteDatasetHeader(FILE* file)
+{
+	const uint8_t head[4] = { 'n', 'b', DATASET_TYPE, 1 };
+	const uint16_t bom = DATASET_BOM;
+	const uint32_t reserved[2] = { 0, 0 };
+
+	fwrite(head, sizeof(head), 1, file);
+	fwrite(&bom, sizeof(bom), 1, file);
+	fwrite(reserved, sizeof(reserved), 1, file);
+}
+
+
+/**
+ * \brief Close the dataset: sample dimension after the data and the end of data in the header
+ */
+static int FinishDataset(FILE* file, uint32_t sampleDim)
+{
+	const long endDataPos = ftell(file);
+	const uint32_t end = (uint32_t) endDataPos;
+
+	if (endDataPos < 0 || fwrite(&sampleDim, sizeof(sampleDim), 1, file) != 1 ||
+		fseek(file, 6, SEEK_SET) != 0 || fwrite(&end, sizeof(end), 1, file) != 1)
+		return -1;
+
+	return fclose(file);
+}
+
+
+static void AddInterval(Decoder* decoder, uint32_t interval)
+{
+	if (decoder->intervalsCount == decoder->intervalsCapacity)
+	{
+		decoder->intervalsCapacity = decoder->intervalsCapacity ? decoder->intervalsCapacity * 2 : 1024;
+		decoder->intervals = realloc(decoder->intervals, decoder->intervalsCapacity * sizeof(uint32_t));
+	}
+
+	decoder->intervals[decoder->intervalsCount++] = interval;
+}
+
+
+static void WriteGesture(Decoder* decoder)
+{
+	const FrameInfo* info = &decoder->info;
+	char value[32];
+
+	if (!decoder->headerWritten)
+	{
+		if (decoder->csv)
+			WriteCsvHeader(decoder);
+		if (decoder->dataset)
+			WriteDatasetHeader(decoder->dataset);
+
+		decoder->headerWritten = 1;
+	}
+
+	for (uint32_t s = 0; s < info->samples; ++s)
+	{
+		const FrameSample* sample = &decoder->samples[s];
+
+		if (s)
+			AddInterval(decoder, sample->time - decoder->samples[s - 1].time);
+
+		for (uint32_t ch = 0; ch < FRAME_CHANNELS; ++ch)
+		{
+			const float physical = sample->counts[ch] * info->units[ch];
+
+			// The same text as Serial.print(value, 3) of the text mode
+			const int length = snprintf(value, sizeof(value), "%.3f,", physical);
+			decoder->csvBytes += length;
+
+			if (decoder->csv)
+				fputs(value, decoder->csv);
+			if (decoder->dataset)
+				fwrite(&physical, sizeof(physical), 1, decoder->dataset);
+		}
+	}
+
+	// Serial.println() ends the line of the text mode with "\r\n", the file with "\n"
+	decoder->csvBytes += snprintf(value, sizeof(value), "%u\n", decoder->samples[0].target) + 1;
+
+	if (decoder->csv)
+		fputs(value, decoder->csv);
+
+	decoder->datasetRows++;
+	decoder->gestures++;
+}
+
+
+static void OnSample(Decoder* decoder, const FrameSample* sample)
+{
+	if (decoder->haveSequence && sample->sequence != decoder->nextSequence)
+		decoder->lostSamples += (uint16_t) (sample->sequence - decoder->nextSequence);
+
+	const uint8_t continues = decoder->haveSequence && sample->sequence == decoder->nextSequence;
+
+	decoder->haveSequence = 1;
+	decoder->nextSequence = sample->sequence + 1;
+
+	if (!decoder->haveInfo)
+		return;
+
+	// A gesture is kept only with all of its samples, in order
+	if (sample->index == 0)
+	{
+		if (decoder->count)
+			decoder->dropped++;
+
+		decoder->count = 0;
+	}
+	else if (sample->index != decoder->count || !continues)
+	{
+		if (decoder->count)
+			decoder->dropped++;
+
+		decoder->count = 0;
+		return;
+	}
+
+	decoder->samples[decoder->count++] = *sample;
+
+	if (decoder->count == decoder->info.samples)
+	{
+		WriteGesture(decoder);
+		decoder->count = 0;
+	}
+}
+
+
+/**
+ * \brief Feed received bytes
+ * \return 1 after the end frame
+ */
+static int Decode(Decoder* decoder, FrameParser* parser, const uint8_t* data, size_t size)
+{
+	for (size_t idx = 0; idx < size; ++idx)
+	{
+		const uint8_t type = FrameParserPush(parser, data[idx]);
+		FrameInfo info;
+		FrameSample sample;
+		uint16_t gestures;
+
+		if (!type)
+			continue;
+
+		decoder->frames++;
+
+		if (FrameDecodeSample(parser, &sample))
+		{
+			OnSample(decoder, &sample);
+		}
+		else if (FrameDecodeInfo(parser, &info))
+		{
+			// The layout of the rows must not change within one output
+			if (info.samples == 0 || (decoder->headerWritten && info.samples != decoder->info.samples))
+				continue;
+
+			decoder->info = info;
+			decoder->haveInfo = 1;
+		}
+		else if (FrameDecodeEnd(parser, &gestures))
+		{
+			decoder->bytes += idx + 1;
+			return 1;
+		}
+	}
+
+	decoder->bytes += size;
+
+	return 0;
+}
+
+
+static int CompareUint32(const void* a, const void* b)
+{
+	const uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+
+	return (x > y) - (x < y);
+}
+
+
+static void Report(Decoder* decoder, const FrameParser* parser)
+{
+	printf("received:       %llu bytes, %u frames, %u CRC errors, %u bytes skipped\n",
+		   (unsigned long long) decoder->bytes, decoder->frames, parser->crcErrors, parser->skipped);
+	printf("gestures:       %u complete, %u dropped, %u samples lost\n",
+		   decoder->gestures, decoder->dropped, decoder->lostSamples);
+
+	if (!decoder->gestures)
+		return;
+
+	printf("bytes/gesture:  %.0f binary, %.0f as CSV text (%.2fx)\n",
+		   (double) decoder->bytes / decoder->gestures, (double) decoder->csvBytes / decoder->gestures,
+		   (double) decoder->csvBytes / decoder->bytes);
+
+	if (!decoder->intervalsCount)
+		return;
+
+	uint32_t* deviations = malloc(decoder->intervalsCount * sizeof(uint32_t));
+	double sum = 0;
+
+	for (uint32_t idx = 0; idx < decoder->intervalsCount; ++idx)
+	{
+		const uint32_t interval = decoder->intervals[idx];
+
+		sum += interval;
+		deviations[idx] = interval > decoder->info.period ? interval - decoder->info.period :
+														   decoder->info.period - interval;
+	}
+
+	qsort(decoder->intervals, decoder->intervalsCount, sizeof(uint32_t), CompareUint32);
+	qsort(deviations, decoder->intervalsCount, sizeof(uint32_t), CompareUint32);
+
+	printf("sample period:  nominal %u us, mean %.1f us, min %u us, max %u us\n",
+		   decoder->info.period, sum / decoder->intervalsCount, decoder->intervals[0],
+		   decoder->intervals[decoder->intervalsCount - 1]);
+	printf("deviation:      p50 %u us, p99 %u us, max %u us\n",
+		   deviations[decoder->intervalsCount / 2], deviations[(decoder->intervalsCount - 1) * 99 / 100],
+		   deviations[decoder->intervalsCount - 1]);
+
+	free(deviations);
+}
+
+
+static int RunDecoder(const char* input, const char* csvName, const char* datasetName, uint32_t maxGestures,
+					  long baud)
+{
+	const int fd = strcmp(input, "-") == 0 ? STDIN_FILENO : open(input, O_RDONLY | O_NOCTTY);
+
+	if (fd < 0)
+	{
+		fprintf(stderr, "Failed to open %s: %s\n", input, strerror(errno));
+		return 1;
+	}
+
+	if (isatty(fd) && SetRaw(fd, BaudConstant(baud)) != 0)
+	{
+		fprintf(stderr, "Failed to set up %s: %s\n", input, strerror(errno));
+		return 1;
+	}
+
+	Decoder decoder = { 0 };
+	FrameParser parser;
+	FrameParserInit(&parser);
+
+	decoder.csv     = csvName ? fopen(csvName, "wb") : NULL;
+	decoder.dataset = datasetName ? fopen(datasetName, "w+b") : NULL;
+
+	if ((csvName && !decoder.csv) || (datasetName && !decoder.dataset))
+	{
+		fprintf(stderr, "Failed to create the output\n");
+		return 1;
+	}
+
+	uint8_t buffer[4096];
+	ssize_t size;
+
+	while ((size = read(fd, buffer, sizeof(buffer))) > 0)
+	{
+		if (Decode(&decoder, &parser, buffer, (size_t) size) ||
+			(maxGestures && decoder.gestures >= maxGestures))
+			break;
+	}
+
+	if (size < 0 && errno != EIO)
+		fprintf(stderr, "Failed to read %s: %s\n", input, strerror(errno));
+
+	if (fd != STDIN_FILENO)
+		close(fd);
+
+	int res = 0;
+
+	if (decoder.csv)
+		res |= fclose(decoder.csv);
+
+	if (decoder.dataset)
+	{
+		if (!decoder.headerWritten)
+			WriteDatasetHeader(decoder.dataset);
+
+		res |= FinishDataset(decoder.dataset, decoder.info.samples * FRAME_CHANNELS);
+	}
+
+	if (res != 0)
+		fprintf(stderr, "Failed to write the output\n");
+
+	Report(&decoder, &parser);
+	free(decoder.intervals);
+
+	return res != 0;
+}
+
+
+static int16_t ToCount(float value, float unit)
+{
+	const double count = nearbyint(value / unit);
+
+	return count > INT16_MAX ? INT16_MAX : count < INT16_MIN ? INT16_MIN : (int16_t) count;
+}
+
+
+/**
+ * \brief Open the output of the board stand-in, "pty" creates a pseudo terminal
+ */
+static int OpenEmulatorOutput(const char* output)
+{
+	if (strcmp(output, "pty") != 0)
+		return open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	const int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0 || SetRaw(fd, B0) != 0)
+		return -1;
+
+	fprintf(stderr, "%s\n", ptsname(fd));
+
+	// The master reports a hang-up until the other side is opened
+	struct pollfd pfd = { fd, POLLOUT, 0 };
+
+	while (poll(&pfd, 1, 10) >= 0 && (pfd.revents & POLLHUP))
+		usleep(10000);
+
+	return fd;
+}
+
+
+/**
+ * \brief Write a frame, corrupting one byte in every corruptEvery bytes
+ */
+static int Send(int fd, uint8_t* frame, uint8_t size, uint32_t corruptEvery, uint64_t* sent)
+{
+	for (uint8_t idx = 0; idx < size && corruptEvery; ++idx)
+		if (++*sent % corruptEvery == 0)
+			frame[idx] ^= 0x10;
+
+	return write(fd, frame, size) == size ? 0 : -1;
+}
+
+
+static int RunEmulator(const char* csvName, const char* output, uint32_t period, uint32_t corruptEvery)
+{
+	// MPU6050 with MPU6050_RANGE_16_G and MPU6050_RANGE_250_DEG, as in the sketch
+	const FrameInfo base = {
+		FRAME_CHANNELS, 0, period ? period : 10000,
+		{ G / 2048, G / 2048, G / 2048, DEG_TO_RAD / 131.0f, DEG_TO_RAD / 131.0f, DEG_TO_RAD / 131.0f }
+	};
+	FILE* file = fopen(csvName, "r");
+	char* line = malloc(MAX_LINE_LENGTH);
+	float* values = malloc((MAX_SAMPLES * FRAME_CHANNELS + 1) * sizeof(float));
+
+	if (!file || !line || !values || !fgets(line, MAX_LINE_LENGTH, file))
+	{
+		fprintf(stderr, "Failed to read %s\n", csvName);
+		return 1;
+	}
+
+	const int fd = OpenEmulatorOutput(output);
+	if (fd < 0)
+	{
+		fprintf(stderr, "Failed to open %s: %s\n", output, strerror(errno));
+		return 1;
+	}
+
+	uint8_t frame[FRAME_MAX_SIZE];
+	uint16_t sequence = 0, gestures = 0;
+	uint64_t sent = 0;
+	const double start = Now();
+	double next = start;
+	int res = 0;
+
+	while (res == 0 && fgets(line, MAX_LINE_LENGTH, file))
+	{
+		uint32_t count = 0;
+		char* pos = line;
+
+		while (count <= MAX_SAMPLES * FRAME_CHANNELS)
+		{
+			char* end;
+			values[count] = strtof(pos, &end);
+			if (end == pos)
+				break;
+
+			count++;
+			pos = (*end == ',') ? end + 1 : end;
+		}
+
+		// The values of the samples and the target
+		const uint32_t samples = (count - 1) / FRAME_CHANNELS;
+		if (count < FRAME_CHANNELS + 1 || samples * FRAME_CHANNELS + 1 != count)
+			continue;
+
+		FrameInfo info = base;
+		info.samples = (uint8_t) samples;
+		res |= Send(fd, frame, FrameEncodeInfo(frame, &info), corruptEvery, &sent);
+
+		for (uint32_t s = 0; s < samples && res == 0; ++s)
+		{
+			FrameSample sample;
+
+			if (period)
+			{
+				while (Now() < next)
+					;
+				next += period * 1e-6;
+			}
+
+			sample.sequence = sequence++;
+			sample.time     = period ? (uint32_t) ((Now() - start) * 1e6) : (sequence - 1u) * info.period;
+			sample.index    = (uint8_t) s;
+			sample.target   = (uint8_t) values[count - 1];
+
+			for (uint32_t ch = 0; ch < FRAME_CHANNELS; ++ch)
+				sample.counts[ch] = ToCount(values[s * FRAME_CHANNELS + ch], info.units[ch]);
+
+			res |= Send(fd, frame, FrameEncodeSample(frame, &sample), corruptEvery, &sent);
+		}
+
+		gestures++;
+	}
+
+	res |= Send(fd, frame, FrameEncodeEnd(frame, gestures), 0, &sent);
+
+	// A pseudo terminal drops what the other side has not read yet when it is closed
+	if (strcmp(output, "pty") == 0)
+	{
+		struct pollfd pfd = { fd, POLLOUT, 0 };
+
+		while (poll(&pfd, 1, 10) >= 0 && !(pfd.revents & POLLHUP))
+			usleep(10000);
+	}
+
+	close(fd);
+	free(values);
+	free(line);
+	fclose(file);
+
+	fprintf(stderr, "sent %u gestures\n", gestures);
+
+	return res != 0;
+}
+
+
+int main(int argc, char** argv)
+{
+	const char* csvName = NULL;
+	const char* datasetName = NULL;
+	const char* emulate = NULL;
+	uint32_t maxGestures = 0, period = 0, corruptEvery = 0;
+	long baud = 115200;
+	int arg = 1;
+
+	for (; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1]; arg += 2)
+	{
+		if (strcmp(argv[arg], "-o") == 0)
+			csvName = argv[arg + 1];
+		else if (strcmp(argv[arg], "-d") == 0)
+			datasetName = argv[arg + 1];
+		else if (strcmp(argv[arg], "-n") == 0)
+			maxGestures = (uint32_t) atoi(argv[arg + 1]);
+		else if (strcmp(argv[arg], "-B") == 0)
+			baud = atol(argv[arg + 1]);
+		else if (strcmp(argv[arg], "-e") == 0)
+			emulate = argv[arg + 1];
+		else if (strcmp(argv[arg], "-t") == 0)
+			period = (uint32_t) atoi(argv[arg + 1]);
+		else if (strcmp(argv[arg], "-z") == 0)
+			corruptEvery = (uint32_t) atoi(argv[arg + 1]);
+		else
+			break;
+	}
+
+	if (argc - arg != 1 || BaudConstant(baud) == B0)
+	{
+		fprintf(stderr, "Usage: %s [-o data.csv] [-d dataset.bin] [-n gestures] [-B baud] input\n"
+				"       %s -e data.csv [-t period_us] [-z corrupt_every] output|pty\n", argv[0], argv[0]);
+		return 1;
+	}
+
+	if (emulate)
+		return RunEmulator(emulate, argv[arg], period, corruptEvery);
+
+	return RunDecoder(argv[arg], csvName, datasetName, maxGestures, baud);
+}
@@ -0,0 +1,543 @@
+/**
+ ******************************************************************************
+ * @file    csv2dataset.c
+ * @brief   Conversion of a CSV file (trainingdata.csv) into a binary dataset
+ *          for NOpenDataset and NReadDatasetSample
+ *
+ * The CSV file is mapped into memory and split into chunks of whole lines.
+ * The threads first count the rows of the chunks, which places every chunk
+ * in the output, and then parse the chunks straight into the mapped output
+ * file. Every row must have as many values as the header has columns. The
+ * column named "target" is left out of the samples, or kept as the last
+ * value of every sample with -t.
+ *
+ * The numbers are parsed with a decimal parser that gives the same floats as
+ * strtof and falls back to it for the forms it does not handle (-s uses
+ * strtof for every number, for comparison).
+ *
+ * Usage: csv2dataset [-j threads] [-c chunk_kb] [-t] [-s] data.csv dataset.bin
+ ******************************************************************************
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+
+#define MAX_THREADS			256
+#define MAX_FIELD_LENGTH	64
+
+#define DATASET_TYPE		1
+#define DATASET_BOM			0xABCD
+#define DATASET_DATA_POS	14
+
+
+typedef struct Chunk_
+{
+	const char* begin;
+	const char* end;
+	uint64_t    rows;
+	uint64_t    firstRow;
+	uint64_t    lines;
+	uint64_t    firstLine;
+
+} Chunk;
+
+typedef struct Job_
+{
+	const char*     body;
+	Chunk*          chunks;
+	uint32_t        chunksCount;
+	uint32_t        columns;
+	int32_t         targetColumn;
+	uint32_t        sampleDim;
+	uint8_t         useStrtof;
+	uint8_t*        output;
+
+	atomic_uint     nextChunk;
+	atomic_int      failed;
+	pthread_mutex_t lock;
+	uint64_t        errorLine;
+	char            error[128];
+
+} Job;
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * \brief Parse a whole field with strtof
+ * \return 0 on success
+ */
+static int ParseFieldStrtof(const char* begin, const char* end, float* value)
+{
+	char text[MAX_FIELD_LENGTH];
+	const size_t length = (size_t) (end - begin);
+
+	if (length == 0 || length >= sizeof(text))
+		return -1;
+
+	memcpy(text, begin, length);
+	text[length] = '\0';
+
+	char* stop;
+	*value = strtof(text, &stop);
+
+	return stop == text + length ? 0 : -1;
+}
+
+
+/**
+ * \brief Parse a plain decimal number ([sign] digits [. digits] [e [sign] digits])
+ * \details A mantissa up to 2^53 and a power of ten up to 22 are both exact in a double,
+ *          so one multiplication or division gives the correctly rounded double.
+ *          Rounding that to a float gives the result of strtof unless the double lies
+ *          exactly halfway between two floats, or the float is out of the normal range;
+ *          those numbers are left to strtof.
+ * \return position after the number, NULL if the number is not handled here
+ */
+static const char* ParseDecimal(const char* pos, const char* end, float* value)
+{
+	static const double powers[23] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	uint64_t mantissa = 0;
+	int32_t exponent = 0, digits = 0;
+	uint8_t negative = 0;
+
+	if (pos < end && (*pos == '-' || *pos == '+'))
+		negative = (*pos++ == '-');
+
+	for (; pos < end && (uint8_t) (*pos - '0') < 10; ++pos, ++digits)
+		mantissa = mantissa * 10 + (uint8_t) (*pos - '0');
+
+	if (pos < end && *pos == '.')
+	{
+		for (++pos; pos < end && (uint8_t) (*pos - '0') < 10; ++pos, ++digits)
+		{
+			mantissa = mantissa * 10 + (uint8_t) (*pos - '0');
+			exponent--;
+		}
+	}
+
+	// 19 digits do not overflow the mantissa
+	if (!digits || digits > 19 || mantissa > (1ull << 53))
+		return NULL;
+
+	if (pos < end && (*pos == 'e' || *pos == 'E'))
+	{
+		int32_t power = 0, powerDigits = 0;
+		uint8_t powerNegative = 0;
+
+		if (++pos < end && (*pos == '-' || *pos == '+'))
+			powerNegative = (*pos++ == '-');
+
+		for (; pos < end && (uint8_t) (*pos - '0') < 10 && power < 1000; ++pos, ++powerDigits)
+			power = power * 10 + (*pos - '0');
+
+		if (!powerDigits)
+			return NULL;
+
+		exponent += powerNegative ? -power : power;
+	}
+
+	if (exponent < -22 || exponent > 22)
+		return NULL;
+
+	const double result = exponent < 0 ? (double) mantissa / powers[-exponent] :
+										 (double) mantissa * powers[exponent];
+	uint64_t bits;
+	memcpy(&bits, &result, sizeof(bits));
+
+	if ((bits & 0x1FFFFFFFu) == 0x10000000u || (result != 0 && (result < FLT_MIN || result > FLT_MAX)))
+		return NULL;
+
+	*value = negative ? -(float) result : (float) result;
+
+	return pos;
+}
+
+
+static void Fail(Job* job, uint64_t line, const char* message)
+{
+	pthread_mutex_lock(&job->lock);
+
+	// The first error in the file is reported, whichever thread finds it first
+	if (!job->failed || line < job->errorLine)
+	{
+		job->errorLine = line;
+		snprintf(job->error, sizeof(job->error), "%s", message);
+	}
+
+	atomic_store(&job->failed, 1);
+	pthread_mutex_unlock(&job->lock);
+}
+
+
+static inline const char* LineEnd(const char* pos, const char* end)
+{
+	const char* newline = memchr(pos, '\n', (size_t) (end - pos));
+
+	return newline ? newline : end;
+}
+
+
+static inline uint8_t IsBlank(const char* line, const char* lineEnd)
+{
+	return lineEnd == line || (lineEnd == line + 1 && *line == '\r');
+}
+
+
+static void CountChunk(Chunk* chunk)
+{
+	chunk->rows = chunk->lines = 0;
+
+	for (const char* line = chunk->begin; line < chunk->end; )
+	{
+		const char* lineEnd = LineEnd(line, chunk->end);
+
+		chunk->rows += !IsBlank(line, lineEnd);
+		chunk->lines++;
+		line = lineEnd + 1;
+	}
+}
+
+
+/**
+ * \brief Parse the rows of a chunk into the output
+ * \return 0 on success
+ */
+static int ParseChunk(Job* job, const Chunk* chunk, float* sample)
+{
+	const size_t sampleSize = job->sampleDim * sizeof(float);
+	uint8_t* out = job->output + DATASET_DATA_POS + chunk->firstRow * sampleSize;
+	uint64_t lineNumber = chunk->firstLine;
+
+	for (const char* line = chunk->begin; line < chunk->end; ++lineNumber)
+	{
+		const char* lineEnd = LineEnd(line, chunk->end);
+		const char* rowEnd = (lineEnd > line && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+		const char* pos = line;
+		uint32_t stored = 0;
+
+		if (IsBlank(line, lineEnd))
+		{
+			line = lineEnd + 1;
+			continue;
+		}
+
+		for (uint32_t column = 0; column < job->columns; ++column)
+		{
+			const char* fieldEnd = NULL;
+			float value;
+
+			if (!job->useStrtof)
+				fieldEnd = ParseDecimal(pos, rowEnd, &value);
+
+			if (!fieldEnd || (fieldEnd < rowEnd && *fieldEnd != ','))
+			{
+				fieldEnd = memchr(pos, ',', (size_t) (rowEnd - pos));
+				fieldEnd = fieldEnd ? fieldEnd : rowEnd;
+
+				if (ParseFieldStrtof(pos, fieldEnd, &value) != 0)
+				{
+					char message[96];
+					snprintf(message, sizeof(message), "column %u is not a number", column + 1);
+					Fail(job, lineNumber, message);
+					return -1;
+				}
+			}
+
+			if ((fieldEnd == rowEnd) != (column + 1 == job->columns))
+			{
+				char message[96];
+				snprintf(message, sizeof(message), "%s values, the header has %u columns",
+						 fieldEnd == rowEnd ? "too few" : "too many", job->columns);
+				Fail(job, lineNumber, message);
+				return -1;
+			}
+
+			if ((int32_t) column != job->targetColumn)
+				sample[stored++] = value;
+			else if (job->sampleDim == job->columns)
+				sample[job->sampleDim - 1] = value;
+
+			pos = fieldEnd + 1;
+		}
+
+		memcpy(out, sample, sampleSize);
+		out += sampleSize;
+		line = lineEnd + 1;
+	}
+
+	return 0;
+}
+
+
+static void* CountWorker(void* arg)
+{
+	Job* job = arg;
+	uint32_t idx;
+
+	while ((idx = atomic_fetch_add(&job->nextChunk, 1)) < job->chunksCount)
+		CountChunk(&job->chunks[idx]);
+
+	return NULL;
+}
+
+
+static void* ParseWorker(void* arg)
+{
+	Job* job = arg;
+	float* sample = malloc(job->sampleDim * sizeof(float));
+	uint32_t idx;
+
+	while (!atomic_load(&job->failed) && (idx = atomic_fetch_add(&job->nextChunk, 1)) < job->chunksCount)
+	{
+		if (ParseChunk(job, &job->chunks[idx], sample) != 0)
+			break;
+	}
+
+	free(sample);
+
+	return NULL;
+}
+
+
+static void RunWorkers(Job* job, void* (*worker)(void*), uint32_t threadsCount)
+{
+	pthread_t threads[MAX_THREADS];
+
+	atomic_store(&job->nextChunk, 0);
+
+	for (uint32_t t = 1; t < threadsCount; ++t)
+		pthread_create(&threads[t], NULL, worker, job);
+
+	worker(job);
+
+	for (uint32_t t = 1; t < threadsCount; ++t)
+		pthread_join(threads[t], NULL);
+}
+
+
+/**
+ * \brief Count the columns of the header and find the target column
+ * \return number of columns
+ */
+static uint32_t ParseHeader(const char* line, const char* lineEnd, int32_t* targetColumn)
+{
+	uint32_t columns = 0;
+
+	*targetColumn = -1;
+
+	if (lineEnd > line && lineEnd[-1] == '\r')
+		lineEnd--;
+
+	for (const char* pos = line; pos <= lineEnd; ++columns)
+	{
+		const char* fieldEnd = memchr(pos, ',', (size_t) (lineEnd - pos));
+		fieldEnd = fieldEnd ? fieldEnd : lineEnd;
+
+		if (fieldEnd - pos == 6 && memcmp(pos, "target", 6) == 0)
+			*targetColumn = (int32_t) columns;
+
+		pos = fieldEnd + 1;
+	}
+
+	return columns;
+}
+
+
+/**
+ * \brief Split the body into chunks of whole lines
+ * \return number of chunks
+ */
+static uint32_t SplitChunks(const char* body, const char* end, size_t chunkSize, Chunk** chunks)
+{
+	const uint32_t capacity = (uint32_t) ((size_t) (end - body) / chunkSize + 1);
+	uint32_t count = 0;
+
+	*chunks = calloc(capacity, sizeof(Chunk));
+
+	for (const char* pos = body; pos < end && count < capacity; ++count)
+	{
+		const char* split = (size_t) (end - pos) > chunkSize ? pos + chunkSize : end;
+
+		if (split < end)
+		{
+			const char* newline = memchr(split, '\n', (size_t) (end - split));
+			split = newline ? newline + 1 : end;
+		}
+
+		if (count + 1 == capacity)
+			split = end;
+
+		(*chunks)[count].begin = pos;
+		(*chunks)[count].end = split;
+		pos = split;
+	}
+
+	return count;
+}
+
+
+int main(int argc, char** argv)
+{
+	long threadsCount = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t chunkSize = 4u << 20;
+	uint8_t keepTarget = 0, useStrtof = 0;
+	int arg = 1;
+
+	for (; arg < argc && argv[arg][0] == '-'; ++arg)
+	{
+		if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+			threadsCount = atol(argv[++arg]);
+		else if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc)
+			chunkSize = (size_t) atol(argv[++arg]) << 10;
+		else if (strcmp(argv[arg], "-t") == 0)
+			keepTarget = 1;
+		else if (strcmp(argv[arg], "-s") == 0)
+			useStrtof = 1;
+		else
+			break;
+	}
+
+	if (argc - arg != 2 || threadsCount < 1 || threadsCount > MAX_THREADS || !chunkSize)
+	{
+		fprintf(stderr, "Usage: %s [-j threads] [-c chunk_kb] [-t] [-s] data.csv dataset.bin\n", argv[0]);
+		return 1;
+	}
+
+	const char* inputName = argv[arg];
+	const char* outputName = argv[arg + 1];
+	const double start = Now();
+
+	const int input = open(inputName, O_RDONLY);
+	struct stat status;
+
+	if (input < 0 || fstat(input, &status) != 0 || status.st_size == 0)
+	{
+		fprintf(stderr, "Failed to open %s\n", inputName);
+		return 1;
+	}
+
+	const size_t inputSize = (size_t) status.st_size;
+	const char* data = mmap(NULL, inputSize, PROT_READ, MAP_PRIVATE, input, 0);
+
+	if (data == MAP_FAILED)
+	{
+		fprintf(stderr, "Failed to map %s\n", inputName);
+		return 1;
+	}
+
+	madvise((void*) data, inputSize, MADV_SEQUENTIAL);
+
+	const char* end = data + inputSize;
+	const char* headerEnd = LineEnd(data, end);
+
+	Job job;
+	memset(&job, 0, sizeof(job));
+	pthread_mutex_init(&job.lock, NULL);
+
+	job.columns   = ParseHeader(data, headerEnd, &job.targetColumn);
+	job.useStrtof = useStrtof;
+	job.sampleDim = job.columns - (job.targetColumn >= 0 && !keepTarget);
+	job.body      = headerEnd < end ? headerEnd + 1 : end;
+
+	if (!job.sampleDim)
+	{
+		fprintf(stderr, "No columns in the header of %s\n", inputName);
+		return 1;
+	}
+
+	job.chunksCount = SplitChunks(job.body, end, chunkSize, &job.chunks);
+	RunWorkers(&job, CountWorker, (uint32_t) threadsCount);
+
+	// The rows before a chunk place it in the output
+	uint64_t rows = 0, lines = 2;
+	for (uint32_t idx = 0; idx < job.chunksCount; ++idx)
+	{
+		job.chunks[idx].firstRow  = rows;
+		job.chunks[idx].firstLine = lines;
+		rows  += job.chunks[idx].rows;
+		lines += job.chunks[idx].lines;
+	}
+
+	const uint64_t endDataPos = DATASET_DATA_POS + rows * job.sampleDim * sizeof(float);
+
+	// The dataset stores the end of the data in 32 bits
+	if (endDataPos > UINT32_MAX)
+	{
+		fprintf(stderr, "%llu rows of %u values do not fit one dataset (4 GB)\n",
+				(unsigned long long) rows, job.sampleDim);
+		return 1;
+	}
+
+	const size_t outputSize = (size_t) endDataPos + sizeof(uint32_t);
+	const int output = open(outputName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if (output < 0 || ftruncate(output, (off_t) outputSize) != 0 ||
+		(job.output = mmap(NULL, outputSize, PROT_READ | PROT_WRITE, MAP_SHARED, output, 0)) == MAP_FAILED)
+	{
+		fprintf(stderr, "Failed to create %s\n", outputName);
+		return 1;
+	}
+
+	const uint8_t head[4] = { 'n', 'b', DATASET_TYPE, 1 };
+	const uint16_t bom = DATASET_BOM;
+	const uint32_t endData = (uint32_t) endDataPos, reserved = 0;
+
+	memcpy(job.output, head, sizeof(head));
+	memcpy(job.output + 4, &bom, sizeof(bom));
+	memcpy(job.output + 6, &endData, sizeof(endData));
+	memcpy(job.output + 10, &reserved, sizeof(reserved));
+	memcpy(job.output + endDataPos, &job.sampleDim, sizeof(job.sampleDim));
+
+	RunWorkers(&job, ParseWorker, (uint32_t) threadsCount);
+
+	const int failed = atomic_load(&job.failed);
+
+	if (munmap(job.output, outputSize) != 0 || close(output) != 0)
+		fprintf(stderr, "Failed to write %s\n", outputName);
+
+	if (failed)
+	{
+		fprintf(stderr, "%s:%llu: %s\n", inputName, (unsigned long long) job.errorLine, job.error);
+		unlink(outputName);
+	}
+
+	munmap((void*) data, inputSize);
+	close(input);
+	free(job.chunks);
+
+	if (failed)
+		return 1;
+
+	const double elapsed = Now() - start;
+
+	printf("dataset:    %llu rows, %u values per sample%s\n", (unsigned long long) rows, job.sampleDim,
+		   job.targetColumn < 0 ? "" : keepTarget ? " (target last)" : " (target left out)");
+	printf("conversion: %.1f MB in %.3f s, %.0f MB/s, %ld threads, %u chunks, %s\n", inputSize / 1e6, elapsed,
+		   inputSize / 1e6 / elapsed, threadsCount, job.chunksCount, useStrtof ? "strtof" : "decimal parser");
+
+	return 0;
+}
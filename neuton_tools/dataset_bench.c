@@ -0,0 +1,252 @@
+/**
+ ******************************************************************************
+ * @file    dataset_bench.c
+ * @brief   Rows per second of the dataset readers: NReadDatasetSample row by
+ *          row against NMapDataset and NDatasetBlock by blocks
+ *
+ * Both readers are timed alone, summing the first value of every row,
+ * and followed by inference: NPrepareSample and NRunPreparedInference for
+ * every row read by NReadDatasetSample, NRunInferenceRowsContext for every
+ * block of the mapped dataset. The outputs of the blocks are compared bit for bit with
+ * the outputs of the rows.
+ *
+ * Usage: dataset_bench [-b block,...] model.bin dataset.bin
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "neuton/neuton.h"
+
+
+#define MAX_BLOCKS			16
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * \brief Read the dataset row by row with NReadDatasetSample
+ * \param model - model to run on every row, NULL to only read
+ * \param outputs - outputs of all rows, with a model
+ * \return number of rows, 0 on error
+ */
+static uint32_t ReadRows(const char* fileName, NeuralNet* model, float* outputs, double* checksum)
+{
+	Dataset dataset;
+	uint32_t rows = 0, read;
+
+	if (NOpenDatasetEx(fileName, &dataset) != ERR_NO_ERROR)
+		return 0;
+
+	// The sample is followed by the bias
+	uint32_t sampleSize = dataset.sampleDim + 1;
+	if (model && model->inputsDim > sampleSize)
+		sampleSize = model->inputsDim;
+
+	float* sample = calloc(sampleSize, sizeof(float));
+
+	*checksum = 0;
+
+	while (NReadDatasetSample(&dataset, sample, &read) == ERR_NO_ERROR && read)
+	{
+		if (model)
+		{
+			NPrepareSample(sample, model);
+
+			const float* result = NRunPreparedInference(model, sample);
+			memcpy(outputs + (size_t) rows * model->outputsDim, result, model->outputsDim * sizeof(float));
+		}
+		else
+		{
+			*checksum += sample[0];
+		}
+
+		rows++;
+	}
+
+	NCloseDataset(&dataset);
+	free(sample);
+
+	return rows;
+}
+
+
+/**
+ * \brief Read the mapped dataset by blocks, see @ReadRows
+ */
+static uint32_t ReadBlocks(const char* fileName, uint32_t blockSize, const NeuralNet* model, float* outputs,
+						   double* checksum)
+{
+	NDatasetView view;
+	NContext context;
+	const void* block;
+	uint32_t rows = 0, count;
+
+	if (NMapDataset(fileName, &view) != ERR_NO_ERROR)
+		return 0;
+
+	// Contexts have a buffer for the normalised inputs of 32 bit models, the model has not
+	if (model && NCreateContext(model, &context) != ERR_NO_ERROR)
+	{
+		NCloseDatasetView(&view);
+		return 0;
+	}
+
+	*checksum = 0;
+
+	while ((block = NDatasetBlock(&view, blockSize, &count)) != NULL)
+	{
+		if (model)
+		{
+			if (NRunInferenceRowsContext(model, &context, block, view.sampleDim, count,
+										 outputs + (size_t) rows * model->outputsDim) != ERR_NO_ERROR)
+				break;
+		}
+		else
+		{
+			for (uint32_t idx = 0; idx < count; ++idx)
+			{
+				float value;
+				memcpy(&value, (const uint8_t*) block + (size_t) idx * view.sampleDim * sizeof(value),
+					   sizeof(value));
+				*checksum += value;
+			}
+		}
+
+		rows += count;
+	}
+
+	if (model)
+		NFreeContext(&context);
+	NCloseDatasetView(&view);
+
+	return rows;
+}
+
+
+static void Report(const char* name, uint32_t rows, double seconds)
+{
+	printf("%-28s %9u rows %8.3f s %12.0f rows/s\n", name, rows, seconds, rows / seconds);
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t blocks[MAX_BLOCKS] = { 1, 16, 256, 4096 };
+	uint32_t blocksCount = 4;
+	int arg = 1;
+
+	for (; arg < argc && argv[arg][0] == '-'; ++arg)
+	{
+		if (!strcmp(argv[arg], "-b") && arg + 1 < argc)
+		{
+			char* list = argv[++arg];
+
+			for (blocksCount = 0; blocksCount < MAX_BLOCKS && *list; ++blocksCount)
+			{
+				blocks[blocksCount] = strtoul(list, &list, 10);
+				if (*list == ',')
+					list++;
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (argc - arg != 2)
+	{
+		fprintf(stderr, "Usage: %s [-b block,...] model.bin dataset.bin\n", argv[0]);
+		return 1;
+	}
+
+	const char* datasetName = argv[arg + 1];
+	NeuralNet model;
+	NDatasetView view;
+
+	if (NLoadModelEx(argv[arg], &model) != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Can not load %s\n", argv[arg]);
+		return 1;
+	}
+
+	if (NMapDataset(datasetName, &view) != ERR_NO_ERROR || view.sampleDim + 1 < model.inputsDim)
+	{
+		fprintf(stderr, "Can not open %s or its samples are shorter than the model inputs\n", datasetName);
+		return 1;
+	}
+
+	const uint32_t samplesCount = view.samplesCount;
+	const uint32_t sampleDim = view.sampleDim;
+	NCloseDatasetView(&view);
+
+	float* expected = malloc((size_t) samplesCount * model.outputsDim * sizeof(float));
+	float* outputs  = malloc((size_t) samplesCount * model.outputsDim * sizeof(float));
+	double rowsChecksum = 0, blocksChecksum = 0, started;
+	uint32_t rows;
+	char name[64];
+
+	printf("%u inputs, %u outputs, %u bit, %u samples of %u values\n", model.inputsDim, model.outputsDim,
+		   model.quantisation, samplesCount, sampleDim);
+
+	// The first pass also brings the file into the page cache
+	ReadRows(datasetName, NULL, NULL, &rowsChecksum);
+
+	started = Now();
+	rows = ReadRows(datasetName, NULL, NULL, &rowsChecksum);
+	Report("read, rows", rows, Now() - started);
+
+	for (uint32_t idx = 0; idx < blocksCount; ++idx)
+	{
+		started = Now();
+		rows = ReadBlocks(datasetName, blocks[idx], NULL, NULL, &blocksChecksum);
+
+		snprintf(name, sizeof(name), "read, blocks of %u", blocks[idx]);
+		Report(name, rows, Now() - started);
+
+		if (blocksChecksum != rowsChecksum)
+			printf("  checksum differs: %.6f, %.6f\n", blocksChecksum, rowsChecksum);
+	}
+
+	started = Now();
+	rows = ReadRows(datasetName, &model, expected, &rowsChecksum);
+	Report("inference, rows", rows, Now() - started);
+
+	for (uint32_t idx = 0; idx < blocksCount; ++idx)
+	{
+		memset(outputs, 0, (size_t) samplesCount * model.outputsDim * sizeof(float));
+
+		started = Now();
+		rows = ReadBlocks(datasetName, blocks[idx], &model, outputs, &blocksChecksum);
+
+		snprintf(name, sizeof(name), "inference, blocks of %u", blocks[idx]);
+		Report(name, rows, Now() - started);
+
+		uint32_t mismatches = 0;
+		for (uint32_t sample = 0; sample < samplesCount; ++sample)
+			mismatches += memcmp(outputs + (size_t) sample * model.outputsDim,
+								 expected + (size_t) sample * model.outputsDim,
+								 model.outputsDim * sizeof(float)) != 0;
+
+		if (mismatches || rows != samplesCount)
+			printf("  %u of %u outputs differ\n", mismatches, samplesCount);
+	}
+
+	free(expected);
+	free(outputs);
+	NFreeModel(&model);
+
+	return 0;
+}
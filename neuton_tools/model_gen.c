@@ -0,0 +1,626 @@
+/**
+ ******************************************************************************
+ * @file    model_gen.c
+ * @brief   Generator of synthetic Neuton models for scaling and stress benchmarks
+ *
+ * Writes a model file version 1 with random but valid content: input and output
+ * limits, output labels on the last neurons, internal links to earlier neurons,
+ * external links to any input including the bias, weights over the whole range of
+ * the quantisation and nonzero activation coefficients. Sections are aligned and
+ * the file ends with the CRC, in the byte order asked for. The same arguments and
+ * seed give the same file.
+ *
+ * The number of links of every neuron is drawn with the mean given by -f (internal)
+ * and -e (external) from the distribution given by -d:
+ *   fixed     - always the mean
+ *   uniform   - uniform from 0 to twice the mean
+ *   geometric - geometric, mostly short with a long tail
+ * A neuron always has at least one link. With -w the internal links go to the
+ * previous window neurons only, otherwise to any earlier neuron. With -r that
+ * fraction of the internal links goes to the neuron itself or to a later neuron
+ * instead. Such links read 0. The library does not follow them when it marks the
+ * neurons alive from the outputs, and it drops them from the re-laid out structure.
+ *
+ * The file is then loaded from memory by the library as the sketch does, and the
+ * load time and the number of neurons alive from the outputs are reported, with
+ * a CRC of the outputs of seeded inputs. Builds of the library with different
+ * options must report the same CRC for the same file.
+ *
+ * Neurons, inputs and links are 16 bit in the file, so at most 65535 neurons and
+ * 65534 features.
+ *
+ * Usage: model_gen [-q 8|16|32] [-n neurons] [-i features] [-o outputs] [-t task]
+ *                  [-f int_fanin] [-e ext_fanin] [-d fixed|uniform|geometric] [-w window]
+ *                  [-r forward] [-F] [-S] [-L] [-B] [-s seed] output.bin
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "neuton/neuton.h"
+
+
+#if defined(NEUTON_MEMORY_BENCHMARK)
+uint32_t _NeutonExtraMemoryUsage()
+{
+	return 0;
+}
+#endif
+
+
+#define MAX_COUNT				65535
+#define LOAD_RUNS				5
+#define MODEL_FILE_TYPE			5
+#define CHECK_SAMPLES			64
+
+
+typedef enum
+{
+	FANIN_FIXED = 0,
+	FANIN_UNIFORM,
+	FANIN_GEOMETRIC,
+	FANIN_INVALID
+
+} FanIn;
+
+
+/**
+ * \brief Parameters of the generated model
+ */
+typedef struct Spec_
+{
+	uint8_t  quantisation;
+	uint8_t  taskType;
+	uint8_t  options;
+	uint8_t  bigEndian;
+	uint32_t neuronsCount;
+
+	/**
+	 * \brief Number of features, the model has one more input for the bias
+	 */
+	uint32_t featuresCount;
+	uint32_t outputsDim;
+	double   intFanIn;
+	double   extFanIn;
+	FanIn    distribution;
+
+	/**
+	 * \brief Internal links go to this many previous neurons, 0 for any earlier neuron
+	 */
+	uint32_t window;
+
+	/**
+	 * \brief Fraction of the internal links to the neuron itself or a later neuron
+	 */
+	double   forwardRatio;
+	uint64_t seed;
+
+} Spec;
+
+
+/**
+ * \brief Output file being written in the byte order of the model
+ */
+typedef struct Writer_
+{
+	uint8_t* data;
+	uint32_t size;
+	uint32_t capacity;
+	uint8_t  bigEndian;
+
+} Writer;
+
+
+static int Reserve(Writer* writer, uint32_t size)
+{
+	if (writer->size + size <= writer->capacity)
+		return 0;
+
+	uint32_t capacity = writer->capacity ? writer->capacity : 4096;
+	while (capacity < writer->size + size)
+		capacity *= 2;
+
+	uint8_t* data = realloc(writer->data, capacity);
+	if (!data)
+		return -1;
+
+	memset(data + writer->capacity, 0, capacity - writer->capacity);
+	writer->data     = data;
+	writer->capacity = capacity;
+
+	return 0;
+}
+
+
+/**
+ * \brief Append value of size bytes in the byte order of the writer
+ */
+static int Put(Writer* writer, uint32_t value, uint8_t size)
+{
+	if (Reserve(writer, size) != 0)
+		return -1;
+
+	for (uint8_t idx = 0; idx < size; idx++)
+	{
+		const uint8_t shift = 8 * (writer->bigEndian ? size - 1 - idx : idx);
+		writer->data[writer->size++] = (uint8_t) (value >> shift);
+	}
+
+	return 0;
+}
+
+
+static int PutFloat(Writer* writer, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	return Put(writer, bits, sizeof(bits));
+}
+
+
+/**
+ * \brief Append zeros up to the alignment, counted from the start of the file
+ */
+static int Pad(Writer* writer, uint8_t align)
+{
+	const uint32_t padding = (align - writer->size % align) % align;
+
+	if (Reserve(writer, padding) != 0)
+		return -1;
+	writer->size += padding;
+
+	return 0;
+}
+
+
+static uint32_t Crc32(const uint8_t* buffer, uint32_t size)
+{
+	static uint32_t table[256];
+
+	if (!table[1])
+	{
+		for (uint32_t n = 0; n < 256; n++)
+		{
+			uint32_t crc = n;
+			for (uint32_t k = 0; k < 8; k++)
+				crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+			table[n] = crc;
+		}
+	}
+
+	uint32_t crc = ~0u;
+	while (size--)
+		crc = (crc >> 8) ^ table[(crc ^ *buffer++) & 0xFF];
+
+	return ~crc;
+}
+
+
+/**
+ * \brief splitmix64, the same on every platform so the seed reproduces the file
+ */
+static uint64_t Random(uint64_t* state)
+{
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+
+/**
+ * \brief Random number in [0, 1)
+ */
+static double RandomUnit(uint64_t* state)
+{
+	return (Random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+static uint32_t RandomBelow(uint64_t* state, uint32_t bound)
+{
+	return (uint32_t) (RandomUnit(state) * bound);
+}
+
+
+static double RandomRange(uint64_t* state, double low, double high)
+{
+	return low + (high - low) * RandomUnit(state);
+}
+
+
+/**
+ * \brief Number of links of a neuron drawn with the mean, capped at limit
+ */
+static uint32_t DrawFanIn(uint64_t* state, FanIn distribution, double mean, uint32_t limit)
+{
+	double count = mean;
+
+	switch (distribution)
+	{
+	case FANIN_UNIFORM:
+		count = floor(RandomUnit(state) * (2 * mean + 1));
+		break;
+
+	case FANIN_GEOMETRIC:
+		// Geometric on 0, 1, ... with success probability 1 / (mean + 1)
+		count = (mean > 0) ? floor(log(1.0 - RandomUnit(state)) / log(mean / (mean + 1))) : 0;
+		break;
+
+	default:
+		break;
+	}
+
+	return (count < limit) ? (uint32_t) count : limit;
+}
+
+
+/**
+ * \brief Append count maximums then count minimums, minimums in [low, 0] and maximums wider by [minSpan, maxSpan]
+ */
+static int PutLimits(Writer* writer, uint64_t* state, uint32_t count, double low, double minSpan, double maxSpan)
+{
+	float* limits = malloc(2 * count * sizeof(*limits));
+	int res = limits ? 0 : -1;
+
+	for (uint32_t idx = 0; res == 0 && idx < count; idx++)
+	{
+		limits[count + idx] = (float) RandomRange(state, low, 0);
+		limits[idx] = limits[count + idx] + (float) RandomRange(state, minSpan, maxSpan);
+	}
+	for (uint32_t idx = 0; res == 0 && idx < 2 * count; idx++)
+		res |= PutFloat(writer, limits[idx]);
+
+	free(limits);
+
+	return res;
+}
+
+
+/**
+ * \brief Write the whole model, see LoadModel for the layout
+ * \return 0 on success
+ */
+static int WriteModel(Writer* writer, const Spec* spec)
+{
+	const uint32_t neuronsCount = spec->neuronsCount;
+	const uint32_t inputsDim    = spec->featuresCount + 1;
+	const uint32_t outputsDim   = spec->outputsDim;
+	const uint8_t  align        = spec->quantisation / 8;
+	const uint32_t limitsCount  = (spec->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) ? 1 : inputsDim;
+	uint64_t state = spec->seed;
+
+	uint16_t* intCounters = malloc(neuronsCount * sizeof(*intCounters));
+	uint16_t* extCounters = malloc(neuronsCount * sizeof(*extCounters));
+	uint64_t  weightDim   = 0;
+	int res = (intCounters && extCounters) ? 0 : -1;
+
+	for (uint32_t neuron = 0; res == 0 && neuron < neuronsCount; neuron++)
+	{
+		const uint32_t reach = (spec->window && spec->window < neuron) ? spec->window : neuron;
+
+		intCounters[neuron] = DrawFanIn(&state, spec->distribution, spec->intFanIn,
+										(spec->forwardRatio > 0) ? MAX_COUNT : reach);
+		extCounters[neuron] = DrawFanIn(&state, spec->distribution, spec->extFanIn, MAX_COUNT);
+
+		if (!intCounters[neuron] && !extCounters[neuron])
+			extCounters[neuron] = 1;
+
+		weightDim += intCounters[neuron] + extCounters[neuron];
+	}
+
+	// Links and weights of the largest quantisation, the file size is 32 bit
+	if (weightDim * (2 + 4) + neuronsCount * (2 * 2 + 4) + inputsDim * 2 * 4 + outputsDim * 4 * 4 >= 0xF0000000u)
+		res = -1;
+
+	res |= Put(writer, 'n', 1);
+	res |= Put(writer, 'b', 1);
+	res |= Put(writer, MODEL_FILE_TYPE, 1);
+	res |= Put(writer, 1, 1);
+	res |= Put(writer, 0xABCD, 2);
+
+	// MetaInfo
+	res |= Put(writer, spec->options, 1);
+	res |= Put(writer, spec->taskType, 1);
+	res |= Put(writer, inputsDim, 2);
+	res |= Put(writer, outputsDim, 2);
+	res |= Put(writer, spec->quantisation, 1);
+	res |= Put(writer, 0, 1);
+	res |= Put(writer, neuronsCount, 2);
+	res |= Put(writer, (uint32_t) weightDim, 4);
+
+	res |= PutLimits(writer, &state, limitsCount, -10, 0.5, 10);
+	res |= PutLimits(writer, &state, outputsDim, -1, 1, 3);
+
+	if (spec->options & BIT_LOG_SCALE_OUT_EXISTS)
+		for (uint32_t idx = 0; idx < outputsDim; idx++)
+			res |= PutFloat(writer, (float) RandomRange(&state, 0, 1));
+
+	// The outputs are the last neurons, so most of the model is alive
+	res |= Pad(writer, align);
+	for (uint32_t idx = 0; idx < outputsDim; idx++)
+		res |= Put(writer, neuronsCount - outputsDim + idx, 2);
+
+	res |= Pad(writer, align);
+	for (uint32_t neuron = 0; res == 0 && neuron < neuronsCount; neuron++)
+		res |= Put(writer, intCounters[neuron], 2);
+	for (uint32_t neuron = 0; res == 0 && neuron < neuronsCount; neuron++)
+		res |= Put(writer, extCounters[neuron], 2);
+
+	// All internal links in the order of neurons, then all external links
+	res |= Pad(writer, align);
+	for (uint32_t neuron = 0; res == 0 && neuron < neuronsCount; neuron++)
+		for (uint32_t link = 0; link < intCounters[neuron]; link++)
+		{
+			const uint32_t reach = (spec->window && spec->window < neuron) ? spec->window : neuron;
+
+			// The first neuron has no earlier neurons, its internal links all go forward
+			if (!reach || (spec->forwardRatio > 0 && RandomUnit(&state) < spec->forwardRatio))
+				res |= Put(writer, neuron + RandomBelow(&state, neuronsCount - neuron), 2);
+			else
+				res |= Put(writer, neuron - 1 - RandomBelow(&state, reach), 2);
+		}
+	for (uint32_t neuron = 0; res == 0 && neuron < neuronsCount; neuron++)
+		for (uint32_t link = 0; link < extCounters[neuron]; link++)
+			res |= Put(writer, RandomBelow(&state, inputsDim), 2);
+
+	res |= Pad(writer, align);
+	for (uint64_t weight = 0; res == 0 && weight < weightDim; weight++)
+	{
+		switch (spec->quantisation)
+		{
+		case 8:
+			res |= Put(writer, RandomBelow(&state, 256), 1);
+			break;
+		case 16:
+			res |= Put(writer, RandomBelow(&state, 65536), 2);
+			break;
+		default:
+			res |= PutFloat(writer, (float) RandomRange(&state, -4, 4));
+			break;
+		}
+	}
+
+	res |= Pad(writer, align);
+	for (uint32_t neuron = 0; res == 0 && neuron < neuronsCount; neuron++)
+	{
+		switch (spec->quantisation)
+		{
+		case 8:
+			res |= Put(writer, 1 + RandomBelow(&state, 255), 1);
+			break;
+		case 16:
+			res |= Put(writer, 1 + RandomBelow(&state, 65535), 2);
+			break;
+		default:
+			res |= PutFloat(writer, (float) RandomRange(&state, 0.1, 4));
+			break;
+		}
+	}
+
+	free(intCounters);
+	free(extCounters);
+
+	if (res != 0)
+		return -1;
+
+	return Put(writer, Crc32(writer->data, writer->size), 4);
+}
+
+
+static int CompareDouble(const void* a, const void* b)
+{
+	const double x = *(const double*) a, y = *(const double*) b;
+	return (x > y) - (x < y);
+}
+
+
+/**
+ * \brief Load the model from memory as the sketch does and report the load time and the alive neurons
+ */
+static int ReportLoad(const char* name, const uint8_t* data, uint32_t size)
+{
+	double times[LOAD_RUNS];
+	uint32_t executionCount = 0, weightDim = 0;
+
+	for (uint32_t run = 0; run < LOAD_RUNS; run++)
+	{
+		NeuralNet model = { 0 };
+
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		const Err err = NLoadModel(NFileFromBuffer(data, size), &model, 0);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		if (err != ERR_NO_ERROR)
+		{
+			fprintf(stderr, "Failed to load %s from memory: error %d\n", name, err);
+			return -1;
+		}
+
+		times[run] = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) * 1e-3;
+		executionCount = model.executionCount;
+		weightDim      = model.weightDim;
+		NFreeModel(&model);
+	}
+
+	qsort(times, LOAD_RUNS, sizeof(*times), CompareDouble);
+
+	printf("%s: %u bytes, %u weights, load %.1f us, %u neurons alive\n", name, size, weightDim,
+		   times[LOAD_RUNS / 2], executionCount);
+
+	return 0;
+}
+
+
+/**
+ * \brief CRC of the outputs of seeded inputs, equal for library builds that compute the same
+ * \return 0 on success
+ */
+static int OutputsCrc(const uint8_t* data, uint32_t size, uint32_t* crc)
+{
+	NeuralNet model = { 0 };
+
+	if (NLoadModel(NFileFromBuffer(data, size), &model, 0) != ERR_NO_ERROR)
+		return -1;
+
+	float* inputs  = malloc(model.inputsDim * sizeof(*inputs));
+	float* outputs = malloc(CHECK_SAMPLES * model.outputsDim * sizeof(*outputs));
+	uint64_t state = CHECK_SAMPLES;
+
+	for (uint32_t sample = 0; inputs && outputs && sample < CHECK_SAMPLES; sample++)
+	{
+		// Normalised inputs, the last one is the bias
+		for (uint32_t idx = 0; idx + 1 < model.inputsDim; idx++)
+			inputs[idx] = (float) RandomUnit(&state);
+		inputs[model.inputsDim - 1] = 1.0f;
+
+		memcpy(outputs + sample * model.outputsDim, NRunInference(&model, inputs),
+			   model.outputsDim * sizeof(*outputs));
+	}
+
+	const int res = (inputs && outputs) ? 0 : -1;
+	if (res == 0)
+		*crc = Crc32((const uint8_t*) outputs, CHECK_SAMPLES * model.outputsDim * sizeof(*outputs));
+
+	free(inputs);
+	free(outputs);
+	NFreeModel(&model);
+
+	return res;
+}
+
+
+static FanIn ParseFanIn(const char* name)
+{
+	if (strcmp(name, "fixed") == 0)
+		return FANIN_FIXED;
+	if (strcmp(name, "uniform") == 0)
+		return FANIN_UNIFORM;
+	if (strcmp(name, "geometric") == 0)
+		return FANIN_GEOMETRIC;
+
+	return FANIN_INVALID;
+}
+
+
+int main(int argc, char** argv)
+{
+	Spec spec =
+	{
+		.quantisation  = 8,
+		.taskType      = TASK_BINARY_CLASSIFICATION,
+		.neuronsCount  = 100,
+		.featuresCount = 30,
+		.outputsDim    = 2,
+		.intFanIn      = 4,
+		.extFanIn      = 4,
+		.distribution  = FANIN_UNIFORM,
+		.seed          = 1
+	};
+	uint8_t badOption = 0;
+	int arg = 1;
+
+	for (; arg < argc && argv[arg][0] == '-'; arg++)
+	{
+		const char* option = argv[arg];
+		const uint8_t hasValue = arg + 1 < argc;
+
+		if (strcmp(option, "-F") == 0)
+			spec.options |= BIT_FORCE_INTEGER_CALCULATIONS;
+		else if (strcmp(option, "-S") == 0)
+			spec.options |= BIT_ONE_MAXMIN_FOR_ALL_INPUTS;
+		else if (strcmp(option, "-L") == 0)
+			spec.options |= BIT_LOG_SCALE_OUT_EXISTS;
+		else if (strcmp(option, "-B") == 0)
+			spec.bigEndian = 1;
+		else if (strcmp(option, "-q") == 0 && hasValue)
+			spec.quantisation = atoi(argv[++arg]);
+		else if (strcmp(option, "-n") == 0 && hasValue)
+			spec.neuronsCount = strtoul(argv[++arg], NULL, 10);
+		else if (strcmp(option, "-i") == 0 && hasValue)
+			spec.featuresCount = strtoul(argv[++arg], NULL, 10);
+		else if (strcmp(option, "-o") == 0 && hasValue)
+			spec.outputsDim = strtoul(argv[++arg], NULL, 10);
+		else if (strcmp(option, "-t") == 0 && hasValue)
+			spec.taskType = atoi(argv[++arg]);
+		else if (strcmp(option, "-f") == 0 && hasValue)
+			spec.intFanIn = atof(argv[++arg]);
+		else if (strcmp(option, "-e") == 0 && hasValue)
+			spec.extFanIn = atof(argv[++arg]);
+		else if (strcmp(option, "-d") == 0 && hasValue)
+			spec.distribution = ParseFanIn(argv[++arg]);
+		else if (strcmp(option, "-w") == 0 && hasValue)
+			spec.window = strtoul(argv[++arg], NULL, 10);
+		else if (strcmp(option, "-r") == 0 && hasValue)
+			spec.forwardRatio = atof(argv[++arg]);
+		else if (strcmp(option, "-s") == 0 && hasValue)
+			spec.seed = strtoull(argv[++arg], NULL, 10);
+		else
+		{
+			// Unknown option or no value, it is not the output file
+			badOption = 1;
+			break;
+		}
+	}
+
+	const int valid =
+		(spec.quantisation == 8 || spec.quantisation == 16 || spec.quantisation == 32) &&
+		spec.taskType <= TASK_REGRESSION && spec.distribution != FANIN_INVALID &&
+		spec.neuronsCount >= 1 && spec.neuronsCount <= MAX_COUNT &&
+		spec.featuresCount >= 1 && spec.featuresCount < MAX_COUNT &&
+		spec.outputsDim >= 1 && spec.outputsDim <= spec.neuronsCount &&
+		spec.forwardRatio >= 0 && spec.forwardRatio <= 1 &&
+		spec.intFanIn >= 0 && spec.extFanIn >= 0 && spec.intFanIn <= MAX_COUNT && spec.extFanIn <= MAX_COUNT;
+
+	if (badOption || argc - arg != 1 || !valid)
+	{
+		fprintf(stderr,
+				"Usage: %s [-q 8|16|32] [-n neurons] [-i features] [-o outputs] [-t task]\n"
+				"       [-f int_fanin] [-e ext_fanin] [-d fixed|uniform|geometric] [-w window]\n"
+				"       [-r forward] [-F] [-S] [-L] [-B] [-s seed] output.bin\n"
+				"At most %u neurons and %u features, task 0 multiclass, 1 binary, 2 regression,\n"
+				"-F force integer calculations, -S one limit for all inputs, -L log scale outputs,\n"
+				"-r fraction of internal links to the neuron itself or later, -B big endian\n",
+				argv[0], MAX_COUNT, MAX_COUNT - 1);
+		return 1;
+	}
+
+	Writer writer = { 0 };
+	writer.bigEndian = spec.bigEndian;
+
+	if (WriteModel(&writer, &spec) != 0)
+	{
+		fprintf(stderr, "Failed to generate the model, it is too large or out of memory\n");
+		return 1;
+	}
+
+	FILE* file = fopen(argv[arg], "wb");
+	if (!file || fwrite(writer.data, 1, writer.size, file) != writer.size || fclose(file) != 0)
+	{
+		fprintf(stderr, "Failed to write %s\n", argv[arg]);
+		return 1;
+	}
+
+	printf("%u neurons, %u inputs, %u outputs, %u bit, options 0x%02X, %s endian\n", spec.neuronsCount,
+		   spec.featuresCount + 1, spec.outputsDim, spec.quantisation, spec.options,
+		   spec.bigEndian ? "big" : "little");
+
+	uint32_t crc = 0;
+	int res = ReportLoad(argv[arg], writer.data, writer.size);
+	if (res == 0)
+		res = OutputsCrc(writer.data, writer.size, &crc);
+	if (res == 0)
+		printf("outputs CRC of %u seeded samples: 0x%08X\n", CHECK_SAMPLES, crc);
+
+	free(writer.data);
+
+	return res == 0 ? 0 : 1;
+}
@@ -0,0 +1,612 @@
+/**
+ ******************************************************************************
+ * @file    neuton_aot.c
+ * @brief   Ahead-of-time compiler of Neuton models into straight-line C source
+ *
+ * The generated file implements model_init() / model_run_inference() from
+ * user_app.h without the Neuton library: every dot product is unrolled with
+ * literal weights and input indexes, the activation is chosen at generation
+ * time and the model blob is not parsed at runtime.
+ *
+ * Usage: neuton_aot [-p prefix] model.bin output.c
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "neuton/neuton.h"
+
+
+#define MAX_INPUT_FLOAT			0.9999999f
+
+
+/**
+ * \brief Generation context
+ */
+typedef struct Generator_
+{
+	FILE*            out;
+	const NeuralNet* model;
+	const char*      prefix;
+
+	/**
+	 * \brief Offsets of the neurons int/ext links
+	 */
+	uint32_t*        intOffsets;
+	uint32_t*        extOffsets;
+
+	/**
+	 * \brief Slot of the input in the quantised inputs buffer, UINT16_MAX if input is not used
+	 */
+	uint16_t*        inputSlots;
+	uint16_t         usedInputs;
+
+	/**
+	 * \brief Slot of the neuron in the accumulators, UINT16_MAX if neuron does not feed the outputs
+	 */
+	uint16_t*        neuronSlots;
+
+	/**
+	 * \brief Statistics
+	 */
+	uint32_t         emittedTerms;
+	uint32_t         droppedTerms;
+
+} Generator;
+
+
+static void PrintFloat(FILE* out, float value)
+{
+	fprintf(out, "%af", (double) value);
+}
+
+
+static void PrintDouble(FILE* out, double value)
+{
+	fprintf(out, "%a", value);
+}
+
+
+static const char* TaskName(uint8_t taskType)
+{
+	switch (taskType)
+	{
+	case TASK_MULTICLASS_CLASSIFICATION: return "multiclass classification";
+	case TASK_BINARY_CLASSIFICATION:     return "binary classification";
+	case TASK_REGRESSION:                return "regression";
+	default:                             return "unknown";
+	}
+}
+
+
+/**
+ * \brief Compute links offsets, the used inputs and neurons, validate link indexes
+ * \details Only the neurons evaluated by the library (see NGetPruneReport) are used
+ * \return 0 on success
+ */
+static int Prepare(Generator* gen)
+{
+	const NeuralNet* model = gen->model;
+	uint32_t offset = 0;
+
+	if (model->accumulatorSlots)
+	{
+		fprintf(stderr, "models with shared accumulator slots are not supported, convert without -r\n");
+		return -1;
+	}
+
+	gen->intOffsets = calloc(model->neuronsCount, sizeof(*gen->intOffsets));
+	gen->extOffsets = calloc(model->neuronsCount, sizeof(*gen->extOffsets));
+	gen->inputSlots = calloc(model->inputsDim, sizeof(*gen->inputSlots));
+	gen->neuronSlots = calloc(model->neuronsCount, sizeof(*gen->neuronSlots));
+	if (!gen->intOffsets || !gen->extOffsets || !gen->inputSlots || !gen->neuronSlots)
+		return -1;
+
+	for (uint32_t neuron = 0; neuron < model->neuronsCount; offset += model->intLinksCounters[neuron++])
+		gen->intOffsets[neuron] = offset;
+
+	for (uint32_t neuron = 0; neuron < model->neuronsCount; offset += model->extLinksCounters[neuron++])
+		gen->extOffsets[neuron] = offset;
+
+	if (offset != model->weightDim)
+	{
+		fprintf(stderr, "links counters do not match weights count\n");
+		return -1;
+	}
+
+	for (uint16_t input = 0; input < model->inputsDim; ++input)
+		gen->inputSlots[input] = UINT16_MAX;
+
+	for (uint32_t neuron = 0; neuron < model->neuronsCount; ++neuron)
+		gen->neuronSlots[neuron] = UINT16_MAX;
+
+	for (uint32_t step = 0; step < model->executionCount; ++step)
+	{
+		const uint32_t neuron = model->executionList ? model->executionList[step] : step;
+		gen->neuronSlots[neuron] = step;
+
+		for (uint16_t idx = 0; idx < model->intLinksCounters[neuron]; ++idx)
+		{
+			if (model->links[gen->intOffsets[neuron] + idx] >= model->neuronsCount)
+			{
+				fprintf(stderr, "neuron %u links to missing neuron\n", neuron);
+				return -1;
+			}
+		}
+
+		for (uint16_t idx = 0; idx < model->extLinksCounters[neuron]; ++idx)
+		{
+			const uint16_t input = model->links[gen->extOffsets[neuron] + idx];
+
+			if (input >= model->inputsDim)
+			{
+				fprintf(stderr, "neuron %u links to missing input\n", neuron);
+				return -1;
+			}
+
+			gen->inputSlots[input] = 0;
+		}
+	}
+
+	for (uint16_t input = 0; input < model->inputsDim; ++input)
+	{
+		if (gen->inputSlots[input] == 0)
+			gen->inputSlots[input] = gen->usedInputs++;
+	}
+
+	return 0;
+}
+
+
+static void EmitHeader(Generator* gen, const char* modelName)
+{
+	const NeuralNet* model = gen->model;
+
+	fprintf(gen->out,
+			"/**\n"
+			" * Generated by neuton_aot from %s, do not edit.\n"
+			" *\n"
+			" * Task type: %s\n"
+			" * Quantization: %u bit\n"
+			" * Activation: %s\n"
+			" * Input dimension (with BIAS): %u, used: %u\n"
+			" * Output dimension: %u\n"
+			" * Neurons: %u\n"
+			" * Weights: %u\n"
+			" */\n\n",
+			modelName, TaskName(model->taskType), model->quantisation,
+			model->quantisation == 32 ? "float" :
+				(model->options & BIT_FORCE_INTEGER_CALCULATIONS) ? "integer" : "float",
+			model->inputsDim, gen->usedInputs, model->outputsDim,
+			model->neuronsCount, model->weightDim);
+
+	fprintf(gen->out, "#include <stdint.h>\n#include <stddef.h>\n#include <math.h>\n\n");
+
+	if (!gen->prefix[0])
+		fprintf(gen->out, "#include \"user_app.h\"\n\n");
+
+	fprintf(gen->out, "\n#define MAX_INPUT_FLOAT\t\t\t0.9999999f\n\n\n");
+}
+
+
+/**
+ * \brief Emit input conversion and activation helpers, the arithmetic is the same as in neuton.c
+ */
+static void EmitHelpers(Generator* gen)
+{
+	const NeuralNet* model = gen->model;
+	FILE* out = gen->out;
+
+	if (model->quantisation == 32)
+	{
+		fprintf(out,
+				"static inline float normalizeInput(float value)\n"
+				"{\n"
+				"\treturn value > 1.0f ? 1.0f : value < 0.0f ? 0.0f : value;\n"
+				"}\n\n\n"
+				"static inline float activation(double coeff, double summ)\n"
+				"{\n"
+				"\treturn 1.0f / (1.0f + exp((double) -coeff * summ));\n"
+				"}\n\n\n");
+		return;
+	}
+
+	const unsigned q = model->quantisation;
+	const char* valueType = q == 8 ? "uint8_t" : "uint16_t";
+	const char* summType  = q == 8 ? "int32_t" : "int64_t";
+	const char* absType   = q == 8 ? "uint32_t" : "uint64_t";
+	const unsigned shift  = q == 8 ? 8 + 2 - 1 : 16 + 10 - 1;
+
+	fprintf(out,
+			"static inline %s quantiseInput(float value)\n"
+			"{\n"
+			"\treturn value > 0.0f ? (value > MAX_INPUT_FLOAT * %.1ff ? MAX_INPUT_FLOAT * %.1ff : value) : 0;\n"
+			"}\n\n\n",
+			valueType, ldexp(1.0, q), ldexp(1.0, q));
+
+	if (model->options & BIT_FORCE_INTEGER_CALCULATIONS)
+	{
+		if (q == 8)
+		{
+			fprintf(out,
+					"static const uint8_t sigmoidPoints[] =\n"
+					"{\n"
+					"\t0x80, 0x55, 0x33, 0x1C, 0x0F, 0x07, 0x03, 0x01, 0x00\n"
+					"};\n\n\n");
+		}
+		else
+		{
+			fprintf(out,
+					"static const uint16_t sigmoidPoints[] =\n"
+					"{\n"
+					"\t0x8000, 0x5555, 0x3333, 0x1C71, 0x0F0F, 0x07C1, 0x03F0, 0x01FC, 0x00FF,\n"
+					"\t0x007F, 0x003F, 0x001F, 0x000F, 0x0007, 0x0003, 0x0001, 0x0000\n"
+					"};\n\n\n");
+		}
+
+		fprintf(out,
+				"static %s activation(%s coeff, %s summ)\n"
+				"{\n"
+				"\tconst uint8_t QLVL = %u;\n"
+				"\tconst uint8_t LAST_POINT = sizeof(sigmoidPoints) / sizeof(sigmoidPoints[0]) - 1;\n"
+				"\tconst %s arg = -((coeff * summ) >> %u);\n"
+				"\tconst %s absArg = arg < 0 ? 0u - (%s) arg : (%s) arg;\n"
+				"\tconst %s intPart = absArg >> QLVL;\n"
+				"\tconst uint32_t realPart = absArg & ((1ul << QLVL) - 1);\n"
+				"\n"
+				"\tif (absArg == 0)\n"
+				"\t\treturn sigmoidPoints[0];\n"
+				"\n"
+				"\tconst %s firstPointY = sigmoidPoints[intPart < LAST_POINT ? (uint8_t) intPart : LAST_POINT];\n"
+				"\n"
+				"\tif (realPart == 0)\n"
+				"\t\treturn arg > 0 ? firstPointY : (%s) ~firstPointY;\n"
+				"\n"
+				"\tconst %s secondPointY = sigmoidPoints[intPart < LAST_POINT ? (uint8_t) intPart + 1 : LAST_POINT];\n"
+				"\n"
+				"\tconst %s qResult = ((uint32_t) ((1ul << QLVL) - realPart) * firstPointY +\n"
+				"\t\t\t\t\t\t(uint32_t) realPart * secondPointY) >> QLVL;\n"
+				"\tif (arg > 0)\n"
+				"\t\treturn qResult;\n"
+				"\telse\n"
+				"\t\treturn qResult == 0 ? UINT%u_MAX : (%s) ((1ul << QLVL) - qResult);\n"
+				"}\n\n\n",
+				valueType, summType, summType, q, summType, shift,
+				absType, absType, absType, absType,
+				valueType, valueType, valueType, valueType, q, valueType);
+	}
+	else
+	{
+		fprintf(out,
+				"static %s activation(%s coeff, %s summ)\n"
+				"{\n"
+				"\tconst float qs = (float) ((coeff * summ) >> %u) / %.1ff;\n"
+				"\tconst float tmpValue = 1.0f / (1.0f + expf(-qs));\n"
+				"\treturn ldexp(tmpValue > MAX_INPUT_FLOAT ? MAX_INPUT_FLOAT : tmpValue, %u);\n"
+				"}\n\n\n",
+				valueType, summType, summType, shift, ldexp(1.0, q), q);
+	}
+}
+
+
+/**
+ * \brief Emit conversion of the used inputs, matches NPrepareSample with NEUTON_INPUT_SCALES
+ */
+static void EmitInputs(Generator* gen)
+{
+	const NeuralNet* model = gen->model;
+	const uint16_t limitStep = (model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) > 0 ? 0 : 1;
+	const uint16_t bias = model->inputsDim - 1;
+	const float range = model->quantisation == 32 ? 1.0f : (float) ldexp(1.0, model->quantisation);
+	const char* convert = model->quantisation == 32 ? "normalizeInput" : "quantiseInput";
+	FILE* out = gen->out;
+
+	for (uint16_t input = 0; input < model->inputsDim; ++input)
+	{
+		if (gen->inputSlots[input] == UINT16_MAX)
+			continue;
+
+		const uint16_t limit = input * limitStep;
+		const float min = model->inputsMin[limit];
+		const float max = model->inputsMax[limit];
+
+		fprintf(out, "\tin[%u] = ", gen->inputSlots[input]);
+
+		if (input == bias)
+		{
+			if (model->quantisation == 32)
+				fprintf(out, "sample[%u];", input);
+			else
+				fprintf(out, "%s(sample[%u] * %.1ff);", convert, input, range);
+		}
+		else if (max != min)
+		{
+			fprintf(out, "%s((sample[%u] - ", convert, input);
+			PrintFloat(out, min);
+			fprintf(out, ") * ");
+			PrintFloat(out, range / (max - min));
+			fprintf(out, ");");
+		}
+		else
+		{
+			fprintf(out, "%s(sample[%u] * %.1ff);", convert, input, range);
+		}
+
+		fprintf(out, "\n");
+	}
+
+	fprintf(out, "\n");
+}
+
+
+static void EmitTerm(Generator* gen, uint32_t link, const char* buffer, uint16_t index)
+{
+	const NeuralNet* model = gen->model;
+	FILE* out = gen->out;
+
+	switch (model->quantisation)
+	{
+	case 8:
+		fprintf(out, "\tsumm += (int32_t) %d * %s[%u];\n", model->weights.i8[link], buffer, index);
+		break;
+
+	case 16:
+		fprintf(out, "\tsumm += (int64_t) %d * %s[%u];\n", model->weights.i16[link], buffer, index);
+		break;
+
+	default:
+		fprintf(out, "\tsumm += ");
+		PrintDouble(out, (double) model->weights.f32[link]);
+		fprintf(out, " * (double) %s[%u];\n", buffer, index);
+		break;
+	}
+
+	gen->emittedTerms++;
+}
+
+
+/**
+ * \brief Emit unrolled neurons, links to neurons not yet computed read zero and are dropped
+ */
+static void EmitNeurons(Generator* gen)
+{
+	const NeuralNet* model = gen->model;
+	FILE* out = gen->out;
+
+	for (uint32_t step = 0; step < model->executionCount; ++step)
+	{
+		const uint32_t neuron = model->executionList ? model->executionList[step] : step;
+
+		fprintf(out, "\t/* neuron %u */\n", neuron);
+
+		fprintf(out, "\tsumm = 0;\n");
+
+		for (uint16_t idx = 0; idx < model->intLinksCounters[neuron]; ++idx)
+		{
+			const uint32_t link = gen->intOffsets[neuron] + idx;
+			const uint16_t source = model->links[link];
+
+			if (source >= neuron)
+			{
+				gen->droppedTerms++;
+				continue;
+			}
+
+			EmitTerm(gen, link, "acc", gen->neuronSlots[source]);
+		}
+
+		if (model->quantisation == 32)
+			fprintf(out, "\textSumm = 0;\n");
+
+		for (uint16_t idx = 0; idx < model->extLinksCounters[neuron]; ++idx)
+		{
+			const uint32_t link = gen->extOffsets[neuron] + idx;
+			const uint16_t input = model->links[link];
+
+			if (model->quantisation == 32)
+			{
+				fprintf(out, "\textSumm += ");
+				PrintDouble(out, (double) model->weights.f32[link]);
+				fprintf(out, " * (double) in[%u];\n", gen->inputSlots[input]);
+				gen->emittedTerms++;
+			}
+			else
+			{
+				EmitTerm(gen, link, "in", gen->inputSlots[input]);
+			}
+		}
+
+		switch (model->quantisation)
+		{
+		case 8:
+			fprintf(out, "\tacc[%u] = activation(%u, summ);\n\n", step, model->fncCoeffs.u8[neuron]);
+			break;
+
+		case 16:
+			fprintf(out, "\tacc[%u] = activation(%u, summ);\n\n", step, model->fncCoeffs.u16[neuron]);
+			break;
+
+		default:
+			fprintf(out, "\tsumm += extSumm;\n\tacc[%u] = activation(", step);
+			PrintDouble(out, (double) model->fncCoeffs.f32[neuron]);
+			fprintf(out, ", summ);\n\n");
+			break;
+		}
+	}
+}
+
+
+/**
+ * \brief Emit output dequantisation and denormalisation, matches NDenormalizeResult
+ */
+static void EmitOutputs(Generator* gen)
+{
+	const NeuralNet* model = gen->model;
+	FILE* out = gen->out;
+
+	for (uint16_t idx = 0; idx < model->outputsDim; ++idx)
+	{
+		if (model->quantisation == 32)
+			fprintf(out, "\tresult[%u] = acc[%u];\n", idx, gen->neuronSlots[model->outputLabels[idx]]);
+		else
+			fprintf(out, "\tresult[%u] = (float) acc[%u] / %.1ff;\n", idx, gen->neuronSlots[model->outputLabels[idx]],
+					ldexp(1.0, model->quantisation));
+	}
+
+	fprintf(out, "\n");
+
+	if (model->taskType == TASK_BINARY_CLASSIFICATION)
+	{
+		fprintf(out, "\tsum = 0;\n");
+		for (uint16_t idx = 0; idx < model->outputsDim; ++idx)
+			fprintf(out, "\tsum += result[%u];\n", idx);
+		for (uint16_t idx = 0; idx < model->outputsDim; ++idx)
+			fprintf(out, "\tresult[%u] = result[%u] / sum;\n", idx, idx);
+		fprintf(out, "\n");
+	}
+
+	if (model->taskType == TASK_MULTICLASS_CLASSIFICATION || model->taskType == TASK_REGRESSION)
+	{
+		const uint8_t hasLogScale = (model->options & BIT_LOG_SCALE_OUT_EXISTS) > 0;
+
+		for (uint16_t idx = 0; idx < model->outputsDim; ++idx)
+		{
+			fprintf(out, "\tresult[%u] = result[%u] * ", idx, idx);
+			PrintFloat(out, model->outputsMax[idx] - model->outputsMin[idx]);
+			fprintf(out, " + ");
+			PrintFloat(out, model->outputsMin[idx]);
+			fprintf(out, ";\n");
+
+			if (hasLogScale && (model->outputsLogOffset[idx] != 0xFFFFFFFF))
+			{
+				fprintf(out, "\tresult[%u] = exp(result[%u]) - ", idx, idx);
+				PrintFloat(out, model->outputsLogOffset[idx]);
+				fprintf(out, ";\n");
+			}
+		}
+		fprintf(out, "\n");
+	}
+}
+
+
+static void EmitFunctions(Generator* gen)
+{
+	const NeuralNet* model = gen->model;
+	FILE* out = gen->out;
+	const char* valueType = model->quantisation == 8 ? "uint8_t" : model->quantisation == 16 ? "uint16_t" : "float";
+	const char* summType  = model->quantisation == 8 ? "int32_t" : model->quantisation == 16 ? "int64_t" : "double";
+
+	fprintf(out,
+			"uint8_t %smodel_init()\n"
+			"{\n"
+			"\treturn 1;\n"
+			"}\n\n\n",
+			gen->prefix);
+
+	fprintf(out,
+			"float* %smodel_run_inference(float* sample, uint32_t size_in, uint32_t* size_out)\n"
+			"{\n"
+			"\tstatic float result[%u];\n"
+			"\t%s in[%u];\n"
+			"\t%s acc[%u];\n"
+			"\t%s summ;\n",
+			gen->prefix, model->outputsDim, valueType, gen->usedInputs ? gen->usedInputs : 1,
+			valueType, model->executionCount, summType);
+
+	if (model->quantisation == 32)
+		fprintf(out, "\tdouble extSumm;\n");
+	if (model->taskType == TASK_BINARY_CLASSIFICATION)
+		fprintf(out, "\tfloat sum;\n");
+
+	fprintf(out,
+			"\n"
+			"\tif (!sample || !size_out)\n"
+			"\t\treturn NULL;\n"
+			"\n"
+			"\tif (size_in != %u)\n"
+			"\t\treturn NULL;\n"
+			"\n"
+			"\t*size_out = %u;\n"
+			"\n",
+			model->inputsDim, model->outputsDim);
+
+	EmitInputs(gen);
+	EmitNeurons(gen);
+	EmitOutputs(gen);
+
+	fprintf(out, "\treturn result;\n}\n");
+}
+
+
+int main(int argc, char** argv)
+{
+	const char* prefix = "";
+	int arg = 1;
+
+	if (argc > 2 && strcmp(argv[1], "-p") == 0)
+	{
+		prefix = argv[2];
+		arg = 3;
+	}
+
+	if (argc - arg != 2)
+	{
+		fprintf(stderr, "Usage: %s [-p prefix] model.bin output.c\n", argv[0]);
+		return 1;
+	}
+
+	NeuralNet model = { 0 };
+	Err err = NLoadModelEx(argv[arg], &model);
+	if (err != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Failed to load %s: error %d\n", argv[arg], err);
+		return 1;
+	}
+
+	Generator gen = { 0 };
+	gen.model  = &model;
+	gen.prefix = prefix;
+
+	if (Prepare(&gen) != 0)
+		return 1;
+
+	gen.out = fopen(argv[arg + 1], "w");
+	if (!gen.out)
+	{
+		fprintf(stderr, "Failed to open %s\n", argv[arg + 1]);
+		return 1;
+	}
+
+	const char* modelName = strrchr(argv[arg], '/');
+	EmitHeader(&gen, modelName ? modelName + 1 : argv[arg]);
+	EmitHelpers(&gen);
+	EmitFunctions(&gen);
+
+	const long sourceSize = ftell(gen.out);
+	fclose(gen.out);
+
+	NPruneReport pruned;
+	NGetPruneReport(&model, &pruned);
+
+	printf("model:        %u bit, %u neurons, %u weights\n",
+		   model.quantisation, model.neuronsCount, model.weightDim);
+	printf("pruned:       %u neurons, %u links, %u bytes do not feed the outputs\n",
+		   pruned.neurons, pruned.links, pruned.bytes);
+	printf("inputs:       %u of %u used\n", gen.usedInputs, model.inputsDim);
+	printf("terms:        %u emitted, %u dropped (links to neurons computed later read zero)\n",
+		   gen.emittedTerms, gen.droppedTerms);
+	printf("source:       %ld bytes written to %s\n", sourceSize, argv[arg + 1]);
+	printf("stack:        %u bytes of inputs and accumulators\n",
+		   (unsigned) ((gen.usedInputs + model.executionCount) * (model.quantisation / 8)));
+
+	free(gen.intOffsets);
+	free(gen.extOffsets);
+	free(gen.inputSlots);
+	free(gen.neuronSlots);
+	NFreeModel(&model);
+
+	return 0;
+}
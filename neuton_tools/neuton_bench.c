@@ -0,0 +1,222 @@
+/**
+ ******************************************************************************
+ * @file    neuton_bench.c
+ * @brief   Inference latency and throughput of Neuton models for a growing number
+ *          of threads
+ *
+ * By default neurons of one inference are evaluated by several threads, the library
+ * must be built with NEUTON_THREADS=1 then. With -s every thread runs its own stream
+ * of inferences on the shared model with its own context. The layout column tells
+ * the models re-laid out into link records (NEUTON_INTERLEAVED_LINKS) from the ones
+ * with separate links and weights arrays. See README.md.
+ *
+ * Usage: neuton_bench [-s] [-t max_threads] [-r runs] model.bin...
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "neuton/neuton.h"
+
+
+/**
+ * \brief Stream of inferences run by one thread
+ */
+typedef struct Stream_
+{
+	const NeuralNet* model;
+	const float*     inputs;
+	uint32_t         runs;
+	Err              err;
+
+} Stream;
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static int CompareDouble(const void* a, const void* b)
+{
+	const double x = *(const double*) a, y = *(const double*) b;
+	return (x > y) - (x < y);
+}
+
+
+/**
+ * \brief Median latency of the inference over runs, inputs are pseudo-random in 0.0 - 1.0
+ * \return seconds per inference
+ */
+static double MeasureLatency(NeuralNet* model, float* inputs, uint32_t runs)
+{
+	double* times = malloc(runs * sizeof(double));
+	volatile float sink = 0;
+
+	for (uint32_t run = 0; run < runs; ++run)
+	{
+		const double start = Now();
+		sink += NRunInference(model, inputs)[0];
+		times[run] = Now() - start;
+	}
+
+	qsort(times, runs, sizeof(double), CompareDouble);
+	const double median = times[runs / 2];
+	free(times);
+
+	return median;
+}
+
+
+static void* RunStream(void* arg)
+{
+	Stream* stream = arg;
+	NContext context = { 0 };
+	volatile float sink = 0;
+
+	stream->err = NCreateContext(stream->model, &context);
+	if (stream->err != ERR_NO_ERROR)
+		return NULL;
+
+	for (uint32_t run = 0; run < stream->runs; ++run)
+		sink += NRunInferenceContext(stream->model, &context, stream->inputs)[0];
+
+	NFreeContext(&context);
+
+	return NULL;
+}
+
+
+/**
+ * \brief Throughput of threads running inferences on the shared model
+ * \return inferences per second or 0 on failure
+ */
+static double MeasureThroughput(const NeuralNet* model, const float* inputs, uint32_t threads, uint32_t runs)
+{
+	pthread_t handles[256];
+	Stream streams[256];
+	uint8_t failed = 0;
+
+	const double start = Now();
+
+	for (uint32_t idx = 0; idx < threads; ++idx)
+	{
+		streams[idx] = (Stream) { model, inputs, runs, ERR_NO_ERROR };
+		pthread_create(&handles[idx], NULL, RunStream, &streams[idx]);
+	}
+
+	for (uint32_t idx = 0; idx < threads; ++idx)
+	{
+		pthread_join(handles[idx], NULL);
+		failed |= streams[idx].err != ERR_NO_ERROR;
+	}
+
+	return failed ? 0 : (double) threads * runs / (Now() - start);
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t maxThreads = 4, runs = 1000;
+	uint8_t streams = 0;
+	int arg = 1;
+
+	for (; arg < argc && argv[arg][0] == '-'; ++arg)
+	{
+		if (strcmp(argv[arg], "-s") == 0)
+			streams = 1;
+		else if (strcmp(argv[arg], "-t") == 0 && arg + 1 < argc)
+			maxThreads = (uint32_t) atoi(argv[++arg]);
+		else if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc)
+			runs = (uint32_t) atoi(argv[++arg]);
+		else
+			break;
+	}
+
+	if (arg >= argc || argv[arg][0] == '-' || !maxThreads || maxThreads > 255 || !runs)
+	{
+		fprintf(stderr, "Usage: %s [-s] [-t max_threads] [-r runs] model.bin...\n", argv[0]);
+		return 1;
+	}
+
+	if (streams)
+		printf("model,neurons,evaluated,weights,layout,threads,inferences_per_s,speedup\n");
+	else
+		printf("model,neurons,evaluated,weights,layout,threads,latency_us,speedup\n");
+
+	for (; arg < argc; ++arg)
+	{
+		NeuralNet model = { 0 };
+		if (NLoadModelEx(argv[arg], &model) != ERR_NO_ERROR)
+		{
+			fprintf(stderr, "Failed to load %s\n", argv[arg]);
+			continue;
+		}
+
+		float* inputs = malloc(model.inputsDim * sizeof(float));
+		uint32_t seed = 1;
+		for (uint16_t idx = 0; idx < model.inputsDim; ++idx)
+		{
+			seed = seed * 1103515245u + 12345u;
+			inputs[idx] = (float) ((seed >> 8) & 0xFFFF) / 65536.0f;
+		}
+		inputs[model.inputsDim - 1] = 1.0f;
+
+		const char* layout = model.linkRecords.raw ? "records" : "arrays";
+		double sequential = 0;
+
+		for (uint32_t threads = 1; streams && threads <= maxThreads; ++threads)
+		{
+			const double throughput = MeasureThroughput(&model, inputs, threads, runs);
+			if (!throughput)
+			{
+				fprintf(stderr, "%s: failed to create contexts\n", argv[arg]);
+				break;
+			}
+
+			if (threads == 1)
+				sequential = throughput;
+
+			printf("%s,%u,%u,%u,%s,%u,%.0f,%.2f\n", argv[arg], model.neuronsCount, model.executionCount,
+				   model.weightDim, layout, threads, throughput, throughput / sequential);
+		}
+
+		for (uint32_t threads = 1; !streams && threads <= maxThreads; ++threads)
+		{
+			const Err err = NSetThreads(&model, (uint8_t) threads);
+			if (err != ERR_NO_ERROR)
+			{
+				fprintf(stderr, "%s: threads are not supported (error %d)\n", argv[arg], err);
+				break;
+			}
+
+			if (threads > 1 && !model.parallel)
+			{
+				fprintf(stderr, "%s: model is too small, too deep or has shared accumulator slots, "
+						"inference stays sequential\n", argv[arg]);
+				break;
+			}
+
+			const double latency = MeasureLatency(&model, inputs, runs);
+			if (threads == 1)
+				sequential = latency;
+
+			printf("%s,%u,%u,%u,%s,%u,%.2f,%.2f\n", argv[arg], model.neuronsCount, model.executionCount,
+				   model.weightDim, layout, threads, latency * 1e6, sequential / latency);
+		}
+
+		free(inputs);
+		NFreeModel(&model);
+	}
+
+	return 0;
+}
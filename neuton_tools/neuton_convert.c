@@ -0,0 +1,693 @@
+/**
+ ******************************************************************************
+ * @file    neuton_convert.c
+ * @brief   Converter of Neuton models into the model file format version 2
+ *
+ * The model is loaded by the library (version 1 or 2, any byte order) and
+ * written with the section table, the precomputed links offsets, input scales
+ * and execution list in the byte order of the host (see NModelHeaderV2).
+ * Both files are then loaded from memory as the sketch does, and the load time
+ * and the RAM allocated by the library are reported for each. The outputs of
+ * the version 2 file by NRunInference, NInferenceStep and NRunInferenceBatch are
+ * compared with NRunInference of the input file, see CheckOutputs.
+ * With -r neurons that are not alive at the same time share accumulator slots,
+ * see AssignSlots.
+ *
+ * Usage: neuton_convert [-a align] [-r] model.bin output.bin
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "neuton/neuton.h"
+
+
+#if defined(NEUTON_INTERLEAVED_LINKS) && (NEUTON_INTERLEAVED_LINKS == 1)
+#error "Build without NEUTON_INTERLEAVED_LINKS, the re-laid out model can not be written"
+#endif
+#if defined(NEUTON_INPUT_SCALES) && (NEUTON_INPUT_SCALES == 0)
+#error "Build with NEUTON_INPUT_SCALES, the input scales are written to the file"
+#endif
+
+#if defined(NEUTON_MEMORY_BENCHMARK)
+uint32_t _NeutonExtraMemoryUsage()
+{
+	return 0;
+}
+#endif
+
+
+#define LOAD_RUNS				21
+#define CHECK_SAMPLES			32
+#define CHECK_STEP_BUDGET		3
+
+
+/**
+ * \brief Output file being written
+ */
+typedef struct Writer_
+{
+	uint8_t* data;
+	uint32_t size;
+	uint32_t capacity;
+
+	/**
+	 * \brief Minimal alignment of the sections
+	 */
+	uint16_t align;
+
+	NSection sections[SECTIONS_COUNT];
+	uint32_t sectionsCount;
+
+} Writer;
+
+
+static int Reserve(Writer* writer, uint32_t size)
+{
+	if (writer->size + size <= writer->capacity)
+		return 0;
+
+	uint32_t capacity = writer->capacity ? writer->capacity : 4096;
+	while (capacity < writer->size + size)
+		capacity *= 2;
+
+	uint8_t* data = realloc(writer->data, capacity);
+	if (!data)
+		return -1;
+
+	memset(data + writer->capacity, 0, capacity - writer->capacity);
+	writer->data     = data;
+	writer->capacity = capacity;
+
+	return 0;
+}
+
+
+static int Write(Writer* writer, const void* data, uint32_t size)
+{
+	if (Reserve(writer, size) != 0)
+		return -1;
+
+	memcpy(writer->data + writer->size, data, size);
+	writer->size += size;
+
+	return 0;
+}
+
+
+/**
+ * \brief Append section aligned by the larger of its value size and the minimal alignment
+ */
+static int WriteSection(Writer* writer, uint16_t id, const void* data, uint32_t size, uint16_t valueSize)
+{
+	const uint16_t align = (valueSize > writer->align) ? valueSize : writer->align;
+	const uint32_t padding = (align - writer->size % align) % align;
+
+	if (Reserve(writer, padding) != 0)
+		return -1;
+	writer->size += padding;
+
+	NSection* section = &writer->sections[writer->sectionsCount++];
+	section->id     = id;
+	section->align  = align;
+	section->offset = writer->size;
+	section->size   = size;
+
+	return Write(writer, data, size);
+}
+
+
+static uint32_t Crc32(const uint8_t* buffer, uint32_t size)
+{
+	static uint32_t table[256];
+
+	if (!table[1])
+	{
+		for (uint32_t n = 0; n < 256; n++)
+		{
+			uint32_t crc = n;
+			for (uint32_t k = 0; k < 8; k++)
+				crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+			table[n] = crc;
+		}
+	}
+
+	uint32_t crc = ~0u;
+	while (size--)
+		crc = (crc >> 8) ^ table[(crc ^ *buffer++) & 0xFF];
+
+	return ~crc;
+}
+
+
+/**
+ * \brief Store the links offsets of the neurons with the value size of the file
+ */
+static void* MakeOffsets(const NeuralNet* model, const uint16_t* counters, uint32_t first,
+						 uint8_t offsetTypeSize)
+{
+	uint8_t* offsets = calloc(model->neuronsCount, offsetTypeSize);
+	if (!offsets)
+		return NULL;
+
+	uint32_t offset = first;
+	for (uint32_t neuron = 0; neuron < model->neuronsCount; offset += counters[neuron++])
+	{
+		switch (offsetTypeSize)
+		{
+		case 4:  ((uint32_t*) offsets)[neuron] = offset; break;
+		case 2:  ((uint16_t*) offsets)[neuron] = offset; break;
+		default: offsets[neuron] = offset; break;
+		}
+	}
+
+	return offsets;
+}
+
+
+/**
+ * \brief Share accumulator slots between neurons that are not alive at the same time
+ * \details The value of a neuron is alive from its evaluation to the evaluation of its last
+ *          reader, or to the end for outputs. The inputs of a neuron are read before its
+ *          value is written, so it can take the slot of a value it reads last. Slots are
+ *          taken in the evaluation order from the slots freed so far, which gives the least
+ *          slots for this order. Links to the neuron itself and to the neurons evaluated
+ *          later or not at all read 0, they are moved to a slot that is never written.
+ * \param model - loaded model with links between neurons
+ * \param slots - output, slot of every neuron (size model->neuronsCount)
+ * \param links - output, model links with the internal links rewritten to slots
+ *        (size model->weightDim)
+ * \return count of slots or 0 on failure
+ */
+static uint32_t AssignSlots(const NeuralNet* model, uint16_t* slots, uint16_t* links)
+{
+	const uint32_t neuronsCount = model->neuronsCount;
+	const uint32_t notEvaluated = UINT32_MAX;
+	const uint32_t notRead      = UINT32_MAX;
+
+	uint32_t* offsets   = calloc(neuronsCount, sizeof(*offsets));
+	uint32_t* steps     = calloc(neuronsCount, sizeof(*steps));
+	uint32_t* lastReads = calloc(neuronsCount, sizeof(*lastReads));
+	uint16_t* freeSlots = calloc(neuronsCount, sizeof(*freeSlots));
+	if (!offsets || !steps || !lastReads || !freeSlots)
+	{
+		free(offsets);
+		free(steps);
+		free(lastReads);
+		free(freeSlots);
+		return 0;
+	}
+
+	uint32_t offset = 0;
+	for (uint32_t neuron = 0; neuron < neuronsCount; offset += model->intLinksCounters[neuron++])
+	{
+		offsets[neuron]   = offset;
+		steps[neuron]     = notEvaluated;
+		lastReads[neuron] = notRead;
+	}
+
+	for (uint32_t step = 0; step < model->executionCount; step++)
+		steps[model->executionList ? model->executionList[step] : step] = step;
+
+	// A link reads the neuron value if the neuron is evaluated before, otherwise it reads 0
+	uint8_t zeroRead = 0;
+	for (uint32_t step = 0; step < model->executionCount; step++)
+	{
+		const uint32_t neuron = model->executionList ? model->executionList[step] : step;
+
+		for (uint32_t link = offsets[neuron]; link < offsets[neuron] + model->intLinksCounters[neuron]; link++)
+		{
+			const uint16_t source = model->links[link];
+
+			if (source < neuronsCount && steps[source] < step)
+				lastReads[source] = step;
+			else
+				zeroRead = 1;
+		}
+	}
+
+	for (uint16_t idx = 0; idx < model->outputsDim; idx++)
+	{
+		if (steps[model->outputLabels[idx]] != notEvaluated)
+			lastReads[model->outputLabels[idx]] = model->executionCount;
+		else
+			zeroRead = 1;
+	}
+
+	const uint16_t zeroSlot = 0;
+	uint32_t count = zeroRead, freeCount = 0;
+
+	for (uint32_t step = 0; step < model->executionCount; step++)
+	{
+		const uint32_t neuron = model->executionList ? model->executionList[step] : step;
+
+		for (uint32_t link = offsets[neuron]; link < offsets[neuron] + model->intLinksCounters[neuron]; link++)
+		{
+			const uint16_t source = model->links[link];
+
+			// A value read twice by the neuron is freed once
+			if (source < neuronsCount && lastReads[source] == step)
+			{
+				freeSlots[freeCount++] = slots[source];
+				lastReads[source] = notRead - 1;
+			}
+		}
+
+		slots[neuron] = freeCount ? freeSlots[--freeCount] : count++;
+
+		// Values that nobody reads are overwritten by the next neuron
+		if (lastReads[neuron] == notRead)
+			freeSlots[freeCount++] = slots[neuron];
+	}
+
+	memcpy(links, model->links, model->weightDim * sizeof(*links));
+
+	for (uint32_t neuron = 0; neuron < neuronsCount; neuron++)
+	{
+		const uint32_t step = steps[neuron];
+
+		if (step == notEvaluated)
+			slots[neuron] = zeroSlot;
+
+		for (uint32_t link = offsets[neuron]; link < offsets[neuron] + model->intLinksCounters[neuron]; link++)
+		{
+			const uint16_t source = model->links[link];
+			const uint8_t  reads  = step != notEvaluated && source < neuronsCount && steps[source] < step;
+
+			links[link] = reads ? slots[source] : zeroSlot;
+		}
+	}
+
+	free(offsets);
+	free(steps);
+	free(lastReads);
+	free(freeSlots);
+
+	return count;
+}
+
+
+static int WriteModel(Writer* writer, const NeuralNet* model, const uint16_t* slots, const uint16_t* links)
+{
+	const uint8_t  coeffTypeSize  = model->quantisation / 8;
+	const uint8_t  offsetTypeSize = model->weightDim <= 256 ? 1 : model->weightDim <= 65536 ? 2 : 4;
+	const uint32_t limitsCount    = (model->options & BIT_ONE_MAXMIN_FOR_ALL_INPUTS) ? 1 : model->inputsDim;
+	const uint32_t limitsSize     = limitsCount * sizeof(float);
+	const uint32_t outputsSize    = model->outputsDim * sizeof(float);
+	const uint32_t countersSize   = model->neuronsCount * sizeof(uint16_t);
+
+	uint32_t intLinksCount = 0;
+	for (uint32_t neuron = 0; neuron < model->neuronsCount; neuron++)
+		intLinksCount += model->intLinksCounters[neuron];
+
+	void* intOffsets = MakeOffsets(model, model->intLinksCounters, 0, offsetTypeSize);
+	void* extOffsets = MakeOffsets(model, model->extLinksCounters, intLinksCount, offsetTypeSize);
+	if (!intOffsets || !extOffsets)
+	{
+		free(intOffsets);
+		free(extOffsets);
+		return -1;
+	}
+
+	const uint8_t  nb[2]   = { 'n', 'b' };
+	const uint8_t  type    = 5;
+	const uint8_t  version = 2;
+	const uint16_t bom     = 0xABCD;
+
+	NModelHeaderV2 header = { 0 };
+	header.options        = model->options;
+	header.taskType       = model->taskType;
+	header.quantisation   = model->quantisation;
+	header.offsetTypeSize = offsetTypeSize;
+	header.inputsDim      = model->inputsDim;
+	header.outputsDim     = model->outputsDim;
+	header.neuronsCount   = model->neuronsCount;
+	header.weightDim      = model->weightDim;
+	header.executionCount = model->executionCount;
+	header.sectionsCount  = 13 + (model->outputsLogOffset != NULL) + (model->executionList != NULL) +
+							(slots != NULL);
+
+	const uint32_t tablePos = sizeof(nb) + sizeof(type) + sizeof(version) + sizeof(bom) + sizeof(header);
+
+	int res = Write(writer, nb, sizeof(nb)) | Write(writer, &type, sizeof(type)) |
+			  Write(writer, &version, sizeof(version)) | Write(writer, &bom, sizeof(bom)) |
+			  Write(writer, &header, sizeof(header)) | Reserve(writer, header.sectionsCount * sizeof(NSection));
+	writer->size += header.sectionsCount * sizeof(NSection);
+
+	res |= WriteSection(writer, SECTION_INPUTS_MAX,  model->inputsMax,  limitsSize,  sizeof(float));
+	res |= WriteSection(writer, SECTION_INPUTS_MIN,  model->inputsMin,  limitsSize,  sizeof(float));
+	res |= WriteSection(writer, SECTION_OUTPUTS_MAX, model->outputsMax, outputsSize, sizeof(float));
+	res |= WriteSection(writer, SECTION_OUTPUTS_MIN, model->outputsMin, outputsSize, sizeof(float));
+	if (model->outputsLogOffset)
+		res |= WriteSection(writer, SECTION_OUTPUTS_LOG_OFFSET, model->outputsLogOffset, outputsSize, sizeof(float));
+	res |= WriteSection(writer, SECTION_OUTPUT_LABELS, model->outputLabels,
+						model->outputsDim * sizeof(uint16_t), sizeof(uint16_t));
+	res |= WriteSection(writer, SECTION_INT_LINKS_COUNTERS, model->intLinksCounters, countersSize, sizeof(uint16_t));
+	res |= WriteSection(writer, SECTION_EXT_LINKS_COUNTERS, model->extLinksCounters, countersSize, sizeof(uint16_t));
+	res |= WriteSection(writer, SECTION_LINKS, links, model->weightDim * sizeof(uint16_t), sizeof(uint16_t));
+	res |= WriteSection(writer, SECTION_WEIGHTS, model->weights.raw, model->weightDim * coeffTypeSize, coeffTypeSize);
+	res |= WriteSection(writer, SECTION_FNC_COEFFS, model->fncCoeffs.raw, model->neuronsCount * coeffTypeSize,
+						coeffTypeSize);
+	res |= WriteSection(writer, SECTION_INT_LINKS, intOffsets, model->neuronsCount * offsetTypeSize, offsetTypeSize);
+	res |= WriteSection(writer, SECTION_EXT_LINKS, extOffsets, model->neuronsCount * offsetTypeSize, offsetTypeSize);
+	res |= WriteSection(writer, SECTION_INPUTS_SCALE, model->inputsScale, limitsSize, sizeof(float));
+	if (model->executionList)
+		res |= WriteSection(writer, SECTION_EXECUTION_LIST, model->executionList,
+							model->executionCount * sizeof(uint16_t), sizeof(uint16_t));
+	if (slots)
+		res |= WriteSection(writer, SECTION_ACCUMULATOR_SLOTS, slots, countersSize, sizeof(uint16_t));
+
+	free(intOffsets);
+	free(extOffsets);
+
+	if (res != 0 || writer->sectionsCount != header.sectionsCount)
+		return -1;
+
+	memcpy(writer->data + tablePos, writer->sections, header.sectionsCount * sizeof(NSection));
+
+	const uint32_t crc = Crc32(writer->data, writer->size);
+	return Write(writer, &crc, sizeof(crc));
+}
+
+
+static int CompareDouble(const void* a, const void* b)
+{
+	const double x = *(const double*) a, y = *(const double*) b;
+	return (x > y) - (x < y);
+}
+
+
+/**
+ * \brief Load the model from memory as the sketch does and report the load time and RAM
+ */
+static int ReportLoad(const char* name, const uint8_t* data, uint32_t size)
+{
+	double times[LOAD_RUNS];
+	uint32_t ram = 0;
+
+	for (uint32_t run = 0; run < LOAD_RUNS; run++)
+	{
+		NeuralNet model = { 0 };
+		const uint32_t before = NBytesAllocated();
+
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		const Err err = NLoadModel(NFileFromBuffer(data, size), &model, 0);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		if (err != ERR_NO_ERROR)
+		{
+			fprintf(stderr, "Failed to load %s from memory: error %d\n", name, err);
+			return -1;
+		}
+
+		times[run] = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) * 1e-3;
+		ram = NBytesAllocated() - before;
+		NFreeModel(&model);
+	}
+
+	qsort(times, LOAD_RUNS, sizeof(*times), CompareDouble);
+
+#if defined(NEUTON_MEMORY_BENCHMARK)
+	printf("%-12s  %8u bytes, load %9.1f us, RAM %8u bytes\n", name, size, times[LOAD_RUNS / 2], ram);
+#else
+	(void) ram;
+	printf("%-12s  %8u bytes, load %9.1f us, RAM n/a (build with -DNEUTON_MEMORY_BENCHMARK)\n",
+		   name, size, times[LOAD_RUNS / 2]);
+#endif
+
+	return 0;
+}
+
+
+/**
+ * \brief Run seeded samples through a model by NRunInference, NInferenceStep and
+ *        NRunInferenceBatch
+ *
+ * \param outputs - CHECK_SAMPLES outputs of every path, sample by sample
+ *
+ * \return 0 on success, -1 if the model can not be loaded or run
+ */
+static int RunPaths(const uint8_t* data, uint32_t size, float* outputs[3])
+{
+	NeuralNet model = { 0 };
+	if (NLoadModel(NFileFromBuffer(data, size), &model, 0) != ERR_NO_ERROR)
+		return -1;
+
+	const uint32_t inputsDim  = model.inputsDim;
+	const uint32_t outputsDim = model.outputsDim;
+
+	NContext context;
+	float* samples = malloc(CHECK_SAMPLES * inputsDim * sizeof(float));
+	float* input   = malloc(inputsDim * sizeof(float));
+	float* batch   = malloc(CHECK_SAMPLES * inputsDim * sizeof(float));
+	int res = (samples && input && batch && NCreateContext(&model, &context) == ERR_NO_ERROR) ? 0 : -1;
+
+	if (res == 0)
+	{
+		// The last input is the bias, fed as 1 as the model was trained
+		srand(1);
+		for (uint32_t i = 0; i < CHECK_SAMPLES * inputsDim; i++)
+			samples[i] = (i % inputsDim == inputsDim - 1) ? 1.0f : (float) rand() / RAND_MAX;
+
+		for (uint32_t sample = 0; sample < CHECK_SAMPLES && res == 0; sample++)
+		{
+			// The inference may normalise the inputs in place
+			memcpy(input, samples + sample * inputsDim, inputsDim * sizeof(float));
+			const float* result = NRunInference(&model, input);
+			if (result)
+				memcpy(outputs[0] + sample * outputsDim, result, outputsDim * sizeof(float));
+
+			memcpy(input, samples + sample * inputsDim, inputsDim * sizeof(float));
+			const float* step = NULL;
+			if (NStartInference(&model, &context, input) == ERR_NO_ERROR)
+				while (!(step = NInferenceStep(&model, &context, CHECK_STEP_BUDGET)));
+			if (step)
+				memcpy(outputs[1] + sample * outputsDim, step, outputsDim * sizeof(float));
+
+			if (!result || !step)
+				res = -1;
+		}
+
+		NFreeContext(&context);
+	}
+
+	if (res == 0)
+	{
+		// NRunInferenceBatch takes the inputs input by input
+		for (uint32_t sample = 0; sample < CHECK_SAMPLES; sample++)
+			for (uint32_t i = 0; i < inputsDim; i++)
+				batch[i * CHECK_SAMPLES + sample] = samples[sample * inputsDim + i];
+
+		if (NRunInferenceBatch(&model, batch, CHECK_SAMPLES, outputs[2]) != ERR_NO_ERROR)
+			res = -1;
+	}
+
+	free(samples);
+	free(input);
+	free(batch);
+	NFreeModel(&model);
+
+	return res;
+}
+
+
+/**
+ * \brief Check that every inference path of the version 2 file gives the outputs of the
+ *        input file
+ *
+ * \details The int/ext links offsets of the version 2 file are written with the width the
+ *          library derives from weightDim. A model with exactly 256 or 65536 weights is
+ *          the boundary of that rule.
+ *
+ * \return 0 if all outputs match, -1 otherwise
+ */
+static int CheckOutputs(const uint8_t* input, uint32_t inputSize, const uint8_t* output, uint32_t outputSize)
+{
+	static const char* paths[] = { "NRunInference", "NInferenceStep", "NRunInferenceBatch" };
+
+	NeuralNet model = { 0 };
+	if (NLoadModel(NFileFromBuffer(input, inputSize), &model, 0) != ERR_NO_ERROR)
+		return -1;
+	const uint32_t count = CHECK_SAMPLES * model.outputsDim;
+	NFreeModel(&model);
+
+	float* expected[3];
+	float* actual[3];
+	float* values = malloc(6 * count * sizeof(float));
+	if (!values)
+		return -1;
+	for (uint32_t path = 0; path < 3; path++)
+	{
+		expected[path] = values + path * count;
+		actual[path]   = values + (3 + path) * count;
+	}
+
+	int res = 0;
+	if (RunPaths(input, inputSize, expected) != 0 || RunPaths(output, outputSize, actual) != 0)
+	{
+		fprintf(stderr, "Failed to run the models for the outputs check\n");
+		free(values);
+		return -1;
+	}
+
+	for (uint32_t path = 0; path < 3; path++)
+	{
+		uint32_t mismatches = 0;
+		for (uint32_t i = 0; i < count; i++)
+			mismatches += (actual[path][i] != expected[0][i]);
+
+		printf("%-18s  %u of %u outputs differ from the input file\n", paths[path], mismatches, count);
+		if (mismatches)
+			res = -1;
+	}
+
+	free(values);
+
+	return res;
+}
+
+
+static uint8_t* ReadFile(const char* fileName, uint32_t* size)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
+		return NULL;
+
+	fseek(file, 0, SEEK_END);
+	const long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	uint8_t* data = (length > 0) ? malloc(length) : NULL;
+	if (data && fread(data, length, 1, file) != 1)
+	{
+		free(data);
+		data = NULL;
+	}
+
+	fclose(file);
+	*size = length;
+
+	return data;
+}
+
+
+int main(int argc, char** argv)
+{
+	Writer writer = { 0 };
+	writer.align = 1;
+	uint8_t shareSlots = 0;
+	int arg = 1;
+
+	for (; arg < argc && argv[arg][0] == '-'; arg++)
+	{
+		if (strcmp(argv[arg], "-a") == 0 && arg + 1 < argc)
+			writer.align = atoi(argv[++arg]);
+		else if (strcmp(argv[arg], "-r") == 0)
+			shareSlots = 1;
+		else
+			break;
+	}
+
+	if (argc - arg != 2 || !writer.align || (writer.align & (writer.align - 1)))
+	{
+		fprintf(stderr, "Usage: %s [-a align] [-r] model.bin output.bin\n", argv[0]);
+		return 1;
+	}
+
+	uint32_t inputSize = 0;
+	uint8_t* input = ReadFile(argv[arg], &inputSize);
+	if (!input)
+	{
+		fprintf(stderr, "Failed to read %s\n", argv[arg]);
+		return 1;
+	}
+
+	NeuralNet model = { 0 };
+	Err err = NLoadModel(NFileFromBuffer(input, inputSize), &model, 1);
+	if (err != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Failed to load %s: error %d\n", argv[arg], err);
+		return 1;
+	}
+
+	const uint8_t  inputVersion = model.version;
+	const uint8_t  accTypeSize  = model.quantisation / 8;
+	const uint32_t neuronsCount = model.neuronsCount;
+
+	// Links of a model with slots already hold slots, they are written as they are
+	uint16_t* slots = model.accumulatorSlots;
+	uint16_t* links = model.links;
+	uint32_t  slotsCount = model.accumulatorsCount;
+
+	if (shareSlots && !model.accumulatorSlots)
+	{
+		slots = malloc(neuronsCount * sizeof(*slots));
+		links = malloc(model.weightDim * sizeof(*links));
+		slotsCount = (slots && links) ? AssignSlots(&model, slots, links) : 0;
+		if (!slotsCount)
+		{
+			fprintf(stderr, "Failed to assign accumulator slots\n");
+			return 1;
+		}
+
+		// Slots that save nothing are not written
+		if (slotsCount >= neuronsCount)
+		{
+			free(slots);
+			free(links);
+			slots = NULL;
+			links = model.links;
+			slotsCount = neuronsCount;
+		}
+	}
+
+	if (WriteModel(&writer, &model, slots, links) != 0)
+	{
+		fprintf(stderr, "Failed to convert %s\n", argv[arg]);
+		return 1;
+	}
+
+	if (slots && slots != model.accumulatorSlots)
+	{
+		free(slots);
+		free(links);
+	}
+
+	NFreeModel(&model);
+
+	FILE* output = fopen(argv[arg + 1], "wb");
+	if (!output || fwrite(writer.data, writer.size, 1, output) != 1)
+	{
+		fprintf(stderr, "Failed to write %s\n", argv[arg + 1]);
+		return 1;
+	}
+	fclose(output);
+
+	printf("sections:     %u, aligned by %u or the value size\n", writer.sectionsCount, writer.align);
+	printf("accumulators: %u bytes per sample, %u bytes with a slot for every neuron\n",
+		   slotsCount * accTypeSize, neuronsCount * accTypeSize);
+
+	char name[16];
+	snprintf(name, sizeof(name), "version %u", inputVersion);
+
+	// Copy to memory aligned for any value, as a linker places a model array
+	uint8_t* copy = malloc(writer.size);
+	if (!copy)
+		return 1;
+	memcpy(copy, writer.data, writer.size);
+
+	int res = ReportLoad(name, input, inputSize) | ReportLoad("version 2", copy, writer.size);
+	res |= CheckOutputs(input, inputSize, copy, writer.size);
+
+	free(copy);
+	free(writer.data);
+	free(input);
+
+	return res ? 1 : 0;
+}
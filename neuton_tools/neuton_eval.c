@@ -0,0 +1,664 @@
+/**
+ ******************************************************************************
+ * @file    neuton_eval.c
+ * @brief   Evaluation of a model over a binary dataset or a CSV file
+ *          (trainingdata.csv) by a pool of threads
+ *
+ * The model is loaded once and shared, every thread has its own context. The
+ * rows are split into chunks, which the threads take from a shared counter:
+ * runs of rows of the mapped dataset (NMapDataset) or runs of whole lines of
+ * the mapped CSV file, parsed by the thread that takes them. Every block of
+ * rows is run by NRunInferenceRowsContext and timed. The threads keep their
+ * own counts, which are added up at the end into the confusion matrix, the
+ * mean probabilities of every class by target and the latency percentiles
+ * (the error for regression models).
+ *
+ * Targets are read from the CSV column named "target", or from the last value
+ * of the dataset samples if the samples have one value more than the model
+ * inputs without bias (csv2dataset -t).
+ *
+ * Usage: neuton_eval [-j threads] [-b block] model.bin data.bin|data.csv
+ ******************************************************************************
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "neuton/neuton.h"
+
+
+#define MAX_THREADS			256
+#define MAX_FIELD_LENGTH	64
+#define MAX_CLASSES			64
+
+#define DATASET_CHUNK_ROWS	4096
+#define CSV_CHUNK_SIZE		(1u << 20)
+
+
+typedef struct Chunk_
+{
+	const char* begin;
+	const char* end;
+
+} Chunk;
+
+/**
+ * \brief Counts of one thread, added up at the end
+ */
+typedef struct Stats_
+{
+	uint64_t  rows;
+	uint64_t  skipped;
+	uint64_t  badTargets;
+	uint64_t  confusion[MAX_CLASSES * MAX_CLASSES];
+	double    probabilities[MAX_CLASSES * MAX_CLASSES];
+	double    absError;
+	double    squaredError;
+
+	float*    latencies;
+	uint64_t  latenciesCount;
+	uint64_t  latenciesCapacity;
+
+} Stats;
+
+typedef struct Job_
+{
+	NeuralNet*      model;
+	uint32_t        blockSize;
+	uint32_t        classes;
+	uint8_t         hasTargets;
+
+	// Binary dataset
+	NDatasetView    view;
+	uint8_t         isDataset;
+
+	// CSV file
+	const char*     csv;
+	size_t          csvSize;
+	Chunk*          chunks;
+	uint32_t        columns;
+	int32_t         targetColumn;
+
+	uint32_t        chunksCount;
+	atomic_uint     nextChunk;
+
+} Job;
+
+typedef struct Worker_
+{
+	Job*      job;
+	pthread_t thread;
+	NContext  context;
+	float*    rows;
+	float*    targets;
+	float*    outputs;
+	Stats     stats;
+	Err       err;
+
+} Worker;
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static int CompareFloat(const void* a, const void* b)
+{
+	const float x = *(const float*) a, y = *(const float*) b;
+	return (x > y) - (x < y);
+}
+
+
+/**
+ * \brief Run inference on a block of rows and count the results
+ * \param rows - model inputs without bias, row s starts at value s * rowDim
+ * \param targets - target of every row, NULL if there are none
+ */
+static void Evaluate(Worker* worker, const void* rows, uint32_t rowDim, uint32_t count, const float* targets)
+{
+	Job* job = worker->job;
+	NeuralNet* model = job->model;
+	Stats* stats = &worker->stats;
+
+	const double start = Now();
+	worker->err = NRunInferenceRowsContext(model, &worker->context, rows, rowDim, count, worker->outputs);
+	const double elapsed = Now() - start;
+
+	if (worker->err != ERR_NO_ERROR)
+		return;
+
+	if (stats->latenciesCount == stats->latenciesCapacity)
+	{
+		stats->latenciesCapacity = stats->latenciesCapacity ? 2 * stats->latenciesCapacity : 4096;
+		stats->latencies = realloc(stats->latencies, stats->latenciesCapacity * sizeof(float));
+	}
+	stats->latencies[stats->latenciesCount++] = (float) (elapsed * 1e6);
+
+	if (!job->hasTargets)
+		targets = NULL;
+
+	for (uint32_t s = 0; s < count; ++s)
+	{
+		float* result = worker->outputs + (size_t) s * model->outputsDim;
+
+		// Only reads the model, so the shared model is safe here
+		NDenormalizeResult(result, model);
+		stats->rows++;
+
+		if (model->taskType == TASK_REGRESSION)
+		{
+			if (targets)
+			{
+				const double error = (double) result[0] - targets[s];
+				stats->absError += fabs(error);
+				stats->squaredError += error * error;
+			}
+			continue;
+		}
+
+		uint32_t predicted = 0;
+		for (uint32_t idx = 1; idx < job->classes; ++idx)
+			if (result[idx] > result[predicted])
+				predicted = idx;
+
+		// Without targets every row is counted under target 0
+		uint32_t target = 0;
+		if (targets)
+		{
+			const float value = targets[s];
+
+			if (!(value >= 0.0f && value < (float) job->classes) || value != floorf(value))
+			{
+				stats->badTargets++;
+				continue;
+			}
+
+			target = (uint32_t) value;
+		}
+
+		stats->confusion[target * job->classes + predicted]++;
+
+		for (uint32_t idx = 0; idx < job->classes; ++idx)
+			stats->probabilities[target * job->classes + idx] += result[idx];
+	}
+}
+
+
+static void EvaluateDatasetChunk(Worker* worker, uint32_t chunk)
+{
+	const Job* job = worker->job;
+	const NDatasetView* view = &job->view;
+	const uint32_t first = chunk * DATASET_CHUNK_ROWS;
+	const uint32_t last = first + DATASET_CHUNK_ROWS < view->samplesCount ? first + DATASET_CHUNK_ROWS :
+			view->samplesCount;
+	const size_t rowSize = (size_t) view->sampleDim * sizeof(float);
+
+	for (uint32_t row = first; row < last; row += job->blockSize)
+	{
+		const uint32_t count = last - row < job->blockSize ? last - row : job->blockSize;
+		const uint8_t* block = view->samples + row * rowSize;
+
+		// The target is the last value, samples are not aligned
+		if (job->hasTargets)
+			for (uint32_t s = 0; s < count; ++s)
+				memcpy(&worker->targets[s], block + s * rowSize + rowSize - sizeof(float), sizeof(float));
+
+		Evaluate(worker, block, view->sampleDim, count, worker->targets);
+	}
+}
+
+
+static int ParseField(const char* begin, const char* end, float* value)
+{
+	char text[MAX_FIELD_LENGTH];
+	const size_t length = (size_t) (end - begin);
+
+	if (length == 0 || length >= sizeof(text))
+		return -1;
+
+	memcpy(text, begin, length);
+	text[length] = '\0';
+
+	char* stop;
+	*value = strtof(text, &stop);
+
+	return stop == text + length ? 0 : -1;
+}
+
+
+/**
+ * \brief Parse one CSV row into the model inputs and the target
+ * \return 0 on success, -1 if a value is not a number or the row has a wrong number of values
+ */
+static int ParseRow(const Job* job, const char* pos, const char* rowEnd, float* row, float* target)
+{
+	uint32_t stored = 0;
+
+	for (uint32_t column = 0; column < job->columns; ++column)
+	{
+		const char* fieldEnd = memchr(pos, ',', (size_t) (rowEnd - pos));
+		fieldEnd = fieldEnd ? fieldEnd : rowEnd;
+
+		if ((fieldEnd == rowEnd) != (column + 1 == job->columns))
+			return -1;
+
+		float value;
+		if (ParseField(pos, fieldEnd, &value) != 0)
+			return -1;
+
+		if ((int32_t) column == job->targetColumn)
+			*target = value;
+		else
+			row[stored++] = value;
+
+		pos = fieldEnd + 1;
+	}
+
+	return 0;
+}
+
+
+static void EvaluateCsvChunk(Worker* worker, uint32_t chunk)
+{
+	const Job* job = worker->job;
+	const uint32_t rowDim = job->model->inputsDim - 1;
+	uint32_t count = 0;
+
+	for (const char* line = job->chunks[chunk].begin; line < job->chunks[chunk].end; )
+	{
+		const char* newline = memchr(line, '\n', (size_t) (job->chunks[chunk].end - line));
+		const char* lineEnd = newline ? newline : job->chunks[chunk].end;
+		const char* rowEnd = (lineEnd > line && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+
+		if (rowEnd > line)
+		{
+			if (ParseRow(job, line, rowEnd, worker->rows + (size_t) count * rowDim, &worker->targets[count]) == 0)
+				count++;
+			else
+				worker->stats.skipped++;
+		}
+
+		if (count == job->blockSize)
+		{
+			Evaluate(worker, worker->rows, rowDim, count, worker->targets);
+			count = 0;
+		}
+
+		line = lineEnd + 1;
+	}
+
+	if (count)
+		Evaluate(worker, worker->rows, rowDim, count, worker->targets);
+}
+
+
+static void* RunWorker(void* arg)
+{
+	Worker* worker = arg;
+	Job* job = worker->job;
+	uint32_t chunk;
+
+	worker->err = NCreateContext(job->model, &worker->context);
+
+	while (worker->err == ERR_NO_ERROR && (chunk = atomic_fetch_add(&job->nextChunk, 1)) < job->chunksCount)
+	{
+		if (job->isDataset)
+			EvaluateDatasetChunk(worker, chunk);
+		else
+			EvaluateCsvChunk(worker, chunk);
+	}
+
+	NFreeContext(&worker->context);
+
+	return NULL;
+}
+
+
+/**
+ * \brief Count the columns of the header and find the target column
+ * \return number of columns
+ */
+static uint32_t ParseHeader(const char* line, const char* lineEnd, int32_t* targetColumn)
+{
+	uint32_t columns = 0;
+
+	*targetColumn = -1;
+
+	if (lineEnd > line && lineEnd[-1] == '\r')
+		lineEnd--;
+
+	for (const char* pos = line; pos <= lineEnd; ++columns)
+	{
+		const char* fieldEnd = memchr(pos, ',', (size_t) (lineEnd - pos));
+		fieldEnd = fieldEnd ? fieldEnd : lineEnd;
+
+		if (fieldEnd - pos == 6 && memcmp(pos, "target", 6) == 0)
+			*targetColumn = (int32_t) columns;
+
+		pos = fieldEnd + 1;
+	}
+
+	return columns;
+}
+
+
+/**
+ * \brief Split the body into chunks of whole lines
+ * \return number of chunks
+ */
+static uint32_t SplitChunks(const char* body, const char* end, Chunk** chunks)
+{
+	const uint32_t capacity = (uint32_t) ((size_t) (end - body) / CSV_CHUNK_SIZE + 1);
+	uint32_t count = 0;
+
+	*chunks = calloc(capacity, sizeof(Chunk));
+
+	for (const char* pos = body; pos < end && count < capacity; ++count)
+	{
+		const char* split = (size_t) (end - pos) > CSV_CHUNK_SIZE ? pos + CSV_CHUNK_SIZE : end;
+
+		if (split < end)
+		{
+			const char* newline = memchr(split, '\n', (size_t) (end - split));
+			split = newline ? newline + 1 : end;
+		}
+
+		if (count + 1 == capacity)
+			split = end;
+
+		(*chunks)[count].begin = pos;
+		(*chunks)[count].end = split;
+		pos = split;
+	}
+
+	return count;
+}
+
+
+/**
+ * \brief Open the data file as a binary dataset or as a CSV file
+ * \return 0 on success
+ */
+static int OpenData(Job* job, const char* fileName)
+{
+	const uint32_t features = job->model->inputsDim - 1;
+	const Err err = NMapDataset(fileName, &job->view);
+
+	if (err == ERR_NO_ERROR)
+	{
+		if (job->view.sampleDim != features && job->view.sampleDim != features + 1)
+		{
+			fprintf(stderr, "%s: samples have %u values, the model has %u inputs\n", fileName,
+					job->view.sampleDim, features);
+			return -1;
+		}
+
+		job->isDataset   = 1;
+		job->hasTargets  = job->view.sampleDim == features + 1;
+		job->chunksCount = (job->view.samplesCount + DATASET_CHUNK_ROWS - 1) / DATASET_CHUNK_ROWS;
+		return 0;
+	}
+
+	if (err != ERR_BAD_FILE_FORMAT)
+	{
+		fprintf(stderr, "%s: can not open (error %d)\n", fileName, err);
+		return -1;
+	}
+
+	const int fd = open(fileName, O_RDONLY);
+	struct stat st;
+
+	if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		fprintf(stderr, "%s: can not open\n", fileName);
+		return -1;
+	}
+
+	job->csvSize = (size_t) st.st_size;
+	job->csv = mmap(NULL, job->csvSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (job->csv == MAP_FAILED)
+	{
+		job->csv = NULL;
+		fprintf(stderr, "%s: can not map\n", fileName);
+		return -1;
+	}
+
+	const char* end = job->csv + job->csvSize;
+	const char* newline = memchr(job->csv, '\n', job->csvSize);
+	const char* headerEnd = newline ? newline : end;
+
+	job->columns    = ParseHeader(job->csv, headerEnd, &job->targetColumn);
+	job->hasTargets = job->targetColumn >= 0;
+
+	if (job->columns - job->hasTargets != features)
+	{
+		fprintf(stderr, "%s: %u columns%s, the model has %u inputs\n", fileName, job->columns,
+				job->hasTargets ? " with target" : "", features);
+		return -1;
+	}
+
+	job->chunksCount = newline ? SplitChunks(newline + 1, end, &job->chunks) : 0;
+
+	return 0;
+}
+
+
+static void PrintReport(const Job* job, const Stats* total, uint32_t threads, double seconds)
+{
+	const NeuralNet* model = job->model;
+	const uint32_t classes = job->classes;
+
+	printf("%llu rows in %.3f s, %.0f rows/s, %u threads, blocks of %u rows\n",
+		   (unsigned long long) total->rows, seconds, total->rows / seconds, threads, job->blockSize);
+
+	if (total->skipped)
+		printf("%llu CSV rows skipped: a value is not a number or the number of values is wrong\n",
+			   (unsigned long long) total->skipped);
+
+	if (total->latenciesCount)
+	{
+		float* latencies = total->latencies;
+		const uint64_t count = total->latenciesCount;
+
+		qsort(latencies, count, sizeof(float), CompareFloat);
+
+		printf("latency of a block, us: p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+			   latencies[(count - 1) * 50 / 100], latencies[(count - 1) * 90 / 100],
+			   latencies[(count - 1) * 99 / 100], latencies[(count - 1) * 999 / 1000], latencies[count - 1]);
+	}
+
+	if (model->taskType == TASK_REGRESSION)
+	{
+		if (job->hasTargets && total->rows)
+			printf("MAE %.6g, RMSE %.6g\n", total->absError / total->rows, sqrt(total->squaredError / total->rows));
+		return;
+	}
+
+	if (total->badTargets)
+		printf("%llu rows skipped: target is not a class of the model\n", (unsigned long long) total->badTargets);
+
+	const uint32_t targets = job->hasTargets ? classes : 1;
+	uint64_t correct = 0, counted = 0;
+
+	for (uint32_t target = 0; target < targets; ++target)
+		for (uint32_t predicted = 0; predicted < classes; ++predicted)
+		{
+			counted += total->confusion[target * classes + predicted];
+			correct += target == predicted ? total->confusion[target * classes + predicted] : 0;
+		}
+
+	if (job->hasTargets)
+	{
+		printf("accuracy %.4f (%llu of %llu)\n\n", counted ? (double) correct / counted : 0.0,
+			   (unsigned long long) correct, (unsigned long long) counted);
+		printf("confusion matrix, rows are targets, columns are predicted classes\n");
+	}
+	else
+	{
+		printf("no targets\n\npredicted classes\n");
+	}
+
+	printf("%8s", "");
+	for (uint32_t predicted = 0; predicted < classes; ++predicted)
+		printf(" %10u", predicted);
+	printf("\n");
+
+	for (uint32_t target = 0; target < targets; ++target)
+	{
+		if (job->hasTargets)
+			printf("%8u", target);
+		else
+			printf("%8s", "");
+
+		for (uint32_t predicted = 0; predicted < classes; ++predicted)
+			printf(" %10llu", (unsigned long long) total->confusion[target * classes + predicted]);
+		printf("\n");
+	}
+
+	printf("\nmean probabilities%s\n", job->hasTargets ? ", rows are targets" : "");
+
+	for (uint32_t target = 0; target < targets; ++target)
+	{
+		uint64_t rows = 0;
+		for (uint32_t predicted = 0; predicted < classes; ++predicted)
+			rows += total->confusion[target * classes + predicted];
+
+		if (job->hasTargets)
+			printf("%8u", target);
+		else
+			printf("%8s", "");
+
+		for (uint32_t idx = 0; idx < classes; ++idx)
+			printf(" %10.4f", rows ? total->probabilities[target * classes + idx] / rows : 0.0);
+		printf("\n");
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	long threadsCount = sysconf(_SC_NPROCESSORS_ONLN);
+	long blockSize = 64;
+	int arg = 1;
+
+	for (; arg < argc && argv[arg][0] == '-'; ++arg)
+	{
+		if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+			threadsCount = atol(argv[++arg]);
+		else if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc)
+			blockSize = atol(argv[++arg]);
+		else
+			break;
+	}
+
+	if (argc - arg != 2 || threadsCount < 1 || threadsCount > MAX_THREADS || blockSize < 1 || blockSize > 65536)
+	{
+		fprintf(stderr, "Usage: %s [-j threads] [-b block] model.bin data.bin|data.csv\n", argv[0]);
+		return 1;
+	}
+
+	static Job job;
+	static NeuralNet model;
+
+	if (NLoadModelEx(argv[arg], &model) != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "%s: can not load the model\n", argv[arg]);
+		return 1;
+	}
+
+	job.model     = &model;
+	job.blockSize = (uint32_t) blockSize;
+	job.classes   = model.outputsDim < MAX_CLASSES ? model.outputsDim : MAX_CLASSES;
+
+	if (OpenData(&job, argv[arg + 1]) != 0)
+		return 1;
+
+	printf("%s: %u inputs, %u outputs, %u bit; %s: %s%s\n", argv[arg], model.inputsDim, model.outputsDim,
+		   model.quantisation, argv[arg + 1], job.isDataset ? "dataset" : "CSV",
+		   job.hasTargets ? " with targets" : "");
+
+	Worker* workers = calloc((size_t) threadsCount, sizeof(Worker));
+	const double start = Now();
+
+	for (long idx = 0; idx < threadsCount; ++idx)
+	{
+		Worker* worker = &workers[idx];
+
+		worker->job     = &job;
+		worker->rows    = malloc((size_t) blockSize * model.inputsDim * sizeof(float));
+		worker->targets = malloc((size_t) blockSize * sizeof(float));
+		worker->outputs = malloc((size_t) blockSize * model.outputsDim * sizeof(float));
+
+		pthread_create(&worker->thread, NULL, RunWorker, worker);
+	}
+
+	for (long idx = 0; idx < threadsCount; ++idx)
+		pthread_join(workers[idx].thread, NULL);
+
+	const double seconds = Now() - start;
+	static Stats total;
+	int status = 0;
+
+	for (long idx = 0; idx < threadsCount; ++idx)
+	{
+		Worker* worker = &workers[idx];
+		const Stats* stats = &worker->stats;
+
+		if (worker->err != ERR_NO_ERROR)
+		{
+			fprintf(stderr, "thread %ld failed (error %d)\n", idx, worker->err);
+			status = 1;
+		}
+
+		total.rows         += stats->rows;
+		total.skipped      += stats->skipped;
+		total.badTargets   += stats->badTargets;
+		total.absError     += stats->absError;
+		total.squaredError += stats->squaredError;
+
+		for (uint32_t cell = 0; cell < MAX_CLASSES * MAX_CLASSES; ++cell)
+		{
+			total.confusion[cell]     += stats->confusion[cell];
+			total.probabilities[cell] += stats->probabilities[cell];
+		}
+
+		total.latencies = realloc(total.latencies, (total.latenciesCount + stats->latenciesCount) * sizeof(float));
+		memcpy(total.latencies + total.latenciesCount, stats->latencies, stats->latenciesCount * sizeof(float));
+		total.latenciesCount += stats->latenciesCount;
+
+		free(stats->latencies);
+		free(worker->rows);
+		free(worker->targets);
+		free(worker->outputs);
+	}
+
+	PrintReport(&job, &total, (uint32_t) threadsCount, seconds);
+
+	free(total.latencies);
+	free(workers);
+	free(job.chunks);
+	if (job.csv)
+		munmap((void*) job.csv, job.csvSize);
+	NCloseDatasetView(&job.view);
+	NFreeModel(&model);
+
+	return status || total.skipped || total.badTargets;
+}
@@ -0,0 +1,312 @@
+/**
+ ******************************************************************************
+ * @file    raw_check.c
+ * @brief   Differential test and benchmark of the integer raw sensor input path
+ *          (NSetRawInputs, NRunRawInference) against the float one
+ *
+ * Every CSV value is converted to the raw count of its channel. The float path
+ * prepares count * unit with NPrepareSample, the raw path converts the counts
+ * with no float arithmetic. Quantised inputs and outputs of both are compared.
+ *
+ * Usage: raw_check [-u unit,...] model.bin data.csv [repeats]
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "neuton/neuton.h"
+
+
+#define MAX_LINE_LENGTH		(1 << 16)
+#define MAX_CHANNELS		64
+
+#define G					9.80665f
+#define DEG_TO_RAD			0.017453292519943295f
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * \brief Run the float path the same way as CalculatorRunInference
+ */
+static float* RunFloat(NeuralNet* model, float* sample)
+{
+	NPrepareSample(sample, model);
+
+	float* result = NRunPreparedInference(model, sample);
+	if (result)
+		NDenormalizeResult(result, model);
+
+	return result;
+}
+
+
+/**
+ * \brief Run the raw path the same way as CalculatorRunRawInference
+ */
+static float* RunRaw(NeuralNet* model, const int16_t* counts)
+{
+	float* result = NRunRawInference(model, counts);
+	if (result)
+		NDenormalizeResult(result, model);
+
+	return result;
+}
+
+
+/**
+ * \brief Read CSV rows into samples, extra columns (target) are ignored and bias is set to 1.0
+ * \return number of samples
+ */
+static uint32_t ReadCsv(const char* fileName, uint16_t inputsDim, float** samples)
+{
+	FILE* file = fopen(fileName, "r");
+	if (!file)
+		return 0;
+
+	char* line = malloc(MAX_LINE_LENGTH);
+	uint32_t count = 0, capacity = 0;
+	*samples = NULL;
+
+	if (!line || !fgets(line, MAX_LINE_LENGTH, file))
+	{
+		free(line);
+		fclose(file);
+		return 0;
+	}
+
+	while (fgets(line, MAX_LINE_LENGTH, file))
+	{
+		if (count == capacity)
+		{
+			capacity = capacity ? capacity * 2 : 64;
+			*samples = realloc(*samples, (size_t) capacity * inputsDim * sizeof(float));
+		}
+
+		float* sample = *samples + (size_t) count * inputsDim;
+		char* pos = line;
+
+		for (uint16_t idx = 0; idx < inputsDim - 1; ++idx)
+		{
+			char* end;
+			sample[idx] = strtof(pos, &end);
+			pos = (*end == ',') ? end + 1 : end;
+		}
+		sample[inputsDim - 1] = 1.0f;
+
+		count++;
+	}
+
+	free(line);
+	fclose(file);
+
+	return count;
+}
+
+
+/**
+ * \brief Parse comma separated units
+ * \return number of units or 0 on failure
+ */
+static uint16_t ParseUnits(const char* text, float* units)
+{
+	uint16_t count = 0;
+
+	while (*text && count < MAX_CHANNELS)
+	{
+		char* end;
+		units[count] = strtof(text, &end);
+		if (end == text || units[count] == 0.0f)
+			return 0;
+
+		count++;
+		text = (*end == ',') ? end + 1 : end;
+	}
+
+	return *text ? 0 : count;
+}
+
+
+static uint16_t Argmax(const float* values, uint16_t count)
+{
+	uint16_t max = 0;
+
+	for (uint16_t idx = 1; idx < count; ++idx)
+		if (values[idx] > values[max])
+			max = idx;
+
+	return max;
+}
+
+
+int main(int argc, char** argv)
+{
+	// MPU6050 with MPU6050_RANGE_16_G and MPU6050_RANGE_250_DEG, as in the sketch
+	float units[MAX_CHANNELS] = {
+		G / 2048, G / 2048, G / 2048,
+		DEG_TO_RAD / 131.0f, DEG_TO_RAD / 131.0f, DEG_TO_RAD / 131.0f
+	};
+	uint16_t channels = 6;
+	int arg = 1;
+
+	if (arg + 1 < argc && strcmp(argv[arg], "-u") == 0)
+	{
+		channels = ParseUnits(argv[arg + 1], units);
+		arg += 2;
+	}
+
+	if (argc - arg < 2 || !channels)
+	{
+		fprintf(stderr, "Usage: %s [-u unit,...] model.bin data.csv [repeats]\n", argv[0]);
+		return 1;
+	}
+
+	const uint32_t repeats = argc - arg > 2 ? (uint32_t) atoi(argv[arg + 2]) : 1000;
+
+	NeuralNet model = { 0 };
+	if (NLoadModelEx(argv[arg], &model) != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Failed to load %s\n", argv[arg]);
+		return 1;
+	}
+
+	const Err err = NSetRawInputs(&model, units, channels, 1.0f);
+	if (err != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Raw inputs are not supported by %s (error %d)\n", argv[arg], err);
+		return 1;
+	}
+
+	float* samples = NULL;
+	const uint32_t count = ReadCsv(argv[arg + 1], model.inputsDim, &samples);
+	if (!count)
+	{
+		fprintf(stderr, "No samples in %s\n", argv[arg + 1]);
+		return 1;
+	}
+
+	// Raw counts of the CSV values and the float values the sensor library makes of them
+	const uint16_t countsDim = model.inputsDim - 1;
+	int16_t* counts = malloc((size_t) count * countsDim * sizeof(*counts));
+	float* values = malloc((size_t) count * model.inputsDim * sizeof(*values));
+
+	for (uint32_t s = 0; s < count; ++s)
+	{
+		for (uint16_t idx = 0; idx < countsDim; ++idx)
+		{
+			const float unit = units[idx % channels];
+			const double raw = nearbyint(samples[(size_t) s * model.inputsDim + idx] / unit);
+			const int16_t value = raw > INT16_MAX ? INT16_MAX : raw < INT16_MIN ? INT16_MIN : (int16_t) raw;
+
+			counts[(size_t) s * countsDim + idx] = value;
+			values[(size_t) s * model.inputsDim + idx] = value * unit;
+		}
+		values[(size_t) s * model.inputsDim + countsDim] = 1.0f;
+	}
+
+	float* sample = malloc(model.inputsDim * sizeof(float));
+	uint8_t* expectedInputs = malloc(model.inputsDim);
+	uint32_t inputMismatches = 0, maxInputDiff = 0;
+	uint32_t mismatches = 0, argmaxMismatches = 0, csvArgmaxMismatches = 0;
+	double maxDiff = 0;
+
+	for (uint32_t s = 0; s < count; ++s)
+	{
+		float expected[64], actual[64], original[64];
+
+		memcpy(sample, samples + (size_t) s * model.inputsDim, model.inputsDim * sizeof(float));
+		memcpy(original, RunFloat(&model, sample), model.outputsDim * sizeof(float));
+
+		memset(model.context.quantisedInputs.u8, 0, model.inputsDim);
+		memcpy(sample, values + (size_t) s * model.inputsDim, model.inputsDim * sizeof(float));
+		memcpy(expected, RunFloat(&model, sample), model.outputsDim * sizeof(float));
+		memcpy(expectedInputs, model.context.quantisedInputs.u8, model.inputsDim);
+
+		memset(model.context.quantisedInputs.u8, 0, model.inputsDim);
+		memcpy(actual, RunRaw(&model, counts + (size_t) s * countsDim), model.outputsDim * sizeof(float));
+
+		for (uint16_t idx = 0; idx < model.inputsDim; ++idx)
+		{
+			const uint8_t actualInput = model.context.quantisedInputs.u8[idx];
+			const uint32_t diff = actualInput > expectedInputs[idx] ?
+					actualInput - expectedInputs[idx] : expectedInputs[idx] - actualInput;
+
+			inputMismatches += diff > 0;
+			if (diff > maxInputDiff)
+				maxInputDiff = diff;
+		}
+
+		if (memcmp(expected, actual, model.outputsDim * sizeof(float)) != 0)
+			mismatches++;
+
+		for (uint16_t idx = 0; idx < model.outputsDim; ++idx)
+		{
+			const double diff = fabs((double) expected[idx] - actual[idx]);
+			if (diff > maxDiff)
+				maxDiff = diff;
+		}
+
+		argmaxMismatches += Argmax(expected, model.outputsDim) != Argmax(actual, model.outputsDim);
+		csvArgmaxMismatches += Argmax(original, model.outputsDim) != Argmax(actual, model.outputsDim);
+	}
+
+	// 8 bit models leave the sample unchanged, so the float path runs on the values in place
+	double floatTime = 0, rawTime = 0, kernelTime = 0;
+	volatile float sink = 0;
+
+	for (uint32_t r = 0; r < repeats; ++r)
+	{
+		double start = Now();
+
+		for (uint32_t s = 0; s < count; ++s)
+			sink += RunFloat(&model, values + (size_t) s * model.inputsDim)[0];
+
+		floatTime += Now() - start;
+		start = Now();
+
+		for (uint32_t s = 0; s < count; ++s)
+			sink += RunRaw(&model, counts + (size_t) s * countsDim)[0];
+
+		rawTime += Now() - start;
+		start = Now();
+
+		for (uint32_t s = 0; s < count; ++s)
+			sink += NRunPreparedInference(&model, sample)[0];
+
+		kernelTime += Now() - start;
+	}
+
+	const double runs = (double) repeats * count;
+
+	printf("samples:        %u\n", count);
+	printf("inputs:         %u differ (max %u)\n", inputMismatches, maxInputDiff);
+	printf("mismatches:     %u (argmax %u, max abs diff %g)\n", mismatches, argmaxMismatches, maxDiff);
+	printf("argmax vs CSV:  %u differ from the float path on the CSV values\n", csvArgmaxMismatches);
+	printf("float:          %.1f ns/inference, %.1f ns to prepare the sample\n",
+		   floatTime / runs * 1e9, (floatTime - kernelTime) / runs * 1e9);
+	printf("raw:            %.1f ns/inference, %.1f ns to convert the counts\n",
+		   rawTime / runs * 1e9, (rawTime - kernelTime) / runs * 1e9);
+	printf("capture buffer: %u bytes float, %u bytes raw\n",
+		   (uint32_t) (model.inputsDim * sizeof(float)), (uint32_t) (countsDim * sizeof(int16_t)));
+
+	free(expectedInputs);
+	free(sample);
+	free(values);
+	free(counts);
+	free(samples);
+	NFreeModel(&model);
+
+	return mismatches ? 2 : 0;
+}
@@ -0,0 +1,267 @@
+/**
+ ******************************************************************************
+ * @file    slice_bench.c
+ * @brief   Sampling jitter and dropped samples with and without the time-sliced
+ *          inference (NStartInference, NInferenceStep)
+ *
+ * The loop of the sketch is run on the host clock: a sample is due every period,
+ * an inference is started every hop samples. Without slicing the inference runs
+ * to completion and the samples due meanwhile are read late. A sample read one
+ * period or more after it was due is dropped, as the sensor has overwritten it.
+ * With slicing the loop evaluates at most budget neurons between two samples.
+ *
+ * Usage: slice_bench [-t period_us] [-n samples] [-k hop] [-b budget,...] model.bin
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "neuton/neuton.h"
+
+
+#define MAX_BUDGETS			16
+#define CHANNELS			6
+
+
+typedef struct Result_
+{
+	uint32_t samples;
+	uint32_t dropped;
+	uint32_t inferences;
+	uint32_t skipped;
+	uint32_t steps;
+	double*  delays;
+	double*  latencies;
+
+} Result;
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static int CompareDouble(const void* a, const void* b)
+{
+	const double x = *(const double*) a, y = *(const double*) b;
+
+	return (x > y) - (x < y);
+}
+
+
+static double Percentile(double* values, uint32_t count, uint32_t percent)
+{
+	if (!count)
+		return 0;
+
+	qsort(values, count, sizeof(*values), CompareDouble);
+
+	return values[(uint64_t) (count - 1) * percent / 100];
+}
+
+
+/**
+ * \brief Run the sampling loop
+ * \param budget - neurons per step, 0 to run every inference to completion
+ */
+static void RunLoop(NeuralNet* model, NContext* context, double period, uint32_t samples, uint32_t hop,
+					uint32_t budget, Result* result)
+{
+	const uint32_t windowSize = model->inputsDim - 1u;
+	float* window = calloc(model->inputsDim, sizeof(float));
+	float* sample = calloc(model->inputsDim, sizeof(float));
+	uint32_t position = 0, sinceInference = 0, seed = 1;
+	uint8_t running = 0;
+	double next = Now() + period, started = 0;
+
+	memset(result, 0, offsetof(Result, delays));
+
+	while (result->samples + result->dropped < samples)
+	{
+		const double now = Now();
+
+		if (now >= next)
+		{
+			// Samples due a period ago or earlier are overwritten by the sensor
+			const uint32_t missed = (uint32_t) ((now - next) / period);
+
+			result->dropped += missed;
+			result->delays[result->samples++] = now - next - missed * period;
+			next += (missed + 1) * period;
+
+			for (uint32_t ch = 0; ch < CHANNELS; ++ch)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				window[position] = (seed >> 8) / 16777216.0f;
+				position = position + 1 < windowSize ? position + 1 : 0;
+			}
+
+			if (++sinceInference < hop)
+				continue;
+
+			sinceInference = 0;
+
+			if (running)
+			{
+				result->skipped++;
+				continue;
+			}
+
+			memcpy(sample, window, windowSize * sizeof(float));
+			sample[windowSize] = 1.0f;
+			started = now;
+
+			if (!budget)
+			{
+				NRunInference(model, sample);
+				result->latencies[result->inferences++] = Now() - started;
+				result->steps++;
+			}
+			else
+			{
+				NStartInference(model, context, sample);
+				running = 1;
+			}
+
+			continue;
+		}
+
+		if (running)
+		{
+			result->steps++;
+
+			if (NInferenceStep(model, context, budget))
+			{
+				result->latencies[result->inferences++] = Now() - started;
+				running = 0;
+			}
+		}
+	}
+
+	free(sample);
+	free(window);
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t budgets[MAX_BUDGETS];
+	uint32_t budgetsCount = 0, samples = 5000, hop = 10;
+	double period = 1e-3;
+	int arg = 1;
+
+	for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2)
+	{
+		if (strcmp(argv[arg], "-t") == 0)
+		{
+			period = atof(argv[arg + 1]) * 1e-6;
+		}
+		else if (strcmp(argv[arg], "-n") == 0)
+		{
+			samples = (uint32_t) atoi(argv[arg + 1]);
+		}
+		else if (strcmp(argv[arg], "-k") == 0)
+		{
+			hop = (uint32_t) atoi(argv[arg + 1]);
+		}
+		else if (strcmp(argv[arg], "-b") == 0)
+		{
+			for (char* text = argv[arg + 1]; *text && budgetsCount < MAX_BUDGETS; )
+			{
+				char* end;
+				budgets[budgetsCount++] = (uint32_t) strtoul(text, &end, 10);
+				text = (*end == ',') ? end + 1 : end;
+				if (end == text)
+					break;
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (argc - arg != 1 || period <= 0 || !samples || !hop)
+	{
+		fprintf(stderr, "Usage: %s [-t period_us] [-n samples] [-k hop] [-b budget,...] model.bin\n", argv[0]);
+		return 1;
+	}
+
+	NeuralNet model = { 0 };
+	NContext context = { 0 };
+
+	if (NLoadModelEx(argv[arg], &model) != ERR_NO_ERROR || model.inputsDim < 2 ||
+		NCreateContext(&model, &context) != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Failed to load %s\n", argv[arg]);
+		return 1;
+	}
+
+	// Time of one full inference, to size the default budget to a quarter of the period
+	float* sample = calloc(model.inputsDim, sizeof(float));
+	const uint32_t repeats = 200;
+	double start = Now();
+
+	for (uint32_t r = 0; r < repeats; ++r)
+		NRunInference(&model, sample);
+
+	const double inferenceTime = (Now() - start) / repeats;
+	const double neuronTime = inferenceTime / model.executionCount;
+
+	free(sample);
+
+	if (!budgetsCount)
+	{
+		const double budget = period / 4 / neuronTime;
+
+		budgets[budgetsCount++] = budget < 1 ? 1 : budget > model.executionCount ? model.executionCount :
+								  (uint32_t) budget;
+	}
+
+	printf("model:      %u neurons evaluated, %.1f us/inference, %.1f ns/neuron\n",
+		   model.executionCount, inferenceTime * 1e6, neuronTime * 1e9);
+	printf("loop:       sample every %.0f us, inference every %u samples, %u samples\n\n",
+		   period * 1e6, hop, samples);
+	printf("budget,steps/inference,latency median us,latency max us,"
+		   "read delay median us,read delay p99 us,read delay max us,dropped samples,skipped inferences\n");
+
+	Result result;
+	result.delays = malloc(samples * sizeof(double));
+	result.latencies = malloc(samples * sizeof(double));
+
+	for (uint32_t idx = 0; idx <= budgetsCount; ++idx)
+	{
+		const uint32_t budget = idx ? budgets[idx - 1] : 0;
+		char label[16] = "none";
+
+		if (budget)
+			snprintf(label, sizeof(label), "%u", budget);
+
+		RunLoop(&model, &context, period, samples, hop, budget, &result);
+
+		printf("%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%u,%u\n", label,
+			   result.inferences ? (double) result.steps / result.inferences : 0.0,
+			   Percentile(result.latencies, result.inferences, 50) * 1e6,
+			   Percentile(result.latencies, result.inferences, 100) * 1e6,
+			   Percentile(result.delays, result.samples, 50) * 1e6,
+			   Percentile(result.delays, result.samples, 99) * 1e6,
+			   Percentile(result.delays, result.samples, 100) * 1e6,
+			   result.dropped, result.skipped);
+	}
+
+	free(result.latencies);
+	free(result.delays);
+	NFreeContext(&context);
+	NFreeModel(&model);
+
+	return 0;
+}
@@ -0,0 +1,377 @@
+/**
+ ******************************************************************************
+ * @file    stream_replay.c
+ * @brief   Host replay of a sensor stream through the sliding window inference
+ *          (NStreamPush, NStreamTrigger, NRunRawInferenceView)
+ *
+ * The stream is a CSV file with one sample per line (the counts of all
+ * channels in the units of the sensor library) and an optional target
+ * column: the class of the gesture the sample belongs to, -1 or empty for
+ * none. A CSV file of windows (trainingdata.csv) is replayed as a stream of
+ * its windows separated by samples of a device at rest. Detections are
+ * reported the same way as by the sketch and matched against the targets.
+ *
+ * Usage: stream_replay [-k hop] [-p pre_trigger] [-c confidence] [-g gap] [-u unit,...]
+ *                      model.bin data.csv
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "neuton/neuton.h"
+
+
+#define MAX_LINE_LENGTH		(1 << 16)
+#define MAX_CHANNELS		64
+
+#define G					9.80665f
+#define DEG_TO_RAD			0.017453292519943295f
+
+#define SAMPLE_PERIOD_MS	10.0
+#define ACC_THRESHOLD		(5 * 2048 / 2)
+
+
+typedef struct Stream_
+{
+	int16_t* counts;
+	int16_t* targets;
+	uint32_t samples;
+	uint32_t capacity;
+
+} Stream;
+
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static int16_t ToCount(float value, float unit)
+{
+	const double count = nearbyint(value / unit);
+
+	return count > INT16_MAX ? INT16_MAX : count < INT16_MIN ? INT16_MIN : (int16_t) count;
+}
+
+
+static void Append(Stream* stream, const int16_t* counts, uint16_t channels, int16_t target)
+{
+	if (stream->samples == stream->capacity)
+	{
+		stream->capacity = stream->capacity ? stream->capacity * 2 : 1024;
+		stream->counts  = realloc(stream->counts, (size_t) stream->capacity * channels * sizeof(int16_t));
+		stream->targets = realloc(stream->targets, (size_t) stream->capacity * sizeof(int16_t));
+	}
+
+	memcpy(stream->counts + (size_t) stream->samples * channels, counts, channels * sizeof(int16_t));
+	stream->targets[stream->samples++] = target;
+}
+
+
+/**
+ * \brief Append samples of a device lying still, with a little deterministic noise
+ */
+static void AppendRest(Stream* stream, const float* units, uint16_t channels, uint32_t samples)
+{
+	static uint32_t seed = 1;
+	int16_t counts[MAX_CHANNELS];
+
+	for (uint32_t s = 0; s < samples; ++s)
+	{
+		for (uint16_t ch = 0; ch < channels; ++ch)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const float noise = ((seed >> 8) / 16777216.0f - 0.5f) * (ch % 6 < 3 ? 0.1f : 0.02f);
+			const float rest = (ch % 6 == 0 || ch % 6 == 1) ? -0.4f : (ch % 6 == 2) ? 9.2f : 0.0f;
+
+			counts[ch] = ToCount(rest + noise, units[ch]);
+		}
+
+		Append(stream, counts, channels, -1);
+	}
+}
+
+
+/**
+ * \brief Read the stream, lines with at least windowCounts values are windows
+ * \return number of samples
+ */
+static uint32_t ReadStream(const char* fileName, const float* units, uint16_t channels,
+						   uint32_t windowCounts, uint32_t gap, Stream* stream)
+{
+	FILE* file = fopen(fileName, "r");
+	if (!file)
+		return 0;
+
+	char* line = malloc(MAX_LINE_LENGTH);
+	float* values = malloc((windowCounts + 1) * sizeof(float));
+	int16_t counts[MAX_CHANNELS];
+
+	if (!line || !values || !fgets(line, MAX_LINE_LENGTH, file))
+	{
+		free(values);
+		free(line);
+		fclose(file);
+		return 0;
+	}
+
+	while (fgets(line, MAX_LINE_LENGTH, file))
+	{
+		uint32_t count = 0;
+		char* pos = line;
+
+		while (count <= windowCounts)
+		{
+			char* end;
+			values[count] = strtof(pos, &end);
+			if (end == pos)
+				break;
+
+			count++;
+			pos = (*end == ',') ? end + 1 : end;
+		}
+
+		if (count >= windowCounts)
+		{
+			const int16_t target = count > windowCounts ? (int16_t) values[windowCounts] : 0;
+
+			AppendRest(stream, units, channels, gap);
+
+			for (uint32_t first = 0; first < windowCounts; first += channels)
+			{
+				for (uint16_t ch = 0; ch < channels; ++ch)
+					counts[ch] = ToCount(values[first + ch], units[ch]);
+
+				Append(stream, counts, channels, target);
+			}
+		}
+		else if (count >= channels)
+		{
+			for (uint16_t ch = 0; ch < channels; ++ch)
+				counts[ch] = ToCount(values[ch], units[ch]);
+
+			Append(stream, counts, channels, count > channels ? (int16_t) values[channels] : -1);
+		}
+	}
+
+	if (gap)
+		AppendRest(stream, units, channels, gap);
+
+	free(values);
+	free(line);
+	fclose(file);
+
+	return stream->samples;
+}
+
+
+/**
+ * \brief Parse comma separated units
+ * \return number of units or 0 on failure
+ */
+static uint16_t ParseUnits(const char* text, float* units)
+{
+	uint16_t count = 0;
+
+	while (*text && count < MAX_CHANNELS)
+	{
+		char* end;
+		units[count] = strtof(text, &end);
+		if (end == text || units[count] == 0.0f)
+			return 0;
+
+		count++;
+		text = (*end == ',') ? end + 1 : end;
+	}
+
+	return *text ? 0 : count;
+}
+
+
+static int CompareUint32(const void* a, const void* b)
+{
+	const uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+
+	return (x > y) - (x < y);
+}
+
+
+int main(int argc, char** argv)
+{
+	// MPU6050 with MPU6050_RANGE_16_G and MPU6050_RANGE_250_DEG, as in the sketch
+	float units[MAX_CHANNELS] = {
+		G / 2048, G / 2048, G / 2048,
+		DEG_TO_RAD / 131.0f, DEG_TO_RAD / 131.0f, DEG_TO_RAD / 131.0f
+	};
+	uint16_t channels = 6;
+	uint32_t hop = 10, preTrigger = 0, gap = 100;
+	float confidence = 0.6f;
+	int arg = 1;
+
+	for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2)
+	{
+		if (strcmp(argv[arg], "-k") == 0)
+			hop = (uint32_t) atoi(argv[arg + 1]);
+		else if (strcmp(argv[arg], "-p") == 0)
+			preTrigger = (uint32_t) atoi(argv[arg + 1]);
+		else if (strcmp(argv[arg], "-c") == 0)
+			confidence = strtof(argv[arg + 1], NULL);
+		else if (strcmp(argv[arg], "-g") == 0)
+			gap = (uint32_t) atoi(argv[arg + 1]);
+		else if (strcmp(argv[arg], "-u") == 0)
+			channels = ParseUnits(argv[arg + 1], units);
+		else
+			break;
+	}
+
+	if (argc - arg != 2 || !channels || hop > UINT16_MAX)
+	{
+		fprintf(stderr, "Usage: %s [-k hop] [-p pre_trigger] [-c confidence] [-g gap] [-u unit,...] "
+				"model.bin data.csv\n", argv[0]);
+		return 1;
+	}
+
+	NeuralNet model = { 0 };
+	if (NLoadModelEx(argv[arg], &model) != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Failed to load %s\n", argv[arg]);
+		return 1;
+	}
+
+	const Err err = NSetRawInputs(&model, units, channels, 1.0f);
+	if (err != ERR_NO_ERROR)
+	{
+		fprintf(stderr, "Raw inputs are not supported by %s (error %d)\n", argv[arg], err);
+		return 1;
+	}
+
+	const uint32_t windowCounts = model.inputsDim - 1u;
+	const uint32_t windowSamples = windowCounts / channels;
+	int16_t* ring = malloc(windowCounts * sizeof(int16_t));
+	NStream window;
+
+	if (!ring || NStreamInit(&window, &model, ring, channels, hop) != ERR_NO_ERROR ||
+		preTrigger >= windowSamples)
+	{
+		fprintf(stderr, "Window of %u counts does not fit %u channels and %u pre-trigger samples\n",
+				windowCounts, channels, preTrigger);
+		return 1;
+	}
+
+	Stream stream = { 0 };
+	if (!ReadStream(argv[arg + 1], units, channels, windowCounts, gap, &stream))
+	{
+		fprintf(stderr, "No samples in %s\n", argv[arg + 1]);
+		return 1;
+	}
+
+	// Gestures are the runs of samples with one target, latencies are counted from their first sample
+	uint32_t* latencies = malloc(stream.samples * sizeof(uint32_t));
+	uint32_t gestures = 0, detected = 0, wrong = 0, falseDetections = 0, inferences = 0;
+	uint32_t onset = 0;
+	int16_t target = -1, found = -1, lastGesture = -1;
+	double inferenceTime = 0;
+
+	const double start = Now();
+
+	for (uint32_t s = 0; s < stream.samples; ++s)
+	{
+		const int16_t* sample = stream.counts + (size_t) s * channels;
+
+		if (stream.targets[s] >= 0 && (s == 0 || stream.targets[s - 1] != stream.targets[s]))
+		{
+			gestures++;
+			onset = s;
+			target = stream.targets[s];
+			found = -1;
+		}
+
+		if (labs(sample[0]) + labs(sample[1]) + labs(sample[2]) >= ACC_THRESHOLD)
+			NStreamTrigger(&window, preTrigger);
+
+		if (!NStreamPush(&window, sample))
+			continue;
+
+		NRawView view;
+		NStreamView(&window, &view);
+
+		// The same as CalculatorRunRawInferenceView
+		const double inferenceStart = Now();
+		float* result = NRunRawInferenceView(&model, &view);
+		NDenormalizeResult(result, &model);
+		inferenceTime += Now() - inferenceStart;
+		inferences++;
+
+		int16_t gesture = -1;
+		for (uint16_t idx = 0; idx < model.outputsDim; ++idx)
+			if (result[idx] > confidence)
+				gesture = idx;
+
+		// Reported as by the sketch: every result after a trigger, changes in the continuous mode
+		const uint8_t reported = gesture >= 0 && (hop == 0 || gesture != lastGesture);
+		lastGesture = gesture;
+
+		if (!reported)
+			continue;
+
+		// A detection belongs to the latest gesture until one more window has passed after it
+		if (target >= 0 && s < onset + 2 * windowSamples)
+		{
+			if (gesture == target && found < 0)
+			{
+				latencies[detected++] = s - onset;
+				found = gesture;
+			}
+			else if (gesture != target)
+			{
+				wrong++;
+			}
+		}
+		else
+		{
+			falseDetections++;
+		}
+	}
+
+	const double elapsed = Now() - start;
+
+	qsort(latencies, detected, sizeof(*latencies), CompareUint32);
+
+	const double streamSeconds = stream.samples * SAMPLE_PERIOD_MS / 1000.0;
+
+	printf("mode:           %s, hop %u, pre-trigger %u samples, confidence %.2f\n",
+		   hop ? "continuous + trigger" : "trigger", hop, preTrigger, confidence);
+	printf("stream:         %u samples (%.1f s at %.0f ms), %u gestures\n",
+		   stream.samples, streamSeconds, SAMPLE_PERIOD_MS, gestures);
+	printf("detections:     %u detected, %u missed, %u wrong class, %u outside gestures\n",
+		   detected, gestures - detected, wrong, falseDetections);
+
+	if (detected)
+	{
+		printf("latency:        median %.0f ms, p90 %.0f ms, max %.0f ms from the gesture onset\n",
+			   latencies[detected / 2] * SAMPLE_PERIOD_MS,
+			   latencies[(detected * 9) / 10] * SAMPLE_PERIOD_MS,
+			   latencies[detected - 1] * SAMPLE_PERIOD_MS);
+	}
+
+	printf("inferences:     %u, %.1f per second of stream\n", inferences, inferences / streamSeconds);
+	printf("host:           %.0f ns/inference, replay at %.0f samples/s\n",
+		   inferences ? inferenceTime / inferences * 1e9 : 0.0, stream.samples / elapsed);
+
+	free(latencies);
+	free(stream.targets);
+	free(stream.counts);
+	free(ring);
+	NFreeModel(&model);
+
+	return 0;
+}